@@ -0,0 +1,30 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common/rc.h"
+
+/**
+ * @brief 检查性能测试中准备环境的操作是否成功
+ * @details 建文件、插入初始数据等步骤失败以后测出来的数据没有意义，直接打印出错的步骤并退出进程
+ * @param rc   操作的返回值
+ * @param what 操作的描述，比如 "create file"
+ */
+inline void check(RC rc, const char *what)
+{
+  if (OB_FAIL(rc)) {
+    fprintf(stderr, "failed to %s. rc=%s\n", what, strrc(rc));
+    exit(1);
+  }
+}
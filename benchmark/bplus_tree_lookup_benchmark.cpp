@@ -0,0 +1,128 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <list>
+#include <memory>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+#include "benchmark_util.h"
+#include "common/rc.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/index/bplus_tree.h"
+
+using namespace std;
+using namespace benchmark;
+
+/**
+ * @brief 多线程读为主的 B+ 树查找
+ * @details 先插入 KEY_NUM 个整数键值，然后多个线程随机地查找，其中 write_percent% 的操作是插入新的键值。
+ * optimistic=1 时查找叶子节点先乐观地从根节点向下走，只在叶子节点上加锁；optimistic=0 时只使用加锁(crabbing)
+ * 的方式，每一层都加读锁并经过 root_lock_。按照线程数输出每秒的操作次数(items_per_second)，用来对比两种方式
+ * 在多核上的扩展性。
+ * 运行示例：./bplus_tree_lookup_benchmark --benchmark_counters_tabular=true
+ */
+class LookupBenchmark : public Fixture
+{
+public:
+  static constexpr int KEY_NUM = 1 << 20;
+
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    BufferPoolParam param;
+    param.memory_size     = 256L * 1024 * 1024;  // 整棵树都在内存中，测的是节点上的并发
+    param.frame_shard_num = 16;
+
+    bpm_ = make_unique<BufferPoolManager>(param);
+    BufferPoolManager::set_instance(bpm_.get());
+
+    file_name_ = "bplus_tree_lookup_benchmark_" + to_string(getpid()) + ".index";
+    ::remove(file_name_.c_str());
+
+    handler_ = make_unique<BplusTreeHandler>();
+    check(handler_->create(file_name_.c_str(), AttrType::INTS, sizeof(int32_t)), "create index");
+    for (int32_t i = 0; i < KEY_NUM; i++) {
+      RID rid(i / 100, i % 100);
+      check(handler_->insert_entry(reinterpret_cast<const char *>(&i), &rid), "insert entry");
+    }
+    next_key_.store(KEY_NUM);
+
+    handler_->set_optimistic(state.range(0) != 0);
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    handler_->close();
+    handler_.reset();
+    bpm_.reset();
+    ::remove(file_name_.c_str());
+  }
+
+protected:
+  unique_ptr<BufferPoolManager> bpm_;
+  string                        file_name_;
+  unique_ptr<BplusTreeHandler>  handler_;
+  atomic<int32_t>               next_key_{0};
+};
+
+BENCHMARK_DEFINE_F(LookupBenchmark, Lookup)(State &state)
+{
+  const int write_percent = static_cast<int>(state.range(1));
+
+  mt19937                           random(state.thread_index());
+  uniform_int_distribution<int32_t> key_dist(0, KEY_NUM - 1);
+  uniform_int_distribution<int>     op_dist(0, 99);
+
+  list<RID> rids;
+  int64_t   failed = 0;
+  for (auto _ : state) {
+    RC rc = RC::SUCCESS;
+    if (op_dist(random) < write_percent) {
+      const int32_t key = next_key_.fetch_add(1);
+      RID           rid(key / 100, key % 100);
+      rc = handler_->insert_entry(reinterpret_cast<const char *>(&key), &rid);
+    } else {
+      const int32_t key = key_dist(random);
+      rids.clear();
+      rc = handler_->get_entry(reinterpret_cast<const char *>(&key), sizeof(key), rids);
+      if (OB_SUCC(rc) && rids.size() != 1) {
+        rc = RC::RECORD_INVALID_KEY;
+      }
+    }
+
+    if (OB_FAIL(rc)) {
+      failed++;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["failed"] = Counter(static_cast<double>(failed));
+}
+
+BENCHMARK_REGISTER_F(LookupBenchmark, Lookup)
+    ->ArgNames({"optimistic", "write_percent"})
+    ->ArgsProduct({{0, 1}, {0, 5}})
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
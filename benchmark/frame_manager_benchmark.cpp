@@ -0,0 +1,134 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+
+#include "benchmark_util.h"
+#include "common/rc.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/frame.h"
+
+using namespace std;
+using namespace benchmark;
+
+/**
+ * @brief 多线程访问页帧管理器的吞吐量
+ * @details 多个线程随机地访问 PAGE_NUM 个页面，页面个数比页帧个数多一些。先用 get 查找页帧，找不到就 alloc，
+ * 分片中没有空闲页帧时调用 purge_frames 淘汰一些页帧后再 alloc。不读写磁盘，测的只是页帧表和分片锁上的竞争。
+ * 按照分片个数(shards)和线程数输出每秒查找页帧的次数(lookups)以及命中率(hit_ratio)，用来观察分片以后
+ * 查找能不能随着线程数扩展。
+ * 运行示例：./frame_manager_benchmark --benchmark_counters_tabular=true
+ */
+class FrameManagerBenchmark : public Fixture
+{
+public:
+  static constexpr int FILE_DESC = 100;
+  static constexpr int FRAME_NUM = 8192;
+  static constexpr int PAGE_NUM  = FRAME_NUM + FRAME_NUM / 4;
+  static constexpr int PURGE_NUM = 8;
+
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    BufferPoolParam param;
+    param.frame_shard_num = static_cast<int>(state.range(0));
+
+    frame_manager_ = make_unique<BPFrameManager>("FrameManagerBenchmark");
+    check(frame_manager_->init(FRAME_NUM, param), "init frame manager");
+
+    // 先把一部分页面放进来，测试开始时大部分的查找都能命中
+    for (PageNum page_num = 0; page_num < FRAME_NUM / 2; page_num++) {
+      Frame *frame = frame_manager_->alloc(FILE_DESC, page_num);
+      if (nullptr == frame) {
+        check(RC::NOMEM, "alloc frame");
+      }
+      frame->set_file_desc(FILE_DESC);
+      frame->unpin();
+    }
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    frame_manager_->cleanup();
+    frame_manager_.reset();
+  }
+
+protected:
+  /**
+   * @brief 分配一个页帧，没有空闲页帧时淘汰一些
+   * @details 页面都是干净的，purger 不需要做任何事情
+   */
+  Frame *alloc_frame(PageNum page_num)
+  {
+    Frame *frame = frame_manager_->alloc(FILE_DESC, page_num);
+    if (nullptr == frame) {
+      (void)frame_manager_->purge_frames(FILE_DESC, page_num, PURGE_NUM, [](Frame *) { return RC::SUCCESS; });
+      frame = frame_manager_->alloc(FILE_DESC, page_num);
+    }
+
+    if (frame != nullptr) {
+      frame->set_file_desc(FILE_DESC);
+    }
+    return frame;
+  }
+
+protected:
+  unique_ptr<BPFrameManager> frame_manager_;
+};
+
+BENCHMARK_DEFINE_F(FrameManagerBenchmark, Lookup)(State &state)
+{
+  mt19937                           random(state.thread_index());
+  uniform_int_distribution<PageNum> page_dist(0, PAGE_NUM - 1);
+
+  int64_t hit_count = 0;
+  int64_t failed    = 0;
+  for (auto _ : state) {
+    const PageNum page_num = page_dist(random);
+
+    Frame *frame = frame_manager_->get(FILE_DESC, page_num);
+    if (frame != nullptr) {
+      hit_count++;
+    } else {
+      frame = alloc_frame(page_num);
+    }
+
+    if (nullptr == frame) {
+      failed++;
+      continue;
+    }
+    frame->unpin();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["lookups"]   = Counter(static_cast<double>(state.iterations()), Counter::kIsRate);
+  state.counters["hit_ratio"] = Counter(static_cast<double>(hit_count), Counter::kAvgIterations);
+  state.counters["failed"]    = Counter(static_cast<double>(failed));
+}
+
+BENCHMARK_REGISTER_F(FrameManagerBenchmark, Lookup)
+    ->ArgName("shards")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
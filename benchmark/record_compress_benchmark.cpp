@@ -0,0 +1,186 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+#include "benchmark_util.h"
+#include "common/rc.h"
+#include "sql/parser/parse_defs.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/common/meta_util.h"
+#include "storage/record/record_manager.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+using namespace benchmark;
+
+/**
+ * @brief 压缩页面的压缩率和扫描速度
+ * @details 创建两个结构相同的表，一个是定长格式，一个是压缩格式，插入同样的数据：递增的 id、取值范围很小的
+ * 整数、只有几个不同取值的字符串和随机的浮点数。分别扫描两个表，输出：
+ * - items_per_second 每秒扫描的记录数
+ * - pages 存放这些记录用了多少个页面，也就是全表扫描需要读取的页面个数和占用的 buffer pool 页帧个数
+ * - ratio 定长格式的页面个数除以当前表的页面个数，即压缩率
+ * 运行示例：./record_compress_benchmark --benchmark_counters_tabular=true
+ */
+class CompressBenchmark : public Fixture
+{
+public:
+  static constexpr int ROW_NUM = 200000;
+
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    if (nullptr == TrxKit::instance()) {
+      check(TrxKit::init_global("vacuous"), "init trx kit");
+    }
+
+    BufferPoolParam param;
+    param.memory_size = 512L * 1024 * 1024;  // 两个表都放在内存中，比较的是解码的开销
+
+    bpm_ = make_unique<BufferPoolManager>(param);
+    BufferPoolManager::set_instance(bpm_.get());
+
+    base_dir_ = "record_compress_benchmark_" + to_string(getpid());
+    filesystem::remove_all(base_dir_);
+    filesystem::create_directories(base_dir_);
+
+    fixed_table_      = create_table("fixed_table", false /*compressed*/);
+    compressed_table_ = create_table("compressed_table", true /*compressed*/);
+
+    fixed_pages_      = scan(*fixed_table_).second;
+    compressed_pages_ = scan(*compressed_table_).second;
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    fixed_table_.reset();
+    compressed_table_.reset();
+    bpm_.reset();
+    filesystem::remove_all(base_dir_);
+  }
+
+protected:
+  /**
+   * @brief 创建表并插入数据
+   * @details 压缩格式的表在插入数据之前压缩(相当于空表执行 ALTER TABLE ... COMPRESS)，之后写满的页面自动压缩
+   */
+  unique_ptr<Table> create_table(const char *table_name, bool compressed)
+  {
+    AttrInfoSqlNode attrs[4];
+    attrs[0].type   = AttrType::INTS;
+    attrs[0].name   = "id";
+    attrs[0].length = 4;
+    attrs[1].type   = AttrType::INTS;
+    attrs[1].name   = "quantity";
+    attrs[1].length = 4;
+    attrs[2].type   = AttrType::CHARS;
+    attrs[2].name   = "category";
+    attrs[2].length = 16;
+    attrs[3].type   = AttrType::FLOATS;
+    attrs[3].name   = "price";
+    attrs[3].length = 4;
+
+    const string meta_file = table_meta_file(base_dir_.c_str(), table_name);
+
+    auto table = make_unique<Table>();
+    check(table->create(next_table_id_++, meta_file.c_str(), table_name, base_dir_.c_str(), 4, attrs),
+        "create table");
+    if (compressed) {
+      check(table->compress(), "compress table");
+    }
+
+    static const char *categories[] = {"book", "food", "toy", "clothes", "sports", "music", "garden", "tools"};
+
+    srand(0);
+    Value values[4];
+    for (int i = 0; i < ROW_NUM; i++) {
+      values[0].set_int(i);
+      values[1].set_int(rand() % 100);
+      values[2].set_string(categories[rand() % (sizeof(categories) / sizeof(categories[0]))]);
+      values[3].set_float(static_cast<float>(rand()) / RAND_MAX * 1000);
+
+      Record record;
+      check(table->make_record(4, values, record), "make record");
+      check(table->insert_record(record), "insert record");
+    }
+    check(table->sync(), "sync table");
+    return table;
+  }
+
+  /**
+   * @brief 扫描整个表
+   * @return 记录的个数和记录所在的页面个数
+   */
+  static pair<int64_t, int64_t> scan(Table &table)
+  {
+    RecordFileScanner scanner;
+    check(table.get_record_scanner(scanner, nullptr /*trx*/, true /*readonly*/), "open scanner");
+
+    int64_t row_num   = 0;
+    int64_t page_num  = 0;
+    PageNum last_page = BP_INVALID_PAGE_NUM;
+    Record  record;
+    while (scanner.has_next()) {
+      check(scanner.next(record), "scan record");
+      DoNotOptimize(record.data());
+      row_num++;
+      if (record.rid().page_num != last_page) {
+        last_page = record.rid().page_num;
+        page_num++;
+      }
+    }
+    scanner.close_scan();
+    return {row_num, page_num};
+  }
+
+protected:
+  unique_ptr<BufferPoolManager> bpm_;
+  string                        base_dir_;
+  int32_t                       next_table_id_ = 1;
+  unique_ptr<Table>             fixed_table_;
+  unique_ptr<Table>             compressed_table_;
+  int64_t                       fixed_pages_      = 0;
+  int64_t                       compressed_pages_ = 0;
+};
+
+BENCHMARK_DEFINE_F(CompressBenchmark, Scan)(State &state)
+{
+  const bool compressed = state.range(0) != 0;
+  Table     &table      = compressed ? *compressed_table_ : *fixed_table_;
+  const auto pages      = compressed ? compressed_pages_ : fixed_pages_;
+
+  int64_t row_num = 0;
+  for (auto _ : state) {
+    row_num += scan(table).first;
+  }
+
+  state.SetItemsProcessed(row_num);
+  state.counters["pages"] = Counter(static_cast<double>(pages));
+  state.counters["ratio"] = Counter(pages > 0 ? static_cast<double>(fixed_pages_) / pages : 0.0);
+}
+
+BENCHMARK_REGISTER_F(CompressBenchmark, Scan)->ArgName("compressed")->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+
+#include "benchmark_util.h"
+#include "common/rc.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/record/record_manager.h"
+
+using namespace std;
+using namespace benchmark;
+
+/**
+ * @brief 多线程插入记录的吞吐量
+ * @details 每个线程不停地向同一个文件插入定长记录，按照线程数输出每秒插入的记录数(items_per_second)，
+ * 用来观察插入能不能随着线程数扩展。每个线程有自己的插入页面，理想情况下不会去抢同一个页面的锁。
+ * 运行示例：./record_insert_benchmark --benchmark_counters_tabular=true
+ */
+class InsertBenchmark : public Fixture
+{
+public:
+  static constexpr int RECORD_SIZE = 64;
+
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    BufferPoolParam param;
+    param.memory_size     = 256L * 1024 * 1024;  // 尽量都在内存中，测的是插入路径本身的并发
+    param.frame_shard_num = 16;
+
+    bpm_       = make_unique<BufferPoolManager>(param);
+    file_name_ = "record_insert_benchmark_" + to_string(getpid()) + ".data";
+    ::remove(file_name_.c_str());
+
+    check(bpm_->create_file(file_name_.c_str()), "create file");
+    check(bpm_->open_file(file_name_.c_str(), buffer_pool_), "open file");
+    check(handler_.init(buffer_pool_), "init record file handler");
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    handler_.close();
+    bpm_->close_file(file_name_.c_str());
+    bpm_.reset();
+    ::remove(file_name_.c_str());
+  }
+
+protected:
+  unique_ptr<BufferPoolManager> bpm_;
+  string                        file_name_;
+  DiskBufferPool               *buffer_pool_ = nullptr;
+  RecordFileHandler             handler_;
+};
+
+BENCHMARK_DEFINE_F(InsertBenchmark, Insert)(State &state)
+{
+  char record[RECORD_SIZE];
+  memset(record, 'a' + state.thread_index() % 26, sizeof(record));
+
+  RID     rid;
+  int64_t failed = 0;
+  for (auto _ : state) {
+    if (OB_FAIL(handler_.insert_record(record, sizeof(record), &rid))) {
+      failed++;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["failed"] = Counter(static_cast<double>(failed));
+}
+
+BENCHMARK_REGISTER_F(InsertBenchmark, Insert)->ThreadRange(1, 32)->UseRealTime();
+
+BENCHMARK_MAIN();
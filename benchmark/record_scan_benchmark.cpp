@@ -0,0 +1,197 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "common/rc.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "sql/parser/parse_defs.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/common/meta_util.h"
+#include "storage/record/record_manager.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+using namespace benchmark;
+
+/// 进程中调用 operator new 的次数，用来统计扫描每一行时的堆内存分配
+static atomic<int64_t> allocation_count{0};
+
+void *operator new(size_t size)
+{
+  allocation_count.fetch_add(1, memory_order_relaxed);
+  void *ptr = malloc(size == 0 ? 1 : size);
+  if (nullptr == ptr) {
+    throw bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void  operator delete(void *ptr) noexcept { free(ptr); }
+void  operator delete[](void *ptr) noexcept { free(ptr); }
+void  operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void  operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+
+/**
+ * @brief 扫描表时每一行的堆内存分配次数
+ * @details 表中有一个整数列和一个字符串列，分别用 RecordFileScanner 直接扫描，以及通过带一个过滤条件的
+ * TableScanPhysicalOperator 扫描，输出每扫描一行调用了多少次 operator new(allocs_per_row)。
+ * 扫描出来的记录直接指向页面中的数据，理想情况下 allocs_per_row 接近0，只有打开扫描器时的几次分配。
+ * 运行示例：./record_scan_benchmark --benchmark_counters_tabular=true
+ */
+class ScanBenchmark : public Fixture
+{
+public:
+  static constexpr int ROW_NUM = 100000;
+
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    if (nullptr == TrxKit::instance()) {
+      check(TrxKit::init_global("vacuous"), "init trx kit");
+    }
+
+    BufferPoolParam param;
+    param.memory_size = 256L * 1024 * 1024;  // 数据都在内存中，只看扫描路径本身的开销
+
+    bpm_ = make_unique<BufferPoolManager>(param);
+    BufferPoolManager::set_instance(bpm_.get());
+
+    base_dir_ = "record_scan_benchmark_" + to_string(getpid());
+    filesystem::remove_all(base_dir_);
+    filesystem::create_directories(base_dir_);
+
+    AttrInfoSqlNode attrs[2];
+    attrs[0].type   = AttrType::INTS;
+    attrs[0].name   = "id";
+    attrs[0].length = 4;
+    attrs[1].type   = AttrType::CHARS;
+    attrs[1].name   = "name";
+    attrs[1].length = 16;
+
+    const char  *table_name = "scan_table";
+    const string meta_file  = table_meta_file(base_dir_.c_str(), table_name);
+
+    table_ = make_unique<Table>();
+    check(table_->create(1, meta_file.c_str(), table_name, base_dir_.c_str(), 2, attrs), "create table");
+
+    Value values[2];
+    for (int i = 0; i < ROW_NUM; i++) {
+      const string name = "name_" + to_string(i % 100);
+      values[0].set_int(i);
+      values[1].set_string(name.c_str());
+
+      Record record;
+      check(table_->make_record(2, values, record), "make record");
+      check(table_->insert_record(record), "insert record");
+    }
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    table_.reset();
+    bpm_.reset();
+    filesystem::remove_all(base_dir_);
+  }
+
+protected:
+  /**
+   * @brief 直接使用 RecordFileScanner 扫描整个表
+   */
+  int64_t scan_records()
+  {
+    RecordFileScanner scanner;
+    check(table_->get_record_scanner(scanner, nullptr /*trx*/, true /*readonly*/), "open scanner");
+
+    int64_t row_num = 0;
+    Record  record;
+    while (scanner.has_next()) {
+      check(scanner.next(record), "scan record");
+      DoNotOptimize(record.data());
+      row_num++;
+    }
+    scanner.close_scan();
+    return row_num;
+  }
+
+  /**
+   * @brief 通过表扫描算子扫描整个表，过滤条件是 id >= 0，每一行都会计算一次表达式
+   */
+  int64_t scan_with_predicate()
+  {
+    const FieldMeta *field_meta = table_->table_meta().field("id");
+
+    vector<unique_ptr<Expression>> predicates;
+    predicates.emplace_back(new ComparisonExpr(CompOp::GREAT_EQUAL,
+        make_unique<FieldExpr>(table_.get(), field_meta),
+        make_unique<ValueExpr>(Value(0))));
+
+    TableScanPhysicalOperator scan_oper(table_.get(), true /*readonly*/);
+    scan_oper.set_predicates(std::move(predicates));
+    check(scan_oper.open(nullptr /*trx*/), "open table scan operator");
+
+    int64_t row_num = 0;
+    RC      rc      = RC::SUCCESS;
+    while (OB_SUCC(rc = scan_oper.next())) {
+      DoNotOptimize(scan_oper.current_tuple());
+      row_num++;
+    }
+    if (rc != RC::RECORD_EOF) {
+      check(rc, "scan with table scan operator");
+    }
+    scan_oper.close();
+    return row_num;
+  }
+
+protected:
+  unique_ptr<BufferPoolManager> bpm_;
+  unique_ptr<Table>             table_;
+  string                        base_dir_;
+};
+
+BENCHMARK_DEFINE_F(ScanBenchmark, Scan)(State &state)
+{
+  const bool with_predicate = state.range(0) != 0;
+
+  int64_t row_num     = 0;
+  int64_t allocations = 0;
+  for (auto _ : state) {
+    const int64_t allocations_before = allocation_count.load(memory_order_relaxed);
+    row_num += with_predicate ? scan_with_predicate() : scan_records();
+    allocations += allocation_count.load(memory_order_relaxed) - allocations_before;
+  }
+
+  state.SetItemsProcessed(row_num);
+  state.counters["allocs_per_row"] = Counter(row_num > 0 ? static_cast<double>(allocations) / row_num : 0.0);
+}
+
+BENCHMARK_REGISTER_F(ScanBenchmark, Scan)->ArgName("predicate")->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 class BufferPoolManager;
 class DefaultHandler;
+class IoBackend;
 class TrxKit;
 
 /**
@@ -24,6 +25,7 @@ class TrxKit;
  */
 struct GlobalContext
 {
+  IoBackend         *io_backend_          = nullptr;
   BufferPoolManager *buffer_pool_manager_ = nullptr;
   DefaultHandler    *handler_             = nullptr;
   TrxKit            *trx_kit_             = nullptr;
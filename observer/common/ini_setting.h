@@ -24,4 +24,32 @@ See the Mulan PSL v2 for more details. */
 
 #define SOCKET_BUFFER_SIZE 8192
 
+#define BUFFER_POOL "BUFFER_POOL"
+#define BUFFER_POOL_MEMORY_SIZE "MEMORY_SIZE"
+#define BUFFER_POOL_FRAME_SHARD_NUM "FRAME_SHARD_NUM"
+#define BUFFER_POOL_CLEAN_FRAME_NUM "CLEAN_FRAME_NUM"
+#define BUFFER_POOL_PAGE_CLEANER_INTERVAL_MS "PAGE_CLEANER_INTERVAL_MS"
+#define BUFFER_POOL_REPLACER "REPLACER"
+#define BUFFER_POOL_LRU_K "LRU_K"
+#define BUFFER_POOL_READ_AHEAD_THREAD_NUM "READ_AHEAD_THREAD_NUM"
+#define BUFFER_POOL_READ_AHEAD_MAX_PAGES "READ_AHEAD_MAX_PAGES"
+#define BUFFER_POOL_DIRECT_IO "DIRECT_IO"
+#define BUFFER_POOL_EXTENT_PAGES "EXTENT_PAGES"
+#define BUFFER_POOL_HUGE_PAGE "HUGE_PAGE"
+#define BUFFER_POOL_NUMA_POLICY "NUMA_POLICY"
+#define BUFFER_POOL_NUMA_NODES "NUMA_NODES"
+
+#define CLOG "CLOG"
+#define CLOG_CHECKPOINT_INTERVAL_MS "CHECKPOINT_INTERVAL_MS"
+#define CLOG_SEGMENT_SIZE "SEGMENT_SIZE"
+
+#define INDEX "INDEX"
+#define INDEX_FILL_FACTOR "FILL_FACTOR"
+#define INDEX_SORT_BUFFER_SIZE "SORT_BUFFER_SIZE"
+
+#define IO_BACKEND "IO_BACKEND"
+#define IO_BACKEND_NAME "NAME"
+#define IO_BACKEND_URING_QUEUE_DEPTH "URING_QUEUE_DEPTH"
+#define IO_BACKEND_URING_QUEUE_DEPTH_DEFAULT 64
+
 #define SESSION_STAGE_NAME "SessionStage"
@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/init.h"
 
 #include "common/conf/ini.h"
+#include "common/ini_setting.h"
 #include "common/lang/string.h"
 #include "common/log/log.h"
 #include "common/os/path.h"
@@ -26,7 +27,10 @@ See the Mulan PSL v2 for more details. */
 #include "session/session_stage.h"
 #include "sql/plan_cache/plan_cache_stage.h"
 #include "storage/buffer/disk_buffer_pool.h"
+#include "storage/clog/clog.h"
 #include "storage/default/default_handler.h"
+#include "storage/index/bplus_tree_index.h"
+#include "storage/io/io_backend.h"
 #include "storage/trx/trx.h"
 
 using namespace std;
@@ -134,12 +138,166 @@ int prepare_init_seda()
   return 0;
 }
 
+void init_buffer_pool_param(Ini &properties, BufferPoolParam &param)
+{
+  map<string, string> bp_section = properties.get(BUFFER_POOL);
+
+  map<string, string>::iterator it = bp_section.find(BUFFER_POOL_MEMORY_SIZE);
+  if (it != bp_section.end()) {
+    str_to_val(it->second, param.memory_size);
+  }
+
+  it = bp_section.find(BUFFER_POOL_FRAME_SHARD_NUM);
+  if (it != bp_section.end()) {
+    str_to_val(it->second, param.frame_shard_num);
+  }
+
+  it = bp_section.find(BUFFER_POOL_CLEAN_FRAME_NUM);
+  if (it != bp_section.end()) {
+    str_to_val(it->second, param.clean_frame_num);
+  }
+
+  it = bp_section.find(BUFFER_POOL_PAGE_CLEANER_INTERVAL_MS);
+  if (it != bp_section.end()) {
+    str_to_val(it->second, param.page_cleaner_interval_ms);
+  }
+
+  it = bp_section.find(BUFFER_POOL_REPLACER);
+  if (it != bp_section.end()) {
+    param.replacer = it->second;
+  }
+
+  it = bp_section.find(BUFFER_POOL_LRU_K);
+  if (it != bp_section.end()) {
+    str_to_val(it->second, param.lru_k);
+  }
+
+  it = bp_section.find(BUFFER_POOL_READ_AHEAD_THREAD_NUM);
+  if (it != bp_section.end()) {
+    str_to_val(it->second, param.read_ahead_thread_num);
+  }
+
+  it = bp_section.find(BUFFER_POOL_READ_AHEAD_MAX_PAGES);
+  if (it != bp_section.end()) {
+    str_to_val(it->second, param.read_ahead_max_pages);
+  }
+
+  it = bp_section.find(BUFFER_POOL_DIRECT_IO);
+  if (it != bp_section.end()) {
+    str_to_val(it->second, param.direct_io);
+  }
+
+  it = bp_section.find(BUFFER_POOL_EXTENT_PAGES);
+  if (it != bp_section.end()) {
+    str_to_val(it->second, param.extent_pages);
+  }
+
+  it = bp_section.find(BUFFER_POOL_HUGE_PAGE);
+  if (it != bp_section.end()) {
+    param.huge_page = it->second;
+  }
+
+  it = bp_section.find(BUFFER_POOL_NUMA_POLICY);
+  if (it != bp_section.end()) {
+    param.numa_policy = it->second;
+  }
+
+  it = bp_section.find(BUFFER_POOL_NUMA_NODES);
+  if (it != bp_section.end()) {
+    param.numa_nodes = it->second;
+  }
+}
+
+void init_clog_param(Ini &properties, CLogParam &param)
+{
+  map<string, string> clog_section = properties.get(CLOG);
+
+  map<string, string>::iterator it = clog_section.find(CLOG_CHECKPOINT_INTERVAL_MS);
+  if (it != clog_section.end()) {
+    str_to_val(it->second, param.checkpoint_interval_ms);
+  }
+
+  it = clog_section.find(CLOG_SEGMENT_SIZE);
+  if (it != clog_section.end()) {
+    str_to_val(it->second, param.segment_size);
+  }
+}
+
+void init_index_build_param(Ini &properties, IndexBuildParam &param)
+{
+  map<string, string> index_section = properties.get(INDEX);
+
+  map<string, string>::iterator it = index_section.find(INDEX_FILL_FACTOR);
+  if (it != index_section.end()) {
+    str_to_val(it->second, param.fill_factor);
+  }
+
+  it = index_section.find(INDEX_SORT_BUFFER_SIZE);
+  if (it != index_section.end()) {
+    str_to_val(it->second, param.sort_buffer_size);
+  }
+}
+
+IoBackend *create_io_backend(Ini &properties)
+{
+  map<string, string> io_section = properties.get(IO_BACKEND);
+
+  string name;
+  int    queue_depth = IO_BACKEND_URING_QUEUE_DEPTH_DEFAULT;
+
+  map<string, string>::iterator it = io_section.find(IO_BACKEND_NAME);
+  if (it != io_section.end()) {
+    name = it->second;
+  }
+
+  it = io_section.find(IO_BACKEND_URING_QUEUE_DEPTH);
+  if (it != io_section.end()) {
+    str_to_val(it->second, queue_depth);
+  }
+
+  IoBackend *backend = IoBackend::create(name.c_str(), queue_depth);
+  if (backend != nullptr) {
+    RC rc = backend->init();
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("failed to init io backend %s. rc=%s", backend->name(), strrc(rc));
+      delete backend;
+      backend = nullptr;
+    }
+  }
+
+  if (nullptr == backend) {
+    LOG_WARN("cannot use io backend '%s', use sync io backend instead", name.c_str());
+    backend = IoBackend::create("sync", queue_depth);
+  }
+
+  LOG_INFO("use io backend %s", backend->name());
+  return backend;
+}
+
 int init_global_objects(ProcessParam *process_param, Ini &properties)
 {
-  GCTX.buffer_pool_manager_ = new BufferPoolManager();
+  // 数据文件和日志文件都通过 IO 后端读写，需要最先创建
+  GCTX.io_backend_ = create_io_backend(properties);
+  IoBackend::set_instance(GCTX.io_backend_);
+
+  BufferPoolParam buffer_pool_param;
+  init_buffer_pool_param(properties, buffer_pool_param);
+  // 命令行参数 -n 优先于配置文件
+  if (process_param->buffer_pool_memory_size() > 0) {
+    buffer_pool_param.memory_size = process_param->buffer_pool_memory_size();
+  }
+
+  GCTX.buffer_pool_manager_ = new BufferPoolManager(buffer_pool_param);
   BufferPoolManager::set_instance(GCTX.buffer_pool_manager_);
 
-  GCTX.handler_ = new DefaultHandler();
+  CLogParam clog_param;
+  init_clog_param(properties, clog_param);
+
+  IndexBuildParam index_build_param;
+  init_index_build_param(properties, index_build_param);
+  BplusTreeIndex::set_build_param(index_build_param);
+
+  GCTX.handler_ = new DefaultHandler(clog_param);
 
   DefaultHandler::set_default(GCTX.handler_);
 
@@ -173,6 +331,13 @@ int uninit_global_objects()
     BufferPoolManager::set_instance(nullptr);
     delete bpm;
   }
+
+  if (GCTX.io_backend_ != nullptr) {
+    LOG_INFO("%s", GCTX.io_backend_->latency_string().c_str());
+    IoBackend::set_instance(nullptr);
+    delete GCTX.io_backend_;
+    GCTX.io_backend_ = nullptr;
+  }
   return 0;
 }
 
@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <stdint.h>
+
 /// 磁盘文件，包括存放数据的文件和索引(B+-Tree)文件，都按照页来组织
 /// 每一页都有一个编号，称为PageNum
 using PageNum = int32_t;
@@ -27,3 +29,13 @@ using LSN = int32_t;
 
 /// page的CRC校验和
 using CheckSum = unsigned int;
+
+/// 表数据在页面上的存放格式
+enum class StorageFormat
+{
+  UNKNOWN_FORMAT = 0,
+  FIXED_FORMAT,       ///< 定长记录，每条记录占用一样大小的空间，字段放在固定的位置上
+  SLOTTED_FORMAT,     ///< 变长记录，页面上有一个槽位目录，记录的数据从页面末尾开始存放
+  PAX_FORMAT,         ///< 定长记录按列存放，页面内每一列的数据连续存放在一起(PAX)，适合只访问少数几列的扫描
+  COMPRESSED_FORMAT,  ///< 定长记录，页面写满之后按列压缩，适合很少修改、主要是扫描的冷数据
+};
@@ -50,6 +50,12 @@ RC AlterExecutor::execute(SQLStageEvent *sql_event) {
   std::string name = alter_stmt-> relation_name();
   std::vector<AttrInfoSqlNode> attr_infos_ = alter_stmt -> attr_infos();
 
+  // 没有字段的修改，比如 ALTER TABLE ... COMPRESS
+  if (attr_infos_.empty()) {
+    return session->get_current_db()->alter_table(
+        name.c_str(), alter_stmt->object_().c_str(), alter_stmt->operation().c_str(), nullptr);
+  }
+
   // 执行表更改操作
   for (AttrInfoSqlNode attr : attr_infos_) {
     rc = session->get_current_db()
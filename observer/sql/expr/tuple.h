@@ -161,6 +161,24 @@ public:
     return RC::SUCCESS;
   }
 
+  /**
+   * @brief 字段在行中的下标，与 TableMeta 中字段的下标一致，按列扫描时用来确定读取哪一列
+   * @return 不是当前表的字段时返回 -1
+   */
+  int field_index(const Field &field) const
+  {
+    if (field.table() != table_) {
+      return -1;
+    }
+
+    for (size_t i = 0; i < speces_.size(); ++i) {
+      if (0 == strcmp(field.field_name(), speces_[i]->field().field_name())) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
   RC find_cell(const TupleCellSpec &spec, Value &cell) const override
   {
     const char *table_name = spec.table_name();
@@ -31,6 +31,7 @@ RC DeletePhysicalOperator::open(Trx *trx)
   }
 
   trx_ = trx;
+  page_records_.clear();
 
   return RC::SUCCESS;
 }
@@ -52,16 +53,50 @@ RC DeletePhysicalOperator::next()
 
     RowTuple *row_tuple = static_cast<RowTuple *>(tuple);
     Record   &record    = row_tuple->record();
-    rc                  = trx_->delete_record(table_, record);
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to delete record: %s", strrc(rc));
-      return rc;
+    if (!page_records_.empty() && page_records_.front().rid().page_num != record.rid().page_num) {
+      rc = flush_page_records();
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
     }
+
+    // 子算子返回的记录只在下一次 next 之前有效，这里要复制一份
+    char *data = static_cast<char *>(malloc(record.len()));
+    ASSERT(nullptr != data, "failed to allocate memory. size=%d", record.len());
+    memcpy(data, record.data(), record.len());
+
+    Record copy;
+    copy.set_data_owner(data, record.len());
+    copy.set_rid(record.rid());
+    page_records_.push_back(std::move(copy));
   }
 
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to fetch record from child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = flush_page_records();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
   return RC::RECORD_EOF;
 }
 
+RC DeletePhysicalOperator::flush_page_records()
+{
+  if (page_records_.empty()) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = trx_->delete_records(table_, page_records_);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to delete records: %s", strrc(rc));
+  }
+  page_records_.clear();
+  return rc;
+}
+
 RC DeletePhysicalOperator::close()
 {
   if (!children_.empty()) {
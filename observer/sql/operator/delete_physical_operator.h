@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <vector>
+
 #include "sql/operator/physical_operator.h"
 
 class Trx;
@@ -22,6 +24,8 @@ class DeleteStmt;
 /**
  * @brief 物理算子，删除
  * @ingroup PhysicalOperator
+ * @details 子算子输出的记录按照页面攒成一批，换页或者结束的时候一次删除整个页面上的这批记录，
+ * 这样每个页面只需要加一次锁，MVCC 事务也只需要写一条日志。
  */
 class DeletePhysicalOperator : public PhysicalOperator
 {
@@ -39,6 +43,13 @@ public:
   Tuple *current_tuple() override { return nullptr; }
 
 private:
-  Table *table_ = nullptr;
-  Trx   *trx_   = nullptr;
+  /**
+   * @brief 删除当前攒下的同一个页面上的记录
+   */
+  RC flush_page_records();
+
+private:
+  Table              *table_ = nullptr;
+  Trx                *trx_   = nullptr;
+  std::vector<Record> page_records_;  ///< 同一个页面上等待删除的记录，数据都是复制出来的
 };
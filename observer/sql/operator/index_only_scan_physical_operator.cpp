@@ -0,0 +1,134 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include "sql/operator/index_only_scan_physical_operator.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
+
+using namespace std;
+
+IndexOnlyScanPhysicalOperator::IndexOnlyScanPhysicalOperator(Table *table, Index *index, vector<Value> prefix_values,
+    const Value *left_value, bool left_inclusive, const Value *right_value, bool right_inclusive)
+    : table_(table),
+      index_(index),
+      prefix_values_(std::move(prefix_values)),
+      left_inclusive_(left_inclusive),
+      right_inclusive_(right_inclusive)
+{
+  if (left_value) {
+    left_value_     = *left_value;
+    has_left_value_ = true;
+  }
+  if (right_value) {
+    right_value_     = *right_value;
+    has_right_value_ = true;
+  }
+}
+
+RC IndexOnlyScanPhysicalOperator::open(Trx * /*trx*/)
+{
+  if (nullptr == table_ || nullptr == index_) {
+    return RC::INTERNAL;
+  }
+
+  IndexScanner *index_scanner = index_->create_prefix_scanner(prefix_values_,
+      has_left_value_ ? &left_value_ : nullptr,
+      left_inclusive_,
+      has_right_value_ ? &right_value_ : nullptr,
+      right_inclusive_);
+  if (nullptr == index_scanner) {
+    LOG_WARN("failed to create index scanner");
+    return RC::INTERNAL;
+  }
+  index_scanner_ = index_scanner;
+
+  record_buffer_.assign(table_->table_meta().record_size(), 0);
+  current_record_.set_data(record_buffer_.data(), static_cast<int>(record_buffer_.size()));
+
+  tuple_.set_schema(table_, &index_->field_metas());
+  return RC::SUCCESS;
+}
+
+RC IndexOnlyScanPhysicalOperator::next()
+{
+  RC          rc            = RC::SUCCESS;
+  RID         rid;
+  const char *key           = nullptr;
+  bool        filter_result = false;
+  while (RC::SUCCESS == (rc = index_scanner_->next_entry(&rid, key))) {
+    // 把键值中的各个字段放回到记录中的位置上
+    char *record = record_buffer_.data();
+    for (const FieldMeta &field_meta : index_->field_metas()) {
+      memcpy(record + field_meta.offset(), key, field_meta.len());
+      key += field_meta.len();
+    }
+    current_record_.set_rid(rid);
+
+    tuple_.set_record(&current_record_);
+    rc = filter(tuple_, filter_result);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+
+    if (filter_result) {
+      return rc;
+    }
+  }
+
+  return rc;
+}
+
+RC IndexOnlyScanPhysicalOperator::close()
+{
+  if (index_scanner_ != nullptr) {
+    index_scanner_->destroy();
+    index_scanner_ = nullptr;
+  }
+  return RC::SUCCESS;
+}
+
+Tuple *IndexOnlyScanPhysicalOperator::current_tuple()
+{
+  tuple_.set_record(&current_record_);
+  return &tuple_;
+}
+
+void IndexOnlyScanPhysicalOperator::set_predicates(vector<unique_ptr<Expression>> &&exprs)
+{
+  predicates_ = std::move(exprs);
+}
+
+RC IndexOnlyScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
+{
+  RC    rc = RC::SUCCESS;
+  Value value;
+  for (unique_ptr<Expression> &expr : predicates_) {
+    rc = expr->get_value(tuple, value);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+
+    bool tmp_result = value.get_boolean();
+    if (!tmp_result) {
+      result = false;
+      return rc;
+    }
+  }
+
+  result = true;
+  return rc;
+}
+
+string IndexOnlyScanPhysicalOperator::param() const
+{
+  return string(index_->index_meta().name()) + " ON " + table_->name();
+}
@@ -0,0 +1,71 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <vector>
+
+#include "sql/expr/tuple.h"
+#include "sql/operator/physical_operator.h"
+#include "storage/record/record_manager.h"
+
+class Index;
+class IndexScanner;
+
+/**
+ * @brief 只访问索引、不回表的扫描物理算子(covering index scan)
+ * @ingroup PhysicalOperator
+ * @details 查询用到的字段都在索引中时，直接从 B+ 树叶子节点的键值中取出字段的值，不再通过 RID 读取数据文件。
+ * 键值中各个字段的值会被复制到一个与表记录一样大小的缓存中，按照字段在记录中的偏移存放，
+ * 所以上层的算子和过滤条件可以像访问普通记录一样访问这些字段；tuple 中只包含索引的字段。
+ * 索引中没有记录的可见性信息，所以只有没有事务字段(不使用MVCC)的表才能使用这个算子。
+ */
+class IndexOnlyScanPhysicalOperator : public PhysicalOperator
+{
+public:
+  IndexOnlyScanPhysicalOperator(Table *table, Index *index, std::vector<Value> prefix_values, const Value *left_value,
+      bool left_inclusive, const Value *right_value, bool right_inclusive);
+
+  virtual ~IndexOnlyScanPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::INDEX_ONLY_SCAN; }
+
+  std::string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+
+  Tuple *current_tuple() override;
+
+  void set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs);
+
+private:
+  RC filter(RowTuple &tuple, bool &result);
+
+private:
+  Table        *table_         = nullptr;
+  Index        *index_         = nullptr;
+  IndexScanner *index_scanner_ = nullptr;
+
+  std::vector<char> record_buffer_;  ///< 从键值中还原出来的记录，只有索引字段是有效的
+  Record            current_record_;
+  RowTuple          tuple_;
+
+  std::vector<Value> prefix_values_;  ///< 联合索引前面几个字段的等值条件
+  Value              left_value_;
+  Value              right_value_;
+  bool               has_left_value_  = false;
+  bool               has_right_value_ = false;
+  bool               left_inclusive_  = false;
+  bool               right_inclusive_ = false;
+
+  std::vector<std::unique_ptr<Expression>> predicates_;
+};
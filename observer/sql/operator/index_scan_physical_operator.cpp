@@ -12,23 +12,35 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2022/07/08.
 //
 
+#include <algorithm>
+
 #include "sql/operator/index_scan_physical_operator.h"
 #include "storage/index/index.h"
 #include "storage/trx/trx.h"
 
 IndexScanPhysicalOperator::IndexScanPhysicalOperator(Table *table, Index *index, bool readonly, const Value *left_value,
     bool left_inclusive, const Value *right_value, bool right_inclusive)
+    : IndexScanPhysicalOperator(
+          table, index, readonly, std::vector<Value>(), left_value, left_inclusive, right_value, right_inclusive)
+{}
+
+IndexScanPhysicalOperator::IndexScanPhysicalOperator(Table *table, Index *index, bool readonly,
+    std::vector<Value> prefix_values, const Value *left_value, bool left_inclusive, const Value *right_value,
+    bool right_inclusive)
     : table_(table),
       index_(index),
       readonly_(readonly),
+      prefix_values_(std::move(prefix_values)),
       left_inclusive_(left_inclusive),
       right_inclusive_(right_inclusive)
 {
   if (left_value) {
-    left_value_ = *left_value;
+    left_value_     = *left_value;
+    has_left_value_ = true;
   }
   if (right_value) {
-    right_value_ = *right_value;
+    right_value_     = *right_value;
+    has_right_value_ = true;
   }
 }
 
@@ -38,11 +50,10 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
     return RC::INTERNAL;
   }
 
-  IndexScanner *index_scanner = index_->create_scanner(left_value_.data(),
-      left_value_.length(),
+  IndexScanner *index_scanner = index_->create_prefix_scanner(prefix_values_,
+      has_left_value_ ? &left_value_ : nullptr,
       left_inclusive_,
-      right_value_.data(),
-      right_value_.length(),
+      has_right_value_ ? &right_value_ : nullptr,
       right_inclusive_);
   if (nullptr == index_scanner) {
     LOG_WARN("failed to create index scanner");
@@ -56,6 +67,13 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
     return RC::INTERNAL;
   }
   index_scanner_ = index_scanner;
+  record_page_handler_.reset(record_handler_->create_page_handler());
+
+  point_lookup_  = index_->index_meta().unique() && prefix_values_.size() == index_->field_metas().size();
+  batch_mode_    = false;
+  fetched_count_ = 0;
+  batch_pos_     = 0;
+  rid_batch_.clear();
 
   tuple_.set_schema(table_, table_->table_meta().field_metas());
 
@@ -68,11 +86,14 @@ RC IndexScanPhysicalOperator::next()
   RID rid;
   RC  rc = RC::SUCCESS;
 
-  record_page_handler_.cleanup();
+  // 批量模式下同一个页面上的记录是连续访问的，页面一直拿着，直到访问下一个页面时才释放
+  if (!batch_mode_) {
+    record_page_handler_->cleanup();
+  }
 
   bool filter_result = false;
-  while (RC::SUCCESS == (rc = index_scanner_->next_entry(&rid))) {
-    rc = record_handler_->get_record(record_page_handler_, &rid, readonly_, &current_record_);
+  while (RC::SUCCESS == (rc = next_rid(rid))) {
+    rc = record_handler_->get_record(*record_page_handler_, &rid, readonly_, &current_record_);
     if (rc != RC::SUCCESS) {
       return rc;
     }
@@ -95,11 +116,68 @@ RC IndexScanPhysicalOperator::next()
     }
   }
 
+  record_page_handler_->cleanup();
   return rc;
 }
 
+RC IndexScanPhysicalOperator::next_rid(RID &rid)
+{
+  if (point_lookup_ && fetched_count_ > 0) {
+    return RC::RECORD_EOF;
+  }
+
+  if (!batch_mode_) {
+    RC rc = index_scanner_->next_entry(&rid);
+    if (OB_SUCC(rc) && ++fetched_count_ >= BATCH_FETCH_THRESHOLD) {
+      batch_mode_ = true;
+      LOG_TRACE("switch index scan to batch fetch mode. index=%s", index_->index_meta().name());
+    }
+    return rc;
+  }
+
+  if (batch_pos_ >= rid_batch_.size()) {
+    RC rc = fill_rid_batch();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  rid = rid_batch_[batch_pos_++];
+  return RC::SUCCESS;
+}
+
+RC IndexScanPhysicalOperator::fill_rid_batch()
+{
+  // 访问索引之前先释放数据页面，不在拿着数据页面锁的时候再去加索引页面的锁
+  record_page_handler_->cleanup();
+
+  rid_batch_.clear();
+  batch_pos_ = 0;
+
+  RID rid;
+  RC  rc = RC::SUCCESS;
+  while (rid_batch_.size() < BATCH_FETCH_SIZE && OB_SUCC(rc = index_scanner_->next_entry(&rid))) {
+    rid_batch_.push_back(rid);
+  }
+  if (OB_FAIL(rc) && rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to fetch rids from index. index=%s, rc=%s", index_->index_meta().name(), strrc(rc));
+    return rc;
+  }
+
+  if (rid_batch_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  std::sort(rid_batch_.begin(), rid_batch_.end(), [](const RID &left, const RID &right) {
+    return RID::compare(&left, &right) < 0;
+  });
+  return RC::SUCCESS;
+}
+
 RC IndexScanPhysicalOperator::close()
 {
+  record_page_handler_->cleanup();
+  rid_batch_.clear();
   index_scanner_->destroy();
   index_scanner_ = nullptr;
   return RC::SUCCESS;
@@ -139,5 +217,12 @@ RC IndexScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
 
 std::string IndexScanPhysicalOperator::param() const
 {
-  return std::string(index_->index_meta().name()) + " ON " + table_->name();
+  std::string result = std::string(index_->index_meta().name()) + " ON " + table_->name();
+  if (prefix_values_.size() > 1 || has_left_value_ || has_right_value_) {
+    result += " PREFIX " + std::to_string(prefix_values_.size());
+    if (has_left_value_ || has_right_value_) {
+      result += " RANGE";
+    }
+  }
+  return result;
 }
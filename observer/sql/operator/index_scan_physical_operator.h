@@ -21,12 +21,21 @@ See the Mulan PSL v2 for more details. */
 /**
  * @brief 索引扫描物理算子
  * @ingroup PhysicalOperator
+ * @details 索引中相邻的记录通常分散在不同的数据页面上，逐条回表时会反复地 pin 和加锁同一个页面。
+ * 索引扫描返回的记录超过 BATCH_FETCH_THRESHOLD 条时，认为匹配的记录比较多，切换成批量读取的模式：
+ * 每次从索引中收集一批 RID，按照页面排序之后再回表，每个页面只加锁一次就可以取出这一批中所有的记录。
+ * 批量模式下返回的记录是按照物理位置排序的，不再是索引的顺序。
+ *
+ * 联合索引可以只使用前面几个字段：prefix_values 是前几个字段的等值条件，left_value/right_value 是紧接着的一个字段的范围。
+ * 唯一索引的所有字段都是等值条件时最多只有一条记录，拿到第一条之后就结束扫描。
  */
 class IndexScanPhysicalOperator : public PhysicalOperator
 {
 public:
   IndexScanPhysicalOperator(Table *table, Index *index, bool readonly, const Value *left_value, bool left_inclusive,
       const Value *right_value, bool right_inclusive);
+  IndexScanPhysicalOperator(Table *table, Index *index, bool readonly, std::vector<Value> prefix_values,
+      const Value *left_value, bool left_inclusive, const Value *right_value, bool right_inclusive);
 
   virtual ~IndexScanPhysicalOperator() = default;
 
@@ -46,6 +55,22 @@ private:
   // 与TableScanPhysicalOperator代码相同，可以优化
   RC filter(RowTuple &tuple, bool &result);
 
+  /**
+   * @brief 获取下一个要回表的RID，批量模式下从排好序的一批RID中获取
+   */
+  RC next_rid(RID &rid);
+
+  /**
+   * @brief 从索引中收集下一批RID并按照页面排序
+   */
+  RC fill_rid_batch();
+
+private:
+  /// 索引返回这么多条记录之后切换到批量读取的模式
+  static constexpr int BATCH_FETCH_THRESHOLD = 64;
+  /// 批量读取模式下每批最多收集多少个RID
+  static constexpr size_t BATCH_FETCH_SIZE = 1024;
+
 private:
   Trx               *trx_            = nullptr;
   Table             *table_          = nullptr;
@@ -54,14 +79,23 @@ private:
   IndexScanner      *index_scanner_  = nullptr;
   RecordFileHandler *record_handler_ = nullptr;
 
-  RecordPageHandler record_page_handler_;
-  Record            current_record_;
-  RowTuple          tuple_;
+  std::unique_ptr<RecordPageHandler> record_page_handler_;
+  Record                             current_record_;
+  RowTuple                           tuple_;
+
+  bool             point_lookup_  = false;  ///< 唯一索引上的等值查询，最多返回一条记录
+  bool             batch_mode_    = false;  ///< 是否已经切换到批量读取的模式
+  int              fetched_count_ = 0;      ///< 切换到批量模式之前已经从索引中获取的记录数
+  std::vector<RID> rid_batch_;              ///< 按照页面排序的一批RID
+  size_t           batch_pos_ = 0;          ///< 下一个要回表的RID在 rid_batch_ 中的位置
 
-  Value left_value_;
-  Value right_value_;
-  bool  left_inclusive_  = false;
-  bool  right_inclusive_ = false;
+  std::vector<Value> prefix_values_;  ///< 联合索引前面几个字段的等值条件
+  Value              left_value_;
+  Value              right_value_;
+  bool               has_left_value_  = false;
+  bool               has_right_value_ = false;
+  bool               left_inclusive_  = false;
+  bool               right_inclusive_ = false;
 
   std::vector<std::unique_ptr<Expression>> predicates_;
 };
@@ -39,6 +39,7 @@ enum class PhysicalOperatorType
 {
   TABLE_SCAN,
   INDEX_SCAN,
+  INDEX_ONLY_SCAN,
   NESTED_LOOP_JOIN,
   EXPLAIN,
   PREDICATE,
@@ -29,15 +29,16 @@ public:
 
   LogicalOperatorType type() const override { return LogicalOperatorType::TABLE_GET; }
 
-  Table *table() const { return table_; }
-  bool   readonly() const { return readonly_; }
+  Table                    *table() const { return table_; }
+  const std::vector<Field> &fields() const { return fields_; }
+  bool                      readonly() const { return readonly_; }
 
   void                                      set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs);
   std::vector<std::unique_ptr<Expression>> &predicates() { return predicates_; }
 
 private:
   Table             *table_ = nullptr;
-  std::vector<Field> fields_;
+  std::vector<Field> fields_;  ///< 上层算子需要从这个表中获取的字段，包括查询的字段和过滤条件中用到的字段
   bool               readonly_ = false;
 
   // 与当前表相关的过滤操作，可以尝试在遍历数据时执行
@@ -12,8 +12,12 @@ See the Mulan PSL v2 for more details. */
 // Created by WangYunlai on 2021/6/9.
 //
 
+#include <string.h>
+
 #include "sql/operator/table_scan_physical_operator.h"
+#include "common/lang/comparator.h"
 #include "event/sql_debug.h"
+#include "sql/expr/expression.h"
 #include "storage/table/table.h"
 
 using namespace std;
@@ -23,6 +27,7 @@ RC TableScanPhysicalOperator::open(Trx *trx)
   RC rc = table_->get_record_scanner(record_scanner_, trx, readonly_);
   if (rc == RC::SUCCESS) {
     tuple_.set_schema(table_, table_->table_meta().field_metas());
+    init_column_filter();
   }
   trx_ = trx;
   return rc;
@@ -30,6 +35,10 @@ RC TableScanPhysicalOperator::open(Trx *trx)
 
 RC TableScanPhysicalOperator::next()
 {
+  if (filter_column_ >= 0) {
+    return next_by_column();
+  }
+
   if (!record_scanner_.has_next()) {
     return RC::RECORD_EOF;
   }
@@ -78,7 +87,12 @@ RC TableScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
 {
   RC    rc = RC::SUCCESS;
   Value value;
-  for (unique_ptr<Expression> &expr : predicates_) {
+  for (size_t i = 0; i < predicates_.size(); i++) {
+    if (static_cast<int>(i) == filter_predicate_) {
+      continue;  // 已经按列计算过了
+    }
+
+    unique_ptr<Expression> &expr = predicates_[i];
     rc = expr->get_value(tuple, value);
     if (rc != RC::SUCCESS) {
       return rc;
@@ -94,3 +108,178 @@ RC TableScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
   result = true;
   return rc;
 }
+
+void TableScanPhysicalOperator::init_column_filter()
+{
+  filter_column_    = -1;
+  filter_predicate_ = -1;
+  selected_slots_.clear();
+  selected_index_ = 0;
+
+  // 按列扫描不会对记录加锁，只在只读扫描时使用
+  if (!readonly_ || table_->table_meta().storage_format() != StorageFormat::PAX_FORMAT) {
+    return;
+  }
+
+  for (size_t i = 0; i < predicates_.size(); i++) {
+    if (predicates_[i]->type() != ExprType::COMPARISON) {
+      continue;
+    }
+
+    auto       *comparison = static_cast<ComparisonExpr *>(predicates_[i].get());
+    CompOp      comp       = comparison->comp();
+    Expression *field_expr = comparison->left().get();
+    Expression *value_expr = comparison->right().get();
+    if (field_expr->type() == ExprType::VALUE && value_expr->type() == ExprType::FIELD) {
+      // 常量在左边，交换之后比较的方向也要反过来
+      std::swap(field_expr, value_expr);
+      switch (comp) {
+        case LESS_EQUAL: {
+          comp = GREAT_EQUAL;
+        } break;
+        case LESS_THAN: {
+          comp = GREAT_THAN;
+        } break;
+        case GREAT_EQUAL: {
+          comp = LESS_EQUAL;
+        } break;
+        case GREAT_THAN: {
+          comp = LESS_THAN;
+        } break;
+        default: {
+        } break;
+      }
+    }
+    if (field_expr->type() != ExprType::FIELD || value_expr->type() != ExprType::VALUE || comp == NO_OP) {
+      continue;
+    }
+
+    const Field &field = static_cast<FieldExpr *>(field_expr)->field();
+    const Value &value = static_cast<ValueExpr *>(value_expr)->get_value();
+    const int    index = tuple_.field_index(field);
+    // 类型不一样时需要转换，交给逐行过滤处理
+    if (index < 0 || field.attr_type() != value.attr_type() ||
+        (value.attr_type() != INTS && value.attr_type() != FLOATS && value.attr_type() != CHARS)) {
+      continue;
+    }
+
+    filter_column_    = index;
+    filter_predicate_ = static_cast<int>(i);
+    filter_comp_      = comp;
+    filter_value_     = value;
+    filter_string_    = value.attr_type() == CHARS ? value.get_string() : string();
+    LOG_TRACE("scan table by column. table=%s, field=%s", table_->name(), field.field_name());
+    return;
+  }
+}
+
+RC TableScanPhysicalOperator::next_by_column()
+{
+  RC   rc            = RC::SUCCESS;
+  bool filter_result = false;
+  while (true) {
+    while (selected_index_ < selected_slots_.size()) {
+      const SlotNum slot_num = selected_slots_[selected_index_++];
+
+      rc = record_scanner_.get_column_record(slot_num, current_record_);
+      if (rc == RC::RECORD_INVISIBLE) {
+        continue;
+      }
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+
+      tuple_.set_record(&current_record_);
+      rc = filter(tuple_, filter_result);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      if (filter_result) {
+        sql_debug("get a tuple: %s", tuple_.to_string().c_str());
+        return RC::SUCCESS;
+      }
+    }
+
+    // 当前页面上满足条件的记录都返回了，取下一个页面的列数据
+    rc = record_scanner_.next_column(filter_column_, chunk_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    selected_slots_.clear();
+    selected_index_ = 0;
+    filter_column(chunk_, selected_slots_);
+  }
+}
+
+/**
+ * @brief 根据比较的结果判断是否满足比较条件，与 ComparisonExpr::compare_value 一致
+ */
+static bool match_compare_result(CompOp comp, int cmp_result)
+{
+  switch (comp) {
+    case EQUAL_TO: {
+      return 0 == cmp_result;
+    }
+    case LESS_EQUAL: {
+      return cmp_result <= 0;
+    }
+    case NOT_EQUAL: {
+      return cmp_result != 0;
+    }
+    case LESS_THAN: {
+      return cmp_result < 0;
+    }
+    case GREAT_EQUAL: {
+      return cmp_result >= 0;
+    }
+    case GREAT_THAN: {
+      return cmp_result > 0;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+void TableScanPhysicalOperator::filter_column(const ColumnChunk &chunk, vector<SlotNum> &slots) const
+{
+  // 比较的方法与 Value::compare 一致，只是直接在列数据上比较，不需要为每一行构造 Value
+  const int count = chunk.count();
+  switch (filter_value_.attr_type()) {
+    case INTS: {
+      int right = filter_value_.get_int();
+      for (int i = 0; i < count; i++) {
+        if (match_compare_result(filter_comp_, common::compare_int((void *)chunk.value(i), &right))) {
+          slots.push_back(chunk.slots[i]);
+        }
+      }
+    } break;
+
+    case FLOATS: {
+      float right = filter_value_.get_float();
+      for (int i = 0; i < count; i++) {
+        if (match_compare_result(filter_comp_, common::compare_float((void *)chunk.value(i), &right))) {
+          slots.push_back(chunk.slots[i]);
+        }
+      }
+    } break;
+
+    case CHARS: {
+      void     *right     = (void *)filter_string_.c_str();
+      const int right_len = static_cast<int>(filter_string_.length());
+      for (int i = 0; i < count; i++) {
+        // 与 Value::set_string 一样，字符串到第一个 '\0' 为止
+        const char *left       = chunk.value(i);
+        const int   cmp_result = common::compare_string((void *)left, strnlen(left, chunk.value_len), right, right_len);
+        if (match_compare_result(filter_comp_, cmp_result)) {
+          slots.push_back(chunk.slots[i]);
+        }
+      }
+    } break;
+
+    default: {
+      ASSERT(false, "unsupported column filter type. type=%d", filter_value_.attr_type());
+    } break;
+  }
+}
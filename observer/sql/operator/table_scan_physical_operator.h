@@ -23,6 +23,8 @@ class Table;
 /**
  * @brief 表扫描物理算子
  * @ingroup PhysicalOperator
+ * @details PAX 格式的表只读扫描时，如果过滤条件中有"字段 比较 常量"的条件，就按列过滤：每个页面先取出这一列的
+ * 所有值(ColumnChunk)，在列数据上比较，只有满足条件的槽位才拼装成完整的行，再计算其它的过滤条件。
  */
 class TableScanPhysicalOperator : public PhysicalOperator
 {
@@ -46,6 +48,21 @@ public:
 private:
   RC filter(RowTuple &tuple, bool &result);
 
+  /**
+   * @brief 从过滤条件中选一个可以按列计算的条件，参考类的说明
+   */
+  void init_column_filter();
+
+  /**
+   * @brief 按列过滤时的 next
+   */
+  RC next_by_column();
+
+  /**
+   * @brief 在一个页面的列数据上计算按列过滤的条件，满足条件的槽位放到 slots 中
+   */
+  void filter_column(const ColumnChunk &chunk, std::vector<SlotNum> &slots) const;
+
 private:
   Table                                   *table_    = nullptr;
   Trx                                     *trx_      = nullptr;
@@ -54,4 +71,13 @@ private:
   Record                                   current_record_;
   RowTuple                                 tuple_;
   std::vector<std::unique_ptr<Expression>> predicates_;  // TODO chang predicate to table tuple filter
+
+  int                  filter_column_    = -1;     ///< 按列过滤的字段下标，-1 表示不按列过滤
+  int                  filter_predicate_ = -1;     ///< 按列计算的是 predicates_ 中的哪个条件，逐行过滤时跳过它
+  CompOp               filter_comp_      = NO_OP;  ///< 列上的值与 filter_value_ 比较，字段在左边
+  Value                filter_value_;
+  std::string          filter_string_;           ///< filter_value_ 是字符串时的值，避免每次比较都复制一次
+  ColumnChunk          chunk_;                   ///< 当前页面上的列数据
+  std::vector<SlotNum> selected_slots_;          ///< 当前页面上满足按列过滤条件的槽位
+  size_t               selected_index_ = 0;
 };
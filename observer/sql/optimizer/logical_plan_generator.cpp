@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2023/08/16.
 //
 
+#include <algorithm>
+
 #include "sql/optimizer/logical_plan_generator.h"
 
 #include <common/log/log.h>
@@ -88,10 +90,29 @@ RC LogicalPlanGenerator::create_plan(SelectStmt *select_stmt, unique_ptr<Logical
 
   const std::vector<Table *> &tables     = select_stmt->tables();
   const std::vector<Field>   &all_fields = select_stmt->query_fields();
+
+  // 过滤条件中用到的字段也需要从表中获取，物理计划据此判断能否只访问索引
+  std::vector<Field> used_fields = all_fields;
+  FilterStmt        *filter_stmt = select_stmt->filter_stmt();
+  if (filter_stmt != nullptr) {
+    for (const FilterUnit *filter_unit : filter_stmt->filter_units()) {
+      if (filter_unit->left().is_attr) {
+        used_fields.push_back(filter_unit->left().field);
+      }
+      if (filter_unit->right().is_attr) {
+        used_fields.push_back(filter_unit->right().field);
+      }
+    }
+  }
+
   for (Table *table : tables) {
     std::vector<Field> fields;
-    for (const Field &field : all_fields) {
-      if (0 == strcmp(field.table_name(), table->name())) {
+    for (const Field &field : used_fields) {
+      if (0 != strcmp(field.table_name(), table->name())) {
+        continue;
+      }
+      auto same_field = [&field](const Field &other) { return 0 == strcmp(other.field_name(), field.field_name()); };
+      if (std::find_if(fields.begin(), fields.end(), same_field) == fields.end()) {
         fields.push_back(field);
       }
     }
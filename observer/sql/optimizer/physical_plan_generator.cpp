@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2022/12/14.
 //
 
+#include <algorithm>
+#include <string.h>
 #include <utility>
 
 #include "common/log/log.h"
@@ -22,6 +24,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/delete_physical_operator.h"
 #include "sql/operator/explain_logical_operator.h"
 #include "sql/operator/explain_physical_operator.h"
+#include "sql/operator/index_only_scan_physical_operator.h"
 #include "sql/operator/index_scan_physical_operator.h"
 #include "sql/operator/insert_logical_operator.h"
 #include "sql/operator/insert_physical_operator.h"
@@ -34,6 +37,8 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/table_get_logical_operator.h"
 #include "sql/operator/table_scan_physical_operator.h"
 #include "sql/optimizer/physical_plan_generator.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
 
 using namespace std;
 
@@ -81,19 +86,67 @@ RC PhysicalPlanGenerator::create(LogicalOperator &logical_operator, unique_ptr<P
   return rc;
 }
 
+/**
+ * @brief 可以用于索引查找的条件，即字段与常量值的比较
+ * @details 常量在左边时会把比较符号反过来，保证总是 field comp value 的形式
+ */
+struct IndexCondition
+{
+  const FieldMeta *field = nullptr;
+  CompOp           comp  = NO_OP;
+  const Value     *value = nullptr;
+};
+
+static CompOp swap_comp_op(CompOp comp)
+{
+  switch (comp) {
+    case LESS_EQUAL: return GREAT_EQUAL;
+    case LESS_THAN: return GREAT_THAN;
+    case GREAT_EQUAL: return LESS_EQUAL;
+    case GREAT_THAN: return LESS_THAN;
+    default: return comp;
+  }
+}
+
+static const IndexCondition *find_index_condition(
+    const vector<IndexCondition> &conditions, const FieldMeta &field, CompOp comp1, CompOp comp2)
+{
+  for (const IndexCondition &condition : conditions) {
+    if (0 == strcmp(condition.field->name(), field.name()) && (condition.comp == comp1 || condition.comp == comp2)) {
+      return &condition;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief 索引是否包含了所有的字段
+ */
+static bool covers_fields(const Index &index, const vector<Field> &fields)
+{
+  const vector<FieldMeta> &index_fields = index.field_metas();
+  for (const Field &field : fields) {
+    auto same_field = [&field](const FieldMeta &field_meta) {
+      return 0 == strcmp(field_meta.name(), field.field_name());
+    };
+    if (std::find_if(index_fields.begin(), index_fields.end(), same_field) == index_fields.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, unique_ptr<PhysicalOperator> &oper)
 {
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
   // 看看是否有可以用于索引查找的表达式
   Table *table = table_get_oper.table();
 
-  Index     *index      = nullptr;
-  ValueExpr *value_expr = nullptr;
+  vector<IndexCondition> conditions;
   for (auto &expr : predicates) {
     if (expr->type() == ExprType::COMPARISON) {
       auto comparison_expr = static_cast<ComparisonExpr *>(expr.get());
-      // 简单处理，就找等值查询
-      if (comparison_expr->comp() != EQUAL_TO) {
+      if (comparison_expr->comp() == NOT_EQUAL || comparison_expr->comp() == NO_OP) {
         continue;
       }
 
@@ -104,36 +157,104 @@ RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, u
         continue;
       }
 
-      FieldExpr *field_expr = nullptr;
+      FieldExpr     *field_expr = nullptr;
+      ValueExpr     *value_expr = nullptr;
+      IndexCondition condition;
       if (left_expr->type() == ExprType::FIELD) {
         ASSERT(right_expr->type() == ExprType::VALUE, "right expr should be a value expr while left is field expr");
-        field_expr = static_cast<FieldExpr *>(left_expr.get());
-        value_expr = static_cast<ValueExpr *>(right_expr.get());
+        field_expr     = static_cast<FieldExpr *>(left_expr.get());
+        value_expr     = static_cast<ValueExpr *>(right_expr.get());
+        condition.comp = comparison_expr->comp();
       } else if (right_expr->type() == ExprType::FIELD) {
         ASSERT(left_expr->type() == ExprType::VALUE, "left expr should be a value expr while right is a field expr");
-        field_expr = static_cast<FieldExpr *>(right_expr.get());
-        value_expr = static_cast<ValueExpr *>(left_expr.get());
+        field_expr     = static_cast<FieldExpr *>(right_expr.get());
+        value_expr     = static_cast<ValueExpr *>(left_expr.get());
+        condition.comp = swap_comp_op(comparison_expr->comp());
       }
 
-      if (field_expr == nullptr) {
+      // 类型不同时索引中的键值无法直接与常量比较，交给过滤条件处理
+      if (field_expr == nullptr || field_expr->field().attr_type() != value_expr->get_value().attr_type()) {
         continue;
       }
 
-      const Field &field = field_expr->field();
-      index              = table->find_index_by_field(field.field_name());
-      if (nullptr != index) {
+      condition.field = field_expr->field().meta();
+      condition.value = &value_expr->get_value();
+      conditions.push_back(condition);
+    }
+  }
+
+  // 每个索引从第一个字段开始尽量多地匹配等值条件，下一个字段还可以再使用一个范围条件。
+  // 选择匹配字段最多的索引，匹配的字段一样多时，有范围条件的更好。唯一索引的所有字段都匹配时最多只有一条记录，直接使用。
+  // 上层需要的字段都在索引中时可以只扫描索引，不用回表，这样的索引即使没有匹配的条件也比全表扫描好。
+  // 索引中没有记录的可见性信息，有事务字段的表不能只扫描索引
+  const bool index_only_allowed = table_get_oper.readonly() && table->table_meta().sys_field_num() == 0;
+
+  Index                *index = nullptr;
+  vector<Value>         prefix_values;
+  const IndexCondition *left_condition  = nullptr;
+  const IndexCondition *right_condition = nullptr;
+  bool                  covering        = false;
+  int                   best_score      = 0;
+  for (Index *candidate : table->indexes()) {
+    const vector<FieldMeta> &index_fields = candidate->field_metas();
+
+    vector<Value> candidate_prefix;
+    size_t        field_idx = 0;
+    for (; field_idx < index_fields.size(); field_idx++) {
+      const IndexCondition *condition = find_index_condition(conditions, index_fields[field_idx], EQUAL_TO, EQUAL_TO);
+      if (condition == nullptr) {
         break;
       }
+      candidate_prefix.push_back(*condition->value);
+    }
+
+    const IndexCondition *candidate_left  = nullptr;
+    const IndexCondition *candidate_right = nullptr;
+    if (field_idx < index_fields.size()) {
+      candidate_left  = find_index_condition(conditions, index_fields[field_idx], GREAT_THAN, GREAT_EQUAL);
+      candidate_right = find_index_condition(conditions, index_fields[field_idx], LESS_THAN, LESS_EQUAL);
     }
-  }
 
-  if (index != nullptr) {
-    ASSERT(value_expr != nullptr, "got an index but value expr is null ?");
+    int score = static_cast<int>(candidate_prefix.size()) * 2 + (candidate_left || candidate_right ? 1 : 0);
+    if (candidate->index_meta().unique() && candidate_prefix.size() == index_fields.size()) {
+      score = IndexMeta::MAX_FIELD_NUM * 2 + 2;
+    }
 
-    const Value               &value           = value_expr->get_value();
-    IndexScanPhysicalOperator *index_scan_oper = new IndexScanPhysicalOperator(
-        table, index, table_get_oper.readonly(), &value, true /*left_inclusive*/, &value, true /*right_inclusive*/);
+    const bool candidate_covering = index_only_allowed && covers_fields(*candidate, table_get_oper.fields());
+    score                         = score * 2 + (candidate_covering ? 1 : 0);
+    if (score > best_score) {
+      index           = candidate;
+      best_score      = score;
+      left_condition  = candidate_left;
+      right_condition = candidate_right;
+      covering        = candidate_covering;
+      prefix_values.swap(candidate_prefix);
+    }
+  }
 
+  if (index != nullptr && covering) {
+    IndexOnlyScanPhysicalOperator *index_scan_oper = new IndexOnlyScanPhysicalOperator(table,
+        index,
+        std::move(prefix_values),
+        left_condition == nullptr ? nullptr : left_condition->value,
+        left_condition == nullptr || left_condition->comp == GREAT_EQUAL,
+        right_condition == nullptr ? nullptr : right_condition->value,
+        right_condition == nullptr || right_condition->comp == LESS_EQUAL);
+
+    index_scan_oper->set_predicates(std::move(predicates));
+    oper = unique_ptr<PhysicalOperator>(index_scan_oper);
+    LOG_TRACE("use index only scan");
+  } else if (index != nullptr) {
+    IndexScanPhysicalOperator *index_scan_oper = new IndexScanPhysicalOperator(table,
+        index,
+        table_get_oper.readonly(),
+        std::move(prefix_values),
+        left_condition == nullptr ? nullptr : left_condition->value,
+        left_condition == nullptr || left_condition->comp == GREAT_EQUAL,
+        right_condition == nullptr ? nullptr : right_condition->value,
+        right_condition == nullptr || right_condition->comp == LESS_EQUAL);
+
+    // 索引只是缩小了扫描的范围，所有的条件仍然需要再过滤一次
     index_scan_oper->set_predicates(std::move(predicates));
     oper = unique_ptr<PhysicalOperator>(index_scan_oper);
     LOG_TRACE("use index scan");
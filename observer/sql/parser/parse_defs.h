@@ -151,6 +151,17 @@ struct AttrInfoSqlNode
   size_t      length;  ///< Length of attribute
 };
 
+/**
+ * @brief 建表时指定的表选项
+ * @ingroup SQLParser
+ * @details 比如 create table t(id int) storage_format=slotted
+ */
+struct TableOptionSqlNode
+{
+  std::string name;   ///< 选项名称
+  std::string value;  ///< 选项的值
+};
+
 /**
  * @brief 描述一个create table语句
  * @ingroup SQLParser
@@ -158,8 +169,9 @@ struct AttrInfoSqlNode
  */
 struct CreateTableSqlNode
 {
-  std::string                  relation_name;  ///< Relation name
-  std::vector<AttrInfoSqlNode> attr_infos;     ///< attributes
+  std::string                     relation_name;  ///< Relation name
+  std::vector<AttrInfoSqlNode>    attr_infos;     ///< attributes
+  std::vector<TableOptionSqlNode> options;        ///< table options
 };
 
 /**
@@ -187,13 +199,14 @@ struct DropTableSqlNode
  * @brief 描述一个create index语句
  * @ingroup SQLParser
  * @details 创建索引时，需要指定索引名，表名，字段名。
- * 正常的SQL语句中，一个索引可能包含了多个字段，这里仅支持一个字段。
+ * 一个索引可以包含多个字段，字段的顺序就是联合索引键值中的顺序。
  */
 struct CreateIndexSqlNode
 {
-  std::string index_name;      ///< Index name
-  std::string relation_name;   ///< Relation name
-  std::string attribute_name;  ///< Attribute name
+  std::string              index_name;       ///< Index name
+  std::string              relation_name;    ///< Relation name
+  std::vector<std::string> attribute_names;  ///< Attribute names
+  bool                     unique = false;   ///< 是否是唯一索引
 };
 
 /**
@@ -182,62 +182,67 @@ enum yysymbol_kind_t
   YYSYMBOL_ALTER = 40,                     /* ALTER  */
   YYSYMBOL_ADD = 41,                       /* ADD  */
   YYSYMBOL_COLUMN = 42,                    /* COLUMN  */
-  YYSYMBOL_EQ = 43,                        /* EQ  */
-  YYSYMBOL_LT = 44,                        /* LT  */
-  YYSYMBOL_GT = 45,                        /* GT  */
-  YYSYMBOL_LE = 46,                        /* LE  */
-  YYSYMBOL_GE = 47,                        /* GE  */
-  YYSYMBOL_NE = 48,                        /* NE  */
-  YYSYMBOL_NUMBER = 49,                    /* NUMBER  */
-  YYSYMBOL_FLOAT = 50,                     /* FLOAT  */
-  YYSYMBOL_ID = 51,                        /* ID  */
-  YYSYMBOL_SSS = 52,                       /* SSS  */
-  YYSYMBOL_53_ = 53,                       /* '+'  */
-  YYSYMBOL_54_ = 54,                       /* '-'  */
-  YYSYMBOL_55_ = 55,                       /* '*'  */
-  YYSYMBOL_56_ = 56,                       /* '/'  */
-  YYSYMBOL_UMINUS = 57,                    /* UMINUS  */
-  YYSYMBOL_YYACCEPT = 58,                  /* $accept  */
-  YYSYMBOL_commands = 59,                  /* commands  */
-  YYSYMBOL_command_wrapper = 60,           /* command_wrapper  */
-  YYSYMBOL_exit_stmt = 61,                 /* exit_stmt  */
-  YYSYMBOL_help_stmt = 62,                 /* help_stmt  */
-  YYSYMBOL_sync_stmt = 63,                 /* sync_stmt  */
-  YYSYMBOL_begin_stmt = 64,                /* begin_stmt  */
-  YYSYMBOL_commit_stmt = 65,               /* commit_stmt  */
-  YYSYMBOL_rollback_stmt = 66,             /* rollback_stmt  */
-  YYSYMBOL_drop_table_stmt = 67,           /* drop_table_stmt  */
-  YYSYMBOL_show_tables_stmt = 68,          /* show_tables_stmt  */
-  YYSYMBOL_desc_table_stmt = 69,           /* desc_table_stmt  */
-  YYSYMBOL_create_index_stmt = 70,         /* create_index_stmt  */
-  YYSYMBOL_drop_index_stmt = 71,           /* drop_index_stmt  */
-  YYSYMBOL_create_table_stmt = 72,         /* create_table_stmt  */
-  YYSYMBOL_attr_def_list = 73,             /* attr_def_list  */
-  YYSYMBOL_attr_def = 74,                  /* attr_def  */
-  YYSYMBOL_number = 75,                    /* number  */
-  YYSYMBOL_type = 76,                      /* type  */
-  YYSYMBOL_insert_stmt = 77,               /* insert_stmt  */
-  YYSYMBOL_value_list = 78,                /* value_list  */
-  YYSYMBOL_value = 79,                     /* value  */
-  YYSYMBOL_delete_stmt = 80,               /* delete_stmt  */
-  YYSYMBOL_update_stmt = 81,               /* update_stmt  */
-  YYSYMBOL_select_stmt = 82,               /* select_stmt  */
-  YYSYMBOL_calc_stmt = 83,                 /* calc_stmt  */
-  YYSYMBOL_expression_list = 84,           /* expression_list  */
-  YYSYMBOL_expression = 85,                /* expression  */
-  YYSYMBOL_select_attr = 86,               /* select_attr  */
-  YYSYMBOL_rel_attr = 87,                  /* rel_attr  */
-  YYSYMBOL_attr_list = 88,                 /* attr_list  */
-  YYSYMBOL_rel_list = 89,                  /* rel_list  */
-  YYSYMBOL_where = 90,                     /* where  */
-  YYSYMBOL_condition_list = 91,            /* condition_list  */
-  YYSYMBOL_condition = 92,                 /* condition  */
-  YYSYMBOL_comp_op = 93,                   /* comp_op  */
-  YYSYMBOL_load_data_stmt = 94,            /* load_data_stmt  */
-  YYSYMBOL_explain_stmt = 95,              /* explain_stmt  */
-  YYSYMBOL_set_variable_stmt = 96,         /* set_variable_stmt  */
-  YYSYMBOL_alter_stmt = 97,                /* alter_stmt  */
-  YYSYMBOL_opt_semicolon = 98              /* opt_semicolon  */
+  YYSYMBOL_UNIQUE = 43,                    /* UNIQUE  */
+  YYSYMBOL_COMPRESS = 44,                  /* COMPRESS  */
+  YYSYMBOL_STORAGE_FORMAT = 45,            /* STORAGE_FORMAT  */
+  YYSYMBOL_EQ = 46,                        /* EQ  */
+  YYSYMBOL_LT = 47,                        /* LT  */
+  YYSYMBOL_GT = 48,                        /* GT  */
+  YYSYMBOL_LE = 49,                        /* LE  */
+  YYSYMBOL_GE = 50,                        /* GE  */
+  YYSYMBOL_NE = 51,                        /* NE  */
+  YYSYMBOL_NUMBER = 52,                    /* NUMBER  */
+  YYSYMBOL_FLOAT = 53,                     /* FLOAT  */
+  YYSYMBOL_ID = 54,                        /* ID  */
+  YYSYMBOL_SSS = 55,                       /* SSS  */
+  YYSYMBOL_56_ = 56,                       /* '+'  */
+  YYSYMBOL_57_ = 57,                       /* '-'  */
+  YYSYMBOL_58_ = 58,                       /* '*'  */
+  YYSYMBOL_59_ = 59,                       /* '/'  */
+  YYSYMBOL_UMINUS = 60,                    /* UMINUS  */
+  YYSYMBOL_YYACCEPT = 61,                  /* $accept  */
+  YYSYMBOL_commands = 62,                  /* commands  */
+  YYSYMBOL_command_wrapper = 63,           /* command_wrapper  */
+  YYSYMBOL_exit_stmt = 64,                 /* exit_stmt  */
+  YYSYMBOL_help_stmt = 65,                 /* help_stmt  */
+  YYSYMBOL_sync_stmt = 66,                 /* sync_stmt  */
+  YYSYMBOL_begin_stmt = 67,                /* begin_stmt  */
+  YYSYMBOL_commit_stmt = 68,               /* commit_stmt  */
+  YYSYMBOL_rollback_stmt = 69,             /* rollback_stmt  */
+  YYSYMBOL_drop_table_stmt = 70,           /* drop_table_stmt  */
+  YYSYMBOL_show_tables_stmt = 71,          /* show_tables_stmt  */
+  YYSYMBOL_desc_table_stmt = 72,           /* desc_table_stmt  */
+  YYSYMBOL_create_index_stmt = 73,         /* create_index_stmt  */
+  YYSYMBOL_opt_unique = 74,                /* opt_unique  */
+  YYSYMBOL_drop_index_stmt = 75,           /* drop_index_stmt  */
+  YYSYMBOL_create_table_stmt = 76,         /* create_table_stmt  */
+  YYSYMBOL_table_option_list = 77,         /* table_option_list  */
+  YYSYMBOL_attr_def_list = 78,             /* attr_def_list  */
+  YYSYMBOL_attr_def = 79,                  /* attr_def  */
+  YYSYMBOL_number = 80,                    /* number  */
+  YYSYMBOL_type = 81,                      /* type  */
+  YYSYMBOL_insert_stmt = 82,               /* insert_stmt  */
+  YYSYMBOL_value_list = 83,                /* value_list  */
+  YYSYMBOL_value = 84,                     /* value  */
+  YYSYMBOL_delete_stmt = 85,               /* delete_stmt  */
+  YYSYMBOL_update_stmt = 86,               /* update_stmt  */
+  YYSYMBOL_select_stmt = 87,               /* select_stmt  */
+  YYSYMBOL_calc_stmt = 88,                 /* calc_stmt  */
+  YYSYMBOL_expression_list = 89,           /* expression_list  */
+  YYSYMBOL_expression = 90,                /* expression  */
+  YYSYMBOL_select_attr = 91,               /* select_attr  */
+  YYSYMBOL_rel_attr = 92,                  /* rel_attr  */
+  YYSYMBOL_attr_list = 93,                 /* attr_list  */
+  YYSYMBOL_rel_list = 94,                  /* rel_list  */
+  YYSYMBOL_where = 95,                     /* where  */
+  YYSYMBOL_condition_list = 96,            /* condition_list  */
+  YYSYMBOL_condition = 97,                 /* condition  */
+  YYSYMBOL_comp_op = 98,                   /* comp_op  */
+  YYSYMBOL_load_data_stmt = 99,            /* load_data_stmt  */
+  YYSYMBOL_explain_stmt = 100,             /* explain_stmt  */
+  YYSYMBOL_set_variable_stmt = 101,        /* set_variable_stmt  */
+  YYSYMBOL_alter_stmt = 102,               /* alter_stmt  */
+  YYSYMBOL_opt_semicolon = 103             /* opt_semicolon  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -566,21 +571,21 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  68
+#define YYFINAL  69
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   154
+#define YYLAST   159
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  58
+#define YYNTOKENS  61
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  41
+#define YYNNTS  43
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  91
+#define YYNRULES  96
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  173
+#define YYNSTATES  182
 
 /* YYMAXUTOK -- Last valid token kind.  */
-#define YYMAXUTOK   308
+#define YYMAXUTOK   311
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
@@ -598,7 +603,7 @@ static const yytype_int8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,    55,    53,     2,    54,     2,    56,     2,     2,
+       2,     2,    58,    56,     2,    57,     2,    59,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -624,23 +629,24 @@ static const yytype_int8 yytranslate[] =
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
       25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
       35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
-      45,    46,    47,    48,    49,    50,    51,    52,    57
+      45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
+      55,    60
 };
 
 #if YYDEBUG
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   177,   177,   185,   186,   187,   188,   189,   190,   191,
-     192,   193,   194,   195,   196,   197,   198,   199,   200,   201,
-     202,   203,   204,   205,   209,   216,   222,   228,   234,   240,
-     246,   253,   259,   267,   281,   291,   311,   314,   327,   335,
-     345,   348,   349,   350,   353,   370,   373,   384,   388,   392,
-     401,   413,   428,   450,   460,   465,   476,   479,   482,   485,
-     488,   492,   495,   503,   510,   522,   527,   538,   541,   555,
-     558,   571,   574,   580,   583,   588,   595,   607,   619,   631,
-     646,   647,   648,   649,   650,   651,   655,   668,   676,   687,
-     711,   712
+       0,   183,   183,   191,   192,   193,   194,   195,   196,   197,
+     198,   199,   200,   201,   202,   203,   204,   205,   206,   207,
+     208,   209,   210,   211,   215,   222,   228,   234,   240,   246,
+     252,   259,   265,   273,   294,   297,   304,   314,   340,   343,
+     356,   359,   372,   380,   390,   393,   394,   395,   398,   415,
+     418,   429,   433,   437,   446,   458,   473,   495,   505,   510,
+     521,   524,   527,   530,   533,   537,   540,   548,   555,   567,
+     572,   583,   586,   600,   603,   616,   619,   625,   628,   633,
+     640,   652,   664,   676,   691,   692,   693,   694,   695,   696,
+     700,   713,   721,   732,   754,   767,   768
 };
 #endif
 
@@ -662,16 +668,17 @@ static const char *const yytname[] =
   "TRX_BEGIN", "TRX_COMMIT", "TRX_ROLLBACK", "INT_T", "STRING_T",
   "FLOAT_T", "HELP", "EXIT", "DOT", "INTO", "VALUES", "FROM", "WHERE",
   "AND", "SET", "ON", "LOAD", "DATA", "INFILE", "EXPLAIN", "ALTER", "ADD",
-  "COLUMN", "EQ", "LT", "GT", "LE", "GE", "NE", "NUMBER", "FLOAT", "ID",
-  "SSS", "'+'", "'-'", "'*'", "'/'", "UMINUS", "$accept", "commands",
-  "command_wrapper", "exit_stmt", "help_stmt", "sync_stmt", "begin_stmt",
-  "commit_stmt", "rollback_stmt", "drop_table_stmt", "show_tables_stmt",
-  "desc_table_stmt", "create_index_stmt", "drop_index_stmt",
-  "create_table_stmt", "attr_def_list", "attr_def", "number", "type",
-  "insert_stmt", "value_list", "value", "delete_stmt", "update_stmt",
-  "select_stmt", "calc_stmt", "expression_list", "expression",
-  "select_attr", "rel_attr", "attr_list", "rel_list", "where",
-  "condition_list", "condition", "comp_op", "load_data_stmt",
+  "COLUMN", "UNIQUE", "COMPRESS", "STORAGE_FORMAT", "EQ", "LT", "GT", "LE",
+  "GE", "NE", "NUMBER", "FLOAT", "ID", "SSS", "'+'", "'-'", "'*'", "'/'",
+  "UMINUS", "$accept", "commands", "command_wrapper", "exit_stmt",
+  "help_stmt", "sync_stmt", "begin_stmt", "commit_stmt", "rollback_stmt",
+  "drop_table_stmt", "show_tables_stmt", "desc_table_stmt",
+  "create_index_stmt", "opt_unique", "drop_index_stmt",
+  "create_table_stmt", "table_option_list", "attr_def_list", "attr_def",
+  "number", "type", "insert_stmt", "value_list", "value", "delete_stmt",
+  "update_stmt", "select_stmt", "calc_stmt", "expression_list",
+  "expression", "select_attr", "rel_attr", "attr_list", "rel_list",
+  "where", "condition_list", "condition", "comp_op", "load_data_stmt",
   "explain_stmt", "set_variable_stmt", "alter_stmt", "opt_semicolon", YY_NULLPTR
 };
 
@@ -682,7 +689,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-145)
+#define YYPACT_NINF (-146)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -696,24 +703,25 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-      48,    23,    28,    -8,   -45,   -36,     9,  -145,   -10,   -11,
-     -23,  -145,  -145,  -145,  -145,  -145,   -18,     6,    48,    39,
-      51,    63,  -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,
-    -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,  -145,
-    -145,  -145,  -145,    21,    22,    30,    32,    -8,  -145,  -145,
-    -145,    -8,  -145,  -145,    -6,    57,  -145,    55,    73,  -145,
-    -145,    42,    43,    61,    53,    59,  -145,    52,  -145,  -145,
-    -145,    85,    69,  -145,    70,   -16,  -145,    -8,    -8,    -8,
-      -8,    -8,    56,    58,    60,  -145,    76,    78,    62,   -38,
-      64,    67,    68,    71,    72,  -145,  -145,   -48,   -48,  -145,
-    -145,  -145,    93,    73,    97,    27,  -145,    74,  -145,    86,
-      79,    66,    99,   103,  -145,    75,    78,  -145,   -38,   -21,
-     -21,  -145,    91,   -38,   119,   110,  -145,  -145,  -145,   111,
-      68,   112,    80,    93,  -145,   113,  -145,  -145,  -145,  -145,
-    -145,  -145,    27,    27,    27,    78,    82,    68,    87,    99,
-    -145,   116,  -145,   -38,   117,  -145,  -145,  -145,  -145,  -145,
-    -145,  -145,    99,  -145,   122,  -145,  -145,   113,  -145,   123,
-    -145,  -145,  -145
+      58,     5,    24,    -8,   -46,   -40,    22,  -146,     8,     3,
+     -19,  -146,  -146,  -146,  -146,  -146,   -15,     9,    58,    48,
+      64,    62,  -146,  -146,  -146,  -146,  -146,  -146,  -146,  -146,
+    -146,  -146,  -146,  -146,  -146,  -146,  -146,  -146,  -146,  -146,
+    -146,  -146,  -146,    29,  -146,    79,    35,    36,    -8,  -146,
+    -146,  -146,    -8,  -146,  -146,    -6,    60,  -146,    65,    72,
+    -146,  -146,    39,    41,    66,    53,    63,  -146,    49,  -146,
+    -146,  -146,    85,    50,  -146,    70,   -16,  -146,    -8,    -8,
+      -8,    -8,    -8,    54,    55,    56,  -146,    76,    75,    57,
+     -37,    67,   -34,    69,    77,    71,  -146,  -146,   -38,   -38,
+    -146,  -146,  -146,    98,    72,   101,     6,  -146,    73,  -146,
+      91,    82,  -146,    52,   102,    74,  -146,    78,    75,  -146,
+     -37,   -23,   -23,  -146,    93,   -37,   121,   112,  -146,  -146,
+    -146,   113,    69,   115,   114,    98,  -146,   116,  -146,  -146,
+    -146,  -146,  -146,  -146,     6,     6,     6,    75,    80,    69,
+      84,   102,    92,    88,  -146,   -37,   120,  -146,  -146,  -146,
+    -146,  -146,  -146,  -146,   102,  -146,   125,  -146,    99,  -146,
+      98,   116,  -146,   126,  -146,    94,   128,  -146,  -146,    92,
+    -146,  -146
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -721,44 +729,45 @@ static const yytype_int16 yypact[] =
    means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
-       0,     0,     0,     0,     0,     0,     0,    26,     0,     0,
+       0,    34,     0,     0,     0,     0,     0,    26,     0,     0,
        0,    27,    28,    29,    25,    24,     0,     0,     0,     0,
-       0,    90,    22,    21,    14,    15,    16,    17,     9,    10,
+       0,    95,    22,    21,    14,    15,    16,    17,     9,    10,
       11,    12,    13,     8,     5,     7,     6,     4,     3,    18,
-      19,    20,    23,     0,     0,     0,     0,     0,    47,    48,
-      49,     0,    62,    53,    54,    65,    63,     0,    67,    32,
-      31,     0,     0,     0,     0,     0,    87,     0,     1,    91,
-       2,     0,     0,    30,     0,     0,    61,     0,     0,     0,
-       0,     0,     0,     0,     0,    64,     0,    71,     0,     0,
-       0,     0,     0,     0,     0,    60,    55,    56,    57,    58,
-      59,    66,    69,    67,     0,    73,    50,     0,    88,     0,
-       0,     0,    36,     0,    34,     0,    71,    68,     0,     0,
-       0,    72,    74,     0,     0,     0,    41,    42,    43,    39,
-       0,     0,     0,    69,    52,    45,    80,    81,    82,    83,
-      84,    85,     0,     0,    73,    71,     0,     0,     0,    36,
-      35,     0,    70,     0,     0,    77,    79,    76,    78,    75,
-      51,    86,    36,    40,     0,    37,    33,    45,    44,     0,
-      38,    46,    89
+      19,    20,    23,     0,    35,     0,     0,     0,     0,    51,
+      52,    53,     0,    66,    57,    58,    69,    67,     0,    71,
+      32,    31,     0,     0,     0,     0,     0,    91,     0,     1,
+      96,     2,     0,     0,    30,     0,     0,    65,     0,     0,
+       0,     0,     0,     0,     0,     0,    68,     0,    75,     0,
+       0,     0,     0,     0,     0,     0,    64,    59,    60,    61,
+      62,    63,    70,    73,    71,     0,    77,    54,     0,    92,
+       0,     0,    94,     0,    40,     0,    36,     0,    75,    72,
+       0,     0,     0,    76,    78,     0,     0,     0,    45,    46,
+      47,    43,     0,     0,     0,    73,    56,    49,    84,    85,
+      86,    87,    88,    89,     0,     0,    77,    75,     0,     0,
+       0,    40,    38,     0,    74,     0,     0,    81,    83,    80,
+      82,    79,    55,    90,    40,    44,     0,    41,     0,    37,
+      73,    49,    48,     0,    42,     0,     0,    50,    93,    38,
+      33,    39
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-    -145,  -145,   124,  -145,  -145,  -145,  -145,  -145,  -145,  -145,
-    -145,  -145,  -145,  -145,  -145,  -144,  -126,  -145,  -145,  -145,
-     -30,   -88,  -145,  -145,  -145,  -145,    77,    20,  -145,    -4,
-      26,    10,  -113,     0,  -145,    25,  -145,  -145,  -145,  -145,
-    -145
+    -146,  -146,   129,  -146,  -146,  -146,  -146,  -146,  -146,  -146,
+    -146,  -146,  -146,  -146,  -146,  -146,   -30,  -145,  -127,  -146,
+    -146,  -146,   -32,   -89,  -146,  -146,  -146,  -146,    81,    34,
+    -146,    -4,    46,  -132,  -114,     7,  -146,    30,  -146,  -146,
+    -146,  -146,  -146
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_uint8 yydefgoto[] =
 {
        0,    20,    21,    22,    23,    24,    25,    26,    27,    28,
-      29,    30,    31,    32,    33,   131,   112,   164,   129,    34,
-     154,    52,    35,    36,    37,    38,    53,    54,    57,   120,
-      85,   116,   106,   121,   122,   142,    39,    40,    41,    42,
-      70
+      29,    30,    31,    45,    32,    33,   169,   133,   114,   166,
+     131,    34,   156,    53,    35,    36,    37,    38,    54,    55,
+      58,   122,    86,   118,   107,   123,   124,   144,    39,    40,
+      41,    42,    71
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -766,42 +775,42 @@ static const yytype_uint8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-      58,   108,    95,   134,   149,   165,    55,    80,    81,    47,
-      56,    48,    49,    77,    50,    59,    60,   119,   169,    61,
-      62,   162,   136,   137,   138,   139,   140,   141,    63,    43,
-     135,    44,   160,    64,    45,   145,    46,    78,    79,    80,
-      81,    48,    49,    65,    50,    67,    51,    78,    79,    80,
-      81,    68,     1,     2,   155,   157,   119,     3,     4,     5,
-       6,     7,     8,     9,    10,   167,    69,    75,    11,    12,
-      13,    76,    71,    72,    14,    15,    48,    49,    55,    50,
-     103,    73,    16,    74,    17,    82,    83,    18,    19,   126,
-     127,   128,    84,    86,    87,    88,    89,    90,    97,    98,
-      99,   100,    92,    91,    93,    94,   104,   101,   110,   102,
-     105,    55,   115,   107,   118,   124,   109,   123,   130,   111,
-     132,   125,   113,   114,   144,   146,   133,   147,   148,   117,
-     150,   151,   153,   161,   166,   168,   163,   171,   156,   158,
-     170,   172,    66,   152,   159,   143,     0,     0,     0,     0,
-       0,     0,     0,     0,    96
+      59,   109,    96,   154,   136,   151,   167,   111,    56,    48,
+     112,    43,    57,    78,    60,    49,    50,   121,    51,   173,
+      81,    82,   164,   138,   139,   140,   141,   142,   143,    61,
+      46,   137,    47,   162,    63,    64,   147,    62,   176,    65,
+      79,    80,    81,    82,    49,    50,    66,    51,    44,    52,
+      79,    80,    81,    82,    68,   157,   159,   121,    49,    50,
+      56,    51,     1,     2,    69,    70,   171,     3,     4,     5,
+       6,     7,     8,     9,    10,   128,   129,   130,    11,    12,
+      13,   104,    76,    72,    14,    15,    77,    73,    83,    74,
+      75,    85,    16,    87,    17,    88,    84,    18,    19,    90,
+      89,    91,    93,    92,    94,    95,   105,   106,   102,   103,
+      56,   108,   115,    98,    99,   100,   101,   117,   120,   125,
+     126,   132,   110,   113,   127,   116,   146,   148,   134,   149,
+     150,   153,   135,   152,   163,   155,   165,   168,   172,   177,
+     158,   160,   170,   174,   178,   175,   180,    67,   179,   181,
+     119,     0,   145,   161,     0,     0,     0,     0,     0,    97
 };
 
 static const yytype_int16 yycheck[] =
 {
-       4,    89,    18,   116,   130,   149,    51,    55,    56,    17,
-      55,    49,    50,    19,    52,    51,     7,   105,   162,    29,
-      31,   147,    43,    44,    45,    46,    47,    48,    51,     6,
-     118,     8,   145,    51,     6,   123,     8,    53,    54,    55,
-      56,    49,    50,    37,    52,     6,    54,    53,    54,    55,
-      56,     0,     4,     5,   142,   143,   144,     9,    10,    11,
-      12,    13,    14,    15,    16,   153,     3,    47,    20,    21,
-      22,    51,    51,    51,    26,    27,    49,    50,    51,    52,
-      84,    51,    34,    51,    36,    28,    31,    39,    40,    23,
-      24,    25,    19,    51,    51,    34,    43,    38,    78,    79,
-      80,    81,    17,    51,    35,    35,    30,    51,    41,    51,
-      32,    51,    19,    51,    17,    29,    52,    43,    19,    51,
-      17,    42,    51,    51,    33,     6,    51,    17,    17,   103,
-      18,    51,    19,    51,    18,    18,    49,   167,   142,   143,
-      18,    18,    18,   133,   144,   120,    -1,    -1,    -1,    -1,
-      -1,    -1,    -1,    -1,    77
+       4,    90,    18,   135,   118,   132,   151,    41,    54,    17,
+      44,     6,    58,    19,    54,    52,    53,   106,    55,   164,
+      58,    59,   149,    46,    47,    48,    49,    50,    51,     7,
+       6,   120,     8,   147,    31,    54,   125,    29,   170,    54,
+      56,    57,    58,    59,    52,    53,    37,    55,    43,    57,
+      56,    57,    58,    59,     6,   144,   145,   146,    52,    53,
+      54,    55,     4,     5,     0,     3,   155,     9,    10,    11,
+      12,    13,    14,    15,    16,    23,    24,    25,    20,    21,
+      22,    85,    48,    54,    26,    27,    52,     8,    28,    54,
+      54,    19,    34,    54,    36,    54,    31,    39,    40,    46,
+      34,    38,    17,    54,    54,    35,    30,    32,    54,    54,
+      54,    54,    35,    79,    80,    81,    82,    19,    17,    46,
+      29,    19,    55,    54,    42,    54,    33,     6,    54,    17,
+      17,    17,    54,    18,    54,    19,    52,    45,    18,   171,
+     144,   145,    54,    18,    18,    46,    18,    18,    54,   179,
+     104,    -1,   122,   146,    -1,    -1,    -1,    -1,    -1,    78
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
@@ -810,37 +819,38 @@ static const yytype_int8 yystos[] =
 {
        0,     4,     5,     9,    10,    11,    12,    13,    14,    15,
       16,    20,    21,    22,    26,    27,    34,    36,    39,    40,
-      59,    60,    61,    62,    63,    64,    65,    66,    67,    68,
-      69,    70,    71,    72,    77,    80,    81,    82,    83,    94,
-      95,    96,    97,     6,     8,     6,     8,    17,    49,    50,
-      52,    54,    79,    84,    85,    51,    55,    86,    87,    51,
-       7,    29,    31,    51,    51,    37,    60,     6,     0,     3,
-      98,    51,    51,    51,    51,    85,    85,    19,    53,    54,
-      55,    56,    28,    31,    19,    88,    51,    51,    34,    43,
-      38,    51,    17,    35,    35,    18,    84,    85,    85,    85,
-      85,    51,    51,    87,    30,    32,    90,    51,    79,    52,
-      41,    51,    74,    51,    51,    19,    89,    88,    17,    79,
-      87,    91,    92,    43,    29,    42,    23,    24,    25,    76,
-      19,    73,    17,    51,    90,    79,    43,    44,    45,    46,
-      47,    48,    93,    93,    33,    79,     6,    17,    17,    74,
-      18,    51,    89,    19,    78,    79,    87,    79,    87,    91,
-      90,    51,    74,    49,    75,    73,    18,    79,    18,    73,
-      18,    78,    18
+      62,    63,    64,    65,    66,    67,    68,    69,    70,    71,
+      72,    73,    75,    76,    82,    85,    86,    87,    88,    99,
+     100,   101,   102,     6,    43,    74,     6,     8,    17,    52,
+      53,    55,    57,    84,    89,    90,    54,    58,    91,    92,
+      54,     7,    29,    31,    54,    54,    37,    63,     6,     0,
+       3,   103,    54,     8,    54,    54,    90,    90,    19,    56,
+      57,    58,    59,    28,    31,    19,    93,    54,    54,    34,
+      46,    38,    54,    17,    54,    35,    18,    89,    90,    90,
+      90,    90,    54,    54,    92,    30,    32,    95,    54,    84,
+      55,    41,    44,    54,    79,    35,    54,    19,    94,    93,
+      17,    84,    92,    96,    97,    46,    29,    42,    23,    24,
+      25,    81,    19,    78,    54,    54,    95,    84,    46,    47,
+      48,    49,    50,    51,    98,    98,    33,    84,     6,    17,
+      17,    79,    18,    17,    94,    19,    83,    84,    92,    84,
+      92,    96,    95,    54,    79,    52,    80,    78,    45,    77,
+      54,    84,    18,    78,    18,    46,    94,    83,    18,    54,
+      18,    77
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,    58,    59,    60,    60,    60,    60,    60,    60,    60,
-      60,    60,    60,    60,    60,    60,    60,    60,    60,    60,
-      60,    60,    60,    60,    61,    62,    63,    64,    65,    66,
-      67,    68,    69,    70,    71,    72,    73,    73,    74,    74,
-      75,    76,    76,    76,    77,    78,    78,    79,    79,    79,
-      80,    81,    82,    83,    84,    84,    85,    85,    85,    85,
-      85,    85,    85,    86,    86,    87,    87,    88,    88,    89,
-      89,    90,    90,    91,    91,    91,    92,    92,    92,    92,
-      93,    93,    93,    93,    93,    93,    94,    95,    96,    97,
-      98,    98
+       0,    61,    62,    63,    63,    63,    63,    63,    63,    63,
+      63,    63,    63,    63,    63,    63,    63,    63,    63,    63,
+      63,    63,    63,    63,    64,    65,    66,    67,    68,    69,
+      70,    71,    72,    73,    74,    74,    75,    76,    77,    77,
+      78,    78,    79,    79,    80,    81,    81,    81,    82,    83,
+      83,    84,    84,    84,    85,    86,    87,    88,    89,    89,
+      90,    90,    90,    90,    90,    90,    90,    91,    91,    92,
+      92,    93,    93,    94,    94,    95,    95,    96,    96,    96,
+      97,    97,    97,    97,    98,    98,    98,    98,    98,    98,
+      99,   100,   101,   102,   102,   103,   103
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
@@ -849,13 +859,13 @@ static const yytype_int8 yyr2[] =
        0,     2,     2,     1,     1,     1,     1,     1,     1,     1,
        1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
        1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       3,     2,     2,     8,     5,     7,     0,     3,     5,     2,
-       1,     1,     1,     1,     8,     0,     3,     1,     1,     1,
-       4,     7,     6,     2,     1,     3,     3,     3,     3,     3,
-       3,     2,     1,     1,     2,     1,     3,     0,     3,     0,
-       3,     0,     2,     0,     1,     3,     3,     3,     3,     3,
-       1,     1,     1,     1,     1,     1,     7,     2,     4,     9,
-       0,     1
+       3,     2,     2,    10,     0,     1,     5,     8,     0,     4,
+       0,     3,     5,     2,     1,     1,     1,     1,     8,     0,
+       3,     1,     1,     1,     4,     7,     6,     2,     1,     3,
+       3,     3,     3,     3,     3,     2,     1,     1,     2,     1,
+       3,     0,     3,     0,     3,     0,     2,     0,     1,     3,
+       3,     3,     3,     3,     1,     1,     1,     1,     1,     1,
+       7,     2,     4,     9,     4,     0,     1
 };
 
 
@@ -1717,108 +1727,130 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* commands: command_wrapper opt_semicolon  */
-#line 178 "yacc_sql.y"
+#line 184 "yacc_sql.y"
   {
     std::unique_ptr<ParsedSqlNode> sql_node = std::unique_ptr<ParsedSqlNode>((yyvsp[-1].sql_node));
     sql_result->add_sql_node(std::move(sql_node));
   }
-#line 1726 "yacc_sql.cpp"
+#line 1736 "yacc_sql.cpp"
     break;
 
   case 24: /* exit_stmt: EXIT  */
-#line 209 "yacc_sql.y"
+#line 215 "yacc_sql.y"
          {
       (void)yynerrs;  // 这么写为了消除yynerrs未使用的告警。如果你有更好的方法欢迎提PR
       (yyval.sql_node) = new ParsedSqlNode(SCF_EXIT);
     }
-#line 1735 "yacc_sql.cpp"
+#line 1745 "yacc_sql.cpp"
     break;
 
   case 25: /* help_stmt: HELP  */
-#line 216 "yacc_sql.y"
+#line 222 "yacc_sql.y"
          {
       (yyval.sql_node) = new ParsedSqlNode(SCF_HELP);
     }
-#line 1743 "yacc_sql.cpp"
+#line 1753 "yacc_sql.cpp"
     break;
 
   case 26: /* sync_stmt: SYNC  */
-#line 222 "yacc_sql.y"
+#line 228 "yacc_sql.y"
          {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SYNC);
     }
-#line 1751 "yacc_sql.cpp"
+#line 1761 "yacc_sql.cpp"
     break;
 
   case 27: /* begin_stmt: TRX_BEGIN  */
-#line 228 "yacc_sql.y"
+#line 234 "yacc_sql.y"
                {
       (yyval.sql_node) = new ParsedSqlNode(SCF_BEGIN);
     }
-#line 1759 "yacc_sql.cpp"
+#line 1769 "yacc_sql.cpp"
     break;
 
   case 28: /* commit_stmt: TRX_COMMIT  */
-#line 234 "yacc_sql.y"
+#line 240 "yacc_sql.y"
                {
       (yyval.sql_node) = new ParsedSqlNode(SCF_COMMIT);
     }
-#line 1767 "yacc_sql.cpp"
+#line 1777 "yacc_sql.cpp"
     break;
 
   case 29: /* rollback_stmt: TRX_ROLLBACK  */
-#line 240 "yacc_sql.y"
+#line 246 "yacc_sql.y"
                   {
       (yyval.sql_node) = new ParsedSqlNode(SCF_ROLLBACK);
     }
-#line 1775 "yacc_sql.cpp"
+#line 1785 "yacc_sql.cpp"
     break;
 
   case 30: /* drop_table_stmt: DROP TABLE ID  */
-#line 246 "yacc_sql.y"
+#line 252 "yacc_sql.y"
                   {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DROP_TABLE);
       (yyval.sql_node)->drop_table.relation_name = (yyvsp[0].string);
       free((yyvsp[0].string));
     }
-#line 1785 "yacc_sql.cpp"
+#line 1795 "yacc_sql.cpp"
     break;
 
   case 31: /* show_tables_stmt: SHOW TABLES  */
-#line 253 "yacc_sql.y"
+#line 259 "yacc_sql.y"
                 {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SHOW_TABLES);
     }
-#line 1793 "yacc_sql.cpp"
+#line 1803 "yacc_sql.cpp"
     break;
 
   case 32: /* desc_table_stmt: DESC ID  */
-#line 259 "yacc_sql.y"
+#line 265 "yacc_sql.y"
              {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DESC_TABLE);
       (yyval.sql_node)->desc_table.relation_name = (yyvsp[0].string);
       free((yyvsp[0].string));
     }
-#line 1803 "yacc_sql.cpp"
+#line 1813 "yacc_sql.cpp"
     break;
 
-  case 33: /* create_index_stmt: CREATE INDEX ID ON ID LBRACE ID RBRACE  */
-#line 268 "yacc_sql.y"
+  case 33: /* create_index_stmt: CREATE opt_unique INDEX ID ON ID LBRACE ID rel_list RBRACE  */
+#line 274 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = (yyval.sql_node)->create_index;
-      create_index.index_name = (yyvsp[-5].string);
-      create_index.relation_name = (yyvsp[-3].string);
-      create_index.attribute_name = (yyvsp[-1].string);
-      free((yyvsp[-5].string));
-      free((yyvsp[-3].string));
-      free((yyvsp[-1].string));
+      create_index.index_name = (yyvsp[-6].string);
+      create_index.relation_name = (yyvsp[-4].string);
+      create_index.unique = ((yyvsp[-8].number) != 0);
+      if ((yyvsp[-1].relation_list) != nullptr) {
+        create_index.attribute_names.swap(*(yyvsp[-1].relation_list));
+        delete (yyvsp[-1].relation_list);
+      }
+      create_index.attribute_names.push_back((yyvsp[-2].string));
+      std::reverse(create_index.attribute_names.begin(), create_index.attribute_names.end());
+      free((yyvsp[-6].string));
+      free((yyvsp[-4].string));
+      free((yyvsp[-2].string));
+    }
+#line 1834 "yacc_sql.cpp"
+    break;
+
+  case 34: /* opt_unique: %empty  */
+#line 294 "yacc_sql.y"
+    {
+      (yyval.number) = 0;
+    }
+#line 1842 "yacc_sql.cpp"
+    break;
+
+  case 35: /* opt_unique: UNIQUE  */
+#line 298 "yacc_sql.y"
+    {
+      (yyval.number) = 1;
     }
-#line 1818 "yacc_sql.cpp"
+#line 1850 "yacc_sql.cpp"
     break;
 
-  case 34: /* drop_index_stmt: DROP INDEX ID ON ID  */
-#line 282 "yacc_sql.y"
+  case 36: /* drop_index_stmt: DROP INDEX ID ON ID  */
+#line 305 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DROP_INDEX);
       (yyval.sql_node)->drop_index.index_name = (yyvsp[-2].string);
@@ -1826,40 +1858,68 @@ yyreduce:
       free((yyvsp[-2].string));
       free((yyvsp[0].string));
     }
-#line 1830 "yacc_sql.cpp"
+#line 1862 "yacc_sql.cpp"
     break;
 
-  case 35: /* create_table_stmt: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE  */
-#line 292 "yacc_sql.y"
+  case 37: /* create_table_stmt: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE table_option_list  */
+#line 315 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_CREATE_TABLE);
       CreateTableSqlNode &create_table = (yyval.sql_node)->create_table;
-      create_table.relation_name = (yyvsp[-4].string);
-      free((yyvsp[-4].string));
+      create_table.relation_name = (yyvsp[-5].string);
+      free((yyvsp[-5].string));
 
-      std::vector<AttrInfoSqlNode> *src_attrs = (yyvsp[-1].attr_infos);
+      std::vector<AttrInfoSqlNode> *src_attrs = (yyvsp[-2].attr_infos);
 
       if (src_attrs != nullptr) {
         create_table.attr_infos.swap(*src_attrs);
         delete src_attrs;
       }
-      create_table.attr_infos.emplace_back(*(yyvsp[-2].attr_info));
+      create_table.attr_infos.emplace_back(*(yyvsp[-3].attr_info));
       std::reverse(create_table.attr_infos.begin(), create_table.attr_infos.end());
-      delete (yyvsp[-2].attr_info);
+      delete (yyvsp[-3].attr_info);
+
+      if ((yyvsp[0].table_options) != nullptr) {
+        create_table.options.swap(*(yyvsp[0].table_options));
+        std::reverse(create_table.options.begin(), create_table.options.end());
+        delete (yyvsp[0].table_options);
+      }
     }
-#line 1851 "yacc_sql.cpp"
+#line 1889 "yacc_sql.cpp"
+    break;
+
+  case 38: /* table_option_list: %empty  */
+#line 340 "yacc_sql.y"
+    {
+      (yyval.table_options) = nullptr;
+    }
+#line 1897 "yacc_sql.cpp"
     break;
 
-  case 36: /* attr_def_list: %empty  */
-#line 311 "yacc_sql.y"
+  case 39: /* table_option_list: STORAGE_FORMAT EQ ID table_option_list  */
+#line 344 "yacc_sql.y"
+    {
+      if ((yyvsp[0].table_options) != nullptr) {
+        (yyval.table_options) = (yyvsp[0].table_options);
+      } else {
+        (yyval.table_options) = new std::vector<TableOptionSqlNode>;
+      }
+      (yyval.table_options)->emplace_back(TableOptionSqlNode{"storage_format", (yyvsp[-1].string)});
+      free((yyvsp[-1].string));
+    }
+#line 1911 "yacc_sql.cpp"
+    break;
+
+  case 40: /* attr_def_list: %empty  */
+#line 356 "yacc_sql.y"
     {
       (yyval.attr_infos) = nullptr;
     }
-#line 1859 "yacc_sql.cpp"
+#line 1919 "yacc_sql.cpp"
     break;
 
-  case 37: /* attr_def_list: COMMA attr_def attr_def_list  */
-#line 315 "yacc_sql.y"
+  case 41: /* attr_def_list: COMMA attr_def attr_def_list  */
+#line 360 "yacc_sql.y"
     {
       if ((yyvsp[0].attr_infos) != nullptr) {
         (yyval.attr_infos) = (yyvsp[0].attr_infos);
@@ -1869,11 +1929,11 @@ yyreduce:
       (yyval.attr_infos)->emplace_back(*(yyvsp[-1].attr_info));
       delete (yyvsp[-1].attr_info);
     }
-#line 1873 "yacc_sql.cpp"
+#line 1933 "yacc_sql.cpp"
     break;
 
-  case 38: /* attr_def: ID type LBRACE number RBRACE  */
-#line 328 "yacc_sql.y"
+  case 42: /* attr_def: ID type LBRACE number RBRACE  */
+#line 373 "yacc_sql.y"
     {
       (yyval.attr_info) = new AttrInfoSqlNode;
       (yyval.attr_info)->type = (AttrType)(yyvsp[-3].number);
@@ -1881,11 +1941,11 @@ yyreduce:
       (yyval.attr_info)->length = (yyvsp[-1].number);
       free((yyvsp[-4].string));
     }
-#line 1885 "yacc_sql.cpp"
+#line 1945 "yacc_sql.cpp"
     break;
 
-  case 39: /* attr_def: ID type  */
-#line 336 "yacc_sql.y"
+  case 43: /* attr_def: ID type  */
+#line 381 "yacc_sql.y"
     {
       (yyval.attr_info) = new AttrInfoSqlNode;
       (yyval.attr_info)->type = (AttrType)(yyvsp[0].number);
@@ -1893,35 +1953,35 @@ yyreduce:
       (yyval.attr_info)->length = 4;
       free((yyvsp[-1].string));
     }
-#line 1897 "yacc_sql.cpp"
+#line 1957 "yacc_sql.cpp"
     break;
 
-  case 40: /* number: NUMBER  */
-#line 345 "yacc_sql.y"
+  case 44: /* number: NUMBER  */
+#line 390 "yacc_sql.y"
            {(yyval.number) = (yyvsp[0].number);}
-#line 1903 "yacc_sql.cpp"
+#line 1963 "yacc_sql.cpp"
     break;
 
-  case 41: /* type: INT_T  */
-#line 348 "yacc_sql.y"
+  case 45: /* type: INT_T  */
+#line 393 "yacc_sql.y"
                { (yyval.number)=INTS; }
-#line 1909 "yacc_sql.cpp"
+#line 1969 "yacc_sql.cpp"
     break;
 
-  case 42: /* type: STRING_T  */
-#line 349 "yacc_sql.y"
+  case 46: /* type: STRING_T  */
+#line 394 "yacc_sql.y"
                { (yyval.number)=CHARS; }
-#line 1915 "yacc_sql.cpp"
+#line 1975 "yacc_sql.cpp"
     break;
 
-  case 43: /* type: FLOAT_T  */
-#line 350 "yacc_sql.y"
+  case 47: /* type: FLOAT_T  */
+#line 395 "yacc_sql.y"
                { (yyval.number)=FLOATS; }
-#line 1921 "yacc_sql.cpp"
+#line 1981 "yacc_sql.cpp"
     break;
 
-  case 44: /* insert_stmt: INSERT INTO ID VALUES LBRACE value value_list RBRACE  */
-#line 354 "yacc_sql.y"
+  case 48: /* insert_stmt: INSERT INTO ID VALUES LBRACE value value_list RBRACE  */
+#line 399 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_INSERT);
       (yyval.sql_node)->insertion.relation_name = (yyvsp[-5].string);
@@ -1934,19 +1994,19 @@ yyreduce:
       delete (yyvsp[-2].value);
       free((yyvsp[-5].string));
     }
-#line 1938 "yacc_sql.cpp"
+#line 1998 "yacc_sql.cpp"
     break;
 
-  case 45: /* value_list: %empty  */
-#line 370 "yacc_sql.y"
+  case 49: /* value_list: %empty  */
+#line 415 "yacc_sql.y"
     {
       (yyval.value_list) = nullptr;
     }
-#line 1946 "yacc_sql.cpp"
+#line 2006 "yacc_sql.cpp"
     break;
 
-  case 46: /* value_list: COMMA value value_list  */
-#line 373 "yacc_sql.y"
+  case 50: /* value_list: COMMA value value_list  */
+#line 418 "yacc_sql.y"
                               { 
       if ((yyvsp[0].value_list) != nullptr) {
         (yyval.value_list) = (yyvsp[0].value_list);
@@ -1956,40 +2016,40 @@ yyreduce:
       (yyval.value_list)->emplace_back(*(yyvsp[-1].value));
       delete (yyvsp[-1].value);
     }
-#line 1960 "yacc_sql.cpp"
+#line 2020 "yacc_sql.cpp"
     break;
 
-  case 47: /* value: NUMBER  */
-#line 384 "yacc_sql.y"
+  case 51: /* value: NUMBER  */
+#line 429 "yacc_sql.y"
            {
       (yyval.value) = new Value((int)(yyvsp[0].number));
       (yyloc) = (yylsp[0]);
     }
-#line 1969 "yacc_sql.cpp"
+#line 2029 "yacc_sql.cpp"
     break;
 
-  case 48: /* value: FLOAT  */
-#line 388 "yacc_sql.y"
+  case 52: /* value: FLOAT  */
+#line 433 "yacc_sql.y"
            {
       (yyval.value) = new Value((float)(yyvsp[0].floats));
       (yyloc) = (yylsp[0]);
     }
-#line 1978 "yacc_sql.cpp"
+#line 2038 "yacc_sql.cpp"
     break;
 
-  case 49: /* value: SSS  */
-#line 392 "yacc_sql.y"
+  case 53: /* value: SSS  */
+#line 437 "yacc_sql.y"
          {
       char *tmp = common::substr((yyvsp[0].string),1,strlen((yyvsp[0].string))-2);
       (yyval.value) = new Value(tmp);
       free(tmp);
       free((yyvsp[0].string));
     }
-#line 1989 "yacc_sql.cpp"
+#line 2049 "yacc_sql.cpp"
     break;
 
-  case 50: /* delete_stmt: DELETE FROM ID where  */
-#line 402 "yacc_sql.y"
+  case 54: /* delete_stmt: DELETE FROM ID where  */
+#line 447 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DELETE);
       (yyval.sql_node)->deletion.relation_name = (yyvsp[-1].string);
@@ -1999,11 +2059,11 @@ yyreduce:
       }
       free((yyvsp[-1].string));
     }
-#line 2003 "yacc_sql.cpp"
+#line 2063 "yacc_sql.cpp"
     break;
 
-  case 51: /* update_stmt: UPDATE ID SET ID EQ value where  */
-#line 414 "yacc_sql.y"
+  case 55: /* update_stmt: UPDATE ID SET ID EQ value where  */
+#line 459 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_UPDATE);
       (yyval.sql_node)->update.relation_name = (yyvsp[-5].string);
@@ -2016,11 +2076,11 @@ yyreduce:
       free((yyvsp[-5].string));
       free((yyvsp[-3].string));
     }
-#line 2020 "yacc_sql.cpp"
+#line 2080 "yacc_sql.cpp"
     break;
 
-  case 52: /* select_stmt: SELECT select_attr FROM ID rel_list where  */
-#line 429 "yacc_sql.y"
+  case 56: /* select_stmt: SELECT select_attr FROM ID rel_list where  */
+#line 474 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SELECT);
       if ((yyvsp[-4].rel_attr_list) != nullptr) {
@@ -2040,31 +2100,31 @@ yyreduce:
       }
       free((yyvsp[-2].string));
     }
-#line 2044 "yacc_sql.cpp"
+#line 2104 "yacc_sql.cpp"
     break;
 
-  case 53: /* calc_stmt: CALC expression_list  */
-#line 451 "yacc_sql.y"
+  case 57: /* calc_stmt: CALC expression_list  */
+#line 496 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_CALC);
       std::reverse((yyvsp[0].expression_list)->begin(), (yyvsp[0].expression_list)->end());
       (yyval.sql_node)->calc.expressions.swap(*(yyvsp[0].expression_list));
       delete (yyvsp[0].expression_list);
     }
-#line 2055 "yacc_sql.cpp"
+#line 2115 "yacc_sql.cpp"
     break;
 
-  case 54: /* expression_list: expression  */
-#line 461 "yacc_sql.y"
+  case 58: /* expression_list: expression  */
+#line 506 "yacc_sql.y"
     {
       (yyval.expression_list) = new std::vector<Expression*>;
       (yyval.expression_list)->emplace_back((yyvsp[0].expression));
     }
-#line 2064 "yacc_sql.cpp"
+#line 2124 "yacc_sql.cpp"
     break;
 
-  case 55: /* expression_list: expression COMMA expression_list  */
-#line 466 "yacc_sql.y"
+  case 59: /* expression_list: expression COMMA expression_list  */
+#line 511 "yacc_sql.y"
     {
       if ((yyvsp[0].expression_list) != nullptr) {
         (yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2073,70 +2133,70 @@ yyreduce:
       }
       (yyval.expression_list)->emplace_back((yyvsp[-2].expression));
     }
-#line 2077 "yacc_sql.cpp"
+#line 2137 "yacc_sql.cpp"
     break;
 
-  case 56: /* expression: expression '+' expression  */
-#line 476 "yacc_sql.y"
+  case 60: /* expression: expression '+' expression  */
+#line 521 "yacc_sql.y"
                               {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::ADD, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2085 "yacc_sql.cpp"
+#line 2145 "yacc_sql.cpp"
     break;
 
-  case 57: /* expression: expression '-' expression  */
-#line 479 "yacc_sql.y"
+  case 61: /* expression: expression '-' expression  */
+#line 524 "yacc_sql.y"
                                 {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::SUB, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2093 "yacc_sql.cpp"
+#line 2153 "yacc_sql.cpp"
     break;
 
-  case 58: /* expression: expression '*' expression  */
-#line 482 "yacc_sql.y"
+  case 62: /* expression: expression '*' expression  */
+#line 527 "yacc_sql.y"
                                 {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::MUL, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2101 "yacc_sql.cpp"
+#line 2161 "yacc_sql.cpp"
     break;
 
-  case 59: /* expression: expression '/' expression  */
-#line 485 "yacc_sql.y"
+  case 63: /* expression: expression '/' expression  */
+#line 530 "yacc_sql.y"
                                 {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::DIV, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2109 "yacc_sql.cpp"
+#line 2169 "yacc_sql.cpp"
     break;
 
-  case 60: /* expression: LBRACE expression RBRACE  */
-#line 488 "yacc_sql.y"
+  case 64: /* expression: LBRACE expression RBRACE  */
+#line 533 "yacc_sql.y"
                                {
       (yyval.expression) = (yyvsp[-1].expression);
       (yyval.expression)->set_name(token_name(sql_string, &(yyloc)));
     }
-#line 2118 "yacc_sql.cpp"
+#line 2178 "yacc_sql.cpp"
     break;
 
-  case 61: /* expression: '-' expression  */
-#line 492 "yacc_sql.y"
+  case 65: /* expression: '-' expression  */
+#line 537 "yacc_sql.y"
                                   {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::NEGATIVE, (yyvsp[0].expression), nullptr, sql_string, &(yyloc));
     }
-#line 2126 "yacc_sql.cpp"
+#line 2186 "yacc_sql.cpp"
     break;
 
-  case 62: /* expression: value  */
-#line 495 "yacc_sql.y"
+  case 66: /* expression: value  */
+#line 540 "yacc_sql.y"
             {
       (yyval.expression) = new ValueExpr(*(yyvsp[0].value));
       (yyval.expression)->set_name(token_name(sql_string, &(yyloc)));
       delete (yyvsp[0].value);
     }
-#line 2136 "yacc_sql.cpp"
+#line 2196 "yacc_sql.cpp"
     break;
 
-  case 63: /* select_attr: '*'  */
-#line 503 "yacc_sql.y"
+  case 67: /* select_attr: '*'  */
+#line 548 "yacc_sql.y"
         {
       (yyval.rel_attr_list) = new std::vector<RelAttrSqlNode>;
       RelAttrSqlNode attr;
@@ -2144,11 +2204,11 @@ yyreduce:
       attr.attribute_name = "*";
       (yyval.rel_attr_list)->emplace_back(attr);
     }
-#line 2148 "yacc_sql.cpp"
+#line 2208 "yacc_sql.cpp"
     break;
 
-  case 64: /* select_attr: rel_attr attr_list  */
-#line 510 "yacc_sql.y"
+  case 68: /* select_attr: rel_attr attr_list  */
+#line 555 "yacc_sql.y"
                          {
       if ((yyvsp[0].rel_attr_list) != nullptr) {
         (yyval.rel_attr_list) = (yyvsp[0].rel_attr_list);
@@ -2158,21 +2218,21 @@ yyreduce:
       (yyval.rel_attr_list)->emplace_back(*(yyvsp[-1].rel_attr));
       delete (yyvsp[-1].rel_attr);
     }
-#line 2162 "yacc_sql.cpp"
+#line 2222 "yacc_sql.cpp"
     break;
 
-  case 65: /* rel_attr: ID  */
-#line 522 "yacc_sql.y"
+  case 69: /* rel_attr: ID  */
+#line 567 "yacc_sql.y"
        {
       (yyval.rel_attr) = new RelAttrSqlNode;
       (yyval.rel_attr)->attribute_name = (yyvsp[0].string);
       free((yyvsp[0].string));
     }
-#line 2172 "yacc_sql.cpp"
+#line 2232 "yacc_sql.cpp"
     break;
 
-  case 66: /* rel_attr: ID DOT ID  */
-#line 527 "yacc_sql.y"
+  case 70: /* rel_attr: ID DOT ID  */
+#line 572 "yacc_sql.y"
                 {
       (yyval.rel_attr) = new RelAttrSqlNode;
       (yyval.rel_attr)->relation_name  = (yyvsp[-2].string);
@@ -2180,19 +2240,19 @@ yyreduce:
       free((yyvsp[-2].string));
       free((yyvsp[0].string));
     }
-#line 2184 "yacc_sql.cpp"
+#line 2244 "yacc_sql.cpp"
     break;
 
-  case 67: /* attr_list: %empty  */
-#line 538 "yacc_sql.y"
+  case 71: /* attr_list: %empty  */
+#line 583 "yacc_sql.y"
     {
       (yyval.rel_attr_list) = nullptr;
     }
-#line 2192 "yacc_sql.cpp"
+#line 2252 "yacc_sql.cpp"
     break;
 
-  case 68: /* attr_list: COMMA rel_attr attr_list  */
-#line 541 "yacc_sql.y"
+  case 72: /* attr_list: COMMA rel_attr attr_list  */
+#line 586 "yacc_sql.y"
                                {
       if ((yyvsp[0].rel_attr_list) != nullptr) {
         (yyval.rel_attr_list) = (yyvsp[0].rel_attr_list);
@@ -2203,19 +2263,19 @@ yyreduce:
       (yyval.rel_attr_list)->emplace_back(*(yyvsp[-1].rel_attr));
       delete (yyvsp[-1].rel_attr);
     }
-#line 2207 "yacc_sql.cpp"
+#line 2267 "yacc_sql.cpp"
     break;
 
-  case 69: /* rel_list: %empty  */
-#line 555 "yacc_sql.y"
+  case 73: /* rel_list: %empty  */
+#line 600 "yacc_sql.y"
     {
       (yyval.relation_list) = nullptr;
     }
-#line 2215 "yacc_sql.cpp"
+#line 2275 "yacc_sql.cpp"
     break;
 
-  case 70: /* rel_list: COMMA ID rel_list  */
-#line 558 "yacc_sql.y"
+  case 74: /* rel_list: COMMA ID rel_list  */
+#line 603 "yacc_sql.y"
                         {
       if ((yyvsp[0].relation_list) != nullptr) {
         (yyval.relation_list) = (yyvsp[0].relation_list);
@@ -2226,55 +2286,55 @@ yyreduce:
       (yyval.relation_list)->push_back((yyvsp[-1].string));
       free((yyvsp[-1].string));
     }
-#line 2230 "yacc_sql.cpp"
+#line 2290 "yacc_sql.cpp"
     break;
 
-  case 71: /* where: %empty  */
-#line 571 "yacc_sql.y"
+  case 75: /* where: %empty  */
+#line 616 "yacc_sql.y"
     {
       (yyval.condition_list) = nullptr;
     }
-#line 2238 "yacc_sql.cpp"
+#line 2298 "yacc_sql.cpp"
     break;
 
-  case 72: /* where: WHERE condition_list  */
-#line 574 "yacc_sql.y"
+  case 76: /* where: WHERE condition_list  */
+#line 619 "yacc_sql.y"
                            {
       (yyval.condition_list) = (yyvsp[0].condition_list);  
     }
-#line 2246 "yacc_sql.cpp"
+#line 2306 "yacc_sql.cpp"
     break;
 
-  case 73: /* condition_list: %empty  */
-#line 580 "yacc_sql.y"
+  case 77: /* condition_list: %empty  */
+#line 625 "yacc_sql.y"
     {
       (yyval.condition_list) = nullptr;
     }
-#line 2254 "yacc_sql.cpp"
+#line 2314 "yacc_sql.cpp"
     break;
 
-  case 74: /* condition_list: condition  */
-#line 583 "yacc_sql.y"
+  case 78: /* condition_list: condition  */
+#line 628 "yacc_sql.y"
                 {
       (yyval.condition_list) = new std::vector<ConditionSqlNode>;
       (yyval.condition_list)->emplace_back(*(yyvsp[0].condition));
       delete (yyvsp[0].condition);
     }
-#line 2264 "yacc_sql.cpp"
+#line 2324 "yacc_sql.cpp"
     break;
 
-  case 75: /* condition_list: condition AND condition_list  */
-#line 588 "yacc_sql.y"
+  case 79: /* condition_list: condition AND condition_list  */
+#line 633 "yacc_sql.y"
                                    {
       (yyval.condition_list) = (yyvsp[0].condition_list);
       (yyval.condition_list)->emplace_back(*(yyvsp[-2].condition));
       delete (yyvsp[-2].condition);
     }
-#line 2274 "yacc_sql.cpp"
+#line 2334 "yacc_sql.cpp"
     break;
 
-  case 76: /* condition: rel_attr comp_op value  */
-#line 596 "yacc_sql.y"
+  case 80: /* condition: rel_attr comp_op value  */
+#line 641 "yacc_sql.y"
     {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_is_attr = 1;
@@ -2286,11 +2346,11 @@ yyreduce:
       delete (yyvsp[-2].rel_attr);
       delete (yyvsp[0].value);
     }
-#line 2290 "yacc_sql.cpp"
+#line 2350 "yacc_sql.cpp"
     break;
 
-  case 77: /* condition: value comp_op value  */
-#line 608 "yacc_sql.y"
+  case 81: /* condition: value comp_op value  */
+#line 653 "yacc_sql.y"
     {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_is_attr = 0;
@@ -2302,11 +2362,11 @@ yyreduce:
       delete (yyvsp[-2].value);
       delete (yyvsp[0].value);
     }
-#line 2306 "yacc_sql.cpp"
+#line 2366 "yacc_sql.cpp"
     break;
 
-  case 78: /* condition: rel_attr comp_op rel_attr  */
-#line 620 "yacc_sql.y"
+  case 82: /* condition: rel_attr comp_op rel_attr  */
+#line 665 "yacc_sql.y"
     {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_is_attr = 1;
@@ -2318,11 +2378,11 @@ yyreduce:
       delete (yyvsp[-2].rel_attr);
       delete (yyvsp[0].rel_attr);
     }
-#line 2322 "yacc_sql.cpp"
+#line 2382 "yacc_sql.cpp"
     break;
 
-  case 79: /* condition: value comp_op rel_attr  */
-#line 632 "yacc_sql.y"
+  case 83: /* condition: value comp_op rel_attr  */
+#line 677 "yacc_sql.y"
     {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_is_attr = 0;
@@ -2334,47 +2394,47 @@ yyreduce:
       delete (yyvsp[-2].value);
       delete (yyvsp[0].rel_attr);
     }
-#line 2338 "yacc_sql.cpp"
+#line 2398 "yacc_sql.cpp"
     break;
 
-  case 80: /* comp_op: EQ  */
-#line 646 "yacc_sql.y"
+  case 84: /* comp_op: EQ  */
+#line 691 "yacc_sql.y"
          { (yyval.comp) = EQUAL_TO; }
-#line 2344 "yacc_sql.cpp"
+#line 2404 "yacc_sql.cpp"
     break;
 
-  case 81: /* comp_op: LT  */
-#line 647 "yacc_sql.y"
+  case 85: /* comp_op: LT  */
+#line 692 "yacc_sql.y"
          { (yyval.comp) = LESS_THAN; }
-#line 2350 "yacc_sql.cpp"
+#line 2410 "yacc_sql.cpp"
     break;
 
-  case 82: /* comp_op: GT  */
-#line 648 "yacc_sql.y"
+  case 86: /* comp_op: GT  */
+#line 693 "yacc_sql.y"
          { (yyval.comp) = GREAT_THAN; }
-#line 2356 "yacc_sql.cpp"
+#line 2416 "yacc_sql.cpp"
     break;
 
-  case 83: /* comp_op: LE  */
-#line 649 "yacc_sql.y"
+  case 87: /* comp_op: LE  */
+#line 694 "yacc_sql.y"
          { (yyval.comp) = LESS_EQUAL; }
-#line 2362 "yacc_sql.cpp"
+#line 2422 "yacc_sql.cpp"
     break;
 
-  case 84: /* comp_op: GE  */
-#line 650 "yacc_sql.y"
+  case 88: /* comp_op: GE  */
+#line 695 "yacc_sql.y"
          { (yyval.comp) = GREAT_EQUAL; }
-#line 2368 "yacc_sql.cpp"
+#line 2428 "yacc_sql.cpp"
     break;
 
-  case 85: /* comp_op: NE  */
-#line 651 "yacc_sql.y"
+  case 89: /* comp_op: NE  */
+#line 696 "yacc_sql.y"
          { (yyval.comp) = NOT_EQUAL; }
-#line 2374 "yacc_sql.cpp"
+#line 2434 "yacc_sql.cpp"
     break;
 
-  case 86: /* load_data_stmt: LOAD DATA INFILE SSS INTO TABLE ID  */
-#line 656 "yacc_sql.y"
+  case 90: /* load_data_stmt: LOAD DATA INFILE SSS INTO TABLE ID  */
+#line 701 "yacc_sql.y"
     {
       char *tmp_file_name = common::substr((yyvsp[-3].string), 1, strlen((yyvsp[-3].string)) - 2);
       
@@ -2384,20 +2444,20 @@ yyreduce:
       free((yyvsp[0].string));
       free(tmp_file_name);
     }
-#line 2388 "yacc_sql.cpp"
+#line 2448 "yacc_sql.cpp"
     break;
 
-  case 87: /* explain_stmt: EXPLAIN command_wrapper  */
-#line 669 "yacc_sql.y"
+  case 91: /* explain_stmt: EXPLAIN command_wrapper  */
+#line 714 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_EXPLAIN);
       (yyval.sql_node)->explain.sql_node = std::unique_ptr<ParsedSqlNode>((yyvsp[0].sql_node));
     }
-#line 2397 "yacc_sql.cpp"
+#line 2457 "yacc_sql.cpp"
     break;
 
-  case 88: /* set_variable_stmt: SET ID EQ value  */
-#line 677 "yacc_sql.y"
+  case 92: /* set_variable_stmt: SET ID EQ value  */
+#line 722 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SET_VARIABLE);
       (yyval.sql_node)->set_variable.name  = (yyvsp[-2].string);
@@ -2405,11 +2465,11 @@ yyreduce:
       free((yyvsp[-2].string));
       delete (yyvsp[0].value);
     }
-#line 2409 "yacc_sql.cpp"
+#line 2469 "yacc_sql.cpp"
     break;
 
-  case 89: /* alter_stmt: ALTER TABLE ID ADD COLUMN LBRACE attr_def attr_def_list RBRACE  */
-#line 688 "yacc_sql.y"
+  case 93: /* alter_stmt: ALTER TABLE ID ADD COLUMN LBRACE attr_def attr_def_list RBRACE  */
+#line 733 "yacc_sql.y"
   {
     (yyval.sql_node) = new ParsedSqlNode(SCF_ALTER);
     AlterSqlNode &alter_sql_node = (yyval.sql_node) -> alter;
@@ -2431,11 +2491,26 @@ yyreduce:
     delete (yyvsp[-2].attr_info);
     free((yyvsp[-6].string));
   }
-#line 2435 "yacc_sql.cpp"
+#line 2495 "yacc_sql.cpp"
+    break;
+
+  case 94: /* alter_stmt: ALTER TABLE ID COMPRESS  */
+#line 755 "yacc_sql.y"
+  {
+    (yyval.sql_node) = new ParsedSqlNode(SCF_ALTER);
+    AlterSqlNode &alter_sql_node = (yyval.sql_node) -> alter;
+
+    alter_sql_node.relation_name = (yyvsp[-1].string);
+    alter_sql_node.operation     = "COMPRESS";
+    alter_sql_node.object_       = "TABLE";
+
+    free((yyvsp[-1].string));
+  }
+#line 2510 "yacc_sql.cpp"
     break;
 
 
-#line 2439 "yacc_sql.cpp"
+#line 2514 "yacc_sql.cpp"
 
       default: break;
     }
@@ -2664,7 +2739,7 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 714 "yacc_sql.y"
+#line 770 "yacc_sql.y"
 
 //_____________________________________________________________________
 extern void scan_string(const char *str, yyscan_t scanner);
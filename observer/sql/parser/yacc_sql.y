@@ -94,6 +94,9 @@ ArithmeticExpr *create_arithmetic_expression(ArithmeticExpr::Type type,
         ALTER
         ADD
         COLUMN
+        UNIQUE
+        COMPRESS
+        STORAGE_FORMAT
         EQ
         LT
         GT
@@ -116,6 +119,7 @@ ArithmeticExpr *create_arithmetic_expression(ArithmeticExpr::Type type,
   std::vector<ConditionSqlNode> *   condition_list;
   std::vector<RelAttrSqlNode> *     rel_attr_list;
   std::vector<std::string> *        relation_list;
+  std::vector<TableOptionSqlNode> * table_options;
   char *                            string;
   int                               number;
   float                             floats;
@@ -132,10 +136,12 @@ ArithmeticExpr *create_arithmetic_expression(ArithmeticExpr::Type type,
 %type <condition>           condition
 %type <value>               value
 %type <number>              number
+%type <number>              opt_unique
 %type <comp>                comp_op
 %type <rel_attr>            rel_attr
 %type <attr_infos>          attr_def_list
 %type <attr_info>           attr_def
+%type <table_options>       table_option_list
 %type <value_list>          value_list
 %type <condition_list>      where
 %type <condition_list>      condition_list
@@ -264,16 +270,33 @@ desc_table_stmt:
     ;
 
 create_index_stmt:    /*create index 语句的语法解析树*/
-    CREATE INDEX ID ON ID LBRACE ID RBRACE
+    CREATE opt_unique INDEX ID ON ID LBRACE ID rel_list RBRACE
     {
       $$ = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = $$->create_index;
-      create_index.index_name = $3;
-      create_index.relation_name = $5;
-      create_index.attribute_name = $7;
-      free($3);
-      free($5);
-      free($7);
+      create_index.index_name = $4;
+      create_index.relation_name = $6;
+      create_index.unique = ($2 != 0);
+      if ($9 != nullptr) {
+        create_index.attribute_names.swap(*$9);
+        delete $9;
+      }
+      create_index.attribute_names.push_back($8);
+      std::reverse(create_index.attribute_names.begin(), create_index.attribute_names.end());
+      free($4);
+      free($6);
+      free($8);
+    }
+    ;
+
+opt_unique:
+    /* empty */
+    {
+      $$ = 0;
+    }
+    | UNIQUE
+    {
+      $$ = 1;
     }
     ;
 
@@ -288,7 +311,7 @@ drop_index_stmt:      /*drop index 语句的语法解析树*/
     }
     ;
 create_table_stmt:    /*create table 语句的语法解析树*/
-    CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE
+    CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE table_option_list
     {
       $$ = new ParsedSqlNode(SCF_CREATE_TABLE);
       CreateTableSqlNode &create_table = $$->create_table;
@@ -304,6 +327,28 @@ create_table_stmt:    /*create table 语句的语法解析树*/
       create_table.attr_infos.emplace_back(*$5);
       std::reverse(create_table.attr_infos.begin(), create_table.attr_infos.end());
       delete $5;
+
+      if ($8 != nullptr) {
+        create_table.options.swap(*$8);
+        std::reverse(create_table.options.begin(), create_table.options.end());
+        delete $8;
+      }
+    }
+    ;
+table_option_list:
+    /* empty */
+    {
+      $$ = nullptr;
+    }
+    | STORAGE_FORMAT EQ ID table_option_list
+    {
+      if ($4 != nullptr) {
+        $$ = $4;
+      } else {
+        $$ = new std::vector<TableOptionSqlNode>;
+      }
+      $$->emplace_back(TableOptionSqlNode{"storage_format", $3});
+      free($3);
     }
     ;
 attr_def_list:
@@ -706,6 +751,17 @@ alter_stmt:
     delete $7;
     free($3);
   } 
+  | ALTER TABLE ID COMPRESS
+  {
+    $$ = new ParsedSqlNode(SCF_ALTER);
+    AlterSqlNode &alter_sql_node = $$ -> alter;
+
+    alter_sql_node.relation_name = $3;
+    alter_sql_node.operation     = "COMPRESS";
+    alter_sql_node.object_       = "TABLE";
+
+    free($3);
+  }
   ;
 
 opt_semicolon: /*empty*/
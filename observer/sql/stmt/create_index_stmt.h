@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "sql/stmt/stmt.h"
 
@@ -29,23 +30,26 @@ class FieldMeta;
 class CreateIndexStmt : public Stmt
 {
 public:
-  CreateIndexStmt(Table *table, const FieldMeta *field_meta, const std::string &index_name)
-      : table_(table), field_meta_(field_meta), index_name_(index_name)
+  CreateIndexStmt(
+      Table *table, const std::vector<const FieldMeta *> &field_metas, const std::string &index_name, bool unique)
+      : table_(table), field_metas_(field_metas), index_name_(index_name), unique_(unique)
   {}
 
   virtual ~CreateIndexStmt() = default;
 
   StmtType type() const override { return StmtType::CREATE_INDEX; }
 
-  Table             *table() const { return table_; }
-  const FieldMeta   *field_meta() const { return field_meta_; }
-  const std::string &index_name() const { return index_name_; }
+  Table                               *table() const { return table_; }
+  const std::vector<const FieldMeta *> &field_metas() const { return field_metas_; }
+  const std::string                   &index_name() const { return index_name_; }
+  bool                                 unique() const { return unique_; }
 
 public:
   static RC create(Db *db, const CreateIndexSqlNode &create_index, Stmt *&stmt);
 
 private:
-  Table           *table_      = nullptr;
-  const FieldMeta *field_meta_ = nullptr;
-  std::string      index_name_;
+  Table                         *table_ = nullptr;
+  std::vector<const FieldMeta *> field_metas_;  ///< 索引的字段，按照键值中的顺序
+  std::string                    index_name_;
+  bool                           unique_ = false;
 };
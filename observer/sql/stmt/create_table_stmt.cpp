@@ -12,13 +12,32 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2023/6/13.
 //
 
+#include <strings.h>
+
 #include "sql/stmt/create_table_stmt.h"
+#include "common/log/log.h"
 #include "event/sql_debug.h"
+#include "storage/table/table_meta.h"
 
 RC CreateTableStmt::create(Db *db, const CreateTableSqlNode &create_table, Stmt *&stmt)
 {
-  stmt = new CreateTableStmt(create_table.relation_name, create_table.attr_infos);
-  sql_debug("create table statement: table name %s", create_table.relation_name.c_str());
-  
+  StorageFormat storage_format = StorageFormat::FIXED_FORMAT;
+  for (const TableOptionSqlNode &option : create_table.options) {
+    if (0 != strcasecmp(option.name.c_str(), "storage_format")) {
+      LOG_WARN("unknown table option. table=%s, option=%s", create_table.relation_name.c_str(), option.name.c_str());
+      return RC::INVALID_ARGUMENT;
+    }
+
+    storage_format = storage_format_from_name(option.value.c_str());
+    if (storage_format == StorageFormat::UNKNOWN_FORMAT) {
+      LOG_WARN("unknown storage format. table=%s, format=%s", create_table.relation_name.c_str(), option.value.c_str());
+      return RC::INVALID_ARGUMENT;
+    }
+  }
+
+  stmt = new CreateTableStmt(create_table.relation_name, create_table.attr_infos, storage_format);
+  sql_debug("create table statement: table name %s, storage format %s",
+      create_table.relation_name.c_str(), storage_format_name(storage_format));
+
   return RC::SUCCESS;
 }
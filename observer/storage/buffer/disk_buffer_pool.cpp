@@ -11,19 +11,58 @@ See the Mulan PSL v2 for more details. */
 //
 // Created by Meiyi & Longda on 2021/4/13.
 //
+#include <algorithm>
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <limits>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
 #include "common/io/io.h"
 #include "common/lang/mutex.h"
 #include "common/log/log.h"
 #include "common/math/crc.h"
+#include "common/thread/thread_util.h"
 #include "storage/buffer/disk_buffer_pool.h"
+#include "storage/io/io_backend.h"
 
 using namespace common;
 using namespace std;
 
-static const int MEM_POOL_ITEM_NUM = 20;
+static const int DEFAULT_FRAME_NUM   = 20 * 128;  ///< 没有配置内存大小时使用的页帧个数
+static const int MAX_PAGES_PER_WRITE = 256;       ///< 批量写回时一个写请求最多合并多少个页面
+
+/**
+ * @brief 以读写方式打开数据文件
+ * @details 开启 direct_io 时使用 O_DIRECT 打开，mac 上没有 O_DIRECT，使用 F_NOCACHE。
+ * 有些文件系统(比如 tmpfs)不支持 O_DIRECT，这时退化成普通的方式打开
+ */
+static int open_data_file(const char *file_name, bool direct_io)
+{
+#if defined(O_DIRECT)
+  if (direct_io) {
+    int fd = ::open(file_name, O_RDWR | O_DIRECT);
+    if (fd >= 0 || errno != EINVAL) {
+      return fd;
+    }
+    LOG_WARN("file system does not support O_DIRECT, open file without it. file=%s", file_name);
+  }
+  return ::open(file_name, O_RDWR);
+#elif defined(F_NOCACHE)
+  int fd = ::open(file_name, O_RDWR);
+  if (fd >= 0 && direct_io && fcntl(fd, F_NOCACHE, 1) != 0) {
+    LOG_WARN("failed to disable page cache of file. file=%s, error=%s", file_name, strerror(errno));
+  }
+  return fd;
+#else
+  if (direct_io) {
+    LOG_WARN("direct io is not supported on this platform. file=%s", file_name);
+  }
+  return ::open(file_name, O_RDWR);
+#endif
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -36,30 +75,124 @@ string BPFileHeader::to_string() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
-BPFrameManager::BPFrameManager(const char *name) : allocator_(name) {}
+BPFrameManager::BPFrameManager(const char *name) : tag_(name) {}
 
-RC BPFrameManager::init(int pool_num)
+RC BPFrameManager::init(int frame_num, const BufferPoolParam &param)
 {
-  int ret = allocator_.init(false, pool_num);
-  if (ret == 0) {
-    return RC::SUCCESS;
+  if (!shards_.empty()) {
+    LOG_WARN("frame manager has been initialized. tag=%s", tag_.c_str());
+    return RC::INTERNAL;
+  }
+
+  if (frame_num <= 0) {
+    frame_num = 1;
+  }
+
+  int shard_num = param.frame_shard_num;
+  if (shard_num <= 0) {
+    shard_num = 1;
+  }
+
+  // 每个分片至少需要一个页帧，否则这个分片上永远也分配不出页帧
+  if (shard_num > frame_num) {
+    shard_num = frame_num;
   }
-  return RC::NOMEM;
+
+  std::vector<std::unique_ptr<FrameShard>> shards;
+  shards.reserve(shard_num);
+  for (int i = 0; i < shard_num; i++) {
+    std::unique_ptr<FrameShard> shard = std::make_unique<FrameShard>();
+
+    shard->replacer.reset(FrameReplacer::create(param.replacer.c_str(), param.lru_k));
+    if (!shard->replacer) {
+      LOG_ERROR("failed to create frame replacer. tag=%s, replacer=%s", tag_.c_str(), param.replacer.c_str());
+      return RC::INVALID_ARGUMENT;
+    }
+    shards.push_back(std::move(shard));
+  }
+
+  RC rc = arena_.init(frame_num, param.huge_page.c_str(), param.numa_policy.c_str(), param.numa_nodes.c_str());
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to init frame arena. tag=%s, frame num=%d, rc=%s", tag_.c_str(), frame_num, strrc(rc));
+    return rc;
+  }
+
+  // 每个分片分到连续的一段页帧
+  int frame_index = 0;
+  for (int i = 0; i < shard_num; i++) {
+    FrameShard &shard = *shards[i];
+    shard.total_num   = frame_num / shard_num + (i < frame_num % shard_num ? 1 : 0);
+    shard.free_frames.reserve(shard.total_num);
+    // 倒序放入，分配时从尾部取，先分配地址小的页帧
+    for (int j = shard.total_num - 1; j >= 0; j--) {
+      shard.free_frames.push_back(arena_.frame(frame_index + j));
+    }
+    frame_index += shard.total_num;
+  }
+
+  shards_.swap(shards);
+  replacer_name_ = shards_.front()->replacer->name();
+  LOG_INFO("frame manager init done. tag=%s, frame num=%d, shard num=%d, replacer=%s, huge page=%s",
+           tag_.c_str(), frame_num, shard_num, replacer_name_.c_str(), arena_.huge_page());
+  return RC::SUCCESS;
+}
+
+Frame *BPFrameManager::alloc_free_frame(FrameShard &shard)
+{
+  if (shard.free_frames.empty()) {
+    return nullptr;
+  }
+
+  Frame *frame = shard.free_frames.back();
+  shard.free_frames.pop_back();
+  frame->reinit();
+  return frame;
+}
+
+void BPFrameManager::release_frame(FrameShard &shard, Frame *frame)
+{
+  frame->reset();
+  shard.free_frames.push_back(frame);
 }
 
 RC BPFrameManager::cleanup()
 {
-  if (frames_.count() > 0) {
+  if (frame_num() > 0) {
     return RC::INTERNAL;
   }
 
-  frames_.destroy();
+  for (std::unique_ptr<FrameShard> &shard : shards_) {
+    shard->frames.clear();
+  }
   return RC::SUCCESS;
 }
 
-int BPFrameManager::purge_frames(int count, std::function<RC(Frame *frame)> purger)
+BPFrameManager::FrameShard &BPFrameManager::shard_of(const FrameId &frame_id)
 {
-  std::lock_guard<std::mutex> lock_guard(lock_);
+  return *shards_[frame_id.hash() % shards_.size()];
+}
+
+size_t BPFrameManager::frame_num() const
+{
+  size_t num = 0;
+  for (const std::unique_ptr<FrameShard> &shard : shards_) {
+    num += shard->frames.size();
+  }
+  return num;
+}
+
+size_t BPFrameManager::total_frame_num() const
+{
+  size_t num = 0;
+  for (const std::unique_ptr<FrameShard> &shard : shards_) {
+    num += shard->total_num;
+  }
+  return num;
+}
+
+int BPFrameManager::purge_frames(int file_desc, PageNum page_num, int count, std::function<RC(Frame *frame)> purger)
+{
+  FrameShard &shard = shard_of(FrameId(file_desc, page_num));
 
   std::vector<Frame *> frames_can_purge;
   if (count <= 0) {
@@ -67,8 +200,9 @@ int BPFrameManager::purge_frames(int count, std::function<RC(Frame *frame)> purg
   }
   frames_can_purge.reserve(count);
 
-  auto purge_finder = [&frames_can_purge, count](const FrameId &frame_id, Frame *const frame) {
-    if (frame->can_purge()) {
+  bool clean_only   = true;
+  auto purge_finder = [&frames_can_purge, &clean_only, count](Frame *frame) {
+    if (frame->can_purge() && (!clean_only || !frame->dirty())) {
       frame->pin();
       frames_can_purge.push_back(frame);
       if (frames_can_purge.size() >= static_cast<size_t>(count)) {
@@ -78,134 +212,558 @@ int BPFrameManager::purge_frames(int count, std::function<RC(Frame *frame)> purg
     return true;  // true continue to look up
   };
 
-  frames_.foreach_reverse(purge_finder);
+  {
+    std::lock_guard<std::mutex> lock_guard(shard.lock);
+
+    // 先找干净的页面，淘汰它们不需要刷盘。干净的页面不够时再找脏页。
+    // 找干净页面的这一遍可能什么都找不到，只是看一看，不能修改淘汰策略的状态(比如清除时钟策略的访问标记)
+    shard.replacer->peek_victims(purge_finder);
+    if (frames_can_purge.size() < static_cast<size_t>(count)) {
+      clean_only = false;
+      shard.replacer->foreach_victim(purge_finder);
+    }
+  }
   LOG_INFO("purge frames find %ld pages total", frames_can_purge.size());
 
-  /// 当前还在frameManager的锁内，而 purger 是一个非常耗时的操作
-  /// 他需要把脏页数据刷新到磁盘上去，所以这里会极大地降低并发度
-  int freed_count = 0;
+  /// purger 需要把脏页数据刷新到磁盘上去，是一个非常耗时的操作，所以不能持有分片的锁。
+  /// 挑选出来的页面都已经被 pin 住了，其它线程不会再淘汰它们
+  std::vector<Frame *> frames_purged;
+  frames_purged.reserve(frames_can_purge.size());
   for (Frame *frame : frames_can_purge) {
     RC rc = purger(frame);
     if (RC::SUCCESS == rc) {
-      free_internal(frame->frame_id(), frame);
-      freed_count++;
+      frames_purged.push_back(frame);
     } else {
       frame->unpin();
       LOG_WARN("failed to purge frame. frame_id=%s, rc=%s", 
                to_string(frame->frame_id()).c_str(), strrc(rc));
     }
   }
+
+  int freed_count = 0;
+
+  std::lock_guard<std::mutex> lock_guard(shard.lock);
+  for (Frame *frame : frames_purged) {
+    // 刷盘的时候没有加锁，其它线程可能又访问甚至修改了这个页面，这时就不能再淘汰它了
+    if (frame->pin_count() != 1 || frame->dirty()) {
+      frame->unpin();
+      continue;
+    }
+
+    free_internal(shard, frame->frame_id(), frame);
+    freed_count++;
+  }
+  shard.stats.evict_count += freed_count;
   LOG_INFO("purge frame done. number=%d", freed_count);
   return freed_count;
 }
 
+std::vector<Frame *> BPFrameManager::find_frames_to_clean(int clean_num)
+{
+  std::vector<Frame *> frames_to_clean;
+  if (clean_num <= 0 || shards_.empty()) {
+    return frames_to_clean;
+  }
+
+  const int shard_clean_num = std::max(clean_num / static_cast<int>(shards_.size()), 1);
+  for (std::unique_ptr<FrameShard> &shard : shards_) {
+    std::lock_guard<std::mutex> lock_guard(shard->lock);
+
+    // 空闲的页帧可以直接分配，也算作干净的页帧
+    int  available_num = static_cast<int>(shard->free_frames.size());
+    auto dirty_finder  = [&frames_to_clean, &available_num, shard_clean_num](Frame *frame) {
+      if (available_num >= shard_clean_num) {
+        return false;
+      }
+
+      if (frame->can_purge()) {
+        if (frame->dirty()) {
+          frame->pin();
+          frames_to_clean.push_back(frame);
+        }
+        available_num++;
+      }
+      return true;
+    };
+
+    // 页面清理线程只是提前把快要淘汰的脏页写回去，不是真的淘汰页面，不能修改淘汰策略的状态
+    shard->replacer->peek_victims(dirty_finder);
+  }
+  return frames_to_clean;
+}
+
+std::vector<Frame *> BPFrameManager::find_frames_to_checkpoint()
+{
+  std::vector<Frame *> frames;
+  for (std::unique_ptr<FrameShard> &shard : shards_) {
+    std::lock_guard<std::mutex> lock_guard(shard->lock);
+    for (auto &[frame_id, frame] : shard->frames) {
+      if (frame->dirty() && frame->rec_lsn() != BP_INVALID_LSN) {
+        frame->pin();
+        frames.push_back(frame);
+      }
+    }
+  }
+  return frames;
+}
+
+LSN BPFrameManager::min_recovery_lsn(LSN dirty_lsn, LSN default_lsn)
+{
+  LSN min_lsn = default_lsn;
+  for (std::unique_ptr<FrameShard> &shard : shards_) {
+    std::lock_guard<std::mutex> lock_guard(shard->lock);
+    for (auto &[frame_id, frame] : shard->frames) {
+      if (!frame->dirty()) {
+        continue;
+      }
+
+      // 上一次检查点时这个页面还是干净的，修改它产生的日志的LSN不会小于 dirty_lsn
+      LSN rec_lsn = frame->rec_lsn();
+      if (rec_lsn == BP_INVALID_LSN) {
+        rec_lsn = dirty_lsn;
+        frame->set_rec_lsn(rec_lsn);
+      }
+      min_lsn = std::min(min_lsn, rec_lsn);
+    }
+  }
+  return min_lsn;
+}
+
 Frame *BPFrameManager::get(int file_desc, PageNum page_num)
 {
   FrameId                     frame_id(file_desc, page_num);
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  return get_internal(frame_id);
+  FrameShard                 &shard = shard_of(frame_id);
+  std::lock_guard<std::mutex> lock_guard(shard.lock);
+  return get_internal(shard, frame_id);
 }
 
-Frame *BPFrameManager::get_internal(const FrameId &frame_id)
+Frame *BPFrameManager::get_internal(FrameShard &shard, const FrameId &frame_id)
 {
-  Frame *frame = nullptr;
-  (void)frames_.get(frame_id, frame);
-  if (frame != nullptr) {
-    frame->pin();
+  auto iter = shard.frames.find(frame_id);
+  if (iter == shard.frames.end()) {
+    return nullptr;
+  }
+
+  Frame *frame = iter->second;
+  frame->pin();
+  shard.replacer->access(frame);
+  shard.stats.hit_count++;
+  if (frame->read_ahead()) {
+    frame->set_read_ahead(false);
+    shard.stats.read_ahead_used_count++;
   }
   return frame;
 }
 
+void BPFrameManager::put_internal(FrameShard &shard, const FrameId &frame_id, Frame *frame)
+{
+  shard.frames.emplace(frame_id, frame);
+  shard.replacer->insert(frame);
+  if (frame->read_ahead()) {
+    shard.stats.read_ahead_count++;
+  }
+}
+
 Frame *BPFrameManager::alloc(int file_desc, PageNum page_num)
 {
-  FrameId frame_id(file_desc, page_num);
+  FrameId     frame_id(file_desc, page_num);
+  FrameShard &shard = shard_of(frame_id);
 
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  Frame                      *frame = get_internal(frame_id);
+  std::lock_guard<std::mutex> lock_guard(shard.lock);
+  Frame                      *frame = get_internal(shard, frame_id);
   if (frame != nullptr) {
     return frame;
   }
 
-  frame = allocator_.alloc();
+  frame = alloc_free_frame(shard);
+  if (frame != nullptr) {
+    ASSERT(
+        frame->pin_count() == 0, "got an invalid frame that pin count is not 0. frame=%s", to_string(*frame).c_str());
+    frame->set_page_num(page_num);
+    frame->pin();
+    put_internal(shard, frame_id, frame);
+  }
+  return frame;
+}
+
+Frame *BPFrameManager::alloc_detached(int file_desc, PageNum page_num)
+{
+  FrameId     frame_id(file_desc, page_num);
+  FrameShard &shard = shard_of(frame_id);
+
+  std::lock_guard<std::mutex> lock_guard(shard.lock);
+  Frame                      *frame = alloc_free_frame(shard);
   if (frame != nullptr) {
     ASSERT(
         frame->pin_count() == 0, "got an invalid frame that pin count is not 0. frame=%s", to_string(*frame).c_str());
     frame->set_page_num(page_num);
     frame->pin();
-    frames_.put(frame_id, frame);
+    shard.stats.miss_count++;
   }
   return frame;
 }
 
+RC BPFrameManager::attach(int file_desc, PageNum page_num, Frame *frame)
+{
+  FrameId     frame_id(file_desc, page_num);
+  FrameShard &shard = shard_of(frame_id);
+
+  std::lock_guard<std::mutex> lock_guard(shard.lock);
+  auto                        iter = shard.frames.find(frame_id);
+  if (iter != shard.frames.end()) {
+    LOG_ERROR("frame has been attached. frame_id=%s, exist frame=%p, frame=%p",
+              to_string(frame_id).c_str(), iter->second, frame);
+    return RC::INTERNAL;
+  }
+
+  put_internal(shard, frame_id, frame);
+  return RC::SUCCESS;
+}
+
+RC BPFrameManager::free_detached(int file_desc, PageNum page_num, Frame *frame)
+{
+  FrameId     frame_id(file_desc, page_num);
+  FrameShard &shard = shard_of(frame_id);
+
+  std::lock_guard<std::mutex> lock_guard(shard.lock);
+  ASSERT(frame->pin_count() == 1, "failed to free detached frame. frameId=%s, frame=%p, pinCount=%d",
+         to_string(frame_id).c_str(), frame, frame->pin_count());
+
+  frame->unpin();
+  frame->set_read_ahead(false);
+  release_frame(shard, frame);
+  return RC::SUCCESS;
+}
+
+bool BPFrameManager::contains(int file_desc, PageNum page_num)
+{
+  FrameId                     frame_id(file_desc, page_num);
+  FrameShard                 &shard = shard_of(frame_id);
+  std::lock_guard<std::mutex> lock_guard(shard.lock);
+  return shard.frames.find(frame_id) != shard.frames.end();
+}
+
 RC BPFrameManager::free(int file_desc, PageNum page_num, Frame *frame)
 {
-  FrameId frame_id(file_desc, page_num);
+  FrameId     frame_id(file_desc, page_num);
+  FrameShard &shard = shard_of(frame_id);
 
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  return free_internal(frame_id, frame);
+  std::lock_guard<std::mutex> lock_guard(shard.lock);
+  return free_internal(shard, frame_id, frame);
 }
 
-RC BPFrameManager::free_internal(const FrameId &frame_id, Frame *frame)
+bool BPFrameManager::free_if_unpinned(int file_desc, PageNum page_num, Frame *frame)
 {
-  Frame                *frame_source = nullptr;
-  [[maybe_unused]] bool found        = frames_.get(frame_id, frame_source);
+  FrameId     frame_id(file_desc, page_num);
+  FrameShard &shard = shard_of(frame_id);
+
+  std::lock_guard<std::mutex> lock_guard(shard.lock);
+  if (frame->pin_count() > 1) {
+    frame->unpin();
+    return false;
+  }
+
+  free_internal(shard, frame_id, frame);
+  return true;
+}
+
+RC BPFrameManager::free_internal(FrameShard &shard, const FrameId &frame_id, Frame *frame)
+{
+  auto                  iter         = shard.frames.find(frame_id);
+  [[maybe_unused]] bool found        = iter != shard.frames.end();
+  Frame                *frame_source = found ? iter->second : nullptr;
   ASSERT(found && frame == frame_source && frame->pin_count() == 1,
       "failed to free frame. found=%d, frameId=%s, frame_source=%p, frame=%p, pinCount=%d, lbt=%s",
       found, to_string(frame_id).c_str(), frame_source, frame, frame->pin_count(), lbt());
 
+  if (frame->read_ahead()) {
+    frame->set_read_ahead(false);
+    shard.stats.read_ahead_wasted_count++;
+  }
+
   frame->unpin();
-  frames_.remove(frame_id);
-  allocator_.free(frame);
+  shard.frames.erase(iter);
+  shard.replacer->remove(frame);
+  release_frame(shard, frame);
   return RC::SUCCESS;
 }
 
 std::list<Frame *> BPFrameManager::find_list(int file_desc)
 {
-  std::lock_guard<std::mutex> lock_guard(lock_);
-
   std::list<Frame *> frames;
-  auto               fetcher = [&frames, file_desc](const FrameId &frame_id, Frame *const frame) -> bool {
-    if (file_desc == frame_id.file_desc()) {
-      frame->pin();
-      frames.push_back(frame);
+  for (std::unique_ptr<FrameShard> &shard : shards_) {
+    std::lock_guard<std::mutex> lock_guard(shard->lock);
+    for (auto &[frame_id, frame] : shard->frames) {
+      if (file_desc == frame_id.file_desc()) {
+        frame->pin();
+        frames.push_back(frame);
+      }
     }
-    return true;
-  };
-  frames_.foreach (fetcher);
+  }
   return frames;
 }
 
+FrameReplacerStats BPFrameManager::replacer_stats()
+{
+  FrameReplacerStats stats;
+  for (std::unique_ptr<FrameShard> &shard : shards_) {
+    std::lock_guard<std::mutex> lock_guard(shard->lock);
+    stats += shard->stats;
+  }
+  return stats;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 在位图的 [begin, end) 中查找第一个等于 value 的位，没有找到返回 -1
+ * @details 对齐到64位之后按字比较，整个字都不满足条件时直接跳过。位图的第 i 位在第 i/8 个字节的第 i%8 位，
+ * 在小端机器上正好就是按照8个字节读出来的字的第 i%64 位。
+ */
+static int find_bit(const char *bits, int begin, int end, bool value)
+{
+  int i = begin;
+  while (i < end) {
+    if (i % 64 == 0 && i + 64 <= end) {
+      uint64_t word = 0;
+      memcpy(&word, bits + i / 8, sizeof(word));  // 位图不一定按照8字节对齐
+      if (!value) {
+        word = ~word;
+      }
+      if (word == 0) {
+        i += 64;
+        continue;
+      }
+      return i + __builtin_ctzll(word);
+    }
+
+    if (((bits[i / 8] >> (i % 8)) & 1) == static_cast<int>(value)) {
+      return i;
+    }
+    i++;
+  }
+  return -1;
+}
+
+void BPPageMap::reset(BPFileHeader *header)
+{
+  groups_.clear();
+
+  Group group;
+  group.bits     = header->bitmap;
+  group.free_num = group_size(0);
+  for (int i = find_bit(group.bits, 0, group_size(0), true); i != -1;
+       i     = find_bit(group.bits, i + 1, group_size(0), true)) {
+    group.free_num--;
+  }
+  groups_.push_back(group);
+}
+
+void BPPageMap::add_group(char *bits)
+{
+  const int group_index = group_num();
+
+  Group group;
+  group.bits     = bits;
+  group.free_num = group_size(group_index);
+  for (int i = find_bit(bits, 0, GROUP_PAGE_NUM, true); i != -1; i = find_bit(bits, i + 1, GROUP_PAGE_NUM, true)) {
+    group.free_num--;
+  }
+  groups_.push_back(group);
+}
+
+int BPPageMap::group_of(PageNum page_num)
+{
+  if (page_num < BPFileHeader::HEADER_MAP_PAGE_NUM) {
+    return 0;
+  }
+  return 1 + (page_num - BPFileHeader::HEADER_MAP_PAGE_NUM) / GROUP_PAGE_NUM;
+}
+
+PageNum BPPageMap::group_start(int group)
+{
+  if (group == 0) {
+    return 0;
+  }
+  return static_cast<PageNum>(
+      std::min<int64_t>(BPFileHeader::HEADER_MAP_PAGE_NUM + static_cast<int64_t>(group - 1) * GROUP_PAGE_NUM,
+          std::numeric_limits<PageNum>::max()));
+}
+
+int BPPageMap::group_size(int group) { return group == 0 ? BPFileHeader::HEADER_MAP_PAGE_NUM : GROUP_PAGE_NUM; }
+
+bool BPPageMap::get(PageNum page_num) const
+{
+  const int group = group_of(page_num);
+  if (group >= group_num()) {
+    return false;
+  }
+
+  const int index = page_num - group_start(group);
+  return (groups_[group].bits[index / 8] & (1 << (index % 8))) != 0;
+}
+
+void BPPageMap::set(PageNum page_num)
+{
+  const int group = group_of(page_num);
+  ASSERT(group < group_num(), "the map page of page is not loaded. page_num=%d, group=%d", page_num, group);
+
+  const int index = page_num - group_start(group);
+  char     &byte  = groups_[group].bits[index / 8];
+  if ((byte & (1 << (index % 8))) == 0) {
+    byte |= (1 << (index % 8));
+    groups_[group].free_num--;
+  }
+}
+
+void BPPageMap::clear(PageNum page_num)
+{
+  const int group = group_of(page_num);
+  ASSERT(group < group_num(), "the map page of page is not loaded. page_num=%d, group=%d", page_num, group);
+
+  const int index = page_num - group_start(group);
+  char     &byte  = groups_[group].bits[index / 8];
+  if ((byte & (1 << (index % 8))) != 0) {
+    byte &= ~(1 << (index % 8));
+    groups_[group].free_num++;
+  }
+}
+
+PageNum BPPageMap::next_allocated(PageNum start, PageNum end) const
+{
+  for (int group = group_of(start); group < group_num(); group++) {
+    const PageNum begin_page = group_start(group);
+    if (begin_page >= end) {
+      break;
+    }
+
+    const int begin_index = std::max(start - begin_page, 0);
+    const int end_index   = static_cast<int>(std::min<int64_t>(end - begin_page, group_size(group)));
+    // 位图页自己的位总是 1，从下一个位置开始找
+    const int index = find_bit(groups_[group].bits, std::max(begin_index, group == 0 ? 0 : 1), end_index, true);
+    if (index != -1) {
+      return begin_page + index;
+    }
+  }
+  return -1;
+}
+
+PageNum BPPageMap::first_free(PageNum end) const
+{
+  for (int group = 0; group < group_num(); group++) {
+    const PageNum begin_page = group_start(group);
+    if (begin_page >= end) {
+      break;
+    }
+    if (groups_[group].free_num == 0) {
+      continue;
+    }
+
+    const int end_index = static_cast<int>(std::min<int64_t>(end - begin_page, group_size(group)));
+    const int index     = find_bit(groups_[group].bits, 0, end_index, false);
+    if (index != -1) {
+      return begin_page + index;
+    }
+  }
+  return -1;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 BufferPoolIterator::BufferPoolIterator() {}
 BufferPoolIterator::~BufferPoolIterator() {}
 RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
 {
-  bitmap_.init(bp.file_header_->bitmap, bp.file_header_->page_count);
+  {
+    // 复制一份位图页的指针，之后新增的位图页不会影响遍历
+    std::scoped_lock lock_guard(bp.lock_);
+    page_map_   = bp.page_map_;
+    page_count_ = bp.file_header_->page_count;
+  }
   if (start_page <= 0) {
     current_page_num_ = 0;
   } else {
     current_page_num_ = start_page;
   }
+
+  buffer_pool_        = &bp;
+  read_ahead_         = false;
+  sequential_count_   = 0;
+  read_ahead_window_  = MIN_READ_AHEAD_PAGES;
+  read_ahead_trigger_ = -1;
+  read_ahead_until_   = -1;
   return RC::SUCCESS;
 }
 
-bool BufferPoolIterator::has_next() { return bitmap_.next_setted_bit(current_page_num_ + 1) != -1; }
+bool BufferPoolIterator::has_next() { return page_map_.next_allocated(current_page_num_ + 1, page_count_) != -1; }
 
 PageNum BufferPoolIterator::next()
 {
-  PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
+  PageNum next_page = page_map_.next_allocated(current_page_num_ + 1, page_count_);
   if (next_page != -1) {
     current_page_num_ = next_page;
+    if (read_ahead_) {
+      read_ahead();
+    }
   }
   return next_page;
 }
 
 RC BufferPoolIterator::reset()
 {
-  current_page_num_ = 0;
+  current_page_num_   = 0;
+  sequential_count_   = 0;
+  read_ahead_trigger_ = -1;
+  read_ahead_until_   = -1;
   return RC::SUCCESS;
 }
 
+void BufferPoolIterator::read_ahead()
+{
+  if (buffer_pool_ == nullptr || !buffer_pool_->bp_manager_.read_ahead_enabled()) {
+    return;
+  }
+
+  // 偶尔访问一两个页面时不预读
+  if (++sequential_count_ < SEQUENTIAL_THRESHOLD) {
+    return;
+  }
+
+  // 当前的预读窗口还没有用到
+  if (current_page_num_ < read_ahead_trigger_) {
+    return;
+  }
+
+  std::vector<PageNum> page_nums;
+  page_nums.reserve(read_ahead_window_);
+
+  PageNum page_num = std::max(current_page_num_, read_ahead_until_);
+  while (static_cast<int>(page_nums.size()) < read_ahead_window_) {
+    page_num = page_map_.next_allocated(page_num + 1, page_count_);
+    if (page_num == -1) {
+      break;
+    }
+    page_nums.push_back(page_num);
+  }
+
+  if (page_nums.empty()) {
+    read_ahead_trigger_ = std::numeric_limits<PageNum>::max();  // 已经预读到最后一个页面了
+    return;
+  }
+
+  const int issued_num = buffer_pool_->read_ahead(page_nums);
+
+  // 大部分页面本来就在内存中，说明预读没有什么作用，缩小窗口；否则扩大窗口
+  const int max_window = std::max(buffer_pool_->bp_manager_.read_ahead_max_pages(), MIN_READ_AHEAD_PAGES);
+  if (issued_num * 2 < static_cast<int>(page_nums.size())) {
+    read_ahead_window_ = std::max(read_ahead_window_ / 2, MIN_READ_AHEAD_PAGES);
+  } else {
+    read_ahead_window_ = std::min(read_ahead_window_ * 2, max_window);
+  }
+
+  read_ahead_trigger_ = page_nums.front();
+  read_ahead_until_   = page_nums.back();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 DiskBufferPool::DiskBufferPool(BufferPoolManager &bp_manager, BPFrameManager &frame_manager)
     : bp_manager_(bp_manager), frame_manager_(frame_manager)
@@ -219,7 +777,7 @@ DiskBufferPool::~DiskBufferPool()
 
 RC DiskBufferPool::open_file(const char *file_name)
 {
-  int fd = open(file_name, O_RDWR);
+  int fd = open_data_file(file_name, bp_manager_.direct_io());
   if (fd < 0) {
     LOG_ERROR("Failed to open file %s, because %s.", file_name, strerror(errno));
     return RC::IOERR_ACCESS;
@@ -251,8 +809,31 @@ RC DiskBufferPool::open_file(const char *file_name)
 
   file_header_ = (BPFileHeader *)hdr_frame_->data();
 
-  LOG_INFO("Successfully open %s. file_desc=%d, hdr_frame=%p, file header=%s",
-           file_name, file_desc_, hdr_frame_, file_header_->to_string().c_str());
+  page_map_.reset(file_header_);
+  for (int group = 1; BPPageMap::group_start(group) < file_header_->page_count; group++) {
+    if (OB_FAIL(rc = load_map_page(BPPageMap::group_start(group)))) {
+      LOG_ERROR("Failed to load map page of %s. group=%d, rc=%s", file_name, group, strrc(rc));
+      for (Frame *map_frame : map_frames_) {
+        purge_frame(map_frame->page_num(), map_frame);
+      }
+      map_frames_.clear();
+      purge_frame(BP_HEADER_PAGE, hdr_frame_);
+      close(fd);
+      file_desc_ = -1;
+      return rc;
+    }
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == 0) {
+    file_pages_ = static_cast<PageNum>(st.st_size / BP_PAGE_SIZE);
+  } else {
+    LOG_WARN("failed to stat file. file=%s, error=%s", file_name, strerror(errno));
+    file_pages_ = file_header_->page_count;
+  }
+
+  LOG_INFO("Successfully open %s. file_desc=%d, hdr_frame=%p, file pages=%d, file header=%s",
+           file_name, file_desc_, hdr_frame_, file_pages_, file_header_->to_string().c_str());
   return RC::SUCCESS;
 }
 
@@ -263,16 +844,30 @@ RC DiskBufferPool::close_file()
     return rc;
   }
 
+  {
+    // 等待还在执行的预读任务结束，它们会访问当前文件
+    std::unique_lock<std::mutex> io_guard(io_lock_);
+    io_cond_.wait(io_guard, [this]() { return read_ahead_tasks_ == 0; });
+  }
+
   hdr_frame_->unpin();
+  for (Frame *map_frame : map_frames_) {
+    map_frame->unpin();
+  }
 
   // TODO: 理论上是在回放时回滚未提交事务，但目前没有undo log，因此不下刷数据page，只通过redo log回放
-  rc = purge_all_pages();
+  {
+    // 页面清理线程可能正 pin 着这个文件的页面，需要等它刷完，否则这些页面没办法释放
+    std::lock_guard<std::mutex> clean_guard(bp_manager_.page_clean_lock());
+    rc = purge_all_pages();
+  }
   if (rc != RC::SUCCESS) {
     LOG_ERROR("failed to close %s, due to failed to purge pages. rc=%s", file_name_.c_str(), strrc(rc));
     return rc;
   }
 
   disposed_pages_.clear();
+  map_frames_.clear();
 
   if (close(file_desc_) < 0) {
     LOG_ERROR("Failed to close fileId:%d, fileName:%s, error:%s", file_desc_, file_name_.c_str(), strerror(errno));
@@ -287,9 +882,9 @@ RC DiskBufferPool::close_file()
 
 RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
 {
-  RC rc  = RC::SUCCESS;
   *frame = nullptr;
 
+  // 页面已经在内存中时，只需要访问页帧管理器，不需要加文件锁
   Frame *used_match_frame = frame_manager_.get(file_desc_, page_num);
   if (used_match_frame != nullptr) {
     used_match_frame->access();
@@ -297,27 +892,209 @@ RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
     return RC::SUCCESS;
   }
 
-  std::scoped_lock lock_guard(lock_);  // 直接加了一把大锁，其实可以根据访问的页面来细化提高并行度
-
-  // Allocate one page and load the data into this page
-  Frame *allocated_frame = nullptr;
-  rc                     = allocate_frame(page_num, &allocated_frame);
-  if (rc != RC::SUCCESS) {
-    LOG_ERROR("Failed to alloc frame %s:%d, due to failed to alloc page.", file_name_.c_str(), page_num);
-    return rc;
+  // 页面不在内存中，需要从磁盘读取。同一个页面只允许一个线程读取，其它线程等待它读取完成
+  {
+    std::unique_lock<std::mutex> io_guard(io_lock_);
+    while (true) {
+      used_match_frame = frame_manager_.get(file_desc_, page_num);
+      if (used_match_frame != nullptr) {
+        used_match_frame->access();
+        *frame = used_match_frame;
+        return RC::SUCCESS;
+      }
+
+      if (loading_pages_.count(page_num) == 0) {
+        loading_pages_.insert(page_num);
+        break;
+      }
+
+      // 如果读取失败，页面不会出现在页帧表中，被唤醒后会自己重新读取
+      io_cond_.wait(io_guard);
+    }
+  }
+
+  RC rc = load_page_into_frame(page_num, frame);
+
+  {
+    std::lock_guard<std::mutex> io_guard(io_lock_);
+    loading_pages_.erase(page_num);
+  }
+  io_cond_.notify_all();
+  return rc;
+}
+
+RC DiskBufferPool::load_page_into_frame(PageNum page_num, Frame **frame)
+{
+  // 页帧加载完成之前不放到页帧表中，这样其它线程就不会拿到一个还没有数据的页帧
+  Frame *allocated_frame = nullptr;
+  RC     rc              = allocate_frame(page_num, &allocated_frame, false /*attach*/);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to alloc frame %s:%d, due to failed to alloc page.", file_name_.c_str(), page_num);
+    return rc;
+  }
+
+  allocated_frame->set_file_desc(file_desc_);
+  allocated_frame->access();
+
+  if ((rc = load_page(page_num, allocated_frame)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to load page %s:%d", file_name_.c_str(), page_num);
+    frame_manager_.free_detached(file_desc_, page_num, allocated_frame);
+    return rc;
+  }
+
+  rc = frame_manager_.attach(file_desc_, page_num, allocated_frame);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to attach frame %s:%d. rc=%s", file_name_.c_str(), page_num, strrc(rc));
+    frame_manager_.free_detached(file_desc_, page_num, allocated_frame);
+    return rc;
+  }
+
+  *frame = allocated_frame;
+  return RC::SUCCESS;
+}
+
+int DiskBufferPool::read_ahead(const std::vector<PageNum> &page_nums)
+{
+  if (page_nums.empty() || !bp_manager_.read_ahead_enabled()) {
+    return 0;
+  }
+
+  // 与 get_this_page 一样，先登记为正在读取，这样同一个页面只会被读取一次
+  std::vector<PageNum> pages_to_load;
+  {
+    std::lock_guard<std::mutex> io_guard(io_lock_);
+    if (file_desc_ < 0) {
+      return 0;
+    }
+
+    for (PageNum page_num : page_nums) {
+      if (loading_pages_.count(page_num) > 0 || frame_manager_.contains(file_desc_, page_num)) {
+        continue;
+      }
+
+      loading_pages_.insert(page_num);
+      pages_to_load.push_back(page_num);
+    }
+
+    if (pages_to_load.empty()) {
+      return 0;
+    }
+    read_ahead_tasks_++;
+  }
+
+  auto task = [this, pages_to_load]() { this->do_read_ahead(pages_to_load); };
+  if (!bp_manager_.execute_read_ahead(task)) {
+    {
+      std::lock_guard<std::mutex> io_guard(io_lock_);
+      for (PageNum page_num : pages_to_load) {
+        loading_pages_.erase(page_num);
+      }
+      read_ahead_tasks_--;
+    }
+    io_cond_.notify_all();
+    return 0;
+  }
+
+  LOG_DEBUG("read ahead pages. file=%s, first page=%d, page num=%ld",
+            file_name_.c_str(), pages_to_load.front(), pages_to_load.size());
+  return static_cast<int>(pages_to_load.size());
+}
+
+void DiskBufferPool::do_read_ahead(const std::vector<PageNum> &page_nums)
+{
+  // 预读是锦上添花的事情，分配不到页帧的时候不要像 allocate_frame 一样一直等待，直接放弃剩下的页面
+  std::vector<Frame *> frames;
+  frames.reserve(page_nums.size());
+  for (PageNum page_num : page_nums) {
+    Frame *frame = frame_manager_.alloc_detached(file_desc_, page_num);
+    if (frame == nullptr) {
+      auto purger = [this](Frame *frame) {
+        if (!frame->dirty()) {
+          return RC::SUCCESS;
+        }
+        return frame->file_desc() == file_desc_ ? this->flush_frames({frame}, false /*sync*/)
+                                                : bp_manager_.flush_frames({frame}, false /*sync*/);
+      };
+      (void)frame_manager_.purge_frames(file_desc_, page_num, 1 /*count*/, purger);
+      frame = frame_manager_.alloc_detached(file_desc_, page_num);
+    }
+
+    if (frame == nullptr) {
+      LOG_TRACE("no free frame for read ahead. file=%s, page num=%d", file_name_.c_str(), page_num);
+      break;
+    }
+
+    frame->set_file_desc(file_desc_);
+    frames.push_back(frame);
+  }
+
+  // 连续的页面用一次读操作读上来
+  size_t begin = 0;
+  while (begin < frames.size()) {
+    size_t end = begin + 1;
+    while (end < frames.size() && end - begin < static_cast<size_t>(IOV_MAX) &&
+           frames[end]->page_num() == frames[end - 1]->page_num() + 1) {
+      end++;
+    }
+
+    std::vector<Frame *> contiguous_frames(frames.begin() + begin, frames.begin() + end);
+    RC                   rc = load_contiguous_pages(contiguous_frames);
+    for (Frame *frame : contiguous_frames) {
+      if (OB_SUCC(rc)) {
+        frame->set_read_ahead(true);
+        frame->access();
+        rc = frame_manager_.attach(file_desc_, frame->page_num(), frame);
+        if (OB_SUCC(rc)) {
+          frame->unpin();
+          continue;
+        }
+        frame->set_read_ahead(false);
+      }
+      frame_manager_.free_detached(file_desc_, frame->page_num(), frame);
+    }
+    begin = end;
+  }
+
+  {
+    std::lock_guard<std::mutex> io_guard(io_lock_);
+    for (PageNum page_num : page_nums) {
+      loading_pages_.erase(page_num);
+    }
+    read_ahead_tasks_--;
+  }
+  io_cond_.notify_all();
+}
+
+RC DiskBufferPool::load_contiguous_pages(const std::vector<Frame *> &frames)
+{
+  if (frames.empty()) {
+    return RC::SUCCESS;
+  }
+
+  std::vector<struct iovec> iovs(frames.size());
+  for (size_t i = 0; i < frames.size(); i++) {
+    iovs[i].iov_base = &frames[i]->page();
+    iovs[i].iov_len  = BP_PAGE_SIZE;
   }
 
-  allocated_frame->set_file_desc(file_desc_);
-  // allocated_frame->pin(); // pined in manager::get
-  allocated_frame->access();
+  const PageNum first_page_num = frames.front()->page_num();
+  const int64_t offset         = ((int64_t)first_page_num) * BP_PAGE_SIZE;
 
-  if ((rc = load_page(page_num, allocated_frame)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to load page %s:%d", file_name_.c_str(), page_num);
-    purge_frame(page_num, allocated_frame);
-    return rc;
+  RC rc = IoBackend::instance().readv(file_desc_, iovs.data(), static_cast<int>(iovs.size()), offset);
+  if (OB_SUCC(rc)) {
+    for (size_t i = 0; i < frames.size(); i++) {
+      init_unwritten_page(first_page_num + static_cast<PageNum>(i), frames[i]->page());
+    }
+    return RC::SUCCESS;
   }
 
-  *frame = allocated_frame;
+  // 很少会出现只读了一部分的情况，这时一个页面一个页面地重新读
+  for (Frame *frame : frames) {
+    rc = load_page(frame->page_num(), frame);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
   return RC::SUCCESS;
 }
 
@@ -327,21 +1104,28 @@ RC DiskBufferPool::allocate_page(Frame **frame)
 
   lock_.lock();
 
-  int byte = 0, bit = 0;
   if ((file_header_->allocated_pages) < (file_header_->page_count)) {
     // There is one free page
-    for (int i = 0; i < file_header_->page_count; i++) {
-      byte = i / 8;
-      bit  = i % 8;
-      if (((file_header_->bitmap[byte]) & (1 << bit)) == 0) {
-        (file_header_->allocated_pages)++;
-        file_header_->bitmap[byte] |= (1 << bit);
-        // TODO,  do we need clean the loaded page's data?
-        hdr_frame_->mark_dirty();
-
-        lock_.unlock();
-        return get_this_page(i, frame);
-      }
+    PageNum free_page = page_map_.first_free(file_header_->page_count);
+    if (free_page != -1) {
+      (file_header_->allocated_pages)++;
+      page_map_.set(free_page);
+      // TODO,  do we need clean the loaded page's data?
+      hdr_frame_->mark_dirty();
+      mark_map_dirty(free_page);
+
+      lock_.unlock();
+      return get_this_page(free_page, frame);
+    }
+  }
+
+  // 文件末尾是下一组页面的开始，先创建这一组的位图页
+  if (file_header_->page_count < BPFileHeader::MAX_PAGE_NUM && BPPageMap::is_map_page(file_header_->page_count)) {
+    if (OB_FAIL(rc = create_map_page(file_header_->page_count))) {
+      LOG_ERROR("Failed to create map page. file=%s, page_num=%d, rc=%s",
+                file_name_.c_str(), file_header_->page_count, strrc(rc));
+      lock_.unlock();
+      return rc;
     }
   }
 
@@ -366,21 +1150,26 @@ RC DiskBufferPool::allocate_page(Frame **frame)
   file_header_->allocated_pages++;
   file_header_->page_count++;
 
-  byte = page_num / 8;
-  bit  = page_num % 8;
-  file_header_->bitmap[byte] |= (1 << bit);
+  page_map_.set(page_num);
   hdr_frame_->mark_dirty();
+  mark_map_dirty(page_num);
 
   allocated_frame->set_file_desc(file_desc_);
   allocated_frame->access();
   allocated_frame->clear_page();
   allocated_frame->set_page_num(file_header_->page_count - 1);
 
-  // Use flush operation to extension file
-  if ((rc = flush_page_internal(*allocated_frame)) != RC::SUCCESS) {
+  if (OB_SUCC(extend_file(page_num))) {
+    // 页面已经在预分配的空间里，不需要同步写文件，标记成脏页之后由后台或者淘汰时写回。
+    // 文件头和位图可能比页面先写回去，这时读出来的是全0的页面，参考 init_unwritten_page
+    allocated_frame->mark_dirty();
+  } else if ((rc = flush_page_internal(*allocated_frame)) != RC::SUCCESS) {
+    // 预分配失败时退化成写一个页面来扩展文件
     LOG_WARN("Failed to alloc page %s , due to failed to extend one page.", file_name_.c_str());
     // skip return false, delay flush the extended page
-    // return tmp;
+    allocated_frame->mark_dirty();
+  } else if (page_num >= file_pages_) {
+    file_pages_ = page_num + 1;
   }
 
   lock_.unlock();
@@ -391,20 +1180,28 @@ RC DiskBufferPool::allocate_page(Frame **frame)
 
 RC DiskBufferPool::dispose_page(PageNum page_num)
 {
+  if (page_num == BP_HEADER_PAGE || BPPageMap::is_map_page(page_num)) {
+    LOG_WARN("cannot dispose header page or map page. file=%s, pageNum=%d", file_name_.c_str(), page_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
   std::scoped_lock lock_guard(lock_);
   Frame           *used_frame = frame_manager_.get(file_desc_, page_num);
-  if (used_frame != nullptr) {
-    ASSERT("the page try to dispose is in use. frame:%s", to_string(*used_frame).c_str());
-    frame_manager_.free(file_desc_, page_num, used_frame);
-  } else {
+  if (used_frame == nullptr) {
     LOG_WARN("failed to fetch the page while disposing it. pageNum=%d", page_num);
     return RC::NOTFOUND;
   }
 
+  // 还有别人 pin 着这个页面时，比如B+树乐观读的线程，它会发现页面的版本变了然后放弃。
+  // 页帧先留在缓存里，等没人使用之后再自然淘汰，页面本身可以回收
+  if (!frame_manager_.free_if_unpinned(file_desc_, page_num, used_frame)) {
+    LOG_DEBUG("the page to dispose is still in use. pageNum=%d", page_num);
+  }
+
   hdr_frame_->mark_dirty();
   file_header_->allocated_pages--;
-  char tmp = 1 << (page_num % 8);
-  file_header_->bitmap[page_num / 8] &= ~tmp;
+  page_map_.clear(page_num);
+  mark_map_dirty(page_num);
   return RC::SUCCESS;
 }
 
@@ -448,13 +1245,20 @@ RC DiskBufferPool::purge_page(PageNum page_num)
 
 RC DiskBufferPool::purge_all_pages()
 {
-  std::list<Frame *> used = frame_manager_.find_list(file_desc_);
+  std::list<Frame *>   used = frame_manager_.find_list(file_desc_);
+  std::vector<Frame *> frames(used.begin(), used.end());
 
-  std::scoped_lock lock_guard(lock_);
-  for (std::list<Frame *>::iterator it = used.begin(); it != used.end(); ++it) {
-    Frame *frame = *it;
+  // 先把脏页批量写回去，后面释放页面时就不需要一个一个地刷盘了
+  RC rc = flush_frames(frames, true /*sync*/);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush pages before purge. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+  }
 
-    purge_frame(frame->page_num(), frame);
+  std::scoped_lock lock_guard(lock_);
+  for (Frame *frame : frames) {
+    if (OB_FAIL(purge_frame(frame->page_num(), frame))) {
+      frame->unpin();
+    }
   }
   return RC::SUCCESS;
 }
@@ -489,65 +1293,306 @@ RC DiskBufferPool::flush_page_internal(Frame &frame)
   // The better way is use mmap the block into memory,
   // so it is easier to flush data to file.
 
+  const uint64_t version = frame.begin_flush();
   frame.set_check_sum(crc32(frame.page().data, BP_PAGE_DATA_SIZE));
   Page   &page   = frame.page();
   int64_t offset = ((int64_t)page.page_num) * sizeof(Page);
-  if (lseek(file_desc_, offset, SEEK_SET) == offset - 1) {
-    LOG_ERROR("Failed to flush page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_SEEK;
+
+  // 不同页面的读写会并发进行，所以不能使用 lseek 修改文件共享的偏移量
+  RC rc = IoBackend::instance().write(file_desc_, &page, sizeof(Page), offset);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to flush page %lld of %d. rc=%s", offset, file_desc_, strrc(rc));
+    return rc;
+  }
+  frame.finish_flush(version);
+  LOG_DEBUG("Flush block. file desc=%d, pageNum=%d, pin count=%d", file_desc_, page.page_num, frame.pin_count());
+
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::extend_file(PageNum page_num)
+{
+  if (page_num < file_pages_) {
+    return RC::SUCCESS;
   }
 
-  if (writen(file_desc_, &page, sizeof(Page)) != 0) {
-    LOG_ERROR("Failed to flush page %lld of %d due to %s.", offset, file_desc_, strerror(errno));
+  // 一次扩展一个 extent，新文件前面几个页面也按照 extent 对齐，避免第一个 extent 只有半截
+  const int     extent_pages = std::max(bp_manager_.extent_pages(), 1);
+  const PageNum new_pages    = static_cast<PageNum>(std::min<int64_t>(
+      (static_cast<int64_t>(page_num) / extent_pages + 1) * extent_pages, BPFileHeader::MAX_PAGE_NUM));
+  const off_t   offset       = static_cast<off_t>(file_pages_) * BP_PAGE_SIZE;
+  const off_t   length       = static_cast<off_t>(new_pages - file_pages_) * BP_PAGE_SIZE;
+
+  int ret = -1;
+#ifdef __linux__
+  ret = fallocate(file_desc_, 0, offset, length);
+  if (ret != 0 && (errno == EOPNOTSUPP || errno == ENOSYS)) {
+    // 有些文件系统不支持 fallocate，退化成修改文件长度，磁盘空间在写页面的时候才真正分配
+    ret = ftruncate(file_desc_, offset + length);
+  }
+#else
+  ret = ftruncate(file_desc_, offset + length);
+#endif
+  if (ret != 0) {
+    LOG_WARN("failed to extend file. file=%s, offset=%ld, length=%ld, error=%s",
+             file_name_.c_str(), static_cast<long>(offset), static_cast<long>(length), strerror(errno));
     return RC::IOERR_WRITE;
   }
-  frame.clear_dirty();
-  LOG_DEBUG("Flush block. file desc=%d, pageNum=%d, pin count=%d", file_desc_, page.page_num, frame.pin_count());
 
+  LOG_DEBUG("extend file. file=%s, pages %d -> %d", file_name_.c_str(), file_pages_, new_pages);
+  file_pages_ = new_pages;
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::load_map_page(PageNum page_num)
+{
+  Frame *frame = nullptr;
+  RC     rc    = allocate_frame(page_num, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to allocate frame for map page. file=%s, page_num=%d", file_name_.c_str(), page_num);
+    return rc;
+  }
+
+  frame->set_file_desc(file_desc_);
+  frame->access();
+  if (OB_FAIL(rc = load_page(page_num, frame))) {
+    purge_frame(page_num, frame);
+    return rc;
+  }
+
+  page_map_.add_group(frame->data());
+  map_frames_.push_back(frame);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::create_map_page(PageNum page_num)
+{
+  ASSERT(BPPageMap::group_of(page_num) == page_map_.group_num() && BPPageMap::is_map_page(page_num),
+         "invalid map page. page_num=%d, group num=%d", page_num, page_map_.group_num());
+
+  Frame *frame = nullptr;
+  RC     rc    = allocate_frame(page_num, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to allocate frame for map page. file=%s, page_num=%d", file_name_.c_str(), page_num);
+    return rc;
+  }
+
+  frame->set_file_desc(file_desc_);
+  frame->access();
+  frame->clear_page();
+  frame->set_page_num(page_num);
+
+  page_map_.add_group(frame->data());
+  page_map_.set(page_num);
+  map_frames_.push_back(frame);
+
+  file_header_->allocated_pages++;
+  file_header_->page_count = std::max(file_header_->page_count, page_num + 1);
+  hdr_frame_->mark_dirty();
+
+  // 位图页要比文件头先写到文件中，否则文件头里已经有了这个组，读出来的位图却是空的，位图页自己也会被当作空闲页面。
+  // 扩展文件失败时，写这个页面也能把文件扩展到这里
+  frame->mark_dirty();
+  if (OB_FAIL(rc = extend_file(page_num))) {
+    LOG_WARN("failed to extend file for map page, write the page directly. file=%s, page_num=%d, rc=%s",
+             file_name_.c_str(), page_num, strrc(rc));
+  }
+  if (OB_FAIL(rc = flush_page_internal(*frame))) {
+    LOG_WARN("failed to write map page. file=%s, page_num=%d, rc=%s", file_name_.c_str(), page_num, strrc(rc));
+  } else if (page_num >= file_pages_) {
+    file_pages_ = page_num + 1;
+  }
+
+  LOG_INFO("create map page. file=%s, page_num=%d, group=%d", file_name_.c_str(), page_num, page_map_.group_num() - 1);
   return RC::SUCCESS;
 }
 
+void DiskBufferPool::mark_map_dirty(PageNum page_num)
+{
+  const int group = BPPageMap::group_of(page_num);
+  if (group == 0) {
+    hdr_frame_->mark_dirty();
+  } else {
+    map_frames_[group - 1]->mark_dirty();
+  }
+}
+
 RC DiskBufferPool::flush_all_pages()
 {
-  std::list<Frame *> used = frame_manager_.find_list(file_desc_);
-  for (Frame *frame : used) {
-    RC rc = flush_page(*frame);
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to flush all pages");
+  std::list<Frame *>   used = frame_manager_.find_list(file_desc_);
+  std::vector<Frame *> frames(used.begin(), used.end());
+
+  RC rc = flush_frames(frames, true /*sync*/);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush all pages. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+  }
+
+  for (Frame *frame : frames) {
+    frame->unpin();
+  }
+  return rc;
+}
+
+RC DiskBufferPool::flush_frames(const std::vector<Frame *> &frames, bool sync)
+{
+  // 数据页由页面的读锁保护，写盘时不能持有 lock_，否则持有页面写锁的线程再来分配页面时就会死锁。
+  // 文件头和位图页只在 lock_ 中修改，它们一直被 pin 着，不会成为淘汰的对象
+  std::vector<Frame *> meta_frames;
+  std::vector<Frame *> latched_frames;
+  std::vector<Frame *> busy_frames;
+  latched_frames.reserve(frames.size());
+  for (Frame *frame : frames) {
+    if (!frame->dirty()) {
+      continue;
+    }
+
+    if (frame->page_num() == BP_HEADER_PAGE || BPPageMap::is_map_page(frame->page_num())) {
+      meta_frames.push_back(frame);
+    } else if (frame->try_read_latch()) {
+      latched_frames.push_back(frame);
+    } else {
+      busy_frames.push_back(frame);
+    }
+  }
+
+  RC rc = flush_frames_internal(latched_frames);
+  for (Frame *frame : latched_frames) {
+    frame->read_unlatch();
+  }
+
+  if (OB_SUCC(rc) && !meta_frames.empty()) {
+    std::scoped_lock lock_guard(lock_);
+    rc = flush_frames_internal(meta_frames);
+  }
+
+  if (OB_FAIL(rc) || !sync) {
+    return rc;
+  }
+
+  // 需要 sync 时，刚才被别人锁住的页面要等拿到锁之后再写
+  for (Frame *frame : busy_frames) {
+    frame->read_latch();
+    if (frame->dirty()) {
+      rc = flush_page_internal(*frame);
+    }
+    frame->read_unlatch();
+    if (OB_FAIL(rc)) {
       return rc;
     }
   }
+
+  rc = IoBackend::instance().sync(file_desc_);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to sync file. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+  }
+  return rc;
+}
+
+RC DiskBufferPool::flush_frames_internal(const std::vector<Frame *> &frames)
+{
+  std::vector<Frame *> dirty_frames;
+  dirty_frames.reserve(frames.size());
+  for (Frame *frame : frames) {
+    if (frame->dirty()) {
+      dirty_frames.push_back(frame);
+    }
+  }
+
+  if (dirty_frames.empty()) {
+    return RC::SUCCESS;
+  }
+
+  std::sort(dirty_frames.begin(), dirty_frames.end(), [](Frame *left, Frame *right) {
+    return left->page_num() < right->page_num();
+  });
+
+  // 页号连续的页面合并成一个写请求，每个请求记录它包含了哪些页面
+  std::vector<IoRequest>           requests;
+  std::vector<std::pair<int, int>> request_frames;  // [begin, end) in dirty_frames
+  std::vector<uint64_t>            versions;
+  versions.reserve(dirty_frames.size());
+  for (int i = 0; i < static_cast<int>(dirty_frames.size()); i++) {
+    Frame *frame = dirty_frames[i];
+    versions.push_back(frame->begin_flush());
+    frame->set_check_sum(crc32(frame->page().data, BP_PAGE_DATA_SIZE));
+
+    const bool contiguous = !requests.empty() && dirty_frames[i - 1]->page_num() + 1 == frame->page_num() &&
+                            requests.back().iovs.size() < static_cast<size_t>(MAX_PAGES_PER_WRITE);
+    if (!contiguous) {
+      IoRequest request;
+      request.type   = IoType::WRITE;
+      request.fd     = file_desc_;
+      request.offset = static_cast<int64_t>(frame->page_num()) * BP_PAGE_SIZE;
+      requests.push_back(std::move(request));
+      request_frames.emplace_back(i, i);
+    }
+
+    requests.back().iovs.push_back({&frame->page(), static_cast<size_t>(BP_PAGE_SIZE)});
+    request_frames.back().second = i + 1;
+  }
+
+  RC rc = IoBackend::instance().submit(requests);
+  for (size_t i = 0; i < requests.size(); i++) {
+    if (!requests[i].succeeded()) {
+      continue;
+    }
+    for (int j = request_frames[i].first; j < request_frames[i].second; j++) {
+      dirty_frames[j]->finish_flush(versions[j]);
+    }
+  }
+
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to flush pages. file=%s, page num=%d, rc=%s",
+              file_name_.c_str(), static_cast<int>(dirty_frames.size()), strrc(rc));
+    return rc;
+  }
+
+  LOG_DEBUG("flush pages done. file=%s, page num=%d, write num=%d",
+            file_name_.c_str(), static_cast<int>(dirty_frames.size()), static_cast<int>(requests.size()));
   return RC::SUCCESS;
 }
 
 RC DiskBufferPool::recover_page(PageNum page_num)
 {
-  int byte = 0, bit = 0;
-  byte = page_num / 8;
-  bit  = page_num % 8;
-
   std::scoped_lock lock_guard(lock_);
-  if (!(file_header_->bitmap[byte] & (1 << bit))) {
-    file_header_->bitmap[byte] |= (1 << bit);
+
+  // 页面所在的组可能还没有位图页，把缺少的位图页都补上
+  for (int group = page_map_.group_num(); group <= BPPageMap::group_of(page_num); group++) {
+    RC rc = create_map_page(BPPageMap::group_start(group));
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create map page while recovering page. file=%s, pageNum=%d, rc=%s",
+               file_name_.c_str(), page_num, strrc(rc));
+      return rc;
+    }
+  }
+
+  if (!page_map_.get(page_num)) {
+    page_map_.set(page_num);
     file_header_->allocated_pages++;
-    file_header_->page_count++;
+    file_header_->page_count = std::max(file_header_->page_count, page_num + 1);
     hdr_frame_->mark_dirty();
+    mark_map_dirty(page_num);
   }
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
+RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer, bool attach /* = true */)
 {
   auto purger = [this](Frame *frame) {
     if (!frame->dirty()) {
       return RC::SUCCESS;
     }
 
+    // 前台线程不得不同步刷脏页，让页面清理线程多准备一些干净的页帧
+    bp_manager_.wake_up_page_cleaner();
+
+    // 其它线程可能刚刚 get 到这个页面并且正在修改，flush_frames 会加页面的读锁，加不上锁时页面仍然是脏的，
+    // purge_frames 就不会淘汰它
     RC rc = RC::SUCCESS;
     if (frame->file_desc() == file_desc_) {
-      rc = this->flush_page_internal(*frame);
+      rc = this->flush_frames({frame}, false /*sync*/);
     } else {
-      rc = bp_manager_.flush_page(*frame);
+      rc = bp_manager_.flush_frames({frame}, false /*sync*/);
     }
 
     if (rc != RC::SUCCESS) {
@@ -557,14 +1602,15 @@ RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
   };
 
   while (true) {
-    Frame *frame = frame_manager_.alloc(file_desc_, page_num);
+    Frame *frame = attach ? frame_manager_.alloc(file_desc_, page_num)
+                          : frame_manager_.alloc_detached(file_desc_, page_num);
     if (frame != nullptr) {
       *buffer = frame;
       return RC::SUCCESS;
     }
 
     LOG_TRACE("frames are all allocated, so we should purge some frames to get one free frame");
-    (void)frame_manager_.purge_frames(1 /*count*/, purger);
+    (void)frame_manager_.purge_frames(file_desc_, page_num, 1 /*count*/, purger);
   }
   return RC::BUFFERPOOL_NOBUF;
 }
@@ -575,7 +1621,7 @@ RC DiskBufferPool::check_page_num(PageNum page_num)
     LOG_ERROR("Invalid pageNum:%d, file's name:%s", page_num, file_name_.c_str());
     return RC::BUFFERPOOL_INVALID_PAGE_NUM;
   }
-  if ((file_header_->bitmap[page_num / 8] & (1 << (page_num % 8))) == 0) {
+  if (!page_map_.get(page_num)) {
     LOG_ERROR("Invalid pageNum:%d, file's name:%s", page_num, file_name_.c_str());
     return RC::BUFFERPOOL_INVALID_PAGE_NUM;
   }
@@ -585,44 +1631,99 @@ RC DiskBufferPool::check_page_num(PageNum page_num)
 RC DiskBufferPool::load_page(PageNum page_num, Frame *frame)
 {
   int64_t offset = ((int64_t)page_num) * BP_PAGE_SIZE;
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to load page %s:%d, due to failed to lseek:%s.", file_name_.c_str(), page_num, strerror(errno));
-
-    return RC::IOERR_SEEK;
-  }
 
   Page &page = frame->page();
-  int   ret  = readn(file_desc_, &page, BP_PAGE_SIZE);
-  if (ret != 0) {
-    LOG_ERROR("Failed to load page %s, file_desc:%d, page num:%d, due to failed to read data:%s, ret=%d, page count=%d",
-              file_name_.c_str(), file_desc_, page_num, strerror(errno), ret, file_header_->allocated_pages);
-    return RC::IOERR_READ;
+  RC    rc   = IoBackend::instance().read(file_desc_, &page, BP_PAGE_SIZE, offset);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to load page %s, file_desc:%d, page num:%d, due to failed to read data. rc=%s, page count=%d",
+              file_name_.c_str(), file_desc_, page_num, strrc(rc), file_header_->allocated_pages);
+    return rc;
   }
+
+  init_unwritten_page(page_num, page);
   return RC::SUCCESS;
 }
 
+void DiskBufferPool::init_unwritten_page(PageNum page_num, Page &page)
+{
+  if (page.page_num == page_num || page.page_num != 0 || page.check_sum != 0) {
+    return;
+  }
+
+  for (int i = 0; i < BP_PAGE_DATA_SIZE; i++) {
+    if (page.data[i] != 0) {
+      return;
+    }
+  }
+
+  // 页号是0的只有文件头，它总是会写到磁盘上的，所以这是一个还没有写过的页面
+  LOG_DEBUG("load an unwritten page, treat it as an empty page. file=%s, page_num=%d", file_name_.c_str(), page_num);
+  page.page_num  = page_num;
+  page.check_sum = crc32(page.data, BP_PAGE_DATA_SIZE);
+}
+
 int DiskBufferPool::file_desc() const { return file_desc_; }
 
 ////////////////////////////////////////////////////////////////////////////////
-BufferPoolManager::BufferPoolManager(int memory_size /* = 0 */)
+BufferPoolManager::BufferPoolManager(const BufferPoolParam &param /* = BufferPoolParam() */) : param_(param)
 {
+  int64_t memory_size = param.memory_size;
   if (memory_size <= 0) {
-    memory_size = MEM_POOL_ITEM_NUM * DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE;
+    memory_size = static_cast<int64_t>(DEFAULT_FRAME_NUM) * BP_PAGE_SIZE;
+  }
+  const int frame_num = static_cast<int>(std::max<int64_t>(memory_size / BP_PAGE_SIZE, 1));
+  RC        rc        = frame_manager_.init(frame_num, param_);
+  if (rc == RC::INVALID_ARGUMENT) {
+    LOG_ERROR("failed to init frame manager. replacer=%s, rc=%s. use default replacer",
+              param.replacer.c_str(), strrc(rc));
+    param_.replacer = "lru";
+    rc              = frame_manager_.init(frame_num, param_);
+  }
+  ASSERT(OB_SUCC(rc), "failed to init frame manager. frame num=%d, rc=%s", frame_num, strrc(rc));
+  LOG_INFO("buffer pool manager init with memory size %ld, page num: %d, "
+           "frame shard num: %d, replacer: %s, direct io: %d",
+           memory_size, frame_num, frame_manager_.shard_num(), frame_manager_.replacer_name(), param_.direct_io);
+
+  if (param_.clean_frame_num > 0) {
+    start_page_cleaner();
+  }
+
+  if (param_.read_ahead_thread_num > 0) {
+    read_ahead_executor_ = new ThreadPoolExecutor();
+    int ret = read_ahead_executor_->init("ReadAhead",  // name
+                                         param_.read_ahead_thread_num,  // core size
+                                         param_.read_ahead_thread_num,  // max size
+                                         60 * 1000                      // keep alive time
+    );
+    if (ret != 0) {
+      LOG_ERROR("failed to init read ahead thread pool. disable read ahead. ret=%d", ret);
+      delete read_ahead_executor_;
+      read_ahead_executor_ = nullptr;
+    }
   }
-  const int pool_num = std::max(memory_size / BP_PAGE_SIZE / DEFAULT_ITEM_NUM_PER_POOL, 1);
-  frame_manager_.init(pool_num);
-  LOG_INFO("buffer pool manager init with memory size %d, page num: %d, pool num: %d",
-           memory_size, pool_num * DEFAULT_ITEM_NUM_PER_POOL, pool_num);
 }
 
 BufferPoolManager::~BufferPoolManager()
 {
+  stop_page_cleaner();
+
+  LOG_INFO("buffer pool manager exit. replacer=%s, %s",
+           frame_manager_.replacer_name(), frame_manager_.replacer_stats().to_string().c_str());
+
   std::unordered_map<std::string, DiskBufferPool *> tmp_bps;
   tmp_bps.swap(buffer_pools_);
 
   for (auto &iter : tmp_bps) {
     delete iter.second;
   }
+
+  // 所有文件都关闭了，不会再有新的预读任务
+  if (read_ahead_executor_ != nullptr) {
+    read_ahead_executor_->shutdown();
+    read_ahead_executor_->await_termination();
+    delete read_ahead_executor_;
+    read_ahead_executor_ = nullptr;
+  }
 }
 
 RC BufferPoolManager::create_file(const char *file_name)
@@ -699,12 +1800,11 @@ RC BufferPoolManager::close_file(const char *_file_name)
 {
   std::string file_name(_file_name);
 
-  lock_.lock();
+  std::unique_lock<common::Mutex> lock_guard(lock_);
 
   auto iter = buffer_pools_.find(file_name);
   if (iter == buffer_pools_.end()) {
     LOG_TRACE("file has not opened: %s", _file_name);
-    lock_.unlock();
     return RC::INTERNAL;
   }
 
@@ -723,25 +1823,218 @@ RC BufferPoolManager::close_file(const char *_file_name)
 
   DiskBufferPool *bp = iter->second;
   buffer_pools_.erase(iter);
-  lock_.unlock();
+
+  // 已经从 fd_buffer_pools_ 中删掉了，不会再有新的引用，等正在刷盘的线程用完
+  buffer_pool_cond_.wait(lock_guard, [this, bp]() { return buffer_pool_refs_.count(bp) == 0; });
+  lock_guard.unlock();
 
   delete bp;
   return RC::SUCCESS;
 }
 
-RC BufferPoolManager::flush_page(Frame &frame)
+DiskBufferPool *BufferPoolManager::acquire_buffer_pool(int fd)
 {
-  int fd = frame.file_desc();
-
   std::scoped_lock lock_guard(lock_);
   auto             iter = fd_buffer_pools_.find(fd);
   if (iter == fd_buffer_pools_.end()) {
     LOG_WARN("unknown buffer pool of fd %d", fd);
+    return nullptr;
+  }
+
+  buffer_pool_refs_[iter->second]++;
+  return iter->second;
+}
+
+void BufferPoolManager::release_buffer_pool(DiskBufferPool *bp)
+{
+  std::scoped_lock lock_guard(lock_);
+  auto             iter = buffer_pool_refs_.find(bp);
+  ASSERT(iter != buffer_pool_refs_.end(), "release a buffer pool that is not acquired. bp=%p", bp);
+  if (--iter->second == 0) {
+    buffer_pool_refs_.erase(iter);
+    buffer_pool_cond_.notify_all();
+  }
+}
+
+RC BufferPoolManager::flush_page(Frame &frame)
+{
+  DiskBufferPool *bp = acquire_buffer_pool(frame.file_desc());
+  if (bp == nullptr) {
     return RC::INTERNAL;
   }
 
-  DiskBufferPool *bp = iter->second;
-  return bp->flush_page(frame);
+  RC rc = bp->flush_page(frame);
+  release_buffer_pool(bp);
+  return rc;
+}
+
+RC BufferPoolManager::flush_frames(const std::vector<Frame *> &frames, bool sync)
+{
+  // 按照文件分组，每个文件的页面一起写回
+  std::unordered_map<int, std::vector<Frame *>> file_frames;
+  for (Frame *frame : frames) {
+    file_frames[frame->file_desc()].push_back(frame);
+  }
+
+  RC rc = RC::SUCCESS;
+  for (auto &[fd, fd_frames] : file_frames) {
+    DiskBufferPool *bp = acquire_buffer_pool(fd);
+    if (bp == nullptr) {
+      rc = RC::INTERNAL;
+      continue;
+    }
+
+    RC flush_rc = bp->flush_frames(fd_frames, sync);
+    release_buffer_pool(bp);
+    if (OB_FAIL(flush_rc)) {
+      rc = flush_rc;
+    }
+  }
+  return rc;
+}
+
+bool BufferPoolManager::execute_read_ahead(const std::function<void()> &task)
+{
+  if (read_ahead_executor_ == nullptr) {
+    return false;
+  }
+
+  int ret = read_ahead_executor_->execute(task);
+  if (ret != 0) {
+    LOG_WARN("failed to execute read ahead task. ret=%d", ret);
+    return false;
+  }
+  return true;
+}
+
+void BufferPoolManager::wake_up_page_cleaner()
+{
+  if (page_cleaner_ != nullptr) {
+    page_cleaner_cond_.notify_one();
+  }
+}
+
+RC BufferPoolManager::start_page_cleaner()
+{
+  if (param_.page_cleaner_interval_ms <= 0) {
+    param_.page_cleaner_interval_ms = 100;
+  }
+
+  page_cleaner_stopped_ = false;
+  page_cleaner_         = new std::thread(&BufferPoolManager::page_cleaner_routine, this);
+  LOG_INFO("page cleaner started. clean frame num=%d, interval=%dms",
+           param_.clean_frame_num, param_.page_cleaner_interval_ms);
+  return RC::SUCCESS;
+}
+
+void BufferPoolManager::stop_page_cleaner()
+{
+  if (page_cleaner_ == nullptr) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(page_cleaner_lock_);
+    page_cleaner_stopped_ = true;
+  }
+  page_cleaner_cond_.notify_all();
+
+  page_cleaner_->join();
+  delete page_cleaner_;
+  page_cleaner_ = nullptr;
+  LOG_INFO("page cleaner stopped");
+}
+
+void BufferPoolManager::page_cleaner_routine()
+{
+  int ret = thread_set_name("PageCleaner");
+  if (ret != 0) {
+    LOG_WARN("failed to set thread name. ret = %d", ret);
+  }
+
+  std::unique_lock<std::mutex> guard(page_cleaner_lock_);
+  while (!page_cleaner_stopped_) {
+    page_cleaner_cond_.wait_for(guard, std::chrono::milliseconds(param_.page_cleaner_interval_ms));
+    if (page_cleaner_stopped_) {
+      break;
+    }
+
+    guard.unlock();
+    clean_pages();
+    guard.lock();
+  }
+}
+
+void BufferPoolManager::clean_pages()
+{
+  std::lock_guard<std::mutex> clean_guard(page_clean_lock_);
+
+  std::vector<Frame *> frames = frame_manager_.find_frames_to_clean(param_.clean_frame_num);
+  if (frames.empty()) {
+    return;
+  }
+
+  // 在找出来之后，可能又有其它线程刷过这些页面，flush_frames 只会写仍然是脏的页面
+  RC rc = flush_frames(frames, false /*sync*/);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("page cleaner failed to flush pages. rc=%s", strrc(rc));
+  }
+
+  for (Frame *frame : frames) {
+    frame->unpin();
+  }
+  LOG_DEBUG("page cleaner flushed %d pages", static_cast<int>(frames.size()));
+}
+
+RC BufferPoolManager::checkpoint(LSN current_lsn, LSN &recovery_lsn)
+{
+  std::lock_guard<std::mutex> clean_guard(page_clean_lock_);
+
+  // 上一次检查点时就已经是脏页的页面先写回，否则经常修改的页面会让恢复的起点一直停在原地。
+  // 这些页面可能正在被使用，flush_frames 会加页面的读锁，正在被修改的页面先跳过，
+  // 它们仍然是脏页并且保留着 rec_lsn，下面计算恢复的起点时会算上它们
+  std::vector<Frame *> frames = frame_manager_.find_frames_to_checkpoint();
+  if (!frames.empty()) {
+    RC rc = flush_frames(frames, false /*sync*/);
+    for (Frame *frame : frames) {
+      frame->unpin();
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to flush pages for checkpoint. page num=%d, rc=%s", static_cast<int>(frames.size()), strrc(rc));
+      return rc;
+    }
+  }
+
+  recovery_lsn    = frame_manager_.min_recovery_lsn(checkpoint_lsn_, current_lsn);
+  checkpoint_lsn_ = current_lsn;
+
+  // 页面清理线程和淘汰页面时写回的页面都没有执行 fsync，这里统一落盘。fsync 很慢，不能持有 lock_
+  std::vector<std::pair<int, DiskBufferPool *>> fd_bps;
+  {
+    std::scoped_lock lock_guard(lock_);
+    for (auto &[fd, bp] : fd_buffer_pools_) {
+      buffer_pool_refs_[bp]++;
+      fd_bps.emplace_back(fd, bp);
+    }
+  }
+
+  RC rc = RC::SUCCESS;
+  for (auto &[fd, bp] : fd_bps) {
+    if (OB_SUCC(rc)) {
+      rc = IoBackend::instance().sync(fd);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to sync file for checkpoint. fd=%d, rc=%s", fd, strrc(rc));
+      }
+    }
+    release_buffer_pool(bp);
+  }
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  LOG_INFO("buffer pool checkpoint done. flushed page num=%d, recovery lsn=%d, current lsn=%d",
+           static_cast<int>(frames.size()), recovery_lsn, current_lsn);
+  return RC::SUCCESS;
 }
 
 static BufferPoolManager *default_bpm = nullptr;
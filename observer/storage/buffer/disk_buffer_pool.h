@@ -13,8 +13,12 @@ See the Mulan PSL v2 for more details. */
 //
 #pragma once
 
+#include <condition_variable>
 #include <fcntl.h>
 #include <functional>
+#include <limits>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <stdio.h>
 #include <stdlib.h>
@@ -22,16 +26,21 @@ See the Mulan PSL v2 for more details. */
 #include <string>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <thread>
 #include <time.h>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "common/lang/bitmap.h"
-#include "common/lang/lru_cache.h"
 #include "common/lang/mutex.h"
 #include "common/mm/mem_pool.h"
+#include "common/thread/thread_pool_executor.h"
 #include "common/rc.h"
 #include "common/types.h"
 #include "storage/buffer/frame.h"
+#include "storage/buffer/frame_arena.h"
+#include "storage/buffer/frame_replacer.h"
 #include "storage/buffer/page.h"
 
 class BufferPoolManager;
@@ -45,30 +54,60 @@ class DiskBufferPool;
 #define BP_FILE_SUB_HDR_SIZE (sizeof(BPFileSubHeader))
 
 /**
- * @brief BufferPool的文件第一个页面，存放一些元数据信息，包括了后面每页的分配信息。
+ * @brief BufferPool的文件第一个页面，存放一些元数据信息，包括了前面一部分页面的分配信息。
  * @ingroup BufferPool
- * @details
- * @code
- * TODO 1. 当前的做法，只能分配比较少的页面，你可以扩展一下，支持更多的页面或无限多的页面吗？
- *         可以参考Linux ext(n)和Windows NTFS等文件系统
- *      2. 当前使用bitmap存放页面分配情况，但是这种方法在页面非常多的时候，查找空闲页面的
- *         效率非常低，你有办法优化吗？
- * @endcode
+ * @details 页头中的位图只能管理 HEADER_MAP_PAGE_NUM 个页面，更多的页面由位图页管理，参考 BPPageMap
  */
 struct BPFileHeader
 {
-  int32_t page_count;       //! 当前文件一共有多少个页面
-  int32_t allocated_pages;  //! 已经分配了多少个页面
+  int32_t page_count;       //! 当前文件一共有多少个页面，包括位图页
+  int32_t allocated_pages;  //! 已经分配了多少个页面，包括位图页
   char    bitmap[0];        //! 页面分配位图, 第0个页面(就是当前页面)，总是1
 
   /**
-   * 能够分配的最大的页面个数，即bitmap的字节数 乘以8
+   * 页头中的位图能够管理的页面个数，即bitmap的字节数 乘以8
+   */
+  static const int HEADER_MAP_PAGE_NUM = (BP_PAGE_DATA_SIZE - sizeof(page_count) - sizeof(allocated_pages)) * 8;
+
+  /**
+   * 能够分配的最大的页面个数，只受页面编号范围的限制
    */
-  static const int MAX_PAGE_NUM = (BP_PAGE_DATA_SIZE - sizeof(page_count) - sizeof(allocated_pages)) * 8;
+  static const int MAX_PAGE_NUM = std::numeric_limits<PageNum>::max() - 1;
 
   std::string to_string() const;
 };
 
+/**
+ * @brief BufferPool 的启动参数
+ * @ingroup BufferPool
+ * @details 这些参数在启动时从配置文件中读取，参考 init_global_objects
+ */
+struct BufferPoolParam
+{
+  int64_t memory_size              = 0;    ///< buffer pool 使用的内存大小(字节)，0 表示使用默认值
+  int     frame_shard_num          = 1;    ///< 页帧管理器分成多少个分片，每个分片有自己的锁、LRU链表和空闲页帧
+  int     clean_frame_num          = 0;    ///< 后台页面清理线程保持多少个干净的可淘汰页帧，0 表示不启动清理线程
+  int     page_cleaner_interval_ms = 100;  ///< 页面清理线程的检查周期(毫秒)
+
+  std::string replacer = "lru";  ///< 页面淘汰策略，参考 FrameReplacer::create
+  int         lru_k    = 2;      ///< 淘汰策略是 lru-k 时的 K
+
+  int read_ahead_thread_num = 0;   ///< 执行预读的后台线程个数，0 表示关闭预读
+  int read_ahead_max_pages  = 64;  ///< 顺序扫描时预读窗口最多多少个页面
+
+  /// 是否使用 O_DIRECT 打开数据文件。开启后页面读写绕过操作系统的页缓存，每个页面在内存中只有
+  /// buffer pool 中的一份，memory_size 就是数据页实际占用的内存
+  bool direct_io = false;
+
+  /// 数据文件每次扩展多少个页面(extent)，默认 128 个页面即 1MB。扩展时一次性预分配磁盘空间，
+  /// 之后在这个范围内分配新页面不需要写文件。1 表示每次只扩展一个页面
+  int extent_pages = 128;
+
+  std::string huge_page   = "auto";  ///< 页面内存使用的大页，auto/none/thp/2m/1g，参考 FrameArena
+  std::string numa_policy = "none";  ///< 页面内存的 NUMA 策略，none/interleave/bind
+  std::string numa_nodes;            ///< NUMA 策略使用的节点，比如 "0-1"，为空表示所有节点
+};
+
 /**
  * @brief 管理页面Frame
  * @ingroup BufferPool
@@ -76,13 +115,23 @@ struct BPFileHeader
  * 当内存中的页帧不够用时，需要从内存中淘汰一些页帧，以便为新的页帧腾出空间。
  * 这个管理器负责为所有的BufferPool提供页帧管理服务，也就是所有的BufferPool磁盘文件
  * 在访问时都使用这个管理器映射到内存。
+ *
+ * 所有的页帧按照 FrameId 的哈希值分散到多个分片(shard)中，每个分片有独立的锁、LRU链表和
+ * 空闲页帧，访问不同分片的页面不会相互竞争同一把锁。淘汰页面时，也只在需要新页帧的那个分片中淘汰。
+ * 淘汰哪些页面由每个分片的淘汰策略(FrameReplacer)决定。
  */
 class BPFrameManager
 {
 public:
   BPFrameManager(const char *tag);
 
-  RC init(int pool_num);
+  /**
+   * @brief 初始化
+   * @details 所有页帧在这里一次性申请好，参考 FrameArena。每个分片分到连续的一段页帧。
+   * @param frame_num 一共有多少个页帧
+   * @param param     分片个数、淘汰策略、大页和 NUMA 等参数
+   */
+  RC init(int frame_num, const BufferPoolParam &param);
   RC cleanup();
 
   /**
@@ -111,31 +160,98 @@ public:
    */
   Frame *alloc(int file_desc, PageNum page_num);
 
+  /**
+   * @brief 分配一个页帧，但是不放到页帧表中
+   * @details 其它线程通过 get 看不到这个页帧，也不会淘汰它。通常用来从磁盘加载页面，
+   * 加载完成后调用 attach 放入页帧表，加载失败则调用 free_detached 释放
+   * @param file_desc 文件描述符
+   * @param page_num  页面编号
+   * @return Frame* 页帧指针，已经 pin 过
+   */
+  Frame *alloc_detached(int file_desc, PageNum page_num);
+
+  /**
+   * @brief 把 alloc_detached 分配的页帧放入页帧表
+   * @details 调用者需要保证页帧表中没有同一个页面的页帧
+   */
+  RC attach(int file_desc, PageNum page_num, Frame *frame);
+
+  /**
+   * @brief 释放 alloc_detached 分配的、还没有放入页帧表的页帧
+   */
+  RC free_detached(int file_desc, PageNum page_num, Frame *frame);
+
+  /**
+   * @brief 页面是否在页帧表中
+   * @details 不会 pin 页帧，也不算作一次访问。预读时用来跳过已经在内存中的页面
+   */
+  bool contains(int file_desc, PageNum page_num);
+
   /**
    * 尽管frame中已经包含了file_desc和page_num，但是依然要求
    * 传入，因为frame可能忘记初始化或者没有初始化
    */
   RC free(int file_desc, PageNum page_num, Frame *frame);
 
+  /**
+   * @brief 只有调用者是唯一 pin 着页帧的人时才释放它，否则只是 unpin
+   * @details 检查和释放都在分片的锁内完成。其它线程 pin 页帧(get)也要拿分片的锁，
+   * 所以检查之后不会有人再 pin 住一个马上就要释放的页帧
+   * @return 是否释放了
+   */
+  bool free_if_unpinned(int file_desc, PageNum page_num, Frame *frame);
+
   /**
    * 如果不能从空闲链表中分配新的页面，就使用这个接口，
    * 尝试从pin count=0的页面中淘汰一些
+   * @details 在分片的锁内挑选要淘汰的页面，优先挑选干净的页面。挑选出来的页面会被 pin 住，
+   * 然后在锁外调用 purger 刷脏页，最后再加锁把仍然可以淘汰的页面释放掉。
+   * @param file_desc 想要分配页帧的文件，与page_num一起决定在哪个分片中淘汰页面
+   * @param page_num  想要分配页帧的页面
    * @param count 想要purge多少个页面
    * @param purger 需要在释放frame之前，对页面做些什么操作。当前是刷新脏数据到磁盘
    * @return 返回本次清理了多少个页面
    */
-  int purge_frames(int count, std::function<RC(Frame *frame)> purger);
+  int purge_frames(int file_desc, PageNum page_num, int count, std::function<RC(Frame *frame)> purger);
+
+  /**
+   * @brief 找出需要后台刷盘的脏页
+   * @details 页面清理线程使用。在每个分片中从LRU尾部开始查找，直到空闲页帧加上干净的可淘汰页帧
+   * 达到 clean_num 按分片平分后的个数。找到的脏页会被 pin 住，调用者刷盘后需要 unpin。
+   * @param clean_num 希望所有分片一共保持多少个干净的可淘汰页帧
+   */
+  std::vector<Frame *> find_frames_to_clean(int clean_num);
 
-  size_t frame_num() const { return frames_.count(); }
+  /**
+   * @brief 找出上一次检查点时就已经是脏页的页面
+   * @details 检查点使用。这些页面已经有了 rec lsn，长时间不写回会让恢复的起点一直无法向前推进。
+   * 找到的页面会被 pin 住，调用者刷盘后需要 unpin。
+   */
+  std::vector<Frame *> find_frames_to_checkpoint();
+
+  /**
+   * @brief 计算所有脏页中最小的 rec lsn
+   * @details 还没有设置 rec lsn 的脏页是在上一次检查点之后才变脏的，把它们的 rec lsn 设置为 dirty_lsn。
+   * @param dirty_lsn 上一次检查点时日志的LSN
+   * @param default_lsn 没有脏页时返回这个值
+   */
+  LSN min_recovery_lsn(LSN dirty_lsn, LSN default_lsn);
+
+  size_t frame_num() const;
 
   /**
    * 测试使用。返回已经从内存申请的个数
    */
-  size_t total_frame_num() const { return allocator_.get_size(); }
+  size_t total_frame_num() const;
 
-private:
-  Frame *get_internal(const FrameId &frame_id);
-  RC     free_internal(const FrameId &frame_id, Frame *frame);
+  int shard_num() const { return static_cast<int>(shards_.size()); }
+
+  const char *replacer_name() const { return replacer_name_.c_str(); }
+
+  /**
+   * @brief 所有分片的命中、淘汰等统计信息之和
+   */
+  FrameReplacerStats replacer_stats();
 
 private:
   class BPFrameIdHasher
@@ -144,17 +260,114 @@ private:
     size_t operator()(const FrameId &frame_id) const { return frame_id.hash(); }
   };
 
-  using FrameLruCache  = common::LruCache<FrameId, Frame *, BPFrameIdHasher>;
-  using FrameAllocator = common::MemPoolSimple<Frame>;
+  using FrameTable = std::unordered_map<FrameId, Frame *, BPFrameIdHasher>;
+
+  /**
+   * @brief 页帧管理器的一个分片
+   * @details 分片之间没有任何共享的数据，所以每个分片的操作只需要加自己的锁
+   */
+  struct FrameShard
+  {
+    std::mutex                     lock;
+    FrameTable                     frames;
+    std::unique_ptr<FrameReplacer> replacer;
+    std::vector<Frame *>           free_frames;    ///< 空闲的页帧
+    int                            total_num = 0;  ///< 分到这个分片的页帧个数
+    FrameReplacerStats             stats;
+  };
+
+  Frame *alloc_free_frame(FrameShard &shard);
+  void   release_frame(FrameShard &shard, Frame *frame);
+
+  FrameShard &shard_of(const FrameId &frame_id);
+
+  Frame *get_internal(FrameShard &shard, const FrameId &frame_id);
+  void   put_internal(FrameShard &shard, const FrameId &frame_id, Frame *frame);
+  RC     free_internal(FrameShard &shard, const FrameId &frame_id, Frame *frame);
+
+private:
+  std::string                              tag_;
+  std::string                              replacer_name_;
+  FrameArena                               arena_;
+  std::vector<std::unique_ptr<FrameShard>> shards_;
+};
+
+/**
+ * @brief 文件的页面分配位图
+ * @ingroup BufferPool
+ * @details 页头中的位图管理最前面 BPFileHeader::HEADER_MAP_PAGE_NUM 个页面，这是第0组页面。
+ * 文件再大时，之后每 GROUP_PAGE_NUM 个页面是一组，每组的第一个页面是位图页，存放这一组页面的分配位图：
+ * @code
+ * | page0(header + bitmap) | ... | map page 1 | ... GROUP_PAGE_NUM - 1 pages ... | map page 2 | ...
+ * @endcode
+ * 位图页的位置是固定的，不需要在页头中记录，原来的文件也不需要做任何转换。
+ * 内存中还记录了每一组的空闲页面个数，分配页面时直接跳过已经满了的组；在位图中查找时按照64位的字比较，
+ * 跳过整个字都已分配或者都未分配的区域。
+ * 位图本身放在一直 pin 在内存中的页帧上，这个对象只保存指针，可以复制一份给 BufferPoolIterator 使用。
+ */
+class BPPageMap
+{
+public:
+  static constexpr int GROUP_PAGE_NUM = BP_PAGE_DATA_SIZE * 8;  ///< 一个位图页管理的页面个数，包括位图页自己
+
+  /**
+   * @brief 使用页头中的位图初始化，之前添加的组都会清除
+   */
+  void reset(BPFileHeader *header);
+
+  /**
+   * @brief 添加下一组页面的位图
+   * @param bits 位图页的数据
+   */
+  void add_group(char *bits);
+
+  int group_num() const { return static_cast<int>(groups_.size()); }
+
+  static int     group_of(PageNum page_num);
+  static PageNum group_start(int group);
+  static int     group_size(int group);
+
+  /**
+   * @brief 页面是否是某一组的位图页。第0组的位图在页头中，没有位图页
+   */
+  static bool is_map_page(PageNum page_num)
+  {
+    return page_num >= BPFileHeader::HEADER_MAP_PAGE_NUM &&
+           (page_num - BPFileHeader::HEADER_MAP_PAGE_NUM) % GROUP_PAGE_NUM == 0;
+  }
+
+  bool get(PageNum page_num) const;
+  void set(PageNum page_num);
+  void clear(PageNum page_num);
+
+  /**
+   * @brief 在 [start, end) 中查找下一个已经分配的页面，跳过位图页
+   * @return 没有找到时返回 -1
+   */
+  PageNum next_allocated(PageNum start, PageNum end) const;
+
+  /**
+   * @brief 查找第一个小于 end 的空闲页面
+   * @return 没有找到时返回 -1
+   */
+  PageNum first_free(PageNum end) const;
+
+private:
+  struct Group
+  {
+    char *bits     = nullptr;
+    int   free_num = 0;  ///< 这一组中还有多少个空闲的位置，包括文件还没有扩展到的部分
+  };
 
-  std::mutex     lock_;
-  FrameLruCache  frames_;
-  FrameAllocator allocator_;
+  std::vector<Group> groups_;
 };
 
 /**
  * @brief 用于遍历BufferPool中的所有页面
  * @ingroup BufferPool
+ * @details 开启预读后，连续调用 next 时会在后台提前读取后面的页面。预读窗口从 MIN_READ_AHEAD_PAGES
+ * 个页面开始，访问到上一个预读窗口的第一个页面时再预读下一个窗口。如果窗口中大部分页面本来就在内存中，
+ * 预读窗口减半，否则加倍，最多 BufferPoolParam::read_ahead_max_pages 个页面。
  */
 class BufferPoolIterator
 {
@@ -167,9 +380,28 @@ public:
   PageNum next();
   RC      reset();
 
+  /**
+   * @brief 是否开启预读。需要在 init 之后调用
+   */
+  void set_read_ahead(bool read_ahead) { read_ahead_ = read_ahead; }
+
+private:
+  void read_ahead();
+
 private:
-  common::Bitmap bitmap_;
-  PageNum        current_page_num_ = -1;
+  static constexpr int MIN_READ_AHEAD_PAGES = 4;  ///< 预读窗口最少多少个页面
+  static constexpr int SEQUENTIAL_THRESHOLD = 2;  ///< 连续访问多少个页面之后才开始预读
+
+  BPPageMap       page_map_;
+  PageNum         page_count_       = 0;  ///< init 时文件的页面个数，之后新分配的页面不会遍历到
+  PageNum         current_page_num_ = -1;
+  DiskBufferPool *buffer_pool_      = nullptr;
+
+  bool    read_ahead_         = false;
+  int     sequential_count_   = 0;   ///< 连续调用了多少次 next
+  int     read_ahead_window_  = MIN_READ_AHEAD_PAGES;
+  PageNum read_ahead_trigger_ = -1;  ///< 访问到这个页面时预读下一个窗口
+  PageNum read_ahead_until_   = -1;  ///< 已经预读到哪个页面了
 };
 
 /**
@@ -199,6 +431,8 @@ public:
 
   /**
    * 根据文件ID和页号获取指定页面到缓冲区，返回页面句柄指针。
+   * @details 页面已经在缓冲区中时只会访问页帧管理器，不加文件锁。页面不在缓冲区时，
+   * 同一个页面只会有一个线程从磁盘读取，其它线程等待读取完成；不同页面可以并行读取。
    */
   RC get_this_page(PageNum page_num, Frame **frame);
 
@@ -247,16 +481,42 @@ public:
 
   /**
    * 刷新所有页面到磁盘，即使pin count不是0
+   * @details 使用 flush_frames 批量写回，最后对文件执行一次 fsync
    */
   RC flush_all_pages();
 
+  /**
+   * @brief 把一批页面批量写回磁盘
+   * @details 只写脏页。页面按照页号排序，页号连续的页面合并成一个写请求(pwritev)，所有的写请求
+   * 作为一批提交给 IO 后端。调用者需要保证页面都属于当前文件并且已经被 pin 住。
+   * 写盘时加着页面的读锁，避免写下去修改到一半的页面。加不上读锁的页面正在被修改，不需要 sync 时
+   * 先跳过，仍然是脏页，等下一次刷盘；需要 sync 时最后再一个一个地等锁写回。
+   * 文件头和位图页是在 lock_ 中修改的，写它们的时候加 lock_。
+   * @param frames 要写回的页面
+   * @param sync   写完之后是否对文件执行 fsync
+   */
+  RC flush_frames(const std::vector<Frame *> &frames, bool sync);
+
   /**
    * 回放日志时处理page0中已被认定为不存在的page
    */
   RC recover_page(PageNum page_num);
 
+  /**
+   * @brief 预读页面
+   * @details 不在缓冲区中的页面会先登记为正在读取，然后交给后台线程读取，连续的页面合并成一次读操作。
+   * 读取完成后页面留在缓冲区中，不会被 pin 住。预读完成之前访问这些页面的线程会等待预读完成。
+   * @param page_nums 需要预读的页面，按照页面编号从小到大排列
+   * @return int 实际发起读取的页面个数
+   */
+  int read_ahead(const std::vector<PageNum> &page_nums);
+
 protected:
-  RC allocate_frame(PageNum page_num, Frame **buf);
+  /**
+   * @brief 分配一个页帧，没有空闲页帧时会淘汰一些页面
+   * @param attach 是否放到页帧表中。参考 BPFrameManager::alloc_detached
+   */
+  RC allocate_frame(PageNum page_num, Frame **buf, bool attach = true);
 
   /**
    * 刷新指定页面到磁盘(flush)，并且释放关联的Frame
@@ -269,23 +529,82 @@ protected:
    */
   RC load_page(PageNum page_num, Frame *frame);
 
+  /**
+   * @brief 处理还没有写过的页面
+   * @details 扩展文件时只是预分配了空间(fallocate/ftruncate)，新分配的页面标记成脏页之后由后台写回，
+   * 文件头和位图可能比页面先写到磁盘上。这样的页面读出来是全0的，当作初始化好的空页面，补上页号和校验和
+   */
+  void init_unwritten_page(PageNum page_num, Page &page);
+
+  /**
+   * @brief 分配页帧并从磁盘读取页面，读取成功后才放入页帧表
+   * @details 调用者需要先把页面登记到 loading_pages_ 中，保证同一个页面只有一个线程在读取
+   */
+  RC load_page_into_frame(PageNum page_num, Frame **frame);
+
+  /**
+   * @brief 在后台线程中执行预读，参考 read_ahead
+   */
+  void do_read_ahead(const std::vector<PageNum> &page_nums);
+
+  /**
+   * @brief 把一批连续的页面读取到页帧中，页帧已经按照页面编号排好序
+   */
+  RC load_contiguous_pages(const std::vector<Frame *> &frames);
+
   /**
    * 如果页面是脏的，就将数据刷新到磁盘
    */
   RC flush_page_internal(Frame &frame);
 
+  /**
+   * @brief 把一批页面合并成写请求批量写回磁盘，不执行 fsync
+   * @details 调用者要保证写盘期间没有其它线程修改这些页面，比如加着页面的读锁。参考 flush_frames
+   */
+  RC flush_frames_internal(const std::vector<Frame *> &frames);
+
+  /**
+   * @brief 保证文件的长度能够放下 page_num 这个页面
+   * @details 文件不够长时按照 extent 扩展，使用 fallocate 预先分配磁盘空间，需要在 lock_ 中调用
+   */
+  RC extend_file(PageNum page_num);
+
+  /**
+   * @brief 读取一个位图页，位图页一直 pin 在内存中，直到关闭文件
+   */
+  RC load_map_page(PageNum page_num);
+
+  /**
+   * @brief 在文件的末尾创建一个新的位图页，需要在 lock_ 中调用
+   */
+  RC create_map_page(PageNum page_num);
+
+  /**
+   * @brief 修改了页面的分配状态之后，标记保存对应位图的页面为脏页
+   */
+  void mark_map_dirty(PageNum page_num);
+
 private:
   BufferPoolManager &bp_manager_;
   BPFrameManager    &frame_manager_;
 
-  std::string       file_name_;
-  int               file_desc_   = -1;
-  Frame            *hdr_frame_   = nullptr;
-  BPFileHeader     *file_header_ = nullptr;
-  std::set<PageNum> disposed_pages_;
+  std::string          file_name_;
+  int                  file_desc_   = -1;
+  Frame               *hdr_frame_   = nullptr;
+  BPFileHeader        *file_header_ = nullptr;
+  std::set<PageNum>    disposed_pages_;
+  PageNum              file_pages_ = 0;  ///< 文件实际能放下多少个页面，[page_count, file_pages_) 是预分配好的空间
+  BPPageMap            page_map_;        ///< 页面分配位图，在 lock_ 中修改
+  std::vector<Frame *> map_frames_;      ///< 第1组开始每一组的位图页，下标是组号减1
 
   common::Mutex lock_;
 
+  /// 正在从磁盘读取的页面。读取同一个页面的其它线程在 io_cond_ 上等待读取完成
+  std::mutex                  io_lock_;
+  std::condition_variable     io_cond_;
+  std::unordered_set<PageNum> loading_pages_;
+  int                         read_ahead_tasks_ = 0;  ///< 还没有执行完的预读任务，关闭文件时要等它们结束
+
 private:
   friend class BufferPoolIterator;
 };
@@ -297,7 +616,7 @@ private:
 class BufferPoolManager
 {
 public:
-  BufferPoolManager(int memory_size = 0);
+  BufferPoolManager(const BufferPoolParam &param = BufferPoolParam());
   ~BufferPoolManager();
 
   RC create_file(const char *file_name);
@@ -306,14 +625,86 @@ public:
 
   RC flush_page(Frame &frame);
 
+  /**
+   * @brief 批量写回一批页面，页面可以属于不同的文件
+   * @details 按照文件分组之后调用每个文件的 DiskBufferPool::flush_frames
+   */
+  RC flush_frames(const std::vector<Frame *> &frames, bool sync);
+
+  /**
+   * @brief 唤醒页面清理线程
+   * @details 前台线程淘汰页面时不得不同步刷脏页，说明干净的页帧不够用了
+   */
+  void wake_up_page_cleaner();
+
+  /**
+   * @brief 页面清理线程 pin 住页面到刷盘结束都持有这个锁
+   * @details 关闭文件时需要先拿到这个锁，保证没有页面被清理线程 pin 着，否则这些页面没办法释放
+   */
+  std::mutex &page_clean_lock() { return page_clean_lock_; }
+
+  /**
+   * @brief 把预读任务交给后台线程执行
+   * @return 没有开启预读或者提交失败时返回 false，这时任务不会被执行
+   */
+  bool execute_read_ahead(const std::function<void()> &task);
+  bool read_ahead_enabled() const { return read_ahead_executor_ != nullptr; }
+  int  read_ahead_max_pages() const { return param_.read_ahead_max_pages; }
+
+  bool direct_io() const { return param_.direct_io; }
+  int  extent_pages() const { return param_.extent_pages; }
+
+  /**
+   * @brief 为日志检查点做准备，返回恢复时需要从哪个LSN开始重做
+   * @details 模糊检查点，不会阻塞其它线程修改页面。先写回上一次检查点时就已经是脏页的页面，
+   * 然后计算所有脏页中最小的 rec lsn，最后对所有文件执行 fsync，保证已经写回的页面都已经落盘。
+   * 调用之前需要先把日志刷到磁盘。
+   * @param current_lsn 当前日志的下一个LSN，下一次检查点时用作新变脏页面的 rec lsn
+   * @param[out] recovery_lsn 恢复时需要从这个LSN开始重做。没有脏页时就是 current_lsn
+   */
+  RC checkpoint(LSN current_lsn, LSN &recovery_lsn);
+
 public:
   static void               set_instance(BufferPoolManager *bpm);  // TODO 优化全局变量的表示方法
   static BufferPoolManager &instance();
 
 private:
-  BPFrameManager frame_manager_{"BufPool"};
+  RC   start_page_cleaner();
+  void stop_page_cleaner();
+  void page_cleaner_routine();
+
+  /**
+   * @brief 把LRU尾部的脏页刷到磁盘，让每个分片都有足够的干净页帧可以直接淘汰
+   */
+  void clean_pages();
+
+  /**
+   * @brief 根据文件描述符找到对应的 DiskBufferPool，并增加它的引用计数
+   * @details 读写文件不能持有 lock_：淘汰页面时会持有 DiskBufferPool 的锁来刷其它文件的页面，
+   * 持有 lock_ 再去拿 DiskBufferPool 的锁就可能死锁。所以在 lock_ 中找到文件并增加引用计数，
+   * 释放 lock_ 之后再读写，用完调用 release_buffer_pool。close_file 会等到引用计数变成0才删除它
+   * @return 文件没有打开时返回 nullptr
+   */
+  DiskBufferPool *acquire_buffer_pool(int fd);
+  void            release_buffer_pool(DiskBufferPool *bp);
+
+private:
+  BufferPoolParam param_;
+  BPFrameManager  frame_manager_{"BufPool"};
+
+  std::thread            *page_cleaner_         = nullptr;
+  bool                    page_cleaner_stopped_ = false;
+  std::mutex              page_cleaner_lock_;  ///< 配合 page_cleaner_cond_ 使用
+  std::condition_variable page_cleaner_cond_;
+  std::mutex              page_clean_lock_;
+
+  LSN checkpoint_lsn_ = 0;  ///< 上一次检查点时日志的LSN，在 page_clean_lock_ 中访问
+
+  common::ThreadPoolExecutor *read_ahead_executor_ = nullptr;
 
   common::Mutex                                     lock_;
   std::unordered_map<std::string, DiskBufferPool *> buffer_pools_;
   std::unordered_map<int, DiskBufferPool *>         fd_buffer_pools_;
+  std::unordered_map<DiskBufferPool *, int>         buffer_pool_refs_;  ///< 参考 acquire_buffer_pool
+  std::condition_variable_any                       buffer_pool_cond_;  ///< 引用计数变成0时通知 close_file
 };
@@ -62,31 +62,47 @@ private:
 class Frame
 {
 public:
+  Frame() = default;
   ~Frame()
   {
     // LOG_DEBUG("deallocate frame. this=%p, lbt=%s", this, common::lbt());
   }
 
+  Frame(const Frame &)            = delete;
+  Frame &operator=(const Frame &) = delete;
+
   /**
    * @brief reinit 和 reset 在 MemPoolSimple 中使用
    * @details 在 MemPoolSimple 分配和释放一个Frame对象时，不会调用构造函数和析构函数，
    * 而是调用reinit和reset。
    */
   void reinit() {}
-  void reset() {}
+  void reset()
+  {
+    read_ahead_ = false;
+    rec_lsn_    = BP_INVALID_LSN;
+    flushed_version_.store(dirty_version_.load());
+  }
+
+  void clear_page() { memset(page_, 0, sizeof(Page)); }
 
-  void clear_page() { memset(&page_, 0, sizeof(page_)); }
+  /**
+   * @brief 设置页帧使用的页面内存
+   * @details 页面的内存与 Frame 对象分开存放，由 FrameArena 统一申请和释放，按照 BP_PAGE_ALIGN 对齐，
+   * 可以直接用于 O_DIRECT 读写。
+   */
+  void set_page(Page *page) { page_ = page; }
 
   int      file_desc() const { return file_desc_; }
   void     set_file_desc(int fd) { file_desc_ = fd; }
-  Page    &page() { return page_; }
-  PageNum  page_num() const { return page_.page_num; }
-  void     set_page_num(PageNum page_num) { page_.page_num = page_num; }
-  FrameId  frame_id() const { return FrameId(file_desc_, page_.page_num); }
-  LSN      lsn() const { return page_.lsn; }
-  void     set_lsn(LSN lsn) { page_.lsn = lsn; }
-  CheckSum check_sum() const { return page_.check_sum; }
-  void     set_check_sum(CheckSum check_sum) { page_.check_sum = check_sum; }
+  Page    &page() { return *page_; }
+  PageNum  page_num() const { return page_->page_num; }
+  void     set_page_num(PageNum page_num) { page_->page_num = page_num; }
+  FrameId  frame_id() const { return FrameId(file_desc_, page_->page_num); }
+  LSN      lsn() const { return page_->lsn; }
+  void     set_lsn(LSN lsn) { page_->lsn = lsn; }
+  CheckSum check_sum() const { return page_->check_sum; }
+  void     set_check_sum(CheckSum check_sum) { page_->check_sum = check_sum; }
 
   /// 刷新访问时间 TODO touch is better?
   void access();
@@ -95,11 +111,43 @@ public:
    * @brief 标记指定页面为“脏”页。如果修改了页面的内容，则应调用此函数，
    * 以便该页面被淘汰出缓冲区时系统将新的页面数据写入磁盘文件
    */
-  void mark_dirty() { dirty_ = true; }
-  void clear_dirty() { dirty_ = false; }
-  bool dirty() const { return dirty_; }
+  void mark_dirty() { dirty_version_.fetch_add(1, std::memory_order_acq_rel); }
+  bool dirty() const
+  {
+    return dirty_version_.load(std::memory_order_acquire) != flushed_version_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief 开始把页面写回磁盘，返回页面当前的修改版本
+   * @details 写盘期间页面仍然是脏页，写成功之后再用返回的版本调用 finish_flush。
+   * 调用者要加着页面的读锁，或者确认没有其它线程在修改这个页面，否则写下去的可能是修改到一半的数据。
+   */
+  uint64_t begin_flush() const { return dirty_version_.load(std::memory_order_acquire); }
+
+  /**
+   * @brief 页面已经写回磁盘
+   * @details 只有写盘期间没有新的修改，页面才会变成干净的，同时清除 rec_lsn。否则页面仍然是脏页，
+   * rec_lsn 也保留下来，等下一次刷盘
+   * @param version begin_flush 返回的版本
+   */
+  void finish_flush(uint64_t version);
+
+  /**
+   * @brief 恢复这个页面时需要从哪个LSN开始重做日志
+   * @details 修改页面时并不知道对应日志的LSN，所以由检查点在发现页面变脏之后设置，保守地取上一次
+   * 检查点时日志的LSN，页面写回磁盘之后清除。参考 BufferPoolManager::checkpoint
+   */
+  LSN  rec_lsn() const { return rec_lsn_.load(); }
+  void set_rec_lsn(LSN lsn) { rec_lsn_.store(lsn); }
+
+  char *data() { return page_->data; }
 
-  char *data() { return page_.data; }
+  /**
+   * @brief 页面是否是预读进来的，并且还没有被访问过
+   * @details 在页帧管理器分片的锁内访问，用来统计预读的页面有多少被用到了
+   */
+  bool read_ahead() const { return read_ahead_; }
+  void set_read_ahead(bool read_ahead) { read_ahead_ = read_ahead; }
 
   bool can_purge() { return pin_count_.load() == 0; }
 
@@ -129,20 +177,50 @@ public:
   void read_unlatch();
   void read_unlatch(intptr_t xid);
 
+  /**
+   * @brief 乐观读：记下页面当前的版本号，不加锁
+   * @details 每次加写锁和释放写锁时版本号都会加1，所以版本号是奇数表示有人正在修改这个页面，这时返回 false。
+   * 乐观读期间读到的数据可能是不一致的，使用之前要通过 optimistic_read_validate 确认页面没有被修改过。
+   * 调用者需要一直 pin 着这个页面，否则页帧可能被淘汰后用于其它页面，版本号就没有意义了。
+   */
+  bool optimistic_read_begin(uint64_t &version) const
+  {
+    version = version_.load(std::memory_order_acquire);
+    return (version & 1) == 0;
+  }
+
+  /**
+   * @brief 检查从 optimistic_read_begin 之后页面有没有被修改过
+   */
+  bool optimistic_read_validate(uint64_t version) const
+  {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   friend std::string to_string(const Frame &frame);
 
 private:
   friend class BufferPool;
 
-  bool             dirty_ = false;
+  /// 每次 mark_dirty 修改版本加1，写回磁盘之后记到 flushed_version_ 中，两者不相等就是脏页。
+  /// 刷盘和修改页面可能同时进行，用版本而不是一个标记，才不会把写盘期间的修改也当作已经写回了
+  std::atomic<uint64_t> dirty_version_{0};
+  std::atomic<uint64_t> flushed_version_{0};
+
+  bool             read_ahead_ = false;
   std::atomic<int> pin_count_{0};
+  std::atomic<LSN> rec_lsn_{BP_INVALID_LSN};
   unsigned long    acc_time_  = 0;
   int              file_desc_ = -1;
-  Page             page_;
+  Page            *page_      = nullptr;  ///< 页面内存，参考 set_page
 
   /// 在非并发编译时，加锁解锁动作将什么都不做
   common::RecursiveSharedMutex lock_;
 
+  std::atomic<uint64_t> version_{0};      ///< 页面版本号，参考 optimistic_read_begin
+  int                   write_depth_ = 0;  ///< 写锁重入的次数，只有持有写锁的线程访问
+
   /// 使用一些手段来做测试，提前检测出头疼的死锁问题
   /// 如果编译时没有增加调试选项，这些代码什么都不做
   common::DebugMutex                debug_lock_;
@@ -0,0 +1,290 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <errno.h>
+#include <fstream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+#include "storage/buffer/frame_arena.h"
+#include "common/lang/string.h"
+#include "common/log/log.h"
+#include "storage/buffer/frame.h"
+
+using namespace std;
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+static constexpr int    HUGE_PAGE_2M_SHIFT = 21;
+static constexpr int    HUGE_PAGE_1G_SHIFT = 30;
+static constexpr size_t THP_SIZE           = 1UL << HUGE_PAGE_2M_SHIFT;
+
+static size_t align_up(size_t size, size_t align) { return (size + align - 1) / align * align; }
+
+bool parse_numa_nodes(const char *nodes, vector<int> &node_ids)
+{
+  node_ids.clear();
+  const char *p = nodes;
+  while (*p != '\0') {
+    while (*p == ' ' || *p == ',' || *p == '\n') {
+      p++;
+    }
+    if (*p == '\0') {
+      break;
+    }
+
+    char *end   = nullptr;
+    long  first = strtol(p, &end, 10);
+    if (end == p || first < 0) {
+      return false;
+    }
+
+    long last = first;
+    p         = end;
+    if (*p == '-') {
+      p++;
+      last = strtol(p, &end, 10);
+      if (end == p || last < first) {
+        return false;
+      }
+      p = end;
+    }
+
+    for (long id = first; id <= last; id++) {
+      node_ids.push_back(static_cast<int>(id));
+    }
+  }
+  return !node_ids.empty();
+}
+
+FrameArena::~FrameArena()
+{
+  frames_.reset();
+  if (memory_ != nullptr) {
+    munmap(memory_, memory_size_);
+    memory_ = nullptr;
+  }
+}
+
+RC FrameArena::init(int frame_num, const char *huge_page, const char *numa_policy, const char *numa_nodes)
+{
+  if (frames_) {
+    LOG_WARN("frame arena has been initialized");
+    return RC::INTERNAL;
+  }
+
+  if (frame_num <= 0) {
+    LOG_WARN("invalid frame num: %d", frame_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  RC rc = map_memory(static_cast<size_t>(frame_num) * sizeof(Page), huge_page);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // NUMA 策略需要在访问内存之前设置，否则物理页面已经分配好了
+  rc = apply_numa_policy(numa_policy, numa_nodes);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to apply numa policy, ignore it. policy=%s, nodes=%s, rc=%s",
+             numa_policy, numa_nodes, strrc(rc));
+  }
+
+  prefault();
+
+  frames_.reset(new Frame[frame_num]);
+  frame_num_  = frame_num;
+  Page *pages = reinterpret_cast<Page *>(memory_);
+  for (int i = 0; i < frame_num; i++) {
+    frames_[i].set_page(&pages[i]);
+  }
+
+  LOG_INFO("frame arena init done. frame num=%d, memory size=%ld, huge page=%s, numa policy=%s",
+           frame_num_, memory_size_, huge_page_, numa_policy == nullptr ? "none" : numa_policy);
+  return RC::SUCCESS;
+}
+
+Frame *FrameArena::frame(int index)
+{
+  if (index < 0 || index >= frame_num_) {
+    return nullptr;
+  }
+  return &frames_[index];
+}
+
+RC FrameArena::map_memory(size_t size, const char *huge_page)
+{
+  if (nullptr == huge_page || common::is_blank(huge_page)) {
+    huge_page = "auto";
+  }
+
+  const bool is_auto = 0 == strcasecmp(huge_page, "auto");
+
+  // 指定的大页申请不到时，依次尝试更小的大页
+  bool try_1g  = is_auto ? size >= (1UL << HUGE_PAGE_1G_SHIFT) : 0 == strcasecmp(huge_page, "1g");
+  bool try_2m  = is_auto || try_1g || 0 == strcasecmp(huge_page, "2m");
+  bool try_thp = try_2m || 0 == strcasecmp(huge_page, "thp");
+  if (!try_thp && 0 != strcasecmp(huge_page, "none")) {
+    LOG_WARN("unknown huge page type: %s, use none instead", huge_page);
+  }
+
+  if (try_1g && map_hugetlb(size, HUGE_PAGE_1G_SHIFT)) {
+    huge_page_ = "1g";
+    return RC::SUCCESS;
+  }
+
+  if (try_2m && map_hugetlb(size, HUGE_PAGE_2M_SHIFT)) {
+    huge_page_ = "2m";
+    return RC::SUCCESS;
+  }
+
+  if (map_normal(size, try_thp)) {
+    huge_page_ = try_thp ? "thp" : "none";
+    return RC::SUCCESS;
+  }
+
+  LOG_ERROR("failed to allocate memory for frames. size=%ld, error=%s", size, strerror(errno));
+  return RC::NOMEM;
+}
+
+bool FrameArena::map_hugetlb(size_t size, int huge_page_shift)
+{
+#ifdef MAP_HUGETLB
+  const size_t map_size = align_up(size, 1UL << huge_page_shift);
+
+  void *memory = mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (huge_page_shift << MAP_HUGE_SHIFT), -1, 0);
+  if (memory == MAP_FAILED) {
+    LOG_INFO("cannot allocate huge pages. huge page size=%ld, size=%ld, error=%s",
+             1UL << huge_page_shift, map_size, strerror(errno));
+    return false;
+  }
+
+  memory_      = static_cast<char *>(memory);
+  memory_size_ = map_size;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool FrameArena::map_normal(size_t size, bool transparent_huge_page)
+{
+  if (!transparent_huge_page) {
+    const size_t map_size = align_up(size, getpagesize());
+    void *memory = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+      return false;
+    }
+
+    memory_      = static_cast<char *>(memory);
+    memory_size_ = map_size;
+    return true;
+  }
+
+  // 透明大页需要虚拟地址按照大页对齐，多申请一个大页，再把首尾多余的部分释放掉
+  const size_t map_size = align_up(size, THP_SIZE);
+  void *memory = mmap(nullptr, map_size + THP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    return false;
+  }
+
+  char *begin   = static_cast<char *>(memory);
+  char *aligned = reinterpret_cast<char *>(align_up(reinterpret_cast<uintptr_t>(begin), THP_SIZE));
+  if (aligned > begin) {
+    munmap(begin, aligned - begin);
+  }
+  char *end = begin + map_size + THP_SIZE;
+  if (end > aligned + map_size) {
+    munmap(aligned + map_size, end - (aligned + map_size));
+  }
+
+#ifdef MADV_HUGEPAGE
+  if (madvise(aligned, map_size, MADV_HUGEPAGE) != 0) {
+    LOG_INFO("failed to enable transparent huge page. error=%s", strerror(errno));
+  }
+#endif
+
+  memory_      = aligned;
+  memory_size_ = map_size;
+  return true;
+}
+
+RC FrameArena::apply_numa_policy(const char *numa_policy, const char *numa_nodes)
+{
+  if (nullptr == numa_policy || common::is_blank(numa_policy) || 0 == strcasecmp(numa_policy, "none")) {
+    return RC::SUCCESS;
+  }
+
+#ifdef __linux__
+  int mode = 0;
+  if (0 == strcasecmp(numa_policy, "interleave")) {
+    mode = MPOL_INTERLEAVE;
+  } else if (0 == strcasecmp(numa_policy, "bind")) {
+    mode = MPOL_BIND;
+  } else {
+    LOG_WARN("unknown numa policy: %s", numa_policy);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  string nodes;
+  if (numa_nodes != nullptr && !common::is_blank(numa_nodes)) {
+    nodes = numa_nodes;
+  } else {
+    ifstream online("/sys/devices/system/node/online");
+    getline(online, nodes);
+  }
+
+  vector<int> node_ids;
+  if (!parse_numa_nodes(nodes.c_str(), node_ids)) {
+    LOG_WARN("invalid numa nodes: '%s'", nodes.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int             bits_per_long = sizeof(unsigned long) * 8;
+  const int             max_node      = *std::max_element(node_ids.begin(), node_ids.end());
+  vector<unsigned long> node_mask(max_node / bits_per_long + 1, 0);
+  for (int node_id : node_ids) {
+    node_mask[node_id / bits_per_long] |= 1UL << (node_id % bits_per_long);
+  }
+
+  // 不依赖 libnuma，直接使用系统调用。maxnode 需要比掩码的位数多1
+  const unsigned long max_node_bits = node_mask.size() * bits_per_long + 1;
+  if (syscall(SYS_mbind, memory_, memory_size_, mode, node_mask.data(), max_node_bits, 0) != 0) {
+    LOG_WARN("failed to set numa policy. policy=%s, nodes=%s, error=%s", numa_policy, nodes.c_str(), strerror(errno));
+    return RC::INTERNAL;
+  }
+
+  LOG_INFO("set numa policy of frame arena. policy=%s, nodes=%s", numa_policy, nodes.c_str());
+  return RC::SUCCESS;
+#else
+  LOG_WARN("numa policy is not supported on this platform");
+  return RC::UNIMPLENMENT;
+#endif
+}
+
+void FrameArena::prefault()
+{
+  const size_t page_size = getpagesize();
+  for (size_t offset = 0; offset < memory_size_; offset += page_size) {
+    reinterpret_cast<volatile char *>(memory_)[offset] = 0;
+  }
+}
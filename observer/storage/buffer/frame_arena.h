@@ -0,0 +1,103 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "common/rc.h"
+
+class Frame;
+struct Page;
+
+/**
+ * @brief 页帧使用的内存
+ * @ingroup BufferPool
+ * @details 所有的页帧在启动时一次性申请，之后不再增加也不会释放。
+ * 页帧头(Frame 对象，包含锁、pin count等)放在一个数组中，页面数据放在另一块连续的内存中。
+ * 页帧头比较小并且访问频繁，集中存放对CPU缓存更友好；页面数据所在的内存可以使用大页来减少
+ * TLB miss，也可以按照 NUMA 策略分布在多个节点上。
+ *
+ * 大页的类型(huge_page)：
+ * - none 不使用大页
+ * - thp 使用透明大页(madvise MADV_HUGEPAGE)
+ * - 2m/1g 使用 hugetlbfs 的 2MB/1GB 大页，需要系统预留了足够的大页(vm.nr_hugepages)
+ * - auto 依次尝试 1g(内存不小于1GB时)、2m、thp
+ * 申请失败时会依次退化成更小的大页，最后使用普通的内存。
+ *
+ * NUMA 策略(numa_policy)：
+ * - none 不设置，按照操作系统默认的策略(通常是首次访问的线程所在的节点)
+ * - interleave 页面数据交错分布在 numa_nodes 指定的节点上
+ * - bind 页面数据只分配在 numa_nodes 指定的节点上
+ * numa_nodes 的格式与 /sys/devices/system/node/online 相同，比如 "0-1,3"，为空表示所有节点。
+ */
+class FrameArena
+{
+public:
+  FrameArena() = default;
+  ~FrameArena();
+
+  RC init(int frame_num, const char *huge_page, const char *numa_policy, const char *numa_nodes);
+
+  int    frame_num() const { return frame_num_; }
+  Frame *frame(int index);
+
+  /**
+   * @brief 页面数据实际占用的内存大小，按照大页对齐之后的
+   */
+  size_t memory_size() const { return memory_size_; }
+
+  /**
+   * @brief 实际使用的大页类型
+   */
+  const char *huge_page() const { return huge_page_; }
+
+private:
+  /**
+   * @brief 申请页面数据使用的内存
+   */
+  RC map_memory(size_t size, const char *huge_page);
+
+  /**
+   * @brief 使用 hugetlbfs 的大页申请内存
+   * @param huge_page_shift 大页大小以2为底的对数，比如 2MB 是 21
+   */
+  bool map_hugetlb(size_t size, int huge_page_shift);
+
+  /**
+   * @brief 申请普通内存，按照透明大页的大小对齐
+   */
+  bool map_normal(size_t size, bool transparent_huge_page);
+
+  RC apply_numa_policy(const char *numa_policy, const char *numa_nodes);
+
+  /**
+   * @brief 提前访问一遍所有的内存，让操作系统在启动时就分配好物理内存
+   */
+  void prefault();
+
+private:
+  std::unique_ptr<Frame[]> frames_;
+  int                      frame_num_ = 0;
+
+  char       *memory_      = nullptr;
+  size_t      memory_size_ = 0;
+  const char *huge_page_   = "none";
+};
+
+/**
+ * @brief 解析节点列表，格式与 /sys/devices/system/node/online 相同，比如 "0-1,3"
+ * @ingroup BufferPool
+ * @return 格式不对时返回 false
+ */
+bool parse_numa_nodes(const char *nodes, std::vector<int> &node_ids);
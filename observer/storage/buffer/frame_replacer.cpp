@@ -0,0 +1,248 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <sstream>
+#include <string.h>
+
+#include "storage/buffer/frame_replacer.h"
+#include "common/lang/string.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+FrameReplacerStats &FrameReplacerStats::operator+=(const FrameReplacerStats &other)
+{
+  hit_count += other.hit_count;
+  miss_count += other.miss_count;
+  evict_count += other.evict_count;
+  read_ahead_count += other.read_ahead_count;
+  read_ahead_used_count += other.read_ahead_used_count;
+  read_ahead_wasted_count += other.read_ahead_wasted_count;
+  return *this;
+}
+
+string FrameReplacerStats::to_string() const
+{
+  const uint64_t access_count = hit_count + miss_count;
+  const double   hit_ratio    = access_count == 0 ? 0 : static_cast<double>(hit_count) / access_count;
+
+  stringstream ss;
+  ss << "hit:" << hit_count << ", miss:" << miss_count << ", evict:" << evict_count << ", hit ratio:" << hit_ratio
+     << ", read ahead:" << read_ahead_count << ", read ahead used:" << read_ahead_used_count
+     << ", read ahead wasted:" << read_ahead_wasted_count;
+  return ss.str();
+}
+
+FrameReplacer *FrameReplacer::create(const char *name, int lru_k)
+{
+  const char *default_name = "lru";
+  if (nullptr == name || common::is_blank(name)) {
+    name = default_name;
+  }
+
+  if (0 == strcasecmp(name, default_name)) {
+    return new LruFrameReplacer();
+  } else if (0 == strcasecmp(name, "lru-k")) {
+    return new LruKFrameReplacer(lru_k);
+  } else if (0 == strcasecmp(name, "clock")) {
+    return new ClockFrameReplacer();
+  } else {
+    LOG_ERROR("unknown frame replacer: %s", name);
+    return nullptr;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LruFrameReplacer::insert(Frame *frame)
+{
+  lru_list_.push_front(frame);
+  positions_[frame] = lru_list_.begin();
+}
+
+void LruFrameReplacer::access(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter == positions_.end()) {
+    insert(frame);
+    return;
+  }
+
+  lru_list_.splice(lru_list_.begin(), lru_list_, iter->second);
+}
+
+void LruFrameReplacer::remove(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter == positions_.end()) {
+    return;
+  }
+
+  lru_list_.erase(iter->second);
+  positions_.erase(iter);
+}
+
+void LruFrameReplacer::foreach_victim(function<bool(Frame *)> visitor)
+{
+  for (auto iter = lru_list_.rbegin(); iter != lru_list_.rend(); ++iter) {
+    if (!visitor(*iter)) {
+      break;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+LruKFrameReplacer::LruKFrameReplacer(int k) : k_(k)
+{
+  if (k_ <= 0) {
+    LOG_WARN("invalid k of lru-k replacer: %d, use 2 instead", k_);
+    k_ = 2;
+  }
+}
+
+LruKFrameReplacer::VictimKey LruKFrameReplacer::victim_key(Frame *frame, const History &history) const
+{
+  // 访问次数不足K次的页面，倒数第K次访问的时间可以认为是无穷远，所以排在前面，它们之间按照最近访问时间排序
+  if (static_cast<int>(history.access_times.size()) < k_) {
+    return VictimKey(false, history.access_times.front(), frame);
+  }
+  return VictimKey(true, history.access_times.back(), frame);
+}
+
+void LruKFrameReplacer::record_access(Frame *frame, History &history)
+{
+  if (!history.access_times.empty()) {
+    victims_.erase(history.key);
+  }
+
+  history.access_times.push_front(++current_time_);
+  if (static_cast<int>(history.access_times.size()) > k_) {
+    history.access_times.pop_back();
+  }
+
+  history.key = victim_key(frame, history);
+  victims_.insert(history.key);
+}
+
+void LruKFrameReplacer::insert(Frame *frame)
+{
+  History &history = histories_[frame];
+  record_access(frame, history);
+}
+
+void LruKFrameReplacer::access(Frame *frame) { insert(frame); }
+
+void LruKFrameReplacer::remove(Frame *frame)
+{
+  auto iter = histories_.find(frame);
+  if (iter == histories_.end()) {
+    return;
+  }
+
+  victims_.erase(iter->second.key);
+  histories_.erase(iter);
+}
+
+void LruKFrameReplacer::foreach_victim(function<bool(Frame *)> visitor)
+{
+  for (const VictimKey &key : victims_) {
+    if (!visitor(std::get<2>(key))) {
+      break;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ClockFrameReplacer::insert(Frame *frame)
+{
+  // 新的页帧放在时钟指针的后面，也就是转一圈之后才会检查到它
+  ClockRing::iterator iter = ring_.insert(hand_, ClockEntry{frame, true});
+  if (hand_ == ring_.end()) {
+    hand_ = iter;
+  }
+  positions_[frame] = iter;
+}
+
+void ClockFrameReplacer::access(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter == positions_.end()) {
+    insert(frame);
+    return;
+  }
+
+  iter->second->referenced = true;
+}
+
+void ClockFrameReplacer::remove(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter == positions_.end()) {
+    return;
+  }
+
+  if (hand_ == iter->second) {
+    ++hand_;
+    if (hand_ == ring_.end()) {
+      hand_ = ring_.begin();
+    }
+  }
+
+  ring_.erase(iter->second);
+  positions_.erase(iter);
+  if (ring_.empty()) {
+    hand_ = ring_.end();
+  }
+}
+
+void ClockFrameReplacer::foreach_victim(function<bool(Frame *)> visitor)
+{
+  // 最多转两圈：第一圈清除所有的访问标记，第二圈一定能看到所有的页帧
+  const size_t max_steps = ring_.size() * 2;
+  for (size_t step = 0; step < max_steps; step++) {
+    ClockEntry &entry = *hand_;
+
+    ++hand_;
+    if (hand_ == ring_.end()) {
+      hand_ = ring_.begin();
+    }
+
+    if (entry.referenced) {
+      entry.referenced = false;
+      continue;
+    }
+
+    if (!visitor(entry.frame)) {
+      break;
+    }
+  }
+}
+
+void ClockFrameReplacer::peek_victims(function<bool(Frame *)> visitor)
+{
+  if (ring_.empty()) {
+    return;
+  }
+
+  // 不清除访问标记也不移动时钟指针，按照 foreach_victim 会给出的顺序遍历：
+  // 先是从指针开始没有访问标记的页帧，然后是有访问标记的页帧(它们要等标记被清除之后才会被淘汰)
+  for (bool referenced : {false, true}) {
+    ClockRing::iterator iter = hand_;
+    for (size_t step = 0; step < ring_.size(); step++) {
+      if (iter->referenced == referenced && !visitor(iter->frame)) {
+        return;
+      }
+
+      ++iter;
+      if (iter == ring_.end()) {
+        iter = ring_.begin();
+      }
+    }
+  }
+}
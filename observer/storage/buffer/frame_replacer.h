@@ -0,0 +1,182 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+class Frame;
+
+/**
+ * @brief 页面淘汰策略的统计信息
+ * @ingroup BufferPool
+ */
+struct FrameReplacerStats
+{
+  uint64_t hit_count   = 0;  ///< 访问页面时页面已经在内存中的次数
+  uint64_t miss_count  = 0;  ///< 访问页面时需要从磁盘加载的次数
+  uint64_t evict_count = 0;  ///< 淘汰页面的次数
+
+  uint64_t read_ahead_count        = 0;  ///< 预读进来的页面个数
+  uint64_t read_ahead_used_count   = 0;  ///< 预读进来并且被访问过的页面个数
+  uint64_t read_ahead_wasted_count = 0;  ///< 预读进来但是直到被淘汰都没有访问过的页面个数
+
+  FrameReplacerStats &operator+=(const FrameReplacerStats &other);
+
+  std::string to_string() const;
+};
+
+/**
+ * @brief 页面淘汰策略
+ * @ingroup BufferPool
+ * @details 页帧管理器的每个分片都有一个淘汰策略对象，在分片的锁内访问，所以这里不需要考虑并发。
+ * 淘汰策略只负责记录页帧的访问情况并给出淘汰的顺序，页帧能不能淘汰(比如是否被pin住)由调用者判断。
+ * 可以通过配置项 BUFFER_POOL.REPLACER 在启动时选择使用哪个策略，参考 FrameReplacer::create。
+ */
+class FrameReplacer
+{
+public:
+  virtual ~FrameReplacer() = default;
+
+  virtual const char *name() const = 0;
+
+  /**
+   * @brief 页帧放入页帧表时调用，也算作一次访问
+   */
+  virtual void insert(Frame *frame) = 0;
+
+  /**
+   * @brief 页帧被访问时调用
+   */
+  virtual void access(Frame *frame) = 0;
+
+  /**
+   * @brief 页帧从页帧表中删除时调用
+   */
+  virtual void remove(Frame *frame) = 0;
+
+  /**
+   * @brief 按照淘汰的优先级从高到低遍历页帧
+   * @param visitor 返回 false 时停止遍历
+   */
+  virtual void foreach_victim(std::function<bool(Frame *)> visitor) = 0;
+
+  /**
+   * @brief 与 foreach_victim 一样按照淘汰的优先级遍历页帧，但是不会修改淘汰策略的状态
+   * @details 只是看一看哪些页面将要被淘汰时使用，比如页面清理线程找脏页、淘汰时先找干净的页面。
+   * 默认实现直接调用 foreach_victim，适用于遍历时本来就不修改状态的策略
+   * @param visitor 返回 false 时停止遍历
+   */
+  virtual void peek_victims(std::function<bool(Frame *)> visitor) { foreach_victim(visitor); }
+
+public:
+  /**
+   * @brief 根据名字创建淘汰策略
+   * @param name 策略名字，支持 lru、lru-k 和 clock，为空时使用 lru
+   * @param lru_k LRU-K 策略中的 K
+   * @return 名字不认识时返回 nullptr
+   */
+  static FrameReplacer *create(const char *name, int lru_k);
+};
+
+/**
+ * @brief 最近最少使用淘汰策略
+ * @ingroup BufferPool
+ */
+class LruFrameReplacer : public FrameReplacer
+{
+public:
+  const char *name() const override { return "lru"; }
+
+  void insert(Frame *frame) override;
+  void access(Frame *frame) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(std::function<bool(Frame *)> visitor) override;
+
+private:
+  std::list<Frame *>                                    lru_list_;  ///< 头部是最近访问的页帧
+  std::unordered_map<Frame *, std::list<Frame *>::iterator> positions_;
+};
+
+/**
+ * @brief LRU-K 淘汰策略
+ * @ingroup BufferPool
+ * @details 按照倒数第K次访问的时间淘汰页面，访问次数不足K次的页面优先淘汰，它们之间按照最近一次访问
+ * 的时间淘汰。全表扫描时每个页面通常只访问一次，不会把多次访问过的热点页面(比如B+树的内部节点)淘汰出去。
+ */
+class LruKFrameReplacer : public FrameReplacer
+{
+public:
+  explicit LruKFrameReplacer(int k);
+
+  const char *name() const override { return "lru-k"; }
+
+  void insert(Frame *frame) override;
+  void access(Frame *frame) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(std::function<bool(Frame *)> visitor) override;
+
+private:
+  /// 淘汰顺序：访问次数是否已经达到K次、时间戳、页帧。set 中越靠前越先淘汰
+  using VictimKey = std::tuple<bool, uint64_t, Frame *>;
+
+  struct History
+  {
+    std::list<uint64_t> access_times;  ///< 最近K次的访问时间，头部是最近一次
+    VictimKey           key;
+  };
+
+  void      record_access(Frame *frame, History &history);
+  VictimKey victim_key(Frame *frame, const History &history) const;
+
+private:
+  int                                   k_            = 2;
+  uint64_t                              current_time_ = 0;  ///< 逻辑时钟，每次访问加1
+  std::unordered_map<Frame *, History> histories_;
+  std::set<VictimKey>                  victims_;
+};
+
+/**
+ * @brief 时钟(CLOCK)淘汰策略
+ * @ingroup BufferPool
+ * @details 所有页帧组成一个环，每个页帧有一个访问标记，访问时置位。查找淘汰页面时，时钟指针沿着环移动，
+ * 遇到有访问标记的页帧就清除标记继续移动(给它第二次机会)，遇到没有访问标记的页帧就把它作为候选。
+ */
+class ClockFrameReplacer : public FrameReplacer
+{
+public:
+  const char *name() const override { return "clock"; }
+
+  void insert(Frame *frame) override;
+  void access(Frame *frame) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(std::function<bool(Frame *)> visitor) override;
+  void peek_victims(std::function<bool(Frame *)> visitor) override;
+
+private:
+  struct ClockEntry
+  {
+    Frame *frame      = nullptr;
+    bool   referenced = false;
+  };
+
+  using ClockRing = std::list<ClockEntry>;
+
+  ClockRing                                       ring_;
+  ClockRing::iterator                             hand_ = ring_.end();
+  std::unordered_map<Frame *, ClockRing::iterator> positions_;
+};
@@ -21,16 +21,23 @@ using TrxID = int32_t;
 
 static constexpr int BP_INVALID_PAGE_NUM = -1;
 
+/// 无效的LSN。日志分配的LSN从1开始
+static constexpr LSN BP_INVALID_LSN = -1;
+
 static constexpr PageNum BP_HEADER_PAGE = 0;
 
 static constexpr const int BP_PAGE_SIZE      = (1 << 13);
 static constexpr const int BP_PAGE_DATA_SIZE = (BP_PAGE_SIZE - sizeof(PageNum) - sizeof(LSN) - sizeof(CheckSum));
 
+/// 页面内存的对齐要求。使用 O_DIRECT 读写文件时，内存地址、文件偏移和长度都需要按照块大小对齐
+static constexpr const int BP_PAGE_ALIGN = 4096;
+static_assert(BP_PAGE_SIZE % BP_PAGE_ALIGN == 0, "page size must be a multiple of page alignment");
+
 /**
  * @brief 表示一个页面，可能放在内存或磁盘上
  * @ingroup BufferPool
  */
-struct Page
+struct alignas(BP_PAGE_ALIGN) Page
 {
   PageNum  page_num;
   LSN      lsn;
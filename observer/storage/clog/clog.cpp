@@ -12,23 +12,52 @@ See the Mulan PSL v2 for more details. */
 // Created by huhaosheng.hhs on 2022
 //
 
+#include <algorithm>
 #include <sstream>
+#include <stdlib.h>
+#include <sys/stat.h>
 #include <vector>
 
 #include "common/global_context.h"
 #include "common/io/io.h"
+#include "common/lang/string.h"
 #include "common/log/log.h"
+#include "common/math/crc.h"
+#include "common/os/path.h"
+#include "common/thread/thread_util.h"
+#include "storage/buffer/disk_buffer_pool.h"
 #include "storage/clog/clog.h"
+#include "storage/io/io_backend.h"
 #include "storage/trx/trx.h"
 
 using namespace std;
 using namespace common;
 
 /**
- * @brief 当前的日志使用固定的文件名，而且就这一个文件
+ * @brief 日志文件名的前缀。日志文件的名字是 clog.<LSN>，没有后缀的 clog 是旧版本只有一个文件时的日志
  */
 const char *CLOG_FILE_NAME = "clog";
 
+static constexpr const char *CLOG_SEGMENT_FILE_PATTERN = "^clog\\.[0-9]+$";
+
+/**
+ * @brief 记录检查点的文件名
+ */
+static constexpr const char *CLOG_CHECKPOINT_FILE_NAME = "clog_checkpoint";
+
+/**
+ * @brief 检查点文件的内容
+ */
+struct CLogCheckpointMeta
+{
+  static constexpr int32_t MAGIC = 0x434b5054;  // "CKPT"
+
+  int32_t  magic          = MAGIC;
+  LSN      checkpoint_lsn = BP_INVALID_LSN;  ///< CHECKPOINT 日志的LSN
+  LSN      recovery_lsn   = BP_INVALID_LSN;  ///< 恢复时从这个LSN开始重做
+  CheckSum check_sum      = 0;               ///< 前面几个字段的校验和
+};
+
 const char *clog_type_name(CLogType type)
 {
 #define DEFINE_CLOG_TYPE(name) \
@@ -65,6 +94,15 @@ string CLogRecordCommitData::to_string() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+string CLogRecordCheckpointData::to_string() const
+{
+  stringstream ss;
+  ss << "recovery_lsn:" << recovery_lsn_;
+  return ss.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 const int32_t CLogRecordData::HEADER_SIZE = sizeof(CLogRecordData) - sizeof(CLogRecordData::data_);
 
 CLogRecordData::~CLogRecordData()
@@ -107,6 +145,18 @@ CLogRecord *CLogRecord::build_commit_record(int32_t trx_id, int32_t commit_xid)
   return log_record;
 }
 
+CLogRecord *CLogRecord::build_checkpoint_record(LSN recovery_lsn)
+{
+  CLogRecord       *log_record = new CLogRecord();
+  CLogRecordHeader &header     = log_record->header_;
+  header.type_                 = clog_type_to_integer(CLogType::CHECKPOINT);
+  header.logrec_len_           = sizeof(CLogRecordCheckpointData);
+
+  CLogRecordCheckpointData &checkpoint_record = log_record->checkpoint_record();
+  checkpoint_record.recovery_lsn_             = recovery_lsn;
+  return log_record;
+}
+
 CLogRecord *CLogRecord::build_data_record(CLogType type, int32_t trx_id, int32_t table_id, const RID &rid,
     int32_t data_len, int32_t data_offset, const char *data)
 {
@@ -152,6 +202,12 @@ CLogRecord *CLogRecord::build(const CLogRecordHeader &header, char *data)
     memcpy(reinterpret_cast<void *>(&commit_record), data, sizeof(CLogRecordCommitData));
 
     LOG_DEBUG("got a commit record %s", log_record->to_string().c_str());
+  } else if (header.type_ == clog_type_to_integer(CLogType::CHECKPOINT)) {
+    ASSERT(header.logrec_len_ == sizeof(CLogRecordCheckpointData), "invalid length of checkpoint. expect %d, got %d",
+           sizeof(CLogRecordCheckpointData), header.logrec_len_);
+
+    CLogRecordCheckpointData &checkpoint_record = log_record->checkpoint_record();
+    memcpy(reinterpret_cast<void *>(&checkpoint_record), data, sizeof(CLogRecordCheckpointData));
   } else {
     /// 当前日志拥有数据，但是不是COMMIT，就认为是普通的修改数据的日志，简单粗暴
     CLogRecordData &data_record = log_record->data_record();
@@ -173,6 +229,8 @@ string CLogRecord::to_string() const
     return header_.to_string();
   } else if (header_.type_ == clog_type_to_integer(CLogType::MTR_COMMIT)) {
     return header_.to_string() + ", " + commit_record().to_string();
+  } else if (header_.type_ == clog_type_to_integer(CLogType::CHECKPOINT)) {
+    return header_.to_string() + ", " + checkpoint_record().to_string();
   } else {
     return header_.to_string() + ", " + data_record().to_string();
   }
@@ -185,7 +243,7 @@ CLogBuffer::CLogBuffer() {}
 
 CLogBuffer::~CLogBuffer() {}
 
-RC CLogBuffer::append_log_record(CLogRecord *log_record)
+RC CLogBuffer::append_log_record(CLogRecord *log_record, LSN &lsn)
 {
   if (nullptr == log_record) {
     return RC::INVALID_ARGUMENT;
@@ -197,52 +255,75 @@ RC CLogBuffer::append_log_record(CLogRecord *log_record)
   }
 
   lock_guard<Mutex> lock_guard(lock_);
+  log_record->header().lsn_ = ++current_lsn_;
+  lsn                       = current_lsn_;
   log_records_.emplace_back(log_record);
   total_size_ += log_record->logrec_len();
   LOG_DEBUG("append log. log_record={%s}", log_record->to_string().c_str());
   return RC::SUCCESS;
 }
 
-RC CLogBuffer::flush_buffer(CLogFile &log_file)
+LSN CLogBuffer::current_lsn()
 {
-  RC  rc    = RC::SUCCESS;
-  int count = 0;
-  while (!log_records_.empty()) {
-    lock_.lock();
-    if (log_records_.empty()) {
-      lock_.unlock();
-      return RC::SUCCESS;
-    }
+  lock_guard<Mutex> guard(lock_);
+  return current_lsn_;
+}
 
-    // log buffer 需要支持并发，所以要考虑加锁
-    // 从队列中取出日志记录然后写入到文件中
-    unique_ptr<CLogRecord> log_record = std::move(log_records_.front());
-    log_records_.pop_front();
+void CLogBuffer::set_current_lsn(LSN lsn)
+{
+  lock_guard<Mutex> guard(lock_);
+  current_lsn_ = lsn;
+}
 
-    rc = write_log_record(log_file, log_record.get());
-    // 当前无法处理日志写不完整的情况，所以直接粗暴退出
-    ASSERT(rc == RC::SUCCESS, "failed to write log record. log_record=%s, rc=%s",
-           log_record->to_string().c_str(), strrc(rc));
+RC CLogBuffer::flush_buffer(CLogFile &log_file)
+{
+  // 其它线程正在刷日志时需要等待，否则返回时不能保证之前加入的日志已经落盘
+  lock_guard<Mutex> flush_guard(flush_lock_);
+
+  // log buffer 需要支持并发，所以要考虑加锁
+  // 一次取出当前所有的日志记录，写文件时不再持有锁，不影响其它线程追加日志
+  deque<unique_ptr<CLogRecord>> log_records;
+  {
+    lock_guard<Mutex> guard(lock_);
+    log_records.swap(log_records_);
+  }
 
-    lock_.unlock();
-    total_size_ -= log_record->logrec_len();
-    count++;
+  if (log_records.empty()) {
+    return RC::SUCCESS;
   }
 
-  LOG_WARN("flush log buffer done. write log record number=%d", count);
-  return log_file.sync();
+  int32_t      records_size = 0;
+  vector<char> buffer;
+  for (unique_ptr<CLogRecord> &log_record : log_records) {
+    serialize_log_record(log_record.get(), buffer);
+    records_size += log_record->logrec_len();
+  }
+
+  // 一批日志写在同一个文件中，文件名就是这一批日志的第一个LSN
+  RC rc = log_file.roll_segment_if_need(log_records.front()->header().lsn_);
+  ASSERT(rc == RC::SUCCESS, "failed to switch log file. rc=%s", strrc(rc));
+
+  rc = log_file.write_and_sync(buffer.data(), static_cast<int>(buffer.size()));
+  // 当前无法处理日志写不完整的情况，所以直接粗暴退出
+  ASSERT(rc == RC::SUCCESS, "failed to write log records. record number=%d, size=%d, rc=%s",
+         static_cast<int>(log_records.size()), static_cast<int>(buffer.size()), strrc(rc));
+
+  total_size_ -= records_size;
+  LOG_DEBUG("flush log buffer done. write log record number=%d, size=%d",
+            static_cast<int>(log_records.size()), static_cast<int>(buffer.size()));
+  return rc;
 }
 
-RC CLogBuffer::write_log_record(CLogFile &log_file, CLogRecord *log_record)
+void CLogBuffer::serialize_log_record(CLogRecord *log_record, vector<char> &buffer)
 {
   // TODO 看起来每种类型的日志自己实现 serialize 接口更好一点
-  const CLogRecordHeader &header = log_record->header();
+  auto append = [&buffer](const void *data, int len) {
+    const char *begin = static_cast<const char *>(data);
+    buffer.insert(buffer.end(), begin, begin + len);
+  };
 
-  RC rc = log_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
-  if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to write log record header. size=%d, rc=%s", sizeof(header), strrc(rc));
-    return rc;
-  }
+  const CLogRecordHeader &header = log_record->header();
+  append(&header, sizeof(header));
 
   switch (log_record->log_type()) {
     case CLogType::MTR_BEGIN:
@@ -251,47 +332,83 @@ RC CLogBuffer::write_log_record(CLogFile &log_file, CLogRecord *log_record)
     } break;
 
     case CLogType::MTR_COMMIT: {
-      rc = log_file.write(
-          reinterpret_cast<const char *>(&log_record->commit_record()), log_record->header().logrec_len_);
+      append(&log_record->commit_record(), log_record->header().logrec_len_);
     } break;
 
-    default: {
-      rc = log_file.write(reinterpret_cast<const char *>(&log_record->data_record()), CLogRecordData::HEADER_SIZE);
-      if (OB_FAIL(rc)) {
-        LOG_WARN("failed to write data record header. size=%d, rc=%s", CLogRecordData::HEADER_SIZE, strrc(rc));
-        return rc;
-      }
+    case CLogType::CHECKPOINT: {
+      append(&log_record->checkpoint_record(), log_record->header().logrec_len_);
+    } break;
 
-      rc = log_file.write(log_record->data_record().data_, log_record->data_record().data_len_);
-      if (OB_FAIL(rc)) {
-        LOG_WARN("failed to write log data. size=%d, rc=%s", log_record->data_record().data_len_, strrc(rc));
-        return rc;
-      }
+    default: {
+      append(&log_record->data_record(), CLogRecordData::HEADER_SIZE);
+      append(log_record->data_record().data_, log_record->data_record().data_len_);
     } break;
   }
-
-  return rc;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-RC CLogFile::init(const char *path)
+RC CLogFile::init(const char *path, int64_t segment_size)
 {
-  RC rc = RC::SUCCESS;
+  path_         = path;
+  segment_size_ = segment_size;
+
+  // 旧版本的日志只有一个叫做 clog 的文件，把它当作第一个日志文件
+  std::string legacy_file_path = path_ + common::FILE_PATH_SPLIT_STR + CLOG_FILE_NAME;
+  std::string first_file_path  = path_ + common::FILE_PATH_SPLIT_STR + CLOG_FILE_NAME + ".0";
+  if (access(legacy_file_path.c_str(), F_OK) == 0 && access(first_file_path.c_str(), F_OK) != 0) {
+    if (::rename(legacy_file_path.c_str(), first_file_path.c_str()) != 0) {
+      LOG_WARN("failed to rename legacy clog file. from=%s, to=%s, error=%s",
+               legacy_file_path.c_str(), first_file_path.c_str(), strerror(errno));
+      return RC::IOERR_ACCESS;
+    }
+    LOG_INFO("rename legacy clog file to %s", first_file_path.c_str());
+  }
 
-  std::string clog_file_path = std::string(path) + common::FILE_PATH_SPLIT_STR + CLOG_FILE_NAME;
+  vector<string> files;
+  int            ret = common::list_file(path_.c_str(), CLOG_SEGMENT_FILE_PATTERN, files);
+  if (ret < 0) {
+    LOG_WARN("failed to list clog files. path=%s", path_.c_str());
+    return RC::IOERR_READ;
+  }
+
+  for (const string &file : files) {
+    Segment segment;
+    segment.first_lsn = static_cast<LSN>(strtol(file.c_str() + strlen(CLOG_FILE_NAME) + 1, nullptr, 10));
+    segment.filename  = path_ + common::FILE_PATH_SPLIT_STR + file;
+    segments_.push_back(segment);
+  }
+  std::sort(segments_.begin(), segments_.end(), [](const Segment &left, const Segment &right) {
+    return left.first_lsn < right.first_lsn;
+  });
+
+  if (segments_.empty()) {
+    // 第一次写日志时再创建文件，那时才知道第一条日志的LSN
+    LOG_INFO("no clog file found. path=%s", path_.c_str());
+    return RC::SUCCESS;
+  }
 
-  int fd = ::open(clog_file_path.c_str(), O_RDWR | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR);
+  // 继续写最后一个文件
+  const Segment &last = segments_.back();
+  int fd = ::open(last.filename.c_str(), O_RDWR | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR);
   if (fd < 0) {
-    rc = RC::IOERR_OPEN;
-    LOG_WARN("failed to open clog file. filename=%s, error=%s", clog_file_path.c_str(), strerror(errno));
-    return rc;
+    LOG_WARN("failed to open clog file. filename=%s, error=%s", last.filename.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
   }
 
-  filename_ = clog_file_path;
-  fd_       = fd;
-  LOG_INFO("open clog file success. file=%s, fd=%d", filename_.c_str(), fd_);
-  return rc;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    LOG_WARN("failed to stat clog file. filename=%s, error=%s", last.filename.c_str(), strerror(errno));
+    ::close(fd);
+    return RC::IOERR_ACCESS;
+  }
+
+  filename_     = last.filename;
+  fd_           = fd;
+  write_offset_ = static_cast<int64_t>(st.st_size);
+  LOG_INFO("open clog file success. file=%s, fd=%d, size=%ld, segment num=%d",
+           filename_.c_str(), fd_, write_offset_, static_cast<int>(segments_.size()));
+  return RC::SUCCESS;
 }
 
 CLogFile::~CLogFile()
@@ -301,46 +418,170 @@ CLogFile::~CLogFile()
     ::close(fd_);
     fd_ = -1;
   }
+
+  if (read_fd_ >= 0) {
+    ::close(read_fd_);
+    read_fd_ = -1;
+  }
+}
+
+RC CLogFile::roll_segment_if_need(LSN first_lsn)
+{
+  if (fd_ >= 0 && write_offset_ < segment_size_) {
+    return RC::SUCCESS;
+  }
+
+  string filename = path_ + common::FILE_PATH_SPLIT_STR + CLOG_FILE_NAME + "." + std::to_string(first_lsn);
+  int    fd       = ::open(filename.c_str(), O_RDWR | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    LOG_WARN("failed to create clog file. filename=%s, error=%s", filename.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  // 新文件的目录项也需要落盘，否则宕机之后可能找不到这个文件
+  int dir_fd = ::open(path_.c_str(), O_RDONLY);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    ::close(dir_fd);
+  }
+
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+
+  LOG_INFO("switch clog file. old file=%s, old size=%ld, new file=%s", filename_.c_str(), write_offset_, filename.c_str());
+  filename_     = filename;
+  fd_           = fd;
+  write_offset_ = 0;
+
+  lock_guard<Mutex> guard(segment_lock_);
+  segments_.push_back(Segment{first_lsn, filename});
+  return RC::SUCCESS;
 }
 
 RC CLogFile::write(const char *data, int len)
 {
-  int ret = writen(fd_, data, len);
-  if (0 != ret) {
-    LOG_WARN("failed to write data to file. filename=%s, data len=%d, error=%s", filename_.c_str(), len, strerror(ret));
-    return RC::IOERR_WRITE;
+  // 文件使用 O_APPEND 打开，数据总是写在文件尾，write_offset_ 与文件尾保持一致
+  RC rc = IoBackend::instance().write(fd_, data, len, write_offset_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write data to file. filename=%s, data len=%d, rc=%s", filename_.c_str(), len, strrc(rc));
+    return rc;
+  }
+  write_offset_ += len;
+  return RC::SUCCESS;
+}
+
+RC CLogFile::write_and_sync(const char *data, int len)
+{
+  RC rc = IoBackend::instance().write_and_sync(fd_, data, len, write_offset_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write and sync data to file. filename=%s, data len=%d, rc=%s",
+             filename_.c_str(), len, strrc(rc));
+    return rc;
   }
+  write_offset_ += len;
+  return RC::SUCCESS;
+}
+
+RC CLogFile::seek(LSN lsn)
+{
+  size_t index = 0;
+  for (size_t i = 1; i < segments_.size(); i++) {
+    if (segments_[i].first_lsn > lsn) {
+      break;
+    }
+    index = i;
+  }
+  return open_segment_for_read(index);
+}
+
+RC CLogFile::open_segment_for_read(size_t index)
+{
+  if (read_fd_ >= 0) {
+    ::close(read_fd_);
+    read_fd_ = -1;
+  }
+
+  read_segment_ = index;
+  eof_          = false;
+  if (index >= segments_.size()) {
+    eof_ = true;
+    return RC::RECORD_EOF;
+  }
+
+  const string &filename = segments_[index].filename;
+  read_fd_               = ::open(filename.c_str(), O_RDONLY);
+  if (read_fd_ < 0) {
+    LOG_WARN("failed to open clog file for read. filename=%s, error=%s", filename.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  LOG_INFO("begin to read clog file %s", filename.c_str());
   return RC::SUCCESS;
 }
 
 RC CLogFile::read(char *data, int len)
 {
-  int ret = readn(fd_, data, len);
+  if (read_fd_ < 0) {
+    eof_ = true;
+    return RC::IOERR_READ;
+  }
+
+  int ret = readn(read_fd_, data, len);
   if (ret != 0) {
     if (ret == -1) {
       eof_ = true;
-      LOG_TRACE("file read touch eof. filename=%s", filename_.c_str());
+      LOG_TRACE("file read touch eof. filename=%s", segments_[read_segment_].filename.c_str());
     } else {
-      LOG_WARN("failed to read data from file. file=%s, data len=%d, error=%s", filename_.c_str(), len, strerror(ret));
+      LOG_WARN("failed to read data from file. file=%s, data len=%d, error=%s",
+               segments_[read_segment_].filename.c_str(), len, strerror(ret));
     }
     return RC::IOERR_READ;
   }
   return RC::SUCCESS;
 }
 
+RC CLogFile::next_segment() { return open_segment_for_read(read_segment_ + 1); }
+
 RC CLogFile::sync()
 {
-  int ret = fsync(fd_);
-  if (ret != 0) {
-    LOG_WARN("failed to sync file. file=%s, error=%s", filename_.c_str(), strerror(errno));
-    return RC::IOERR_SYNC;
+  RC rc = IoBackend::instance().sync(fd_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to sync file. file=%s, rc=%s", filename_.c_str(), strrc(rc));
+    return rc;
   }
   return RC::SUCCESS;
 }
 
+RC CLogFile::truncate(LSN lsn)
+{
+  vector<string> files_to_remove;
+  {
+    lock_guard<Mutex> guard(segment_lock_);
+    // 下一个文件的第一个LSN不大于 lsn，说明这个文件中的日志都比 lsn 小。最后一个文件正在写，不删除
+    size_t remove_num = 0;
+    while (remove_num + 1 < segments_.size() && segments_[remove_num + 1].first_lsn <= lsn) {
+      files_to_remove.push_back(segments_[remove_num].filename);
+      remove_num++;
+    }
+    segments_.erase(segments_.begin(), segments_.begin() + remove_num);
+  }
+
+  RC rc = RC::SUCCESS;
+  for (const string &filename : files_to_remove) {
+    if (::unlink(filename.c_str()) != 0) {
+      LOG_WARN("failed to remove clog file. filename=%s, error=%s", filename.c_str(), strerror(errno));
+      rc = RC::IOERR_ACCESS;
+      continue;
+    }
+    LOG_INFO("remove clog file %s, all log records in it are older than lsn %d", filename.c_str(), lsn);
+  }
+  return rc;
+}
+
 RC CLogFile::offset(int64_t &off) const
 {
-  off_t pos = lseek(fd_, 0, SEEK_CUR);
+  off_t pos = lseek(read_fd_, 0, SEEK_CUR);
   if (pos == -1) {
     LOG_WARN("failed to seek. error=%s", strerror(errno));
     return RC::IOERR_SEEK;
@@ -366,13 +607,18 @@ RC CLogRecordIterator::next()
 
   CLogRecordHeader header;
   RC               rc = log_file_->read(reinterpret_cast<char *>(&header), sizeof(header));
-  if (rc != RC::SUCCESS) {
-    if (log_file_->eof()) {
-      return RC::RECORD_EOF;
+  while (rc != RC::SUCCESS) {
+    if (!log_file_->eof()) {
+      LOG_WARN("failed to read log header. rc=%s", strrc(rc));
+      return rc;
     }
 
-    LOG_WARN("failed to read log header. rc=%s", strrc(rc));
-    return rc;
+    // 日志不会跨越文件，读完一个文件之后接着读下一个文件
+    rc = log_file_->next_segment();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    rc = log_file_->read(reinterpret_cast<char *>(&header), sizeof(header));
   }
 
   char   *data        = nullptr;
@@ -401,15 +647,26 @@ const CLogRecord &CLogRecordIterator::log_record() { return *log_record_; }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-RC CLogManager::init(const char *path)
+RC CLogManager::init(const char *path, const CLogParam &param /* = CLogParam() */)
 {
-  log_buffer_ = new CLogBuffer();
-  log_file_   = new CLogFile();
-  return log_file_->init(path);
+  param_           = param;
+  checkpoint_file_ = string(path) + common::FILE_PATH_SPLIT_STR + CLOG_CHECKPOINT_FILE_NAME;
+  log_buffer_      = new CLogBuffer();
+  log_file_        = new CLogFile();
+
+  RC rc = log_file_->init(path, param_.segment_size);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init clog file. path=%s, rc=%s", path, strrc(rc));
+    return rc;
+  }
+
+  return read_checkpoint_meta();
 }
 
 CLogManager::~CLogManager()
 {
+  stop_checkpointer();
+
   if (log_buffer_) {
     delete log_buffer_;
     log_buffer_ = nullptr;
@@ -459,15 +716,264 @@ RC CLogManager::append_log(CLogRecord *log_record)
   if (nullptr == log_record) {
     return RC::INVALID_ARGUMENT;
   }
-  return log_buffer_->append_log_record(log_record);
+
+  // 加入缓存之后日志随时可能被刷盘线程释放，先把需要的信息取出来
+  const CLogType type   = log_record->log_type();
+  const int32_t  trx_id = log_record->trx_id();
+
+  LSN lsn = BP_INVALID_LSN;
+  RC  rc  = log_buffer_->append_log_record(log_record, lsn);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  switch (type) {
+    case CLogType::MTR_BEGIN: {
+      lock_guard<Mutex> guard(trx_lock_);
+      active_trxes_[trx_id] = lsn;
+    } break;
+
+    case CLogType::MTR_COMMIT:
+    case CLogType::MTR_ROLLBACK: {
+      lock_guard<Mutex> guard(trx_lock_);
+      auto              iter = active_trxes_.find(trx_id);
+      if (iter != active_trxes_.end()) {
+        finished_trxes_.emplace_back(iter->second, lsn);
+        active_trxes_.erase(iter);
+      }
+    } break;
+
+    default: {
+    } break;
+  }
+  return RC::SUCCESS;
 }
 
 RC CLogManager::sync() { return log_buffer_->flush_buffer(*log_file_); }
 
+LSN CLogManager::trx_recovery_lsn(LSN recovery_lsn)
+{
+  lock_guard<Mutex> guard(trx_lock_);
+  for (const auto &[trx_id, begin_lsn] : active_trxes_) {
+    recovery_lsn = std::min(recovery_lsn, begin_lsn);
+  }
+
+  // 恢复起点之后才结束的事务，需要从它的开始位置重做。起点向前移动之后可能又会包含其它事务，直到不再变化
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const auto &[begin_lsn, end_lsn] : finished_trxes_) {
+      if (end_lsn >= recovery_lsn && begin_lsn < recovery_lsn) {
+        recovery_lsn = begin_lsn;
+        changed      = true;
+      }
+    }
+  }
+
+  // 以后检查点的恢复起点不会比这次更小，在它之前就结束的事务不再需要记录
+  finished_trxes_.erase(std::remove_if(finished_trxes_.begin(), finished_trxes_.end(),
+      [recovery_lsn](const pair<LSN, LSN> &trx_lsn) { return trx_lsn.second < recovery_lsn; }),
+      finished_trxes_.end());
+  return recovery_lsn;
+}
+
+RC CLogManager::checkpoint()
+{
+  lock_guard<mutex> checkpoint_guard(checkpoint_lock_);
+
+  BufferPoolManager *bpm = GCTX.buffer_pool_manager_;
+  if (nullptr == bpm) {
+    LOG_WARN("cannot do checkpoint without buffer pool manager");
+    return RC::INTERNAL;
+  }
+
+  // 写回页面之前先把日志刷到磁盘，已经写到磁盘上的修改都能找到对应的日志
+  RC rc = sync();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to sync log before checkpoint. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  const LSN current_lsn  = log_buffer_->current_lsn() + 1;
+  LSN       recovery_lsn = current_lsn;
+  rc                     = bpm->checkpoint(current_lsn, recovery_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to checkpoint buffer pool. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  recovery_lsn = trx_recovery_lsn(recovery_lsn);
+
+  CLogRecord *log_record     = CLogRecord::build_checkpoint_record(recovery_lsn);
+  LSN         checkpoint_lsn = BP_INVALID_LSN;
+  rc                         = log_buffer_->append_log_record(log_record, checkpoint_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to append checkpoint log. rc=%s", strrc(rc));
+    delete log_record;
+    return rc;
+  }
+
+  rc = sync();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to sync checkpoint log. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = write_checkpoint_meta(checkpoint_lsn, recovery_lsn);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 只有检查点文件落盘之后，才能删除恢复起点之前的日志
+  rc = log_file_->truncate(recovery_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to truncate clog files. recovery lsn=%d, rc=%s", recovery_lsn, strrc(rc));
+  }
+
+  LOG_INFO("checkpoint done. checkpoint lsn=%d, recovery lsn=%d", checkpoint_lsn, recovery_lsn);
+  return RC::SUCCESS;
+}
+
+RC CLogManager::read_checkpoint_meta()
+{
+  int fd = ::open(checkpoint_file_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      LOG_INFO("no checkpoint file, recover from the first log file. file=%s", checkpoint_file_.c_str());
+      return RC::SUCCESS;
+    }
+    LOG_WARN("failed to open checkpoint file. file=%s, error=%s", checkpoint_file_.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  CLogCheckpointMeta meta;
+  int                ret = readn(fd, reinterpret_cast<char *>(&meta), sizeof(meta));
+  ::close(fd);
+  if (ret != 0) {
+    LOG_WARN("failed to read checkpoint file. file=%s, ret=%d", checkpoint_file_.c_str(), ret);
+    return RC::IOERR_READ;
+  }
+
+  const CheckSum check_sum = crc32(reinterpret_cast<char *>(&meta), offsetof(CLogCheckpointMeta, check_sum));
+  if (meta.magic != CLogCheckpointMeta::MAGIC || meta.check_sum != check_sum) {
+    LOG_ERROR("invalid checkpoint file. file=%s, magic=%x, check sum=%u, expect=%u",
+              checkpoint_file_.c_str(), meta.magic, meta.check_sum, check_sum);
+    return RC::INTERNAL;
+  }
+
+  checkpoint_lsn_ = meta.checkpoint_lsn;
+  recovery_lsn_   = meta.recovery_lsn;
+  LOG_INFO("got checkpoint. checkpoint lsn=%d, recovery lsn=%d", checkpoint_lsn_, recovery_lsn_);
+  return RC::SUCCESS;
+}
+
+RC CLogManager::write_checkpoint_meta(LSN checkpoint_lsn, LSN recovery_lsn)
+{
+  CLogCheckpointMeta meta;
+  meta.checkpoint_lsn = checkpoint_lsn;
+  meta.recovery_lsn   = recovery_lsn;
+  meta.check_sum      = crc32(reinterpret_cast<char *>(&meta), offsetof(CLogCheckpointMeta, check_sum));
+
+  // 先写临时文件再改名，宕机时不会留下写了一半的检查点文件
+  string tmp_file = checkpoint_file_ + ".tmp";
+  int    fd       = ::open(tmp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    LOG_WARN("failed to create checkpoint file. file=%s, error=%s", tmp_file.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  int ret = writen(fd, reinterpret_cast<const char *>(&meta), sizeof(meta));
+  if (ret != 0 || fsync(fd) != 0) {
+    LOG_WARN("failed to write checkpoint file. file=%s, error=%s", tmp_file.c_str(), strerror(errno));
+    ::close(fd);
+    return RC::IOERR_WRITE;
+  }
+  ::close(fd);
+
+  if (::rename(tmp_file.c_str(), checkpoint_file_.c_str()) != 0) {
+    LOG_WARN("failed to rename checkpoint file. from=%s, to=%s, error=%s",
+             tmp_file.c_str(), checkpoint_file_.c_str(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+
+  string dir    = checkpoint_file_.substr(0, checkpoint_file_.find_last_of(common::FILE_PATH_SPLIT));
+  int    dir_fd = ::open(dir.c_str(), O_RDONLY);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    ::close(dir_fd);
+  }
+
+  checkpoint_lsn_ = checkpoint_lsn;
+  recovery_lsn_   = recovery_lsn;
+  return RC::SUCCESS;
+}
+
+RC CLogManager::start_checkpointer()
+{
+  if (param_.checkpoint_interval_ms <= 0 || checkpointer_ != nullptr) {
+    return RC::SUCCESS;
+  }
+
+  checkpointer_stopped_ = false;
+  checkpointer_         = new std::thread(&CLogManager::checkpointer_routine, this);
+  LOG_INFO("checkpointer started. interval=%dms", param_.checkpoint_interval_ms);
+  return RC::SUCCESS;
+}
+
+void CLogManager::stop_checkpointer()
+{
+  if (checkpointer_ == nullptr) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> guard(checkpointer_lock_);
+    checkpointer_stopped_ = true;
+  }
+  checkpointer_cond_.notify_all();
+
+  checkpointer_->join();
+  delete checkpointer_;
+  checkpointer_ = nullptr;
+  LOG_INFO("checkpointer stopped");
+}
+
+void CLogManager::checkpointer_routine()
+{
+  int ret = thread_set_name("Checkpointer");
+  if (ret != 0) {
+    LOG_WARN("failed to set thread name. ret = %d", ret);
+  }
+
+  unique_lock<mutex> guard(checkpointer_lock_);
+  while (!checkpointer_stopped_) {
+    checkpointer_cond_.wait_for(guard, std::chrono::milliseconds(param_.checkpoint_interval_ms));
+    if (checkpointer_stopped_) {
+      break;
+    }
+
+    guard.unlock();
+    RC rc = checkpoint();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to do checkpoint. rc=%s", strrc(rc));
+    }
+    guard.lock();
+  }
+}
+
 RC CLogManager::recover(Db *db)
 {
+  // 没有检查点时从第一个文件开始重做
+  const LSN start_lsn = recovery_lsn_ == BP_INVALID_LSN ? 0 : recovery_lsn_;
+
+  RC rc = log_file_->seek(start_lsn);
+  if (OB_FAIL(rc) && rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to seek clog file. lsn=%d, rc=%s", start_lsn, strrc(rc));
+    return rc;
+  }
+
   CLogRecordIterator log_record_iterator;
-  RC                 rc = log_record_iterator.init(*log_file_);
+  rc = log_record_iterator.init(*log_file_);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to init log record iterator. rc=%s", strrc(rc));
     return rc;
@@ -476,10 +982,31 @@ RC CLogManager::recover(Db *db)
   TrxKit *trx_manager = GCTX.trx_kit_;
   ASSERT(trx_manager != nullptr, "cannot do recover that trx_manager is null");
 
-  /// 遍历所有的日志，然后做redo
+  // 恢复起点之后的日志所属的事务，可能在恢复起点之前就开始了，这种事务在第一次遇到时创建
+  auto find_or_create_trx = [trx_manager](const CLogRecord &log_record) {
+    Trx *trx = trx_manager->find_trx(log_record.trx_id());
+    if (nullptr == trx) {
+      trx = trx_manager->create_trx(log_record.trx_id());
+    }
+    return trx;
+  };
+
+  LSN max_lsn    = std::max<LSN>(checkpoint_lsn_, 0);
+  int redo_count = 0;
+
+  /// 遍历恢复起点之后的日志，然后做redo
   // 在做redo时，需要记录处理的事务。在所有的日志都重做完成时，如果有事务没有结束，那这些事务就需要回滚
   for (rc = log_record_iterator.next(); OB_SUCC(rc) && log_record_iterator.valid(); rc = log_record_iterator.next()) {
     const CLogRecord &log_record = log_record_iterator.log_record();
+
+    // 旧版本的日志没有LSN，总是需要重做
+    if (log_record.lsn() != BP_INVALID_LSN && log_record.lsn() < start_lsn) {
+      continue;
+    }
+
+    max_lsn = std::max(max_lsn, log_record.lsn());
+    redo_count++;
+
     LOG_TRACE("begin to redo log={%s}", log_record.to_string().c_str());
     switch (log_record.log_type()) {
       case CLogType::MTR_BEGIN: {
@@ -490,9 +1017,13 @@ RC CLogManager::recover(Db *db)
         }
       } break;
 
+      case CLogType::CHECKPOINT: {
+        // 检查点日志只是一个标记，不需要重做
+      } break;
+
       case CLogType::MTR_COMMIT:
       case CLogType::MTR_ROLLBACK: {
-        Trx *trx = trx_manager->find_trx(log_record.trx_id());
+        Trx *trx = find_or_create_trx(log_record);
         if (nullptr == trx) {
           LOG_WARN("no such trx. trx id=%d, log_record={%s}", log_record.trx_id(), log_record.to_string().c_str());
           return RC::INTERNAL;
@@ -503,11 +1034,10 @@ RC CLogManager::recover(Db *db)
                    log_record.trx_id(), log_record.to_string().c_str(), strrc(rc));
           return rc;
         }
-
       } break;
 
       default: {
-        Trx *trx = GCTX.trx_kit_->find_trx(log_record.trx_id());
+        Trx *trx = find_or_create_trx(log_record);
         ASSERT(trx != nullptr,
               "cannot find such trx. trx id=%d, log_record={%s}",
               log_record.trx_id(), log_record.to_string().c_str());
@@ -530,7 +1060,9 @@ RC CLogManager::recover(Db *db)
     return rc;
   }
 
-  LOG_TRACE("recover redo log done");
+  // 新的日志接着已有日志的LSN继续分配
+  log_buffer_->set_current_lsn(max_lsn);
+  LOG_INFO("recover redo log done. start lsn=%d, redo log num=%d, max lsn=%d", start_lsn, redo_count, max_lsn);
 
   vector<Trx *> uncommitted_trxes;
   trx_manager->all_trxes(uncommitted_trxes);
@@ -15,15 +15,21 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <stddef.h>
 #include <stdint.h>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "common/lang/mutex.h"
+#include "common/types.h"
+#include "storage/buffer/page.h"
 #include "storage/persist/persist.h"
 #include "storage/record/record.h"
 
@@ -41,6 +47,16 @@ class Db;
  * 恢复数据库。
  */
 
+/**
+ * @brief 日志模块的参数
+ * @ingroup CLog
+ */
+struct CLogParam
+{
+  int     checkpoint_interval_ms = 30 * 1000;          ///< 后台检查点的周期(毫秒)，0 表示不启动检查点线程
+  int64_t segment_size           = 64L * 1024 * 1024;  ///< 日志文件超过这个大小之后写入新的文件
+};
+
 /**
  * @enum CLogType
  * @ingroup CLog
@@ -55,7 +71,9 @@ class Db;
   DEFINE_CLOG_TYPE(MTR_COMMIT)   \
   DEFINE_CLOG_TYPE(MTR_ROLLBACK) \
   DEFINE_CLOG_TYPE(INSERT)       \
-  DEFINE_CLOG_TYPE(DELETE)
+  DEFINE_CLOG_TYPE(DELETE)       \
+  DEFINE_CLOG_TYPE(CHECKPOINT)   \
+  DEFINE_CLOG_TYPE(DELETE_PAGE)
 
 enum class CLogType
 {
@@ -87,7 +105,7 @@ CLogType clog_type_from_integer(int32_t value);
  */
 struct CLogRecordHeader
 {
-  int32_t lsn_        = -1;                                     ///< log sequence number。当前没有使用
+  int32_t lsn_        = -1;                                     ///< log sequence number。追加到日志缓存时分配，单调递增
   int32_t trx_id_     = -1;                                     ///< 日志所属事务的编号
   int32_t type_       = clog_type_to_integer(CLogType::ERROR);  ///< 日志类型
   int32_t logrec_len_ = 0;                                      ///< record的长度，不包含header长度
@@ -114,6 +132,19 @@ struct CLogRecordCommitData
   std::string to_string() const;
 };
 
+/**
+ * @ingroup CLog
+ * @brief CHECKPOINT 日志的数据
+ */
+struct CLogRecordCheckpointData
+{
+  int32_t recovery_lsn_ = -1;  ///< 恢复时从这个LSN开始重做，更早的日志都不再需要
+
+  bool operator==(const CLogRecordCheckpointData &other) const { return recovery_lsn_ == other.recovery_lsn_; }
+
+  std::string to_string() const;
+};
+
 /**
  * @brief 有具体数据修改的事务日志数据
  * @ingroup CLog
@@ -173,6 +204,13 @@ public:
    */
   static CLogRecord *build_commit_record(int32_t trx_id, int32_t commit_xid);
 
+  /**
+   * @brief 创建一个检查点日志对象
+   *
+   * @param recovery_lsn 恢复时从这个LSN开始重做
+   */
+  static CLogRecord *build_checkpoint_record(LSN recovery_lsn);
+
   /**
    * @brief 创建一个表示数据操作的日志对象
    *
@@ -196,24 +234,28 @@ public:
   static CLogRecord *build(const CLogRecordHeader &header, char *data);
 
   CLogType log_type() const { return clog_type_from_integer(header_.type_); }
+  LSN      lsn() const { return header_.lsn_; }
   int32_t  trx_id() const { return header_.trx_id_; }
   int32_t  logrec_len() const { return header_.logrec_len_; }
 
-  CLogRecordHeader     &header() { return header_; }
-  CLogRecordCommitData &commit_record() { return commit_record_; }
-  CLogRecordData       &data_record() { return data_record_; }
+  CLogRecordHeader         &header() { return header_; }
+  CLogRecordCommitData     &commit_record() { return commit_record_; }
+  CLogRecordCheckpointData &checkpoint_record() { return checkpoint_record_; }
+  CLogRecordData           &data_record() { return data_record_; }
 
-  const CLogRecordHeader     &header() const { return header_; }
-  const CLogRecordCommitData &commit_record() const { return commit_record_; }
-  const CLogRecordData       &data_record() const { return data_record_; }
+  const CLogRecordHeader         &header() const { return header_; }
+  const CLogRecordCommitData     &commit_record() const { return commit_record_; }
+  const CLogRecordCheckpointData &checkpoint_record() const { return checkpoint_record_; }
+  const CLogRecordData           &data_record() const { return data_record_; }
 
   std::string to_string() const;
 
 protected:
   CLogRecordHeader header_;  ///< 日志头信息
 
-  CLogRecordData       data_record_;    ///< 如果日志操作的是数据，此结构生效
-  CLogRecordCommitData commit_record_;  ///< 如果是事务提交日志，此结构生效
+  CLogRecordData           data_record_;        ///< 如果日志操作的是数据，此结构生效
+  CLogRecordCommitData     commit_record_;      ///< 如果是事务提交日志，此结构生效
+  CLogRecordCheckpointData checkpoint_record_;  ///< 如果是检查点日志，此结构生效
 };
 
 /**
@@ -231,37 +273,51 @@ public:
 
   /**
    * @brief 增加一条日志
-   * @details 如果当前的日志达到一定量，就会刷新数据
+   * @details 如果当前的日志达到一定量，就会刷新数据。日志的LSN在这里分配，日志在缓存中按照LSN排列。
+   * @param log_record 日志记录，加入成功之后由 CLogBuffer 负责释放
+   * @param[out] lsn 分配给这条日志的LSN
+   */
+  RC append_log_record(CLogRecord *log_record, LSN &lsn);
+
+  /**
+   * @brief 最近一次分配的LSN
    */
-  RC append_log_record(CLogRecord *log_record);
+  LSN  current_lsn();
+  void set_current_lsn(LSN lsn);
 
   /**
    * @brief 将当前的日志都刷新到日志文件中
-   * @details 因为多线程访问与日志管理的问题，只能有一个线程调用此函数
+   * @details 一次取出当前所有的日志记录，序列化到一块连续的内存中，然后把写数据和 fsync
+   * 一起提交给 IO 后端，这样多个事务的日志只需要一次写入和一次 fsync。
+   * 同时只有一个线程在刷日志，flush_buffer 返回时，调用之前加入的日志一定已经落盘。
    * @param log_file 日志文件
    */
   RC flush_buffer(CLogFile &log_file);
 
 private:
   /**
-   * @brief 将日志记录写入到日志文件中
+   * @brief 将日志记录序列化追加到 buffer 中
    *
-   * @param log_file 日志文件，概念上来讲不一定是某个特定的文件
    * @param log_record 要写入的日志记录
+   * @param buffer 序列化之后的数据
    */
-  RC write_log_record(CLogFile &log_file, CLogRecord *log_record);
+  void serialize_log_record(CLogRecord *log_record, std::vector<char> &buffer);
 
 private:
-  common::Mutex                           lock_;         ///< 加锁支持多线程并发写入
-  std::deque<std::unique_ptr<CLogRecord>> log_records_;  ///< 当前等待刷数据的日志记录
-  std::atomic_int32_t                     total_size_;   ///< 当前缓存中的日志记录的总大小
+  common::Mutex                           flush_lock_;       ///< 保证同时只有一个线程在刷日志
+  common::Mutex                           lock_;             ///< 加锁支持多线程并发写入
+  std::deque<std::unique_ptr<CLogRecord>> log_records_;      ///< 当前等待刷数据的日志记录
+  std::atomic_int32_t                     total_size_;       ///< 当前缓存中的日志记录的总大小
+  LSN                                     current_lsn_ = 0;  ///< 最近一次分配的LSN，在 lock_ 中访问
 };
 
 /**
  * @brief 读写日志文件
  * @ingroup CLog
- * @details 这里的名字不太贴切，因为这个类希望管理所有日志文件，而不是特定的某个文件。不过当前
- * 只有一个文件，并且文件名是固定的。
+ * @details 日志分成多个文件(segment)存放，文件名是 clog.<LSN>，LSN 是这个文件中第一条日志的LSN。
+ * 一个文件超过 CLogParam::segment_size 之后，下一次刷日志时写入新的文件。检查点完成之后，
+ * 所有日志都比恢复起点小的文件会被删除。一批日志总是写在同一个文件中，所以日志不会跨越文件。
+ * 没有LSN的旧版本日志文件 clog 会被当作第一个文件。
  */
 class CLogFile
 {
@@ -272,9 +328,16 @@ public:
   /**
    * @brief 初始化
    *
-   * @param path 日志文件存放的路径。会打开这个目录下叫做 clog 的文件。
+   * @param path 日志文件存放的路径。会加载这个目录下所有 clog.<LSN> 文件
+   * @param segment_size 日志文件超过这个大小之后写入新的文件
    */
-  RC init(const char *path);
+  RC init(const char *path, int64_t segment_size);
+
+  /**
+   * @brief 准备写入一批日志，如果当前文件太大了或者还没有文件，就创建一个新的文件
+   * @param first_lsn 即将写入的第一条日志的LSN，作为新文件的名字
+   */
+  RC roll_segment_if_need(LSN first_lsn);
 
   /**
    * @brief 写入指定数据，全部写入成功返回成功，否则返回失败
@@ -285,19 +348,44 @@ public:
    */
   RC write(const char *data, int len);
 
+  /**
+   * @brief 写入指定数据并同步到磁盘
+   * @details 写数据和 fsync 作为一组请求提交给 IO 后端，fsync 只在写入成功之后执行
+   */
+  RC write_and_sync(const char *data, int len);
+
+  /**
+   * @brief 从可能包含指定LSN的文件开始读取日志
+   * @details 也就是第一条日志的LSN不大于 lsn 的最后一个文件。lsn 比所有文件都小时从第一个文件开始读
+   */
+  RC seek(LSN lsn);
+
   /**
    * @brief 读取指定长度的数据。全部读取成功返回成功，否则返回失败
    * @details 与 write 有类似的问题。如果读取到了文件尾，会标记eof，可以通过eof()函数来判断。
+   * 读到一个文件的结尾之后，需要调用 next_segment 切换到下一个文件。
    * @param data 数据读出来放这里
    * @param len  读取的长度
    */
   RC read(char *data, int len);
 
+  /**
+   * @brief 切换到下一个文件继续读取
+   * @return 已经是最后一个文件时返回 RECORD_EOF
+   */
+  RC next_segment();
+
   /**
    * @brief 将当前写的文件执行sync同步数据到磁盘
    */
   RC sync();
 
+  /**
+   * @brief 删除所有日志的LSN都小于 lsn 的文件
+   * @details 正在写入的文件不会被删除
+   */
+  RC truncate(LSN lsn);
+
   /**
    * @brief 获取当前读取的文件位置
    */
@@ -308,10 +396,29 @@ public:
    */
   bool eof() const { return eof_; }
 
+private:
+  /**
+   * @brief 一个日志文件
+   */
+  struct Segment
+  {
+    LSN         first_lsn = 0;  ///< 文件中第一条日志的LSN
+    std::string filename;
+  };
+
+  RC open_segment_for_read(size_t index);
+
 protected:
-  std::string filename_;     ///< 日志文件名。总是init函数参数path路径下的clog文件
-  int         fd_  = -1;     ///< 操作的文件描述符
-  bool        eof_ = false;  ///< 是否已经读取到文件尾
+  std::string          path_;                  ///< 日志文件存放的目录
+  int64_t              segment_size_ = 0;      ///< 日志文件超过这个大小之后写入新的文件
+  common::Mutex        segment_lock_;          ///< 保护 segments_，检查点线程会删除文件
+  std::vector<Segment> segments_;              ///< 按照LSN从小到大排列的日志文件
+  std::string          filename_;              ///< 当前写入的日志文件名
+  int                  fd_           = -1;     ///< 当前写入的文件描述符
+  int64_t              write_offset_ = 0;      ///< 下一次写入的位置，也就是文件的大小。读文件不影响这个位置
+  int                  read_fd_      = -1;     ///< 当前读取的文件描述符
+  size_t               read_segment_ = 0;      ///< 当前读取的是第几个文件
+  bool                 eof_          = false;  ///< 是否已经读取到文件尾
 };
 
 /**
@@ -341,6 +448,9 @@ private:
  * @ingroup CLog
  * @details 一个日志管理器属于某一个DB（当前仅有一个DB sys）。
  * 管理器负责写日志（运行时）、读日志与恢复（启动时）
+ *
+ * 后台的检查点线程定期执行模糊检查点(参考 checkpoint)，把恢复的起点记录在 clog_checkpoint 文件中，
+ * 恢复时从这里开始重做，并删除更早的日志文件。
  */
 class CLogManager
 {
@@ -352,8 +462,9 @@ public:
    * @brief 初始化日志管理器
    *
    * @param path 日志都放在这个目录下。当前就是数据库的目录
+   * @param param 日志文件大小、检查点周期等参数
    */
-  RC init(const char *path);
+  RC init(const char *path, const CLogParam &param = CLogParam());
 
   /**
    * @brief 新增一条数据更新的日志
@@ -395,12 +506,61 @@ public:
 
   /**
    * @brief 重做
-   * @details 当前会重做所有日志。也就是说，所有buffer pool页面都不会写入到磁盘中，
-   * 否则可能无法恢复成功。
+   * @details 从上一次检查点记录的恢复起点开始重做日志，没有检查点时重做所有日志。
+   * 恢复起点之后的日志对应的修改可能已经写到磁盘上了，所以重做需要能够重复执行。
    */
   RC recover(Db *db);
 
+  /**
+   * @brief 执行一次模糊检查点
+   * @details 检查点不会阻塞事务。恢复的起点取以下几个LSN中最小的一个：
+   * - 所有脏页的 rec lsn，更早的日志对应的修改都已经落盘了(参考 BufferPoolManager::checkpoint)；
+   * - 还没有结束的事务的 MTR_BEGIN 日志，重做时需要看到事务完整的日志；
+   * - 恢复起点之后才结束的事务的 MTR_BEGIN 日志。事务修改页面在写日志之前，提交时只会处理重做时
+   *   看到的操作，需要重做它所有的操作，才能把它修改过的记录都标记为已提交或者回滚掉。
+   * 然后写一条 CHECKPOINT 日志，把恢复起点记录到 clog_checkpoint 文件中，最后删除不再需要的日志文件。
+   */
+  RC checkpoint();
+
+  /**
+   * @brief 启动后台检查点线程
+   * @details 需要在恢复完成之后启动
+   */
+  RC   start_checkpointer();
+  void stop_checkpointer();
+
+private:
+  /**
+   * @brief 记录事务开始和结束的LSN，检查点计算恢复起点时使用
+   */
+  void on_trx_log_appended(const CLogRecord &log_record, LSN lsn);
+
+  /**
+   * @brief 根据事务的开始和结束位置，调整恢复的起点，参考 checkpoint
+   */
+  LSN trx_recovery_lsn(LSN recovery_lsn);
+
+  RC read_checkpoint_meta();
+  RC write_checkpoint_meta(LSN checkpoint_lsn, LSN recovery_lsn);
+
+  void checkpointer_routine();
+
 private:
   CLogBuffer *log_buffer_ = nullptr;  ///< 日志缓存。新增日志时先放到内存，也就是这个buffer中
   CLogFile   *log_file_   = nullptr;  ///< 管理日志，比如读写日志
+
+  CLogParam   param_;
+  std::string checkpoint_file_;                   ///< 记录检查点的文件
+  LSN         checkpoint_lsn_ = BP_INVALID_LSN;  ///< 最近一次检查点日志的LSN
+  LSN         recovery_lsn_   = BP_INVALID_LSN;  ///< 最近一次检查点的恢复起点，没有检查点时是无效值
+  std::mutex  checkpoint_lock_;                   ///< 同时只执行一个检查点
+
+  common::Mutex                    trx_lock_;
+  std::unordered_map<int32_t, LSN> active_trxes_;    ///< 还没有结束的事务，以及它们 MTR_BEGIN 日志的LSN
+  std::vector<std::pair<LSN, LSN>> finished_trxes_;  ///< 上一次检查点之后结束的事务的开始和结束LSN
+
+  std::thread            *checkpointer_         = nullptr;
+  bool                    checkpointer_stopped_ = false;
+  std::mutex              checkpointer_lock_;  ///< 配合 checkpointer_cond_ 使用
+  std::condition_variable checkpointer_cond_;
 };
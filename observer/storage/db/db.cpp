@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/db/db.h"
 
 #include <fcntl.h>
+#include <strings.h>
 #include <sys/stat.h>
 #include <vector>
 
@@ -31,13 +32,18 @@ See the Mulan PSL v2 for more details. */
 
 Db::~Db()
 {
+  // 检查点线程会访问表的数据，需要先停下来
+  if (clog_manager_ != nullptr) {
+    clog_manager_->stop_checkpointer();
+  }
+
   for (auto &iter : opened_tables_) {
     delete iter.second;
   }
   LOG_INFO("Db has been closed: %s", name_.c_str());
 }
 
-RC Db::init(const char *name, const char *dbpath)
+RC Db::init(const char *name, const char *dbpath, const CLogParam &clog_param)
 {
   if (common::is_blank(name)) {
     LOG_ERROR("Failed to init DB, name cannot be empty");
@@ -55,7 +61,7 @@ RC Db::init(const char *name, const char *dbpath)
     return RC::NOMEM;
   }
 
-  RC rc = clog_manager_->init(dbpath);
+  RC rc = clog_manager_->init(dbpath, clog_param);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to init clog manager. dbpath=%s, rc=%s", dbpath, strrc(rc));
     return rc;
@@ -75,10 +81,17 @@ RC Db::init(const char *name, const char *dbpath)
     LOG_WARN("failed to recover db. dbpath=%s, rc=%s", dbpath, strrc(rc));
     return rc;
   }
+
+  rc = clog_manager_->start_checkpointer();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to start checkpointer. dbpath=%s, rc=%s", dbpath, strrc(rc));
+    return rc;
+  }
   return rc;
 }
 
-RC Db::create_table(const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes)
+RC Db::create_table(
+    const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes, StorageFormat storage_format)
 {
   RC rc = RC::SUCCESS;
   // check table_name
@@ -91,7 +104,8 @@ RC Db::create_table(const char *table_name, int attribute_count, const AttrInfoS
   std::string table_file_path = table_meta_file(path_.c_str(), table_name);
   Table      *table           = new Table();
   int32_t     table_id        = next_table_id_++;
-  rc = table->create(table_id, table_file_path.c_str(), table_name, path_.c_str(), attribute_count, attributes);
+  rc = table->create(
+      table_id, table_file_path.c_str(), table_name, path_.c_str(), attribute_count, attributes, storage_format);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create table %s.", table_name);
     delete table;
@@ -150,6 +164,11 @@ RC Db::alter_table(const char *table_name, const char *operation,
   }
 
   Table *table = opened_tables_[table_name]; 
+
+  if (0 == strcasecmp(object_, "TABLE") && 0 == strcasecmp(operation, "COMPRESS")) {
+    return table->compress();
+  }
+
   const TableMeta &table_meta = table->table_meta();
 
   std::vector<FieldMeta> field(*(table_meta.field_metas()));
@@ -184,7 +203,8 @@ RC Db::alter_table(const char *table_name, const char *operation,
   new_table_meta->init(table_meta.table_id(),
                        table_meta.name(),
                        field.size(),
-                       attrs);
+                       attrs,
+                       table_meta.storage_format());
   
   table->set_table_mete(*new_table_meta);
 
@@ -269,6 +289,13 @@ RC Db::sync()
     }
     LOG_INFO("Successfully sync table db:%s, table:%s.", name_.c_str(), table->name());
   }
+
+  // 所有的页面都已经落盘，检查点之后恢复时不再需要重做之前的日志
+  rc = clog_manager_->checkpoint();
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to do checkpoint. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    return rc;
+  }
   LOG_INFO("Successfully sync db. db=%s", name_.c_str());
   return rc;
 }
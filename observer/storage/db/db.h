@@ -20,10 +20,12 @@ See the Mulan PSL v2 for more details. */
 #include <memory>
 
 #include "common/rc.h"
+#include "common/types.h"
 #include "sql/parser/parse_defs.h"
 
 class Table;
 class CLogManager;
+struct CLogParam;
 
 /**
  * @brief 一个DB实例负责管理一批表
@@ -41,11 +43,13 @@ public:
    * @details 从指定的目录下加载指定名称的数据库。这里就会加载dbpath目录下的数据。
    * @param name   数据库名称
    * @param dbpath 当前数据库放在哪个目录下
+   * @param clog_param 日志参数，比如检查点的周期
    * @note 数据库不是放在dbpath/name下，是直接使用dbpath目录
    */
-  RC init(const char *name, const char *dbpath);
+  RC init(const char *name, const char *dbpath, const CLogParam &clog_param);
 
-  RC create_table(const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes);
+  RC create_table(const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes,
+      StorageFormat storage_format = StorageFormat::FIXED_FORMAT);
   RC drop_table(const char *table_name);
   RC alter_table(const char *table_name, const char *operation, const char *object_, const AttrInfoSqlNode *attributes);
 
@@ -56,6 +60,9 @@ public:
 
   void all_tables(std::vector<std::string> &table_names) const;
 
+  /**
+   * @brief 把所有表的数据刷到磁盘，然后做一次检查点
+   */
   RC sync();
 
   RC recover();
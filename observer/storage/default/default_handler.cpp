@@ -39,7 +39,7 @@ void DefaultHandler::set_default(DefaultHandler *handler)
 
 DefaultHandler &DefaultHandler::get_default() { return *default_handler; }
 
-DefaultHandler::DefaultHandler() {}
+DefaultHandler::DefaultHandler(const CLogParam &clog_param /* = CLogParam() */) : clog_param_(clog_param) {}
 
 DefaultHandler::~DefaultHandler() noexcept { destroy(); }
 
@@ -129,7 +129,7 @@ RC DefaultHandler::open_db(const char *dbname)
   // open db
   Db *db  = new Db();
   RC  ret = RC::SUCCESS;
-  if ((ret = db->init(dbname, dbpath.c_str())) != RC::SUCCESS) {
+  if ((ret = db->init(dbname, dbpath.c_str(), clog_param_)) != RC::SUCCESS) {
     LOG_ERROR("Failed to open db: %s. error=%s", dbname, strrc(ret));
     delete db;
   } else {
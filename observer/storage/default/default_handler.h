@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 #include <map>
 #include <string>
 
+#include "storage/clog/clog.h"
 #include "storage/db/db.h"
 
 class Trx;
@@ -23,7 +24,7 @@ class Trx;
 class DefaultHandler
 {
 public:
-  DefaultHandler();
+  explicit DefaultHandler(const CLogParam &clog_param = CLogParam());
 
   virtual ~DefaultHandler() noexcept;
 
@@ -105,4 +106,5 @@ private:
   std::string                 base_dir_;
   std::string                 db_dir_;
   std::map<std::string, Db *> opened_dbs_;
+  CLogParam                   clog_param_;  ///< 打开数据库时使用的日志参数
 };  // class Handler
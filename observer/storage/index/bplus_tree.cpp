@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by Xie Meiyi
 // Rewritten by Longda & Wangyunlai
 //
+#include <thread>
+
 #include "storage/index/bplus_tree.h"
 #include "common/lang/lower_bound.h"
 #include "common/log/log.h"
@@ -197,6 +199,13 @@ int LeafIndexNodeHandler::remove(const char *key, const KeyComparator &comparato
 {
   bool found = false;
   int  index = lookup(comparator, key, &found);
+  if (found && comparator.unique()) {
+    // 唯一索引只按照属性值比较，还要确认删除的是同一条记录
+    const int attr_length = comparator.attr_length();
+    const RID *rid1       = reinterpret_cast<const RID *>(key + attr_length);
+    const RID *rid2       = reinterpret_cast<const RID *>(__key_at(index) + attr_length);
+    found                 = (0 == RID::compare(rid1, rid2));
+  }
   if (found) {
     this->remove(index);
     return 1;
@@ -368,6 +377,18 @@ void InternalIndexNodeHandler::create_new_root(PageNum first_page_num, const cha
   increase_size(2);
 }
 
+void InternalIndexNodeHandler::append_child(const char *key, PageNum page_num)
+{
+  const int index = size();
+  if (index == 0) {
+    memset(__key_at(0), 0, key_size());
+  } else {
+    memcpy(__key_at(index), key, key_size());
+  }
+  memcpy(__value_at(index), &page_num, value_size());
+  increase_size(1);
+}
+
 /**
  * insert one entry
  * the entry to be inserted will never at the first slot.
@@ -689,6 +710,29 @@ RC BplusTreeHandler::sync()
 RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_length, int internal_max_size /* = -1*/,
     int leaf_max_size /* = -1 */)
 {
+  return create(file_name,
+      std::vector<AttrType>{attr_type},
+      std::vector<int>{attr_length},
+      false /*unique*/,
+      internal_max_size,
+      leaf_max_size);
+}
+
+RC BplusTreeHandler::create(const char *file_name, const std::vector<AttrType> &attr_types,
+    const std::vector<int> &attr_lengths, bool unique /* = false */, int internal_max_size /* = -1*/,
+    int leaf_max_size /* = -1 */)
+{
+  if (attr_types.empty() || attr_types.size() != attr_lengths.size() ||
+      static_cast<int>(attr_types.size()) > IndexMeta::MAX_FIELD_NUM) {
+    LOG_WARN("invalid attributes of index. file name=%s, attr num=%d", file_name, static_cast<int>(attr_types.size()));
+    return RC::INVALID_ARGUMENT;
+  }
+
+  int attr_length = 0;
+  for (int length : attr_lengths) {
+    attr_length += length;
+  }
+
   BufferPoolManager &bpm = BufferPoolManager::instance();
 
   RC rc = bpm.create_file(file_name);
@@ -733,10 +777,16 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
   IndexFileHeader *file_header   = (IndexFileHeader *)pdata;
   file_header->attr_length       = attr_length;
   file_header->key_length        = attr_length + sizeof(RID);
-  file_header->attr_type         = attr_type;
+  file_header->attr_type         = attr_types[0];
   file_header->internal_max_size = internal_max_size;
   file_header->leaf_max_size     = leaf_max_size;
   file_header->root_page         = BP_INVALID_PAGE_NUM;
+  file_header->attr_num          = static_cast<int32_t>(attr_types.size());
+  file_header->unique            = unique ? 1 : 0;
+  for (size_t i = 0; i < attr_types.size(); i++) {
+    file_header->attr_types[i]   = attr_types[i];
+    file_header->attr_lengths[i] = attr_lengths[i];
+  }
 
   header_frame->mark_dirty();
 
@@ -753,8 +803,8 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
     return RC::NOMEM;
   }
 
-  key_comparator_.init(file_header->attr_type, file_header->attr_length);
-  key_printer_.init(file_header->attr_type, file_header->attr_length);
+  key_comparator_.init(attr_types, attr_lengths, unique);
+  key_printer_.init(attr_types, attr_lengths);
 
   this->sync();
 
@@ -801,8 +851,11 @@ RC BplusTreeHandler::open(const char *file_name)
   // close old page_handle
   disk_buffer_pool->unpin_page(frame);
 
-  key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
-  key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  std::vector<AttrType> attr_types;
+  std::vector<int>      attr_lengths;
+  file_header_.attrs(attr_types, attr_lengths);
+  key_comparator_.init(attr_types, attr_lengths, file_header_.unique != 0);
+  key_printer_.init(attr_types, attr_lengths);
   LOG_INFO("Successfully open index %s", file_name);
   return RC::SUCCESS;
 }
@@ -1037,6 +1090,16 @@ RC BplusTreeHandler::left_most_page(LatchMemo &latch_memo, Frame *&frame)
 RC BplusTreeHandler::find_leaf_internal(LatchMemo &latch_memo, BplusTreeOperationType op,
     const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame)
 {
+  // 先乐观地查找，大部分情况下只需要在叶子节点上加锁
+  bool retry = optimistic_;
+  for (int i = 0; retry && i < OPTIMISTIC_RETRY_TIMES; i++) {
+    RC rc = optimistic_find_leaf(latch_memo, op, child_page_getter, frame, retry);
+    if (rc != RC::LOCKED_CONCURRENCY_CONFLICT) {
+      return rc;
+    }
+    std::this_thread::yield();
+  }
+
   // root locked
   if (op != BplusTreeOperationType::READ) {
     latch_memo.xlatch(&root_lock_);
@@ -1070,6 +1133,102 @@ RC BplusTreeHandler::find_leaf_internal(LatchMemo &latch_memo, BplusTreeOperatio
   return RC::SUCCESS;
 }
 
+RC BplusTreeHandler::optimistic_find_leaf(LatchMemo &latch_memo, BplusTreeOperationType op,
+    const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame, bool &retry)
+{
+  frame = nullptr;
+  retry = true;
+
+  // 空树或者刚刚被删空，由加锁的流程处理
+  const PageNum root_page = root_page_num();
+  if (root_page == BP_INVALID_PAGE_NUM) {
+    retry = false;
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  auto conflict = [&latch_memo]() {
+    latch_memo.release_to(latch_memo.memo_point());
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  };
+
+  Frame *current_frame = nullptr;
+  RC     rc            = latch_memo.get_page(root_page, current_frame);
+  if (OB_FAIL(rc)) {
+    latch_memo.release_to(latch_memo.memo_point());
+    return root_page_num() != root_page ? RC::LOCKED_CONCURRENCY_CONFLICT : rc;
+  }
+
+  // 读到版本号之后根节点没有变化，说明这个时候它确实是根节点
+  uint64_t current_version = 0;
+  if (!current_frame->optimistic_read_begin(current_version) || root_page_num() != root_page) {
+    return conflict();
+  }
+
+  // 一直 pin 着父节点，到了叶子节点之后还要用它的版本号做校验
+  Frame   *parent_frame   = nullptr;
+  uint64_t parent_version = 0;
+  while (!reinterpret_cast<IndexNode *>(current_frame->data())->is_leaf) {
+    // 页面可能正在被修改，先确认节点的大小是合理的，避免查找时越界
+    InternalIndexNodeHandler internal_node(file_header_, current_frame);
+    if (internal_node.size() <= 0 || internal_node.size() > internal_node.max_size()) {
+      return conflict();
+    }
+
+    const PageNum child_page_num = child_page_getter(internal_node);
+    if (!current_frame->optimistic_read_validate(current_version)) {
+      return conflict();
+    }
+
+    Frame *child_frame = nullptr;
+    rc                 = latch_memo.get_page(child_page_num, child_frame);
+    if (OB_FAIL(rc)) {
+      // 可能是子节点刚刚被删掉了
+      if (!current_frame->optimistic_read_validate(current_version)) {
+        return conflict();
+      }
+      LOG_WARN("failed to fetch page while finding leaf. page num=%d, rc=%s", child_page_num, strrc(rc));
+      latch_memo.release_to(latch_memo.memo_point());
+      return rc;
+    }
+
+    uint64_t child_version = 0;
+    if (!child_frame->optimistic_read_begin(child_version) ||
+        !current_frame->optimistic_read_validate(current_version)) {
+      return conflict();
+    }
+
+    // 只保留父节点和子节点两个页面
+    latch_memo.release_to(latch_memo.memo_point() - 2);
+    parent_frame    = current_frame;
+    parent_version  = current_version;
+    current_frame   = child_frame;
+    current_version = child_version;
+  }
+
+  // 叶子节点才真正加锁，加锁之后检查父节点，父节点没有变化就说明叶子节点负责的键值范围没有变化
+  const bool readonly = (op == BplusTreeOperationType::READ);
+  latch_memo.latch(current_frame, readonly ? LatchMemoType::SHARED : LatchMemoType::EXCLUSIVE);
+
+  IndexNodeHandler leaf_node(file_header_, current_frame);
+  const bool       valid = leaf_node.is_leaf() && (parent_frame != nullptr
+                                                       ? parent_frame->optimistic_read_validate(parent_version)
+                                                       : root_page_num() == current_frame->page_num());
+  if (!valid) {
+    return conflict();
+  }
+
+  if (!leaf_node.is_safe(op, parent_frame == nullptr)) {
+    // 写操作可能会分裂或者合并，要修改父节点，只能加锁重新查找，再乐观地重试也没有用
+    retry = false;
+    return conflict();
+  }
+
+  // 父节点不再需要了，只留下叶子节点的 pin 和锁
+  latch_memo.release_to(latch_memo.memo_point() - 2);
+  frame = current_frame;
+  return RC::SUCCESS;
+}
+
 RC BplusTreeHandler::crabing_protocal_fetch_page(
     LatchMemo &latch_memo, BplusTreeOperationType op, PageNum page_num, bool is_root_node, Frame *&frame)
 {
@@ -1257,8 +1416,8 @@ RC BplusTreeHandler::split(LatchMemo &latch_memo, Frame *frame, Frame *&new_fram
 
 void BplusTreeHandler::update_root_page_num_locked(PageNum root_page_num)
 {
-  file_header_.root_page = root_page_num;
-  header_dirty_          = true;
+  __atomic_store_n(&file_header_.root_page, root_page_num, __ATOMIC_RELEASE);  // 乐观查找不加 root_lock_ 读取根节点
+  header_dirty_ = true;
   LOG_DEBUG("set root page to %d", root_page_num);
 }
 
@@ -1369,6 +1528,176 @@ RC BplusTreeHandler::get_entry(const char *user_key, int key_len, std::list<RID>
   return rc;
 }
 
+RC BplusTreeHandler::bulk_load(
+    const std::function<RC(const char *&key)> &next_key, int64_t key_count, float fill_factor)
+{
+  if (!is_empty()) {
+    LOG_WARN("cannot bulk load into a non-empty tree. root page=%d", file_header_.root_page);
+    return RC::INTERNAL;
+  }
+  if (key_count <= 0) {
+    return RC::SUCCESS;
+  }
+  if (!(fill_factor > 0 && fill_factor <= 1)) {
+    LOG_WARN("invalid fill factor %f, use 1 instead", fill_factor);
+    fill_factor = 1;
+  }
+
+  // 内部节点至少要有两个子节点，否则树的高度会一直增长
+  const int leaf_target     = std::min(std::max(static_cast<int>(file_header_.leaf_max_size * fill_factor), 1),
+      file_header_.leaf_max_size);
+  const int internal_target = std::min(std::max(static_cast<int>(file_header_.internal_max_size * fill_factor), 2),
+      file_header_.internal_max_size);
+
+  // 先算出每一层有多少个节点，最上面一层只有一个节点，就是根节点
+  std::vector<BulkLoadLevel> levels;
+  int64_t                    item_num = key_count;
+  int                        target   = leaf_target;
+  while (true) {
+    BulkLoadLevel level;
+    level.item_num = item_num;
+    level.node_num = (item_num + target - 1) / target;
+    levels.push_back(level);
+    if (level.node_num == 1) {
+      break;
+    }
+    item_num = level.node_num;
+    target   = internal_target;
+  }
+
+  RC                rc = RC::SUCCESS;
+  std::vector<char> last_key;
+  const char       *key       = nullptr;
+  int64_t           key_index = 0;
+  for (; key_index < key_count; key_index++) {
+    rc = next_key(key);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get next key to bulk load. index=%ld, count=%ld, rc=%s", key_index, key_count, strrc(rc));
+      break;
+    }
+
+    // 唯一索引比较的是 user key，普通索引的键值里有 RID，不会相等
+    if (!last_key.empty() && key_comparator_(last_key.data(), key) == 0) {
+      LOG_TRACE("duplicate key while bulk loading unique index");
+      rc = RC::RECORD_DUPLICATE_KEY;
+      break;
+    }
+    last_key.assign(key, key + file_header_.key_length);
+
+    BulkLoadLevel &leaf = levels[0];
+    if (leaf.frame == nullptr || IndexNodeHandler(file_header_, leaf.frame).size() >= leaf.node_capacity) {
+      rc = bulk_load_open_node(levels, 0, key);
+      if (OB_FAIL(rc)) {
+        break;
+      }
+    }
+
+    LeafIndexNodeHandler leaf_node(file_header_, leaf.frame);
+    leaf_node.insert(leaf_node.size(), key, key + file_header_.attr_length);
+  }
+
+  PageNum root_page_num = levels.back().frame != nullptr ? levels.back().frame->page_num() : BP_INVALID_PAGE_NUM;
+  for (BulkLoadLevel &level : levels) {
+    if (level.frame == nullptr) {
+      continue;
+    }
+    if (OB_FAIL(rc)) {
+      disk_buffer_pool_->unpin_page(level.frame);
+      level.frame = nullptr;
+      continue;
+    }
+
+    ASSERT(level.opened_num == level.node_num,
+           "bulk load opened %ld nodes but expect %ld", level.opened_num, level.node_num);
+    rc = bulk_load_finish_node(level.frame);
+  }
+
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  update_root_page_num_locked(root_page_num);
+  LOG_INFO("bulk load index done. key count=%ld, height=%d, leaf num=%ld, root page=%d",
+           key_count, static_cast<int>(levels.size()), levels[0].node_num, root_page_num);
+  return sync();
+}
+
+RC BplusTreeHandler::bulk_load_open_node(std::vector<BulkLoadLevel> &levels, int level, const char *first_key)
+{
+  BulkLoadLevel &current = levels[level];
+  if (current.opened_num >= current.node_num) {
+    LOG_WARN("too many nodes while bulk loading. level=%d, node num=%ld", level, current.node_num);
+    return RC::INTERNAL;
+  }
+
+  Frame *frame = nullptr;
+  RC     rc    = disk_buffer_pool_->allocate_page(&frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate page while bulk loading. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (level == 0) {
+    LeafIndexNodeHandler(file_header_, frame).init_empty();
+  } else {
+    InternalIndexNodeHandler(file_header_, frame).init_empty();
+  }
+
+  if (level + 1 < static_cast<int>(levels.size())) {
+    rc = bulk_load_add_child(levels, level + 1, first_key, frame->page_num());
+    if (OB_FAIL(rc)) {
+      disk_buffer_pool_->unpin_page(frame);
+      return rc;
+    }
+    IndexNodeHandler(file_header_, frame).set_parent_page_num(levels[level + 1].frame->page_num());
+  }
+
+  if (current.frame != nullptr) {
+    if (level == 0) {
+      LeafIndexNodeHandler(file_header_, current.frame).set_next_page(frame->page_num());
+    }
+    rc = bulk_load_finish_node(current.frame);
+    if (OB_FAIL(rc)) {
+      disk_buffer_pool_->unpin_page(frame);
+      return rc;
+    }
+  }
+
+  // 把剩余的项平均分到剩下的节点上，前面的节点多放一个
+  current.node_capacity = static_cast<int>(
+      current.item_num / current.node_num + (current.opened_num < current.item_num % current.node_num ? 1 : 0));
+  current.opened_num++;
+  current.frame = frame;
+  return RC::SUCCESS;
+}
+
+RC BplusTreeHandler::bulk_load_add_child(
+    std::vector<BulkLoadLevel> &levels, int level, const char *key, PageNum page_num)
+{
+  BulkLoadLevel &current = levels[level];
+  if (current.frame == nullptr || IndexNodeHandler(file_header_, current.frame).size() >= current.node_capacity) {
+    RC rc = bulk_load_open_node(levels, level, key);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  InternalIndexNodeHandler(file_header_, current.frame).append_child(key, page_num);
+  return RC::SUCCESS;
+}
+
+RC BplusTreeHandler::bulk_load_finish_node(Frame *&frame)
+{
+  frame->mark_dirty();
+  RC rc = disk_buffer_pool_->flush_page(*frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush page while bulk loading. page=%d, rc=%s", frame->page_num(), strrc(rc));
+  }
+  disk_buffer_pool_->unpin_page(frame);
+  frame = nullptr;
+  return rc;
+}
+
 RC BplusTreeHandler::adjust_root(LatchMemo &latch_memo, Frame *root_frame)
 {
   IndexNodeHandler root_node(file_header_, root_frame);
@@ -1615,14 +1944,15 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
   inited_        = true;
   first_emitted_ = false;
 
-  // 校验输入的键值是否是合法范围
+  // 校验输入的键值是否是合法范围。范围为空时不是错误，比如 a > 5 and a < 3，直接返回一个没有数据的扫描器
   if (left_user_key && right_user_key) {
-    const auto &attr_comparator = tree_handler_.key_comparator_.attr_comparator();
-    const int   result          = attr_comparator(left_user_key, right_user_key);
+    const int result = tree_handler_.key_comparator_.compare_attrs(left_user_key, right_user_key);
     if (result > 0 ||  // left < right
                        // left == right but is (left,right)/[left,right) or (left,right]
         (result == 0 && (left_inclusive == false || right_inclusive == false))) {
-      return RC::INVALID_ARGUMENT;
+      LOG_TRACE("empty scan range of index");
+      current_frame_ = nullptr;
+      return RC::SUCCESS;
     }
   }
 
@@ -1637,7 +1967,7 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
   } else {
 
     char *fixed_left_key = const_cast<char *>(left_user_key);
-    if (tree_handler_.file_header_.attr_type == CHARS) {
+    if (tree_handler_.file_header_.attr_type == CHARS && tree_handler_.file_header_.attr_count() == 1) {
       bool should_inclusive_after_fix = false;
       rc = fix_user_key(left_user_key, left_len, true /*greater*/, &fixed_left_key, &should_inclusive_after_fix);
       if (rc != RC::SUCCESS) {
@@ -1676,6 +2006,11 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
     LeafIndexNodeHandler left_node(tree_handler_.file_header_, current_frame_);
     int                  left_index = left_node.lookup(tree_handler_.key_comparator_, left_key);
+    // 唯一索引不比较RID，不包含左边界时要跳过与左边界相等的键值
+    if (!left_inclusive && tree_handler_.key_comparator_.unique() && left_index < left_node.size() &&
+        tree_handler_.key_comparator_.compare_attrs(left_node.key_at(left_index), left_key) == 0) {
+      left_index++;
+    }
     // lookup 返回的是适合插入的位置，还需要判断一下是否在合适的边界范围内
     if (left_index >= left_node.size()) {  // 超出了当前页，就需要向后移动一个位置
       const PageNum next_page_num = left_node.next_page();
@@ -1704,7 +2039,7 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
     char *fixed_right_key          = const_cast<char *>(right_user_key);
     bool  should_include_after_fix = false;
-    if (tree_handler_.file_header_.attr_type == CHARS) {
+    if (tree_handler_.file_header_.attr_type == CHARS && tree_handler_.file_header_.attr_count() == 1) {
       rc = fix_user_key(right_user_key, right_len, false /*want_greater*/, &fixed_right_key, &should_include_after_fix);
       if (rc != RC::SUCCESS) {
         LOG_WARN("failed to fix right user key. rc=%s", strrc(rc));
@@ -1715,6 +2050,7 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
         right_inclusive = true;
       }
     }
+    right_inclusive_ = right_inclusive;
     if (right_inclusive) {
       right_key_ = tree_handler_.make_key(fixed_right_key, *RID::max());
     } else {
@@ -1750,7 +2086,8 @@ bool BplusTreeScanner::touch_end()
 
   const char *this_key       = node.key_at(iter_index_);
   int         compare_result = tree_handler_.key_comparator_(this_key, static_cast<char *>(right_key_.get()));
-  return compare_result > 0;
+  // 唯一索引不比较RID，与右边界相等时要看是否包含右边界
+  return compare_result > 0 || (compare_result == 0 && !right_inclusive_);
 }
 
 RC BplusTreeScanner::next_entry(RID &rid)
@@ -1805,6 +2142,12 @@ RC BplusTreeScanner::next_entry(RID &rid)
   return next_entry(rid);
 }
 
+const char *BplusTreeScanner::current_key()
+{
+  LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
+  return node.key_at(iter_index_);
+}
+
 RC BplusTreeScanner::close()
 {
   inited_ = false;
@@ -21,11 +21,13 @@ See the Mulan PSL v2 for more details. */
 #include <memory>
 #include <sstream>
 #include <string.h>
+#include <vector>
 
 #include "common/lang/comparator.h"
 #include "common/log/log.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
+#include "storage/index/index_meta.h"
 #include "storage/record/record_manager.h"
 #include "storage/trx/latch_memo.h"
 
@@ -87,29 +89,63 @@ private:
 /**
  * @brief 键值比较(BplusTree)
  * @details BplusTree的键值除了字段属性，还有RID，是为了避免属性值重复而增加的。
+ * 多列索引的属性值按照字段的顺序连续存放，依次比较每个字段。
  * @ingroup BPlusTree
  */
 class KeyComparator
 {
 public:
-  void init(AttrType type, int length) { attr_comparator_.init(type, length); }
+  void init(AttrType type, int length) { init(std::vector<AttrType>{type}, std::vector<int>{length}); }
+  void init(const std::vector<AttrType> &types, const std::vector<int> &lengths, bool unique = false)
+  {
+    attr_comparators_.resize(types.size());
+    unique_      = unique;
+    attr_length_ = 0;
+    for (size_t i = 0; i < types.size(); i++) {
+      attr_comparators_[i].init(types[i], lengths[i]);
+      attr_length_ += lengths[i];
+    }
+  }
 
-  const AttrComparator &attr_comparator() const { return attr_comparator_; }
+  int  attr_length() const { return attr_length_; }
+  bool unique() const { return unique_; }
 
+  /**
+   * @brief 只比较属性值，不比较RID
+   */
+  int compare_attrs(const char *v1, const char *v2) const
+  {
+    for (const AttrComparator &attr_comparator : attr_comparators_) {
+      int result = attr_comparator(v1, v2);
+      if (result != 0) {
+        return result;
+      }
+      v1 += attr_comparator.attr_length();
+      v2 += attr_comparator.attr_length();
+    }
+    return 0;
+  }
+
+  /**
+   * @brief 比较两个完整的键值
+   * @details 唯一索引中属性值不会重复，只比较属性值，这样插入时在叶子节点上就能发现重复的键值
+   */
   int operator()(const char *v1, const char *v2) const
   {
-    int result = attr_comparator_(v1, v2);
-    if (result != 0) {
+    int result = compare_attrs(v1, v2);
+    if (result != 0 || unique_) {
       return result;
     }
 
-    const RID *rid1 = (const RID *)(v1 + attr_comparator_.attr_length());
-    const RID *rid2 = (const RID *)(v2 + attr_comparator_.attr_length());
+    const RID *rid1 = (const RID *)(v1 + attr_length_);
+    const RID *rid2 = (const RID *)(v2 + attr_length_);
     return RID::compare(rid1, rid2);
   }
 
 private:
-  AttrComparator attr_comparator_;
+  std::vector<AttrComparator> attr_comparators_;
+  int                         attr_length_ = 0;
+  bool                        unique_      = false;
 };
 
 /**
@@ -165,29 +201,43 @@ private:
 class KeyPrinter
 {
 public:
-  void init(AttrType type, int length) { attr_printer_.init(type, length); }
-
-  const AttrPrinter &attr_printer() const { return attr_printer_; }
+  void init(AttrType type, int length) { init(std::vector<AttrType>{type}, std::vector<int>{length}); }
+  void init(const std::vector<AttrType> &types, const std::vector<int> &lengths)
+  {
+    attr_printers_.resize(types.size());
+    for (size_t i = 0; i < types.size(); i++) {
+      attr_printers_[i].init(types[i], lengths[i]);
+    }
+  }
 
   std::string operator()(const char *v) const
   {
     std::stringstream ss;
-    ss << "{key:" << attr_printer_(v) << ",";
+    ss << "{key:";
+    for (size_t i = 0; i < attr_printers_.size(); i++) {
+      if (i != 0) {
+        ss << "|";
+      }
+      ss << attr_printers_[i](v);
+      v += attr_printers_[i].attr_length();
+    }
+    ss << ",";
 
-    const RID *rid = (const RID *)(v + attr_printer_.attr_length());
+    const RID *rid = (const RID *)v;
     ss << "rid:{" << rid->to_string() << "}}";
     return ss.str();
   }
 
 private:
-  AttrPrinter attr_printer_;
+  std::vector<AttrPrinter> attr_printers_;
 };
 
 /**
  * @brief the meta information of bplus tree
  * @ingroup BPlusTree
  * @details this is the first page of bplus tree.
- * only one field can be supported, can you extend it to multi-fields?
+ * 多列索引的每个字段的类型和长度记录在 attr_types 和 attr_lengths 中，attr_length 是所有字段的总长度，
+ * attr_type 是第一个字段的类型。老版本的索引文件 attr_num 是0，表示只有一个字段。
  */
 struct IndexFileHeader
 {
@@ -196,12 +246,33 @@ struct IndexFileHeader
     memset(this, 0, sizeof(IndexFileHeader));
     root_page = BP_INVALID_PAGE_NUM;
   }
-  PageNum  root_page;          ///< 根节点在磁盘中的页号
-  int32_t  internal_max_size;  ///< 内部节点最大的键值对数
-  int32_t  leaf_max_size;      ///< 叶子节点最大的键值对数
-  int32_t  attr_length;        ///< 键值的长度
-  int32_t  key_length;         ///< attr length + sizeof(RID)
-  AttrType attr_type;          ///< 键值的类型
+  PageNum  root_page;                               ///< 根节点在磁盘中的页号
+  int32_t  internal_max_size;                       ///< 内部节点最大的键值对数
+  int32_t  leaf_max_size;                           ///< 叶子节点最大的键值对数
+  int32_t  attr_length;                             ///< 键值的长度
+  int32_t  key_length;                              ///< attr length + sizeof(RID)
+  AttrType attr_type;                               ///< 键值的类型
+  int32_t  attr_num;                                ///< 键值包含的字段个数
+  AttrType attr_types[IndexMeta::MAX_FIELD_NUM];    ///< 每个字段的类型
+  int32_t  attr_lengths[IndexMeta::MAX_FIELD_NUM];  ///< 每个字段的长度
+  int32_t  unique;                                  ///< 是否是唯一索引，老的索引文件这里是0
+
+  int attr_count() const { return attr_num > 0 ? attr_num : 1; }
+
+  void attrs(std::vector<AttrType> &types, std::vector<int> &lengths) const
+  {
+    types.clear();
+    lengths.clear();
+    if (attr_num <= 0) {
+      types.push_back(attr_type);
+      lengths.push_back(attr_length);
+      return;
+    }
+    for (int i = 0; i < attr_num; i++) {
+      types.push_back(attr_types[i]);
+      lengths.push_back(attr_lengths[i]);
+    }
+  }
 
   const std::string to_string()
   {
@@ -210,6 +281,8 @@ struct IndexFileHeader
     ss << "attr_length:" << attr_length << ","
        << "key_length:" << key_length << ","
        << "attr_type:" << attr_type << ","
+       << "attr_num:" << attr_count() << ","
+       << "unique:" << unique << ","
        << "root_page:" << root_page << ","
        << "internal_max_size:" << internal_max_size << ","
        << "leaf_max_size:" << leaf_max_size << ";";
@@ -382,6 +455,13 @@ public:
   void init_empty();
   void create_new_root(PageNum first_page_num, const char *key, PageNum page_num);
 
+  /**
+   * @brief 在节点的最后追加一个子节点，批量构建索引时使用
+   * @details 调用者需要保证 key 比当前所有的键值都大，第一个子节点的 key 会被忽略。
+   * 与 append 不同，这里不会修改子节点的 parent，子节点由调用者自己设置
+   */
+  void append_child(const char *key, PageNum page_num);
+
   void    insert(const char *key, PageNum page_num, const KeyComparator &comparator);
   RC      move_half_to(LeafIndexNodeHandler &other, DiskBufferPool *bp);
   char   *key_at(int index);
@@ -445,6 +525,16 @@ public:
   RC create(
       const char *file_name, AttrType attr_type, int attr_length, int internal_max_size = -1, int leaf_max_size = -1);
 
+  /**
+   * @brief 创建一个多列的索引，键值是各个字段按照顺序拼起来的
+   * @param unique 是否是唯一索引，唯一索引插入重复的键值时返回 RECORD_DUPLICATE_KEY
+   */
+  RC create(const char *file_name, const std::vector<AttrType> &attr_types, const std::vector<int> &attr_lengths,
+      bool unique = false, int internal_max_size = -1, int leaf_max_size = -1);
+
+  const IndexFileHeader &file_header() const { return file_header_; }
+  const KeyComparator   &key_comparator() const { return key_comparator_; }
+
   /**
    * 打开名为fileName的索引文件。
    * 如果方法调用成功，则indexHandle为指向被打开的索引句柄的指针。
@@ -481,8 +571,25 @@ public:
    */
   RC get_entry(const char *user_key, int key_len, std::list<RID> &rids);
 
+  /**
+   * @brief 从一批排好序的键值自底向上构建整棵树，只能在空树上调用
+   * @details 键值按照 key_comparator 的顺序逐个给出，格式与树中的键值相同，即 user key + RID。
+   * 每个节点按照 fill_factor 填充，先写满的节点直接刷到磁盘上，所以页面是按照分配的顺序写出的，每个页面只写一次。
+   * 同一层的节点数量是事先算好的，剩余的键值平均分配到各个节点上，不会在最后留下一个很空的节点。
+   * @param next_key    返回下一个键值，返回的指针在下一次调用之前有效
+   * @param key_count   键值的个数，必须与 next_key 能返回的个数一致
+   * @param fill_factor 节点的填充比例，(0, 1]，留一些空间给之后的插入，避免刚建好的索引一插入就分裂
+   * @return 唯一索引有重复的键值时返回 RECORD_DUPLICATE_KEY
+   */
+  RC bulk_load(const std::function<RC(const char *&key)> &next_key, int64_t key_count, float fill_factor);
+
   RC sync();
 
+  /**
+   * @brief 查找叶子节点时是否先乐观地查找，关闭之后只使用加锁(crabbing)的方式，用来对比两种方式的性能
+   */
+  void set_optimistic(bool optimistic) { optimistic_ = optimistic; }
+
   /**
    * Check whether current B+ tree is invalid or not.
    * @return true means current tree is valid, return false means current tree is invalid.
@@ -515,6 +622,22 @@ protected:
   RC crabing_protocal_fetch_page(
       LatchMemo &latch_memo, BplusTreeOperationType op, PageNum page_num, bool is_root_page, Frame *&frame);
 
+  /**
+   * @brief 乐观地查找叶子节点
+   * @details 从根节点向下查找时不加 root_lock_，内部节点也不加锁，只 pin 住页面，通过页面的版本号确认读到的数据是有效的。
+   * 只有到了叶子节点才真正加锁(读操作加读锁，写操作加写锁)，加锁之后再检查父节点的版本号，父节点没有变化就说明这个
+   * 叶子节点仍然负责这个键值的范围。写操作要求叶子节点是安全的，也就是不会分裂或合并，否则交给加锁的方式处理。
+   * @param[out] retry 返回冲突时，再乐观地尝试一次是否有意义。空树或者写操作遇到不安全的叶子节点时是 false
+   * @return 版本校验失败或者需要走加锁的流程时返回 LOCKED_CONCURRENCY_CONFLICT，latch_memo 中已经什么都不持有了
+   */
+  RC optimistic_find_leaf(LatchMemo &latch_memo, BplusTreeOperationType op,
+      const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame, bool &retry);
+
+  /**
+   * @brief 不加 root_lock_ 读取根节点的页号，给乐观查找使用
+   */
+  PageNum root_page_num() const { return __atomic_load_n(&file_header_.root_page, __ATOMIC_ACQUIRE); }
+
   RC insert_into_parent(
       LatchMemo &latch_memo, PageNum parent_page, Frame *left_frame, const char *pkey, Frame &right_frame);
 
@@ -539,12 +662,44 @@ protected:
   RC adjust_root(LatchMemo &latch_memo, Frame *root_frame);
 
 private:
+  /**
+   * @brief 批量构建时每一层的状态，每一层同时只有一个节点是打开的
+   */
+  struct BulkLoadLevel
+  {
+    int64_t item_num      = 0;        ///< 这一层一共有多少个键值(叶子节点)或子节点(内部节点)
+    int64_t node_num      = 0;        ///< 这一层一共有多少个节点
+    int64_t opened_num    = 0;        ///< 已经打开了多少个节点
+    int     node_capacity = 0;        ///< 当前节点应该放多少项
+    Frame  *frame         = nullptr;  ///< 当前正在填充的节点
+  };
+
+  /**
+   * @brief 打开 level 层的下一个节点，并把它挂到上一层的节点上，同时结束这一层前一个节点
+   * @param first_key 新节点上的第一个键值，用作上一层节点中指向它的键值
+   */
+  RC bulk_load_open_node(std::vector<BulkLoadLevel> &levels, int level, const char *first_key);
+
+  /**
+   * @brief 在 level 层(内部节点)追加一个子节点，当前节点满了就打开一个新的
+   */
+  RC bulk_load_add_child(std::vector<BulkLoadLevel> &levels, int level, const char *key, PageNum page_num);
+
+  /**
+   * @brief 节点已经填充好了，直接写到磁盘上
+   */
+  RC bulk_load_finish_node(Frame *&frame);
+
   common::MemPoolItem::unique_ptr make_key(const char *user_key, const RID &rid);
   void                            free_key(char *key);
 
 protected:
+  /// 乐观查找连续失败这么多次之后，改用加锁的方式，避免在写冲突很多时一直重试
+  static constexpr int OPTIMISTIC_RETRY_TIMES = 8;
+
   DiskBufferPool *disk_buffer_pool_ = nullptr;
   bool            header_dirty_     = false;  //
+  bool            optimistic_       = true;   ///< 参考 set_optimistic
   IndexFileHeader file_header_;
 
   // 在调整根节点时，需要加上这个锁。
@@ -585,6 +740,12 @@ public:
 
   RC next_entry(RID &rid);
 
+  /**
+   * @brief 最近一次 next_entry 返回的数据的键值
+   * @details 指向叶子节点页面中的数据，扫描器拿着这个页面的锁，在下一次调用 next_entry 之前是有效的
+   */
+  const char *current_key();
+
   RC close();
 
 private:
@@ -607,6 +768,7 @@ private:
   Frame *current_frame_ = nullptr;
 
   common::MemPoolItem::unique_ptr right_key_;
-  int                             iter_index_    = -1;
-  bool                            first_emitted_ = false;
+  bool                            right_inclusive_ = true;
+  int                             iter_index_      = -1;
+  bool                            first_emitted_   = false;
 };
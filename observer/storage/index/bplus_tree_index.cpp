@@ -14,10 +14,16 @@ See the Mulan PSL v2 for more details. */
 
 #include "storage/index/bplus_tree_index.h"
 #include "common/log/log.h"
+#include "storage/index/external_sorter.h"
+#include "storage/record/record_manager.h"
+
+using namespace std;
+
+IndexBuildParam BplusTreeIndex::build_param_;
 
 BplusTreeIndex::~BplusTreeIndex() noexcept { close(); }
 
-RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
 {
   if (inited_) {
     LOG_WARN("Failed to create index due to the index has been created before. file_name:%s, index:%s, field:%s",
@@ -25,9 +31,16 @@ RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, co
     return RC::RECORD_OPENNED;
   }
 
-  Index::init(index_meta, field_meta);
+  Index::init(index_meta, field_metas);
 
-  RC rc = index_handler_.create(file_name, field_meta.type(), field_meta.len());
+  vector<AttrType> attr_types;
+  vector<int>      attr_lengths;
+  for (const FieldMeta &field_meta : field_metas) {
+    attr_types.push_back(field_meta.type());
+    attr_lengths.push_back(field_meta.len());
+  }
+
+  RC rc = index_handler_.create(file_name, attr_types, attr_lengths, index_meta.unique());
   if (RC::SUCCESS != rc) {
     LOG_WARN("Failed to create index_handler, file_name:%s, index:%s, field:%s, rc:%s",
         file_name, index_meta.name(), index_meta.field(), strrc(rc));
@@ -40,7 +53,7 @@ RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, co
   return RC::SUCCESS;
 }
 
-RC BplusTreeIndex::open(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC BplusTreeIndex::open(const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
 {
   if (inited_) {
     LOG_WARN("Failed to open index due to the index has been initedd before. file_name:%s, index:%s, field:%s",
@@ -48,7 +61,7 @@ RC BplusTreeIndex::open(const char *file_name, const IndexMeta &index_meta, cons
     return RC::RECORD_OPENNED;
   }
 
-  Index::init(index_meta, field_meta);
+  Index::init(index_meta, field_metas);
 
   RC rc = index_handler_.open(file_name);
   if (RC::SUCCESS != rc) {
@@ -76,12 +89,63 @@ RC BplusTreeIndex::close()
 
 RC BplusTreeIndex::insert_entry(const char *record, const RID *rid)
 {
-  return index_handler_.insert_entry(record + field_meta_.offset(), rid);
+  vector<char> key_buffer;
+  return index_handler_.insert_entry(make_key(record, key_buffer), rid);
 }
 
 RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
 {
-  return index_handler_.delete_entry(record + field_meta_.offset(), rid);
+  vector<char> key_buffer;
+  return index_handler_.delete_entry(make_key(record, key_buffer), rid);
+}
+
+RC BplusTreeIndex::bulk_load(RecordFileScanner &scanner, const string &temp_prefix)
+{
+  const IndexFileHeader &header     = index_handler_.file_header();
+  const KeyComparator   &comparator = index_handler_.key_comparator();
+
+  // 排序的数据与树中的键值格式相同，user key + RID
+  ExternalSorter sorter(
+      header.key_length,
+      [&comparator](const char *left, const char *right) { return comparator(left, right); },
+      build_param_.sort_buffer_size,
+      temp_prefix);
+
+  RC           rc = RC::SUCCESS;
+  Record       record;
+  vector<char> key_buffer;
+  vector<char> entry(header.key_length);
+  while (scanner.has_next()) {
+    rc = scanner.next(record);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to scan records while loading index. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+      return rc;
+    }
+
+    memcpy(entry.data(), make_key(record.data(), key_buffer), header.attr_length);
+    memcpy(entry.data() + header.attr_length, &record.rid(), sizeof(RID));
+    rc = sorter.add(entry.data());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to sort index keys. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+      return rc;
+    }
+  }
+
+  rc = sorter.finish();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to sort index keys. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+    return rc;
+  }
+
+  rc = index_handler_.bulk_load(
+      [&sorter](const char *&key) { return sorter.next(key); }, sorter.count(), build_param_.fill_factor);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to bulk load index. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+    return rc;
+  }
+
+  LOG_INFO("bulk load index done. index=%s, key count=%ld", index_meta_.name(), sorter.count());
+  return RC::SUCCESS;
 }
 
 IndexScanner *BplusTreeIndex::create_scanner(
@@ -112,6 +176,15 @@ RC BplusTreeIndexScanner::open(
 
 RC BplusTreeIndexScanner::next_entry(RID *rid) { return tree_scanner_.next_entry(*rid); }
 
+RC BplusTreeIndexScanner::next_entry(RID *rid, const char *&key)
+{
+  RC rc = tree_scanner_.next_entry(*rid);
+  if (OB_SUCC(rc)) {
+    key = tree_scanner_.current_key();
+  }
+  return rc;
+}
+
 RC BplusTreeIndexScanner::destroy()
 {
   delete this;
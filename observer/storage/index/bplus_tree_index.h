@@ -17,6 +17,18 @@ See the Mulan PSL v2 for more details. */
 #include "storage/index/bplus_tree.h"
 #include "storage/index/index.h"
 
+class RecordFileScanner;
+
+/**
+ * @brief 创建索引时的参数
+ * @ingroup Index
+ */
+struct IndexBuildParam
+{
+  float   fill_factor      = 0.9f;               ///< 批量构建时节点的填充比例
+  int64_t sort_buffer_size = 64L * 1024 * 1024;  ///< 排序键值时最多使用多少内存，超过之后写到临时文件中
+};
+
 /**
  * @brief B+树索引
  * @ingroup Index
@@ -27,13 +39,20 @@ public:
   BplusTreeIndex() = default;
   virtual ~BplusTreeIndex() noexcept;
 
-  RC create(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta);
-  RC open(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta);
+  RC create(const char *file_name, const IndexMeta &index_meta, const std::vector<FieldMeta> &field_metas);
+  RC open(const char *file_name, const IndexMeta &index_meta, const std::vector<FieldMeta> &field_metas);
   RC close();
 
   RC insert_entry(const char *record, const RID *rid) override;
   RC delete_entry(const char *record, const RID *rid) override;
 
+  /**
+   * @brief 把 scanner 中的所有记录批量加入到新创建的索引中
+   * @details 键值先做外部排序，再自底向上构建B+树，比逐条插入少了很多次查找和分裂，页面也是顺序写出的。
+   * @param temp_prefix 排序时临时文件名的前缀
+   */
+  RC bulk_load(RecordFileScanner &scanner, const std::string &temp_prefix);
+
   /**
    * 扫描指定范围的数据
    */
@@ -42,7 +61,12 @@ public:
 
   RC sync() override;
 
+  static void                   set_build_param(const IndexBuildParam &param) { build_param_ = param; }
+  static const IndexBuildParam &build_param() { return build_param_; }
+
 private:
+  static IndexBuildParam build_param_;
+
   bool             inited_ = false;
   BplusTreeHandler index_handler_;
 };
@@ -58,6 +82,7 @@ public:
   ~BplusTreeIndexScanner() noexcept override;
 
   RC next_entry(RID *rid) override;
+  RC next_entry(RID *rid, const char *&key) override;
   RC destroy() override;
 
   RC open(const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len,
@@ -0,0 +1,211 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "storage/index/external_sorter.h"
+#include "common/io/io.h"
+#include "common/log/log.h"
+
+using namespace std;
+using namespace common;
+
+ExternalSorter::ExternalSorter(
+    int item_size, Comparator comparator, int64_t memory_limit, const string &temp_prefix)
+    : item_size_(item_size), comparator_(std::move(comparator)), memory_limit_(memory_limit), temp_prefix_(temp_prefix)
+{
+  // 至少能放下两个读缓存，否则频繁地写临时文件得不偿失
+  memory_limit_ = std::max<int64_t>(memory_limit_, RUN_BUFFER_SIZE * 2);
+}
+
+ExternalSorter::~ExternalSorter()
+{
+  for (Run &run : runs_) {
+    if (run.fd >= 0) {
+      ::close(run.fd);
+    }
+    ::unlink(run.file_name.c_str());
+  }
+}
+
+RC ExternalSorter::add(const char *item)
+{
+  ASSERT(!finished_, "cannot add item after finished");
+
+  // sorted_ 中每条数据还要占用一个指针
+  const int64_t memory_used = static_cast<int64_t>(memory_.size() / item_size_) * (item_size_ + sizeof(char *));
+  if (memory_used + item_size_ + static_cast<int64_t>(sizeof(char *)) > memory_limit_) {
+    RC rc = spill();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  memory_.insert(memory_.end(), item, item + item_size_);
+  count_++;
+  return RC::SUCCESS;
+}
+
+void ExternalSorter::sort_memory()
+{
+  const size_t item_num = memory_.size() / item_size_;
+  sorted_.resize(item_num);
+  for (size_t i = 0; i < item_num; i++) {
+    sorted_[i] = memory_.data() + i * item_size_;
+  }
+
+  std::sort(sorted_.begin(), sorted_.end(), [this](const char *left, const char *right) {
+    return comparator_(left, right) < 0;
+  });
+  sorted_pos_ = 0;
+}
+
+RC ExternalSorter::spill()
+{
+  if (memory_.empty()) {
+    return RC::SUCCESS;
+  }
+
+  sort_memory();
+
+  Run run;
+  run.file_name = temp_prefix_ + "." + to_string(runs_.size());
+  run.remain    = static_cast<int64_t>(sorted_.size());
+  run.fd        = ::open(run.file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (run.fd < 0) {
+    LOG_WARN("failed to create temp file for sort. file=%s, error=%s", run.file_name.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+  runs_.push_back(run);
+
+  // 先拷贝到写缓存中，攒够一批再顺序写到文件中
+  vector<char> write_buffer;
+  write_buffer.reserve(RUN_BUFFER_SIZE);
+  for (size_t i = 0; i < sorted_.size(); i++) {
+    write_buffer.insert(write_buffer.end(), sorted_[i], sorted_[i] + item_size_);
+    if (write_buffer.size() + item_size_ > RUN_BUFFER_SIZE || i + 1 == sorted_.size()) {
+      int ret = writen(runs_.back().fd, write_buffer.data(), static_cast<int>(write_buffer.size()));
+      if (ret != 0) {
+        LOG_WARN("failed to write temp file for sort. file=%s, error=%s", run.file_name.c_str(), strerror(errno));
+        return RC::IOERR_WRITE;
+      }
+      write_buffer.clear();
+    }
+  }
+
+  LOG_INFO("spill sorted items to temp file. file=%s, item num=%d", run.file_name.c_str(), static_cast<int>(run.remain));
+  memory_.clear();
+  sorted_.clear();
+  return RC::SUCCESS;
+}
+
+RC ExternalSorter::fill_run(Run &run)
+{
+  const int64_t buffer_items = std::max(RUN_BUFFER_SIZE / item_size_, 1);
+  run.buffer_num             = static_cast<int>(std::min(run.remain, buffer_items));
+  run.buffer_pos             = 0;
+  if (run.buffer_num == 0) {
+    return RC::SUCCESS;
+  }
+
+  run.buffer.resize(static_cast<size_t>(run.buffer_num) * item_size_);
+  int ret = readn(run.fd, run.buffer.data(), static_cast<int>(run.buffer.size()));
+  if (ret != 0) {
+    LOG_WARN("failed to read temp file for sort. file=%s, ret=%d, error=%s", run.file_name.c_str(), ret, strerror(errno));
+    return RC::IOERR_READ;
+  }
+  run.remain -= run.buffer_num;
+  return RC::SUCCESS;
+}
+
+RC ExternalSorter::finish()
+{
+  finished_ = true;
+  if (runs_.empty()) {
+    // 数据都在内存中，不需要归并
+    sort_memory();
+    return RC::SUCCESS;
+  }
+
+  RC rc = spill();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  memory_.shrink_to_fit();
+
+  for (int i = 0; i < static_cast<int>(runs_.size()); i++) {
+    Run &run = runs_[i];
+    if (::lseek(run.fd, 0, SEEK_SET) < 0) {
+      LOG_WARN("failed to seek temp file for sort. file=%s, error=%s", run.file_name.c_str(), strerror(errno));
+      return RC::IOERR_SEEK;
+    }
+
+    rc = fill_run(run);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    if (run.buffer_num > 0) {
+      heap_.push_back(i);
+    }
+  }
+
+  auto greater = [this](int left, int right) { return comparator_(run_item(runs_[left]), run_item(runs_[right])) > 0; };
+  std::make_heap(heap_.begin(), heap_.end(), greater);
+  LOG_INFO("begin to merge sorted runs. run num=%d, item num=%ld", static_cast<int>(runs_.size()), count_);
+  return RC::SUCCESS;
+}
+
+RC ExternalSorter::next(const char *&item)
+{
+  ASSERT(finished_, "cannot get item before finished");
+
+  if (runs_.empty()) {
+    if (sorted_pos_ >= sorted_.size()) {
+      return RC::RECORD_EOF;
+    }
+    item = sorted_[sorted_pos_++];
+    return RC::SUCCESS;
+  }
+
+  auto greater = [this](int left, int right) { return comparator_(run_item(runs_[left]), run_item(runs_[right])) > 0; };
+
+  // 上一次返回的数据已经用完了，对应的 run 向后移动一条再放回堆中
+  if (last_run_ >= 0) {
+    Run &run = runs_[last_run_];
+    run.buffer_pos++;
+    if (run.buffer_pos >= run.buffer_num) {
+      RC rc = fill_run(run);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+
+    if (run.buffer_num > 0) {
+      heap_.push_back(last_run_);
+      std::push_heap(heap_.begin(), heap_.end(), greater);
+    }
+    last_run_ = -1;
+  }
+
+  if (heap_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  std::pop_heap(heap_.begin(), heap_.end(), greater);
+  last_run_ = heap_.back();
+  heap_.pop_back();
+  item = run_item(runs_[last_run_]);
+  return RC::SUCCESS;
+}
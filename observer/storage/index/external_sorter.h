@@ -0,0 +1,114 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "common/rc.h"
+
+/**
+ * @brief 定长数据的外部排序
+ * @ingroup Index
+ * @details 数据先放在内存中，超过内存限制之后排好序写到一个临时文件中(称为一个 run)，
+ * 所有数据都添加完之后，再对所有的 run 做多路归并，依次返回排好序的数据。
+ * 数据量不超过内存限制时不会写临时文件。临时文件都是顺序读写的，在对象析构时删除。
+ */
+class ExternalSorter
+{
+public:
+  using Comparator = std::function<int(const char *, const char *)>;
+
+  /**
+   * @param item_size    每条数据的长度
+   * @param comparator   比较函数，返回值与 strcmp 的含义相同
+   * @param memory_limit 内存中最多缓存多少字节的数据
+   * @param temp_prefix  临时文件名的前缀，后面会加上 run 的编号
+   */
+  ExternalSorter(int item_size, Comparator comparator, int64_t memory_limit, const std::string &temp_prefix);
+  ~ExternalSorter();
+
+  /**
+   * @brief 添加一条数据，必须在 finish 之前调用
+   */
+  RC add(const char *item);
+
+  /**
+   * @brief 数据已经添加完了，准备按照顺序输出
+   */
+  RC finish();
+
+  /**
+   * @brief 按照顺序返回下一条数据
+   * @details 返回的数据在下一次调用 next 之前有效，没有数据时返回 RECORD_EOF
+   */
+  RC next(const char *&item);
+
+  /**
+   * @brief 一共添加了多少条数据
+   */
+  int64_t count() const { return count_; }
+
+private:
+  /**
+   * @brief 一个排好序的临时文件
+   */
+  struct Run
+  {
+    std::string       file_name;
+    int               fd         = -1;
+    int64_t           remain     = 0;  ///< 文件中还没有读到内存中的数据条数
+    std::vector<char> buffer;          ///< 读缓存
+    int               buffer_num = 0;  ///< 读缓存中数据的条数
+    int               buffer_pos = 0;  ///< 读缓存中下一条数据的位置
+  };
+
+  /**
+   * @brief 把内存中的数据排序，排序的结果放在 sorted_ 中
+   */
+  void sort_memory();
+
+  /**
+   * @brief 把内存中的数据排好序之后写到一个新的临时文件中
+   */
+  RC spill();
+
+  /**
+   * @brief 读缓存中的数据都用完了，从文件中读取下一批
+   */
+  RC fill_run(Run &run);
+
+  const char *run_item(const Run &run) const
+  {
+    return run.buffer.data() + static_cast<size_t>(run.buffer_pos) * item_size_;
+  }
+
+private:
+  /// 归并时每个 run 的读缓存大小
+  static constexpr int RUN_BUFFER_SIZE = 256 * 1024;
+
+  const int         item_size_;
+  Comparator        comparator_;
+  int64_t           memory_limit_;
+  const std::string temp_prefix_;
+
+  int64_t                   count_    = 0;
+  bool                      finished_ = false;
+  std::vector<char>         memory_;  ///< 还没有写到临时文件中的数据
+  std::vector<const char *> sorted_;  ///< memory_ 中数据排好序之后的顺序
+  size_t                    sorted_pos_ = 0;
+
+  std::vector<Run> runs_;
+  std::vector<int> heap_;           ///< 归并时 run 编号的小顶堆，按照每个 run 当前的数据比较
+  int              last_run_ = -1;  ///< 上一次 next 返回的数据属于哪个 run，下一次调用时再向后移动
+};
@@ -12,11 +12,151 @@ See the Mulan PSL v2 for more details. */
 // Created by wangyunlai.wyl on 2021/5/19.
 //
 
+#include <limits>
+#include <string.h>
+
 #include "storage/index/index.h"
+#include "common/log/log.h"
+
+using namespace std;
 
-RC Index::init(const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC Index::init(const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
 {
-  index_meta_ = index_meta;
-  field_meta_ = field_meta;
+  index_meta_  = index_meta;
+  field_metas_ = field_metas;
+  key_length_  = 0;
+  for (const FieldMeta &field_meta : field_metas_) {
+    key_length_ += field_meta.len();
+  }
   return RC::SUCCESS;
 }
+
+const char *Index::make_key(const char *record, vector<char> &buffer) const
+{
+  if (field_metas_.size() == 1) {
+    return record + field_metas_[0].offset();
+  }
+
+  buffer.resize(key_length_);
+  char *key = buffer.data();
+  for (const FieldMeta &field_meta : field_metas_) {
+    memcpy(key, record + field_meta.offset(), field_meta.len());
+    key += field_meta.len();
+  }
+  return buffer.data();
+}
+
+/**
+ * @brief 把值按照字段的类型和长度写到键值中
+ */
+static void write_key_value(const FieldMeta &field_meta, const Value &value, char *key)
+{
+  switch (field_meta.type()) {
+    case INTS: {
+      int int_value = value.get_int();
+      memcpy(key, &int_value, sizeof(int_value));
+    } break;
+    case FLOATS: {
+      float float_value = value.get_float();
+      memcpy(key, &float_value, sizeof(float_value));
+    } break;
+    case CHARS: {
+      string str_value = value.get_string();
+      memset(key, 0, field_meta.len());
+      memcpy(key, str_value.data(), min(static_cast<int>(str_value.size()), field_meta.len()));
+    } break;
+    default: {
+      memset(key, 0, field_meta.len());
+      memcpy(key, value.data(), min(value.length(), field_meta.len()));
+    } break;
+  }
+}
+
+/**
+ * @brief 把字段类型的最小值或最大值写到键值中，用来表示这个字段没有限制
+ */
+static void write_key_bound(const FieldMeta &field_meta, bool max_bound, char *key)
+{
+  switch (field_meta.type()) {
+    case INTS: {
+      int int_value = max_bound ? numeric_limits<int>::max() : numeric_limits<int>::min();
+      memcpy(key, &int_value, sizeof(int_value));
+    } break;
+    case FLOATS: {
+      float float_value = max_bound ? numeric_limits<float>::infinity() : -numeric_limits<float>::infinity();
+      memcpy(key, &float_value, sizeof(float_value));
+    } break;
+    default: {
+      // 字符串按照无符号字节比较，全0是最小值，全0xFF是最大值
+      memset(key, max_bound ? 0xFF : 0, field_meta.len());
+    } break;
+  }
+}
+
+IndexScanner *Index::create_prefix_scanner(const vector<Value> &prefix_values, const Value *left_value,
+    bool left_inclusive, const Value *right_value, bool right_inclusive)
+{
+  const int field_num  = static_cast<int>(field_metas_.size());
+  const int prefix_num = static_cast<int>(prefix_values.size());
+  if (prefix_num > field_num || (prefix_num == field_num && (left_value != nullptr || right_value != nullptr))) {
+    LOG_WARN("invalid prefix of index. index=%s, field num=%d, prefix num=%d", index_meta_.name(), field_num, prefix_num);
+    return nullptr;
+  }
+
+  // 单列索引还是使用原来的方式，字符串的长度由 B+ 树自己处理
+  if (field_num == 1) {
+    if (prefix_num == 1) {
+      left_value = right_value = &prefix_values[0];
+      left_inclusive = right_inclusive = true;
+    }
+    return create_scanner(left_value == nullptr ? nullptr : left_value->data(),
+        left_value == nullptr ? 0 : left_value->length(),
+        left_inclusive,
+        right_value == nullptr ? nullptr : right_value->data(),
+        right_value == nullptr ? 0 : right_value->length(),
+        right_inclusive);
+  }
+
+  vector<char> left_key(key_length_);
+  vector<char> right_key(key_length_);
+  char        *left  = left_key.data();
+  char        *right = right_key.data();
+
+  int i = 0;
+  for (; i < prefix_num; i++) {
+    write_key_value(field_metas_[i], prefix_values[i], left);
+    write_key_value(field_metas_[i], prefix_values[i], right);
+    left += field_metas_[i].len();
+    right += field_metas_[i].len();
+  }
+
+  if (i < field_num) {
+    if (left_value != nullptr) {
+      write_key_value(field_metas_[i], *left_value, left);
+    } else {
+      write_key_bound(field_metas_[i], false /*max_bound*/, left);
+      left_inclusive = true;
+    }
+    if (right_value != nullptr) {
+      write_key_value(field_metas_[i], *right_value, right);
+    } else {
+      write_key_bound(field_metas_[i], true /*max_bound*/, right);
+      right_inclusive = true;
+    }
+    left += field_metas_[i].len();
+    right += field_metas_[i].len();
+    i++;
+  } else {
+    left_inclusive = right_inclusive = true;
+  }
+
+  // 后面的字段不做限制。包含边界时左边取最小值、右边取最大值；不包含边界时正好相反，跳过与边界相等的所有键值
+  for (; i < field_num; i++) {
+    write_key_bound(field_metas_[i], !left_inclusive, left);
+    write_key_bound(field_metas_[i], right_inclusive, right);
+    left += field_metas_[i].len();
+    right += field_metas_[i].len();
+  }
+
+  return create_scanner(left_key.data(), key_length_, left_inclusive, right_key.data(), key_length_, right_inclusive);
+}
@@ -18,6 +18,7 @@ See the Mulan PSL v2 for more details. */
 #include <vector>
 
 #include "common/rc.h"
+#include "sql/parser/value.h"
 #include "storage/field/field_meta.h"
 #include "storage/index/index_meta.h"
 #include "storage/record/record_manager.h"
@@ -71,18 +72,39 @@ public:
   virtual IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
       int right_len, bool right_inclusive) = 0;
 
+  /**
+   * @brief 创建一个按照索引字段前缀扫描的扫描器
+   * @details 前面 prefix_values.size() 个字段等值匹配，紧接着的一个字段可以再指定一个范围，后面的字段不做限制。
+   * 值会按照字段的类型转换之后拼成完整的键值，没有限制的字段使用这个类型的最小值或最大值填充。
+   * 字符串超过字段长度时会被截断，扫描的范围可能会比条件大一些，调用者需要再过滤一次。
+   * @param prefix_values  前面几个字段的值，按照索引字段的顺序
+   * @param left_value     下一个字段的左边界，为空表示没有左边界
+   * @param right_value    下一个字段的右边界，为空表示没有右边界
+   */
+  IndexScanner *create_prefix_scanner(const std::vector<Value> &prefix_values, const Value *left_value,
+      bool left_inclusive, const Value *right_value, bool right_inclusive);
+
   /**
    * @brief 同步索引数据到磁盘
    *
    */
   virtual RC sync() = 0;
 
+  const std::vector<FieldMeta> &field_metas() const { return field_metas_; }
+
 protected:
-  RC init(const IndexMeta &index_meta, const FieldMeta &field_meta);
+  RC init(const IndexMeta &index_meta, const std::vector<FieldMeta> &field_metas);
+
+  /**
+   * @brief 从记录中取出索引的键值
+   * @details 单列索引直接返回记录中字段的位置，多列索引把各个字段复制到 buffer 中拼成一个键值
+   */
+  const char *make_key(const char *record, std::vector<char> &buffer) const;
 
 protected:
-  IndexMeta index_meta_;  ///< 索引的元数据
-  FieldMeta field_meta_;  ///< 当前实现仅考虑一个字段的索引
+  IndexMeta              index_meta_;      ///< 索引的元数据
+  std::vector<FieldMeta> field_metas_;     ///< 索引包含的字段，按照键值中的顺序
+  int                    key_length_ = 0;  ///< 所有字段的总长度
 };
 
 /**
@@ -101,4 +123,10 @@ public:
    */
   virtual RC next_entry(RID *rid) = 0;
   virtual RC destroy()            = 0;
+
+  /**
+   * @brief 遍历数据时同时返回索引的键值，用于不需要回表的扫描
+   * @details 键值是索引各个字段按照顺序拼起来的，不包含RID，在下一次调用 next_entry 之前有效
+   */
+  virtual RC next_entry(RID * /*rid*/, const char *& /*key*/) { return RC::UNIMPLENMENT; }
 };
@@ -21,23 +21,52 @@ See the Mulan PSL v2 for more details. */
 
 const static Json::StaticString FIELD_NAME("name");
 const static Json::StaticString FIELD_FIELD_NAME("field_name");
+const static Json::StaticString FIELD_FIELD_NAMES("field_names");
+const static Json::StaticString FIELD_UNIQUE("unique");
 
 RC IndexMeta::init(const char *name, const FieldMeta &field)
+{
+  return init(name, std::vector<const FieldMeta *>{&field});
+}
+
+RC IndexMeta::init(const char *name, const std::vector<const FieldMeta *> &fields, bool unique /* = false */)
 {
   if (common::is_blank(name)) {
     LOG_ERROR("Failed to init index, name is empty.");
     return RC::INVALID_ARGUMENT;
   }
 
-  name_  = name;
-  field_ = field.name();
+  if (fields.empty() || static_cast<int>(fields.size()) > MAX_FIELD_NUM) {
+    LOG_ERROR("Failed to init index, invalid field number. name=%s, field num=%d, max=%d",
+              name, static_cast<int>(fields.size()), MAX_FIELD_NUM);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  name_   = name;
+  unique_ = unique;
+  fields_.clear();
+  for (const FieldMeta *field : fields) {
+    fields_.push_back(field->name());
+  }
   return RC::SUCCESS;
 }
 
 void IndexMeta::to_json(Json::Value &json_value) const
 {
   json_value[FIELD_NAME]       = name_;
-  json_value[FIELD_FIELD_NAME] = field_;
+  json_value[FIELD_FIELD_NAME] = fields_[0];
+
+  if (fields_.size() > 1) {
+    Json::Value field_names;
+    for (const std::string &field : fields_) {
+      field_names.append(field);
+    }
+    json_value[FIELD_FIELD_NAMES] = std::move(field_names);
+  }
+
+  if (unique_) {
+    json_value[FIELD_UNIQUE] = true;
+  }
 }
 
 RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index)
@@ -55,17 +84,48 @@ RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, I
     return RC::INTERNAL;
   }
 
-  const FieldMeta *field = table.field(field_value.asCString());
-  if (nullptr == field) {
-    LOG_ERROR("Deserialize index [%s]: no such field: %s", name_value.asCString(), field_value.asCString());
-    return RC::SCHEMA_FIELD_MISSING;
+  // 单列索引只有 field_name，多列索引的所有字段放在 field_names 中
+  std::vector<const char *> field_names;
+  const Json::Value        &field_names_value = json_value[FIELD_FIELD_NAMES];
+  if (field_names_value.isArray()) {
+    for (int i = 0; i < static_cast<int>(field_names_value.size()); i++) {
+      if (!field_names_value[i].isString()) {
+        LOG_ERROR("Field name of index [%s] is not a string. json value=%s",
+            name_value.asCString(), field_names_value[i].toStyledString().c_str());
+        return RC::INTERNAL;
+      }
+      field_names.push_back(field_names_value[i].asCString());
+    }
+  } else {
+    field_names.push_back(field_value.asCString());
   }
 
-  return index.init(name_value.asCString(), *field);
+  std::vector<const FieldMeta *> fields;
+  for (const char *field_name : field_names) {
+    const FieldMeta *field = table.field(field_name);
+    if (nullptr == field) {
+      LOG_ERROR("Deserialize index [%s]: no such field: %s", name_value.asCString(), field_name);
+      return RC::SCHEMA_FIELD_MISSING;
+    }
+    fields.push_back(field);
+  }
+
+  const Json::Value &unique_value = json_value[FIELD_UNIQUE];
+  const bool         unique       = unique_value.isBool() && unique_value.asBool();
+  return index.init(name_value.asCString(), fields, unique);
 }
 
 const char *IndexMeta::name() const { return name_.c_str(); }
 
-const char *IndexMeta::field() const { return field_.c_str(); }
+const char *IndexMeta::field() const { return fields_[0].c_str(); }
 
-void IndexMeta::desc(std::ostream &os) const { os << "index name=" << name_ << ", field=" << field_; }
\ No newline at end of file
+void IndexMeta::desc(std::ostream &os) const
+{
+  os << "index name=" << name_ << (unique_ ? ", unique" : "") << ", field=";
+  for (size_t i = 0; i < fields_.size(); i++) {
+    if (i != 0) {
+      os << ",";
+    }
+    os << fields_[i];
+  }
+}
\ No newline at end of file
@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/rc.h"
 #include <string>
+#include <vector>
 
 class TableMeta;
 class FieldMeta;
@@ -28,18 +29,31 @@ class Value;
  * @brief 描述一个索引
  * @ingroup Index
  * @details 一个索引包含了表的哪些字段，索引的名称等。
+ * 多列索引的字段是有顺序的，索引的键值按照字段的顺序依次比较。
  * 如果以后实现了多种类型的索引，还需要记录索引的类型，对应类型的一些元数据等
  */
 class IndexMeta
 {
+public:
+  /// 一个索引最多包含多少个字段
+  static constexpr int MAX_FIELD_NUM = 8;
+
 public:
   IndexMeta() = default;
 
   RC init(const char *name, const FieldMeta &field);
+  RC init(const char *name, const std::vector<const FieldMeta *> &fields, bool unique = false);
 
 public:
   const char *name() const;
+
+  /**
+   * @brief 索引的第一个字段
+   */
   const char *field() const;
+  const char *field(int i) const { return fields_[i].c_str(); }
+  int         field_num() const { return static_cast<int>(fields_.size()); }
+  bool        unique() const { return unique_; }
 
   void desc(std::ostream &os) const;
 
@@ -48,6 +62,7 @@ public:
   static RC from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index);
 
 protected:
-  std::string name_;   // index's name
-  std::string field_;  // field's name
+  std::string              name_;    // index's name
+  std::vector<std::string> fields_;          // field names, in key order
+  bool                     unique_ = false;  // 唯一索引不允许出现重复的键值
 };
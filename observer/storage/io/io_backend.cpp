@@ -0,0 +1,321 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <limits.h>
+#include <sstream>
+#include <string.h>
+#include <unistd.h>
+
+#include "storage/io/io_backend.h"
+#include "common/lang/string.h"
+#include "common/log/log.h"
+#include "storage/io/io_uring_backend.h"
+
+using namespace std;
+
+const char *io_type_name(IoType type)
+{
+  switch (type) {
+    case IoType::READ: return "read";
+    case IoType::WRITE: return "write";
+    case IoType::FSYNC: return "fsync";
+    default: return "unknown";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+IoRequest IoRequest::read(int fd, void *buf, int64_t size, int64_t offset)
+{
+  IoRequest request;
+  request.type   = IoType::READ;
+  request.fd     = fd;
+  request.offset = offset;
+  request.iovs.push_back({buf, static_cast<size_t>(size)});
+  return request;
+}
+
+IoRequest IoRequest::write(int fd, const void *buf, int64_t size, int64_t offset)
+{
+  IoRequest request;
+  request.type   = IoType::WRITE;
+  request.fd     = fd;
+  request.offset = offset;
+  request.iovs.push_back({const_cast<void *>(buf), static_cast<size_t>(size)});
+  return request;
+}
+
+IoRequest IoRequest::fsync(int fd)
+{
+  IoRequest request;
+  request.type = IoType::FSYNC;
+  request.fd   = fd;
+  return request;
+}
+
+int64_t IoRequest::total_size() const
+{
+  int64_t size = 0;
+  for (const struct iovec &iov : iovs) {
+    size += static_cast<int64_t>(iov.iov_len);
+  }
+  return size;
+}
+
+bool IoRequest::succeeded() const
+{
+  if (type == IoType::FSYNC) {
+    return result == 0;
+  }
+  return result == total_size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IoLatencyHistogram::record(uint64_t latency_us)
+{
+  // 第0个桶放0，第i个桶放 [2^(i-1), 2^i - 1]
+  const int index = latency_us == 0 ? 0 : std::min(64 - __builtin_clzll(latency_us), BUCKET_NUM - 1);
+  buckets_[index].fetch_add(1, memory_order_relaxed);
+}
+
+uint64_t IoLatencyHistogram::count() const
+{
+  uint64_t total = 0;
+  for (const atomic<uint64_t> &bucket : buckets_) {
+    total += bucket.load(memory_order_relaxed);
+  }
+  return total;
+}
+
+uint64_t IoLatencyHistogram::percentile(double percentile) const
+{
+  const uint64_t total = count();
+  if (total == 0) {
+    return 0;
+  }
+
+  const uint64_t threshold = std::max<uint64_t>(static_cast<uint64_t>(total * percentile / 100.0), 1);
+
+  uint64_t accumulated = 0;
+  for (int i = 0; i < BUCKET_NUM; i++) {
+    accumulated += buckets_[i].load(memory_order_relaxed);
+    if (accumulated >= threshold) {
+      return i == 0 ? 0 : (1ULL << i) - 1;
+    }
+  }
+  return UINT64_MAX;
+}
+
+string IoLatencyHistogram::to_string() const
+{
+  stringstream ss;
+  ss << "count:" << count() << ", p50:" << percentile(50) << "us, p99:" << percentile(99)
+     << "us, p99.9:" << percentile(99.9) << "us";
+  return ss.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RC IoBackend::submit(vector<IoRequest> &requests)
+{
+  if (requests.empty()) {
+    return RC::SUCCESS;
+  }
+
+  for (IoRequest &request : requests) {
+    request.latency_us = 0;
+  }
+
+  do_submit(requests);
+
+  RC rc = RC::SUCCESS;
+  for (IoRequest &request : requests) {
+    latencies_[static_cast<int>(request.type)].record(request.latency_us);
+
+    if (OB_SUCC(rc) && !request.succeeded()) {
+      switch (request.type) {
+        case IoType::READ: rc = RC::IOERR_READ; break;
+        case IoType::WRITE: rc = RC::IOERR_WRITE; break;
+        case IoType::FSYNC: rc = RC::IOERR_SYNC; break;
+      }
+
+      LOG_WARN("io request failed. backend=%s, type=%s, fd=%d, offset=%ld, size=%ld, result=%ld, error=%s",
+               name(), io_type_name(request.type), request.fd, request.offset, request.total_size(),
+               request.result, request.result < 0 ? strerror(-request.result) : "incomplete");
+    }
+  }
+  return rc;
+}
+
+RC IoBackend::read(int fd, void *buf, int64_t size, int64_t offset)
+{
+  vector<IoRequest> requests{IoRequest::read(fd, buf, size, offset)};
+  return submit(requests);
+}
+
+RC IoBackend::readv(int fd, const struct iovec *iovs, int iov_count, int64_t offset)
+{
+  vector<IoRequest> requests(1);
+  requests[0].type   = IoType::READ;
+  requests[0].fd     = fd;
+  requests[0].offset = offset;
+  requests[0].iovs.assign(iovs, iovs + iov_count);
+  return submit(requests);
+}
+
+RC IoBackend::write(int fd, const void *buf, int64_t size, int64_t offset)
+{
+  vector<IoRequest> requests{IoRequest::write(fd, buf, size, offset)};
+  return submit(requests);
+}
+
+RC IoBackend::writev(int fd, const struct iovec *iovs, int iov_count, int64_t offset)
+{
+  vector<IoRequest> requests(1);
+  requests[0].type   = IoType::WRITE;
+  requests[0].fd     = fd;
+  requests[0].offset = offset;
+  requests[0].iovs.assign(iovs, iovs + iov_count);
+  return submit(requests);
+}
+
+RC IoBackend::sync(int fd)
+{
+  vector<IoRequest> requests{IoRequest::fsync(fd)};
+  return submit(requests);
+}
+
+RC IoBackend::write_and_sync(int fd, const void *buf, int64_t size, int64_t offset)
+{
+  vector<IoRequest> requests{IoRequest::write(fd, buf, size, offset), IoRequest::fsync(fd)};
+  requests[0].link = true;
+  return submit(requests);
+}
+
+string IoBackend::latency_string() const
+{
+  stringstream ss;
+  ss << "io backend:" << name();
+  for (IoType type : {IoType::READ, IoType::WRITE, IoType::FSYNC}) {
+    ss << ", " << io_type_name(type) << " {" << latency(type).to_string() << "}";
+  }
+  return ss.str();
+}
+
+/**
+ * @brief 使用同步的系统调用执行一个请求，参考 IoBackend::execute_sync
+ */
+static void execute_sync_request(IoRequest &request)
+{
+  if (request.type == IoType::FSYNC) {
+    request.result = ::fsync(request.fd) == 0 ? 0 : -errno;
+    return;
+  }
+
+  // result 中可能已经记录了完成的部分，从没有完成的地方继续
+  int64_t             done  = std::max<int64_t>(request.result, 0);
+  const int64_t       total = request.total_size();
+  vector<struct iovec> iovs  = request.iovs;
+  size_t              index = 0;
+
+  auto advance = [&iovs, &index](int64_t bytes) {
+    while (bytes > 0 && index < iovs.size()) {
+      if (static_cast<int64_t>(iovs[index].iov_len) <= bytes) {
+        bytes -= iovs[index].iov_len;
+        index++;
+      } else {
+        iovs[index].iov_base = static_cast<char *>(iovs[index].iov_base) + bytes;
+        iovs[index].iov_len -= bytes;
+        bytes = 0;
+      }
+    }
+  };
+
+  advance(done);
+  while (done < total) {
+    const int iov_count = static_cast<int>(std::min<size_t>(iovs.size() - index, IOV_MAX));
+
+    ssize_t ret = request.type == IoType::READ ? ::preadv(request.fd, &iovs[index], iov_count, request.offset + done)
+                                               : ::pwritev(request.fd, &iovs[index], iov_count, request.offset + done);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      request.result = -errno;
+      return;
+    }
+
+    if (ret == 0) {
+      break;  // 读到了文件尾
+    }
+
+    done += ret;
+    advance(ret);
+  }
+  request.result = done;
+}
+
+void IoBackend::execute_sync(IoRequest &request)
+{
+  const auto begin_time = chrono::steady_clock::now();
+  execute_sync_request(request);
+  const auto end_time = chrono::steady_clock::now();
+  request.latency_us += chrono::duration_cast<chrono::microseconds>(end_time - begin_time).count();
+}
+
+static IoBackend *default_io_backend = nullptr;
+
+IoBackend *IoBackend::create(const char *name, [[maybe_unused]] int queue_depth)
+{
+  const char *default_name = "sync";
+  if (nullptr == name || common::is_blank(name)) {
+    name = default_name;
+  }
+
+  if (0 == strcasecmp(name, default_name)) {
+    return new SyncIoBackend();
+  } else if (0 == strcasecmp(name, "io_uring")) {
+#ifdef USE_IO_URING
+    return new IoUringBackend(queue_depth);
+#else
+    LOG_ERROR("io_uring backend is not supported, the observer is built without liburing");
+    return nullptr;
+#endif
+  } else {
+    LOG_ERROR("unknown io backend: %s", name);
+    return nullptr;
+  }
+}
+
+void IoBackend::set_instance(IoBackend *backend) { default_io_backend = backend; }
+
+IoBackend &IoBackend::instance()
+{
+  static SyncIoBackend sync_backend;
+  return default_io_backend != nullptr ? *default_io_backend : sync_backend;
+}
+
+void IoBackend::execute_sync_batch(vector<IoRequest> &requests)
+{
+  bool canceled = false;
+  for (IoRequest &request : requests) {
+    if (canceled) {
+      request.result = -ECANCELED;
+    } else {
+      request.result = 0;
+      execute_sync(request);
+    }
+    canceled = request.link && !request.succeeded();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SyncIoBackend::do_submit(vector<IoRequest> &requests) { execute_sync_batch(requests); }
@@ -0,0 +1,189 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <sys/uio.h>
+#include <vector>
+
+#include "common/rc.h"
+
+/**
+ * @brief 文件读写的后端实现
+ * @defgroup IO
+ * @details 数据文件(DiskBufferPool)和日志文件(CLogFile)的读写都通过 IoBackend 执行，
+ * 这样可以在启动时选择使用同步的系统调用还是 io_uring。
+ */
+
+/**
+ * @brief IO 请求的类型
+ * @ingroup IO
+ */
+enum class IoType
+{
+  READ,
+  WRITE,
+  FSYNC,
+};
+
+const char *io_type_name(IoType type);
+
+/**
+ * @brief 一个 IO 请求
+ * @ingroup IO
+ */
+struct IoRequest
+{
+  IoType                    type       = IoType::READ;
+  int                       fd         = -1;
+  int64_t                   offset     = 0;      ///< 读写的文件位置，FSYNC 请求不使用
+  std::vector<struct iovec> iovs;                ///< 读写的内存，FSYNC 请求不使用
+  bool                      link       = false;  ///< 下一个请求在这个请求成功之后才执行，否则下一个请求被取消
+  int64_t                   result     = 0;      ///< 执行结果，读写的字节数，负数表示错误码(-errno)
+  uint64_t                  latency_us = 0;      ///< 从提交到完成花费的时间(微秒)，由 IO 后端在执行时累加
+
+  static IoRequest read(int fd, void *buf, int64_t size, int64_t offset);
+  static IoRequest write(int fd, const void *buf, int64_t size, int64_t offset);
+  static IoRequest fsync(int fd);
+
+  int64_t total_size() const;
+
+  /**
+   * @brief 请求是否全部执行成功
+   * @details 读写请求需要把所有的数据都读写完才算成功
+   */
+  bool succeeded() const;
+};
+
+/**
+ * @brief IO 延迟的直方图
+ * @ingroup IO
+ * @details 按照延迟(微秒)的以2为底的对数分桶，计算出来的分位数是所在桶的上界，是一个近似值。
+ */
+class IoLatencyHistogram
+{
+public:
+  void record(uint64_t latency_us);
+
+  uint64_t count() const;
+
+  /**
+   * @brief 计算分位数
+   * @param percentile 百分位，比如 99 或 99.9
+   * @return 延迟的上界(微秒)
+   */
+  uint64_t percentile(double percentile) const;
+
+  std::string to_string() const;
+
+private:
+  static constexpr int BUCKET_NUM = 64;
+
+  std::atomic<uint64_t> buckets_[BUCKET_NUM] = {};
+};
+
+/**
+ * @brief 文件读写的后端
+ * @ingroup IO
+ * @details 所有的请求都是同步返回的：submit 在所有请求执行完之后才返回。不同的实现区别在于
+ * 一批请求能否一次提交给内核、并行执行，以及等待请求完成的方式。
+ * 每种请求的延迟(从提交到完成)都会记录下来，可以用来比较不同的实现。一批请求中不同类型的请求完成的
+ * 时间不同，所以由后端记录每个请求自己的延迟(IoRequest::latency_us)，而不是整批请求的时间。
+ */
+class IoBackend
+{
+public:
+  virtual ~IoBackend() = default;
+
+  virtual const char *name() const = 0;
+
+  virtual RC init() { return RC::SUCCESS; }
+
+  /**
+   * @brief 提交一批请求并等待它们全部执行完成
+   * @details 每个请求的结果放在 IoRequest::result 中。设置了 link 的请求与下一个请求按顺序执行，
+   * 比如写数据之后紧跟着 fsync。
+   * @return 所有请求都成功时返回成功，否则返回第一个失败请求对应的错误码
+   */
+  RC submit(std::vector<IoRequest> &requests);
+
+  RC read(int fd, void *buf, int64_t size, int64_t offset);
+  RC readv(int fd, const struct iovec *iovs, int iov_count, int64_t offset);
+  RC write(int fd, const void *buf, int64_t size, int64_t offset);
+  RC writev(int fd, const struct iovec *iovs, int iov_count, int64_t offset);
+  RC sync(int fd);
+
+  /**
+   * @brief 写入数据之后执行 fsync，两个请求一起提交
+   */
+  RC write_and_sync(int fd, const void *buf, int64_t size, int64_t offset);
+
+  const IoLatencyHistogram &latency(IoType type) const { return latencies_[static_cast<int>(type)]; }
+
+  /**
+   * @brief 各种请求的延迟分位数，用于输出到日志
+   */
+  std::string latency_string() const;
+
+public:
+  /**
+   * @brief 根据名字创建 IO 后端
+   * @param name 支持 sync 和 io_uring，为空时使用 sync
+   * @param queue_depth io_uring 的队列深度
+   * @return 名字不认识或者当前环境不支持时返回 nullptr
+   */
+  static IoBackend *create(const char *name, int queue_depth);
+
+  static void set_instance(IoBackend *backend);
+
+  /**
+   * @brief 全局的 IO 后端
+   * @details 如果没有设置过，就使用一个同步的 IO 后端
+   */
+  static IoBackend &instance();
+
+protected:
+  /**
+   * @brief 执行一批请求，所有请求都完成之后才返回
+   * @details 需要把每个请求花费的时间累加到 IoRequest::latency_us 中
+   */
+  virtual void do_submit(std::vector<IoRequest> &requests) = 0;
+
+  /**
+   * @brief 使用同步的系统调用执行一个请求
+   * @details 请求只完成了一部分时(比如读写了一部分数据)，会把剩下的部分执行完。
+   * 执行花费的时间累加到 IoRequest::latency_us 中
+   */
+  static void execute_sync(IoRequest &request);
+
+  /**
+   * @brief 使用同步的系统调用按顺序执行一批请求，处理 link 的语义
+   */
+  static void execute_sync_batch(std::vector<IoRequest> &requests);
+
+private:
+  IoLatencyHistogram latencies_[3];
+};
+
+/**
+ * @brief 使用同步系统调用(preadv/pwritev/fsync)的 IO 后端
+ * @ingroup IO
+ */
+class SyncIoBackend : public IoBackend
+{
+public:
+  const char *name() const override { return "sync"; }
+
+protected:
+  void do_submit(std::vector<IoRequest> &requests) override;
+};
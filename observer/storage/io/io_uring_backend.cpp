@@ -0,0 +1,259 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#ifdef USE_IO_URING
+
+#include <errno.h>
+#include <string.h>
+
+#include "storage/io/io_uring_backend.h"
+#include "common/log/log.h"
+#include "common/thread/thread_util.h"
+
+using namespace common;
+using namespace std;
+
+IoUringBackend::IoUringBackend(int queue_depth) : queue_depth_(queue_depth)
+{
+  if (queue_depth_ <= 0) {
+    queue_depth_ = 64;
+  }
+}
+
+IoUringBackend::~IoUringBackend()
+{
+  if (reaper_ != nullptr) {
+    stopped_ = true;
+
+    // 提交一个没有 user_data 的 NOP 请求，唤醒完成线程让它退出。
+    // 提交失败时留在提交队列中的请求已经改成了 NOP，拿不到 sqe 时直接提交它们也可以唤醒完成线程
+    int ret = 0;
+    {
+      lock_guard<mutex> guard(submit_lock_);
+      struct io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+      if (sqe != nullptr) {
+        io_uring_prep_nop(sqe);
+        io_uring_sqe_set_data(sqe, nullptr);
+      }
+      do {
+        ret = io_uring_submit(&ring_);
+      } while (ret == -EINTR);
+    }
+
+    if (ret <= 0) {
+      // 没有办法唤醒完成线程。所有的请求都已经完成了，它会一直阻塞在等待完成事件上，不会再访问 ring_，
+      // 这里不能销毁 ring_，只能放着不管，进程退出时再回收
+      LOG_ERROR("failed to wake up io_uring reaper, leave it alone. error=%s", ret < 0 ? strerror(-ret) : "none");
+      reaper_->detach();
+      delete reaper_;
+      reaper_      = nullptr;
+      ring_inited_ = false;
+      return;
+    }
+
+    reaper_->join();
+    delete reaper_;
+    reaper_ = nullptr;
+  }
+
+  if (ring_inited_) {
+    io_uring_queue_exit(&ring_);
+    ring_inited_ = false;
+  }
+}
+
+RC IoUringBackend::init()
+{
+  int ret = io_uring_queue_init(queue_depth_, &ring_, 0);
+  if (ret < 0) {
+    LOG_ERROR("failed to init io_uring. queue depth=%d, error=%s", queue_depth_, strerror(-ret));
+    return RC::IOERR_OPEN;
+  }
+
+  ring_inited_ = true;
+  reaper_      = new thread(&IoUringBackend::reap_completions, this);
+  LOG_INFO("io_uring backend inited. queue depth=%d", queue_depth_);
+  return RC::SUCCESS;
+}
+
+void IoUringBackend::do_submit(vector<IoRequest> &requests)
+{
+  if (!ring_inited_ || broken_ || static_cast<int>(requests.size()) > queue_depth_) {
+    execute_sync_batch(requests);
+    return;
+  }
+
+  IoBatch              batch;
+  vector<IoCompletion> completions(requests.size());
+  batch.pending = static_cast<int>(requests.size());
+
+  int submitted = 0;  // 内核已经取走了多少个请求，提交队列中的请求是按顺序取走的
+  {
+    lock_guard<mutex> guard(submit_lock_);
+    if (broken_) {
+      execute_sync_batch(requests);
+      return;
+    }
+
+    // 每次提交都会等到提交队列中的请求全部被内核取走(或者把剩下的改成 NOP)，
+    // 所以这里提交队列总是空的，请求个数不超过队列深度时一定能拿到 sqe
+    vector<struct io_uring_sqe *> sqes(requests.size(), nullptr);
+    for (size_t i = 0; i < requests.size(); i++) {
+      IoRequest           &request = requests[i];
+      struct io_uring_sqe *sqe     = io_uring_get_sqe(&ring_);
+      ASSERT(sqe != nullptr, "cannot get sqe from io_uring. queue depth=%d", queue_depth_);
+
+      request.result = 0;
+      switch (request.type) {
+        case IoType::READ: {
+          io_uring_prep_readv(sqe, request.fd, request.iovs.data(), request.iovs.size(), request.offset);
+        } break;
+        case IoType::WRITE: {
+          io_uring_prep_writev(sqe, request.fd, request.iovs.data(), request.iovs.size(), request.offset);
+        } break;
+        case IoType::FSYNC: {
+          io_uring_prep_fsync(sqe, request.fd, 0);
+        } break;
+      }
+
+      // 最后一个请求不能设置 link，否则会和后面其它线程提交的请求串在一起
+      if (request.link && i + 1 < requests.size()) {
+        sqe->flags |= IOSQE_IO_LINK;
+      }
+
+      completions[i].request = &request;
+      completions[i].batch   = &batch;
+      io_uring_sqe_set_data(sqe, &completions[i]);
+      sqes[i] = sqe;
+    }
+
+    batch.submit_time = chrono::steady_clock::now();
+
+    // 内核一次可能只取走一部分请求，一直提交到全部取走为止。
+    // 内核暂时没有资源(EAGAIN/EBUSY，比如完成队列满了)时等一会儿，让完成线程先取走一些结果
+    int ret        = 0;
+    int busy_times = 0;
+    while (submitted < static_cast<int>(requests.size())) {
+      ret = io_uring_submit(&ring_);
+      if (ret > 0) {
+        submitted += ret;
+        busy_times = 0;
+      } else if (ret == -EINTR) {
+        continue;
+      } else if ((ret == 0 || ret == -EAGAIN || ret == -EBUSY) && busy_times < SUBMIT_BUSY_RETRY_TIMES) {
+        busy_times++;
+        this_thread::sleep_for(chrono::microseconds(1 << min(busy_times, 10)));
+      } else {
+        break;
+      }
+    }
+
+    if (submitted < static_cast<int>(requests.size())) {
+      // 没有取走的请求还留在提交队列中，没有办法撤回，把它们改成不关联任何请求的 NOP，
+      // 之后即使被提交也不会再访问这一批请求。以后不再使用 io_uring
+      LOG_ERROR("failed to submit io requests to io_uring, fallback to sync io. submitted=%d, total=%d, error=%s",
+                submitted, static_cast<int>(requests.size()), ret < 0 ? strerror(-ret) : "none");
+      broken_ = true;
+      for (size_t i = submitted; i < sqes.size(); i++) {
+        io_uring_prep_nop(sqes[i]);
+        io_uring_sqe_set_data(sqes[i], nullptr);
+      }
+
+      lock_guard<mutex> batch_guard(batch.lock);
+      batch.pending -= static_cast<int>(requests.size()) - submitted;
+    }
+  }
+
+  // 已经提交的请求还引用着 batch 和 completions，一定要等它们都完成之后才能返回
+  {
+    unique_lock<mutex> batch_guard(batch.lock);
+    batch.cond.wait(batch_guard, [&batch]() { return batch.pending == 0; });
+  }
+
+  // 读写请求可能只完成了一部分，比如读到了文件尾或者被信号打断，同步地把剩下的部分执行完。
+  // 内核会把只完成一部分的请求当作失败，取消 link 在它后面的请求，这些请求也需要重新执行
+  bool resumed = false;
+  for (int i = 0; i < submitted; i++) {
+    IoRequest &request = requests[i];
+    if (resumed && request.result == -ECANCELED) {
+      request.result = 0;
+      execute_sync(request);
+    } else if (request.type != IoType::FSYNC && request.result > 0 && request.result < request.total_size()) {
+      execute_sync(request);
+    } else {
+      resumed = false;
+      continue;
+    }
+    resumed = request.link && request.succeeded();
+  }
+
+  // 没有提交出去的请求同步执行，前面 link 的请求失败了就取消
+  bool canceled = submitted > 0 && requests[submitted - 1].link && !requests[submitted - 1].succeeded();
+  for (size_t i = submitted; i < requests.size(); i++) {
+    IoRequest &request = requests[i];
+    if (canceled) {
+      request.result = -ECANCELED;
+    } else {
+      request.result = 0;
+      execute_sync(request);
+    }
+    canceled = request.link && !request.succeeded();
+  }
+}
+
+void IoUringBackend::reap_completions()
+{
+  int ret = thread_set_name("IoUringReaper");
+  if (ret != 0) {
+    LOG_WARN("failed to set thread name. ret = %d", ret);
+  }
+
+  while (true) {
+    struct io_uring_cqe *cqe = nullptr;
+    ret                      = io_uring_wait_cqe(&ring_, &cqe);
+    if (ret < 0) {
+      if (ret == -EINTR) {
+        continue;
+      }
+      LOG_ERROR("failed to wait io_uring completion. error=%s", strerror(-ret));
+      if (stopped_) {
+        break;
+      }
+      continue;
+    }
+
+    IoCompletion *completion = static_cast<IoCompletion *>(io_uring_cqe_get_data(cqe));
+    const int     result     = cqe->res;
+    io_uring_cqe_seen(&ring_, cqe);
+
+    if (completion == nullptr) {
+      if (stopped_) {
+        break;
+      }
+      continue;
+    }
+
+    IoRequest *request = completion->request;
+    request->result = result;
+    request->latency_us += chrono::duration_cast<chrono::microseconds>(
+        chrono::steady_clock::now() - completion->batch->submit_time).count();
+
+    // 在锁内通知，等待的线程醒来之后 batch 就会被销毁，解锁之后不能再访问它
+    IoBatch          *batch = completion->batch;
+    lock_guard<mutex> batch_guard(batch->lock);
+    if (--batch->pending == 0) {
+      batch->cond.notify_one();
+    }
+  }
+
+  LOG_INFO("io_uring reaper stopped");
+}
+
+#endif  // USE_IO_URING
@@ -0,0 +1,87 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#ifdef USE_IO_URING
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <liburing.h>
+#include <mutex>
+#include <thread>
+
+#include "storage/io/io_backend.h"
+
+/**
+ * @brief 使用 io_uring 的 IO 后端
+ * @ingroup IO
+ * @details 一批请求准备好之后只调用一次 io_uring_submit 提交给内核，设置了 link 的请求使用
+ * IOSQE_IO_LINK 串联起来(比如写日志之后的 fsync)，由内核保证执行顺序。
+ * 提交请求的线程在这一批请求自己的条件变量上等待，由一个专门的线程从完成队列中取出结果，
+ * 一批请求全部完成时唤醒对应的线程，而不是让每个线程轮询完成队列。
+ * 一批请求的个数超过队列深度时，退化成同步执行。
+ */
+class IoUringBackend : public IoBackend
+{
+public:
+  explicit IoUringBackend(int queue_depth);
+  ~IoUringBackend() override;
+
+  const char *name() const override { return "io_uring"; }
+
+  RC init() override;
+
+protected:
+  void do_submit(std::vector<IoRequest> &requests) override;
+
+private:
+  /**
+   * @brief 一起提交的一批请求，记录还有多少个请求没有完成
+   */
+  struct IoBatch
+  {
+    std::mutex                            lock;
+    std::condition_variable               cond;
+    int                                   pending = 0;
+    std::chrono::steady_clock::time_point submit_time;  ///< 用来计算每个请求的延迟
+  };
+
+  /**
+   * @brief 放在 sqe 的 user_data 中，完成时据此找到请求和它所在的批次
+   */
+  struct IoCompletion
+  {
+    IoRequest *request = nullptr;
+    IoBatch   *batch   = nullptr;
+  };
+
+  /**
+   * @brief 完成线程的主函数，从完成队列中取出结果
+   */
+  void reap_completions();
+
+private:
+  /// 内核暂时没有资源接收请求时最多重试多少次，每次等待的时间逐渐变长
+  static constexpr int SUBMIT_BUSY_RETRY_TIMES = 64;
+
+  int             queue_depth_ = 0;
+  struct io_uring ring_;
+  bool            ring_inited_ = false;
+
+  std::atomic<bool> broken_{false};  ///< 提交失败之后不再使用 io_uring，全部同步执行。提交时不加锁先检查一次
+
+  std::mutex        submit_lock_;  ///< 保护提交队列，同一批请求需要连续地放到提交队列中
+  std::thread      *reaper_ = nullptr;
+  std::atomic<bool> stopped_{false};
+};
+
+#endif  // USE_IO_URING
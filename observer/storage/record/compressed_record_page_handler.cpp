@@ -0,0 +1,651 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+#include "storage/record/compressed_record_page_handler.h"
+#include "common/lang/bitmap.h"
+#include "common/log/log.h"
+#include "storage/table/table_meta.h"
+
+using namespace std;
+using namespace common;
+
+// 定义在 record_manager.cpp 中
+int align8(int size);
+int page_bitmap_size(int record_capacity);
+
+static constexpr int COMPRESSED_PAGE_HEADER_SIZE = sizeof(CompressedPageHeader);
+static constexpr int COMPRESSED_BITMAP_SIZE      = COMPRESSED_MAX_SLOTS / 8;
+static constexpr int COMPRESSED_COLUMNS_OFFSET   = COMPRESSED_PAGE_HEADER_SIZE + COMPRESSED_BITMAP_SIZE;
+
+/**
+ * @brief 存放 value 需要多少位
+ */
+static int bits_needed(uint32_t value)
+{
+  int bits = 0;
+  while (value != 0) {
+    bits++;
+    value >>= 1;
+  }
+  return bits;
+}
+
+/**
+ * @brief num 个 bit_width 位的编码紧凑存放需要多少字节
+ */
+static int packed_size(int num, int bit_width)
+{
+  return static_cast<int>((static_cast<int64_t>(num) * bit_width + 7) / 8);
+}
+
+/**
+ * @brief 读取第 index 个 bit_width 位的编码
+ * @details 一次读取8个字节再移位，bit_width 不超过32位，加上字节内的偏移也不会超过64位。
+ * 按照小端的字节序处理，页面数据不能在不同字节序的机器之间直接使用
+ */
+static uint32_t read_bits(const char *data, int data_len, int index, int bit_width)
+{
+  if (bit_width == 0) {
+    return 0;
+  }
+
+  const int64_t bit   = static_cast<int64_t>(index) * bit_width;
+  const int     start = static_cast<int>(bit >> 3);
+  uint64_t      word  = 0;
+  memcpy(&word, data + start, min(static_cast<int>(sizeof(word)), data_len - start));
+  return static_cast<uint32_t>((word >> (bit & 7)) & ((1ULL << bit_width) - 1));
+}
+
+/**
+ * @brief 写入第 index 个 bit_width 位的编码，data 需要预先清零
+ */
+static void write_bits(char *data, int data_len, int index, int bit_width, uint32_t value)
+{
+  if (bit_width == 0) {
+    return;
+  }
+
+  const int64_t bit   = static_cast<int64_t>(index) * bit_width;
+  const int     start = static_cast<int>(bit >> 3);
+  const int     len   = min(static_cast<int>(sizeof(uint64_t)), data_len - start);
+  uint64_t      word  = 0;
+  memcpy(&word, data + start, len);
+  word |= static_cast<uint64_t>(value) << (bit & 7);
+  memcpy(data + start, &word, len);
+}
+
+/**
+ * @brief 把 rows 中的某一列编码之后写到 page 的 offset 位置，并设置 column 中的编码信息
+ * @details 压缩之后不比原始数据小的话就不压缩
+ * @return 编码之后的长度，页面放不下时返回 -1
+ */
+static int encode_column(const char *rows, int row_num, int row_size, CompressedColumn &column, char *page, int offset)
+{
+  const int space   = BP_PAGE_DATA_SIZE - offset;
+  const int raw_len = row_num * column.len;
+  char     *data    = page + offset;
+
+  column.encoding    = ColumnEncoding::RAW;
+  column.bit_width   = 0;
+  column.base        = 0;
+  column.dict_size   = 0;
+  column.data_offset = offset;
+
+  if (column.in_place) {
+    // 不压缩，走最后 RAW 的逻辑
+  } else if (column.type == INTS && column.len == sizeof(int32_t)) {
+    int32_t min_value = 0;
+    int32_t max_value = 0;
+    for (int i = 0; i < row_num; i++) {
+      int32_t value = 0;
+      memcpy(&value, rows + i * row_size + column.field_offset, sizeof(value));
+      min_value = (i == 0 || value < min_value) ? value : min_value;
+      max_value = (i == 0 || value > max_value) ? value : max_value;
+    }
+
+    const int bit_width = bits_needed(static_cast<uint32_t>(static_cast<int64_t>(max_value) - min_value));
+    const int data_len  = packed_size(row_num, bit_width);
+    if (data_len < raw_len) {
+      if (data_len > space) {
+        return -1;
+      }
+
+      memset(data, 0, data_len);
+      for (int i = 0; i < row_num; i++) {
+        int32_t value = 0;
+        memcpy(&value, rows + i * row_size + column.field_offset, sizeof(value));
+        write_bits(data, data_len, i, bit_width, static_cast<uint32_t>(static_cast<int64_t>(value) - min_value));
+      }
+
+      column.encoding  = ColumnEncoding::FOR_BITPACK;
+      column.bit_width = bit_width;
+      column.base      = min_value;
+      column.data_len  = data_len;
+      return data_len;
+    }
+  } else if (column.type == CHARS) {
+    unordered_map<string, uint32_t> dict;
+    vector<const char *>            dict_values;
+    vector<uint32_t>                codes(row_num);
+    for (int i = 0; i < row_num; i++) {
+      const char *value = rows + i * row_size + column.field_offset;
+      auto        iter  = dict.emplace(string(value, column.len), static_cast<uint32_t>(dict_values.size()));
+      if (iter.second) {
+        dict_values.push_back(value);
+      }
+      codes[i] = iter.first->second;
+    }
+
+    const int dict_size = static_cast<int>(dict_values.size());
+    const int bit_width = bits_needed(dict_size > 0 ? dict_size - 1 : 0);
+    const int dict_len  = dict_size * column.len;
+    const int codes_len = packed_size(row_num, bit_width);
+    if (dict_len + codes_len < raw_len) {
+      if (dict_len + codes_len > space) {
+        return -1;
+      }
+
+      for (int i = 0; i < dict_size; i++) {
+        memcpy(data + i * column.len, dict_values[i], column.len);
+      }
+      memset(data + dict_len, 0, codes_len);
+      for (int i = 0; i < row_num; i++) {
+        write_bits(data + dict_len, codes_len, i, bit_width, codes[i]);
+      }
+
+      column.encoding  = ColumnEncoding::DICTIONARY;
+      column.bit_width = bit_width;
+      column.dict_size = dict_size;
+      column.data_len  = dict_len + codes_len;
+      return column.data_len;
+    }
+  }
+
+  if (raw_len > space) {
+    return -1;
+  }
+  for (int i = 0; i < row_num; i++) {
+    memcpy(data + i * column.len, rows + i * row_size + column.field_offset, column.len);
+  }
+  column.data_len = raw_len;
+  return raw_len;
+}
+
+/**
+ * @brief 把压缩页面上的某一列解压到 rows 中
+ */
+static void decode_column(const CompressedColumn &column, const char *page, int row_num, int row_size, char *rows)
+{
+  const char *data = page + column.data_offset;
+  switch (column.encoding) {
+    case ColumnEncoding::FOR_BITPACK: {
+      for (int i = 0; i < row_num; i++) {
+        const uint32_t delta = read_bits(data, column.data_len, i, column.bit_width);
+        const int32_t  value = static_cast<int32_t>(static_cast<int64_t>(column.base) + delta);
+        memcpy(rows + i * row_size + column.field_offset, &value, sizeof(value));
+      }
+    } break;
+
+    case ColumnEncoding::DICTIONARY: {
+      const int   dict_len = column.dict_size * column.len;
+      const char *codes    = data + dict_len;
+      for (int i = 0; i < row_num; i++) {
+        const uint32_t code = read_bits(codes, column.data_len - dict_len, i, column.bit_width);
+        memcpy(rows + i * row_size + column.field_offset, data + code * column.len, column.len);
+      }
+    } break;
+
+    default: {
+      for (int i = 0; i < row_num; i++) {
+        memcpy(rows + i * row_size + column.field_offset, data + i * column.len, column.len);
+      }
+    } break;
+  }
+}
+
+/**
+ * @brief 只解压某一列上第 index 个值
+ */
+static void decode_value(const CompressedColumn &column, const char *page, int index, char *value)
+{
+  const char *data = page + column.data_offset;
+  switch (column.encoding) {
+    case ColumnEncoding::FOR_BITPACK: {
+      const uint32_t delta  = read_bits(data, column.data_len, index, column.bit_width);
+      const int32_t  result = static_cast<int32_t>(static_cast<int64_t>(column.base) + delta);
+      memcpy(value, &result, sizeof(result));
+    } break;
+
+    case ColumnEncoding::DICTIONARY: {
+      const int      dict_len = column.dict_size * column.len;
+      const uint32_t code     = read_bits(data + dict_len, column.data_len - dict_len, index, column.bit_width);
+      memcpy(value, data + code * column.len, column.len);
+    } break;
+
+    default: {
+      memcpy(value, data + index * column.len, column.len);
+    } break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CompressedRecordPageHandler::init_page_layout()
+{
+  FixedRecordPageHandler::init_page_layout();
+
+  decoded_valid_ = false;
+
+  char *data = frame_->data();
+  if (!is_compressed_page(data)) {
+    compressed_header_ = nullptr;
+    slot_bitmap_       = nullptr;
+    columns_           = nullptr;
+    return;
+  }
+
+  compressed_header_ = reinterpret_cast<CompressedPageHeader *>(data);
+  slot_bitmap_       = data + COMPRESSED_PAGE_HEADER_SIZE;
+  columns_           = reinterpret_cast<CompressedColumn *>(data + COMPRESSED_COLUMNS_OFFSET);
+}
+
+RC CompressedRecordPageHandler::init_empty_page(
+    DiskBufferPool &buffer_pool, PageNum page_num, int record_size, const TableMeta *table_meta)
+{
+  RC rc = FixedRecordPageHandler::init_empty_page(buffer_pool, page_num, record_size, table_meta);
+  if (OB_SUCC(rc)) {
+    // 初始化时页面上还是旧的数据，写入定长页面的页头之后重新识别一下
+    init_page_layout();
+  }
+  return rc;
+}
+
+int CompressedRecordPageHandler::tail_stride() const { return align8(compressed_header_->record_real_size); }
+
+RC CompressedRecordPageHandler::check_slot(SlotNum slot_num) const
+{
+  if (slot_num < 0 || slot_num >= slot_count()) {
+    LOG_ERROR("Invalid slot_num:%d, exceed page's record num, page_num %d.", slot_num, frame_->page_num());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(slot_bitmap_, COMPRESSED_MAX_SLOTS);
+  if (!bitmap.get_bit(slot_num)) {
+    LOG_DEBUG("Invalid slot_num:%d, slot is empty, page_num %d.", slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+  return RC::SUCCESS;
+}
+
+RC CompressedRecordPageHandler::insert_record(const char *data, int data_len, RID *rid)
+{
+  ASSERT(readonly_ == false, "cannot insert record into page while the page is readonly");
+
+  if (!is_compressed()) {
+    RC rc = FixedRecordPageHandler::insert_record(data, data_len, rid);
+    if (OB_SUCC(rc) && FixedRecordPageHandler::is_full()) {
+      // 定长页面写满了，压缩之后还可以再放更多的记录。压缩失败时页面不变，仍然是一个满的定长页面
+      RC compress_rc = compress();
+      if (OB_FAIL(compress_rc) && compress_rc != RC::RECORD_NOMEM) {
+        LOG_WARN("failed to compress page. page_num=%d, rc=%s", frame_->page_num(), strrc(compress_rc));
+      }
+    }
+    return rc;
+  }
+
+  if (compressed_header_->tail_num >= compressed_header_->tail_capacity) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  const SlotNum slot_num = slot_count();
+  Bitmap        bitmap(slot_bitmap_, COMPRESSED_MAX_SLOTS);
+  bitmap.set_bit(slot_num);
+  compressed_header_->tail_num++;
+  compressed_header_->record_num++;
+  memcpy(tail_record(slot_num), data, compressed_header_->record_real_size);
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = slot_num;
+  }
+
+  RC rc = recompress_if_full();
+  if (OB_FAIL(rc) && rc != RC::RECORD_NOMEM) {
+    LOG_WARN("failed to compress page. page_num=%d, rc=%s", frame_->page_num(), strrc(rc));
+  }
+  return RC::SUCCESS;
+}
+
+RC CompressedRecordPageHandler::recover_insert_record(const char *data, int data_len, const RID &rid)
+{
+  if (!is_compressed()) {
+    return FixedRecordPageHandler::recover_insert_record(data, data_len, rid);
+  }
+
+  if (rid.slot_num < 0 || rid.slot_num >= COMPRESSED_MAX_SLOTS) {
+    LOG_WARN("slot_num illegal, slot_num(%d) >= max slots(%d).", rid.slot_num, COMPRESSED_MAX_SLOTS);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  // 恢复的记录可能在追加区域当前的末尾之后，先用空槽位补齐
+  const int row_size = compressed_header_->record_real_size;
+  while (slot_count() <= rid.slot_num) {
+    if (compressed_header_->tail_num >= compressed_header_->tail_capacity) {
+      RC rc = compress();
+      if (OB_FAIL(rc) || compressed_header_->tail_num >= compressed_header_->tail_capacity) {
+        LOG_WARN("no space to recover record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+        return OB_FAIL(rc) ? rc : RC::RECORD_NOMEM;
+      }
+    }
+    memset(tail_record(slot_count()), 0, row_size);
+    compressed_header_->tail_num++;
+  }
+
+  Bitmap bitmap(slot_bitmap_, COMPRESSED_MAX_SLOTS);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    bitmap.set_bit(rid.slot_num);
+    compressed_header_->record_num++;
+  }
+  frame_->mark_dirty();
+
+  if (rid.slot_num >= compressed_header_->encoded_num) {
+    memcpy(tail_record(rid.slot_num), data, row_size);
+    return RC::SUCCESS;
+  }
+  return update_encoded_record(rid.slot_num, data);
+}
+
+RC CompressedRecordPageHandler::delete_record(const RID *rid)
+{
+  if (!is_compressed()) {
+    return FixedRecordPageHandler::delete_record(rid);
+  }
+
+  ASSERT(readonly_ == false, "cannot delete record from page while the page is readonly");
+
+  RC rc = check_slot(rid->slot_num);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 槽位号不能变，所以删除之后的空间也不再使用了
+  Bitmap bitmap(slot_bitmap_, COMPRESSED_MAX_SLOTS);
+  bitmap.clear_bit(rid->slot_num);
+  compressed_header_->record_num--;
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC CompressedRecordPageHandler::update_record(const RID &rid, const char *data, int data_len)
+{
+  if (!is_compressed()) {
+    return FixedRecordPageHandler::update_record(rid, data, data_len);
+  }
+
+  ASSERT(readonly_ == false, "cannot update record in page while the page is readonly");
+
+  RC rc = check_slot(rid.slot_num);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  if (rid.slot_num >= compressed_header_->encoded_num) {
+    char *record_data = tail_record(rid.slot_num);
+    if (record_data != data) {
+      memcpy(record_data, data, compressed_header_->record_real_size);
+    }
+    frame_->mark_dirty();
+    return RC::SUCCESS;
+  }
+
+  return update_encoded_record(rid.slot_num, data);
+}
+
+RC CompressedRecordPageHandler::get_record(const RID *rid, Record *rec)
+{
+  if (!is_compressed()) {
+    return FixedRecordPageHandler::get_record(rid, rec);
+  }
+
+  RC rc = check_slot(rid->slot_num);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  char *data = rid->slot_num < compressed_header_->encoded_num ? encoded_record(rid->slot_num)
+                                                                : tail_record(rid->slot_num);
+  rec->set_rid(*rid);
+  rec->set_data(data, compressed_header_->record_real_size);
+  return RC::SUCCESS;
+}
+
+SlotNum CompressedRecordPageHandler::next_record_slot(SlotNum start_slot_num) const
+{
+  if (!is_compressed()) {
+    return FixedRecordPageHandler::next_record_slot(start_slot_num);
+  }
+
+  Bitmap bitmap(slot_bitmap_, slot_count());
+  return bitmap.next_setted_bit(start_slot_num);
+}
+
+bool CompressedRecordPageHandler::is_full() const
+{
+  if (!is_compressed()) {
+    return FixedRecordPageHandler::is_full();
+  }
+  return compressed_header_->tail_num >= compressed_header_->tail_capacity;
+}
+
+void CompressedRecordPageHandler::space_usage(int64_t &raw_size, int64_t &used_size) const
+{
+  if (!is_compressed()) {
+    raw_size  = static_cast<int64_t>(page_header_->record_num) * page_header_->record_real_size;
+    used_size = page_header_->first_record_offset +
+                static_cast<int64_t>(page_header_->record_num) * page_header_->record_size;
+    return;
+  }
+
+  raw_size  = static_cast<int64_t>(compressed_header_->record_num) * compressed_header_->record_real_size;
+  used_size = compressed_header_->tail_offset + static_cast<int64_t>(compressed_header_->tail_num) * tail_stride();
+}
+
+RC CompressedRecordPageHandler::compress()
+{
+  ASSERT(readonly_ == false, "cannot compress page while the page is readonly");
+
+  vector<char>             rows;
+  vector<CompressedColumn> columns;
+  if (is_compressed()) {
+    load_rows(rows);
+    columns.assign(columns_, columns_ + compressed_header_->column_num);
+    return rebuild(rows.data(), slot_count(), compressed_header_->record_real_size, slot_bitmap_, columns);
+  }
+
+  // 定长页面没有列的信息，需要从表的元数据中获取
+  if (nullptr == table_meta_ || table_meta_->record_size() != page_header_->record_real_size) {
+    LOG_WARN("table meta is required to compress fixed page. page_num=%d", frame_->page_num());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int row_num  = page_header_->record_capacity;
+  const int row_size = page_header_->record_real_size;
+  rows.assign(static_cast<size_t>(row_num) * row_size, 0);
+
+  Bitmap bitmap(bitmap_, row_num);
+  for (SlotNum slot_num = bitmap.next_setted_bit(0); slot_num != -1; slot_num = bitmap.next_setted_bit(slot_num + 1)) {
+    memcpy(rows.data() + slot_num * row_size, get_record_data(slot_num), row_size);
+  }
+
+  for (int i = 0; i < table_meta_->field_num(); i++) {
+    const FieldMeta *field = table_meta_->field(i);
+    CompressedColumn column;
+    memset(&column, 0, sizeof(column));
+    column.field_offset = field->offset();
+    column.len          = field->len();
+    column.type         = field->type();
+    column.in_place     = i < table_meta_->sys_field_num() ? 1 : 0;  // 事务字段会被频繁修改
+    columns.push_back(column);
+  }
+  return rebuild(rows.data(), row_num, row_size, bitmap_, columns);
+}
+
+RC CompressedRecordPageHandler::recompress_if_full()
+{
+  if (compressed_header_->tail_num < compressed_header_->tail_capacity || compressed_header_->sealed) {
+    return RC::SUCCESS;
+  }
+  return compress();
+}
+
+RC CompressedRecordPageHandler::rebuild(
+    const char *rows, int row_num, int row_size, const char *bitmap, const vector<CompressedColumn> &columns)
+{
+  const int column_num = static_cast<int>(columns.size());
+  int       offset     = COMPRESSED_COLUMNS_OFFSET + column_num * static_cast<int>(sizeof(CompressedColumn));
+  if (row_num > COMPRESSED_MAX_SLOTS || offset > BP_PAGE_DATA_SIZE) {
+    LOG_TRACE("too many records or columns to compress. page_num=%d, records=%d, columns=%d",
+              frame_->page_num(), row_num, column_num);
+    return RC::RECORD_NOMEM;
+  }
+
+  // 先在临时的内存中编码，放不下的时候页面保持不变
+  vector<char>          page(BP_PAGE_DATA_SIZE, 0);
+  CompressedPageHeader *header       = reinterpret_cast<CompressedPageHeader *>(page.data());
+  char                 *page_bitmap  = page.data() + COMPRESSED_PAGE_HEADER_SIZE;
+  CompressedColumn     *page_columns = reinterpret_cast<CompressedColumn *>(page.data() + COMPRESSED_COLUMNS_OFFSET);
+
+  for (int i = 0; i < column_num; i++) {
+    page_columns[i] = columns[i];
+    const int len   = encode_column(rows, row_num, row_size, page_columns[i], page.data(), offset);
+    if (len < 0) {
+      LOG_TRACE("compressed data overflow the page. page_num=%d, column=%d", frame_->page_num(), i);
+      return RC::RECORD_NOMEM;
+    }
+    offset += len;
+  }
+
+  memcpy(page_bitmap, bitmap, page_bitmap_size(row_num));
+  Bitmap page_slots(page_bitmap, row_num);
+  int    record_num = 0;
+  for (SlotNum slot_num = page_slots.next_setted_bit(0); slot_num != -1;
+       slot_num         = page_slots.next_setted_bit(slot_num + 1)) {
+    record_num++;
+  }
+
+  const int tail_offset = align8(offset);
+  const int tail_space  = max(0, BP_PAGE_DATA_SIZE - tail_offset);
+
+  header->record_num       = record_num;
+  header->magic            = COMPRESSED_PAGE_MAGIC;
+  header->record_real_size = row_size;
+  header->column_num       = column_num;
+  header->encoded_num      = row_num;
+  header->tail_num         = 0;
+  header->tail_capacity    = min(tail_space / align8(row_size), COMPRESSED_MAX_SLOTS - row_num);
+  header->tail_offset      = tail_offset;
+  header->sealed           = header->tail_capacity < COMPRESSED_MIN_TAIL_RECORDS ? 1 : 0;
+
+  memcpy(frame_->data(), page.data(), BP_PAGE_DATA_SIZE);
+  frame_->mark_dirty();
+  init_page_layout();
+
+  LOG_TRACE("compress page done. page_num=%d, records=%d, encoded size=%d, tail capacity=%d",
+            frame_->page_num(), record_num, offset - COMPRESSED_COLUMNS_OFFSET, compressed_header_->tail_capacity);
+  return RC::SUCCESS;
+}
+
+void CompressedRecordPageHandler::load_rows(vector<char> &rows) const
+{
+  const int row_size = compressed_header_->record_real_size;
+  const int row_num  = slot_count();
+  rows.assign(static_cast<size_t>(row_num) * row_size, 0);
+
+  for (int i = 0; i < compressed_header_->column_num; i++) {
+    decode_column(columns_[i], frame_->data(), compressed_header_->encoded_num, row_size, rows.data());
+  }
+  for (SlotNum slot_num = compressed_header_->encoded_num; slot_num < row_num; slot_num++) {
+    memcpy(rows.data() + slot_num * row_size, tail_record(slot_num), row_size);
+  }
+
+  // 删除的记录不需要保留，清零之后压缩效果更好
+  Bitmap bitmap(slot_bitmap_, row_num);
+  for (SlotNum slot_num = 0; slot_num < row_num; slot_num++) {
+    if (!bitmap.get_bit(slot_num)) {
+      memset(rows.data() + slot_num * row_size, 0, row_size);
+    }
+  }
+}
+
+RC CompressedRecordPageHandler::update_encoded_record(SlotNum slot_num, const char *data)
+{
+  const int row_size = compressed_header_->record_real_size;
+
+  // data 可能就是解压缓存中的这一行，已经被修改过了，所以要和页面上编码的值比较
+  bool in_place = true;
+  char value[BP_PAGE_DATA_SIZE];
+  for (int i = 0; in_place && i < compressed_header_->column_num; i++) {
+    const CompressedColumn &column = columns_[i];
+    if (!column.in_place) {
+      decode_value(column, frame_->data(), slot_num, value);
+      in_place = 0 == memcmp(value, data + column.field_offset, column.len);
+    }
+  }
+
+  if (in_place) {
+    for (int i = 0; i < compressed_header_->column_num; i++) {
+      const CompressedColumn &column = columns_[i];
+      if (column.in_place) {
+        memcpy(frame_->data() + column.data_offset + slot_num * column.len, data + column.field_offset, column.len);
+      }
+    }
+
+    if (decoded_valid_ && decoded_.data() + slot_num * row_size != data) {
+      memcpy(decoded_.data() + slot_num * row_size, data, row_size);
+    }
+    frame_->mark_dirty();
+    return RC::SUCCESS;
+  }
+
+  // data 可能指向解压缓存，要在重新压缩之前复制出来
+  vector<char> rows;
+  load_rows(rows);
+  memcpy(rows.data() + slot_num * row_size, data, row_size);
+
+  vector<CompressedColumn> columns(columns_, columns_ + compressed_header_->column_num);
+  vector<char>             bitmap(slot_bitmap_, slot_bitmap_ + COMPRESSED_BITMAP_SIZE);
+
+  RC rc = rebuild(rows.data(), slot_count(), row_size, bitmap.data(), columns);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("no space to update compressed record. page_num=%d, slot_num=%d, rc=%s",
+             frame_->page_num(), slot_num, strrc(rc));
+  }
+  return rc;
+}
+
+char *CompressedRecordPageHandler::encoded_record(SlotNum slot_num)
+{
+  const int row_size = compressed_header_->record_real_size;
+  if (!decoded_valid_) {
+    decoded_.assign(static_cast<size_t>(compressed_header_->encoded_num) * row_size, 0);
+    for (int i = 0; i < compressed_header_->column_num; i++) {
+      decode_column(columns_[i], frame_->data(), compressed_header_->encoded_num, row_size, decoded_.data());
+    }
+    decoded_valid_ = true;
+  }
+  return decoded_.data() + slot_num * row_size;
+}
@@ -0,0 +1,186 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "storage/record/record_manager.h"
+
+/**
+ * @brief 压缩页面的页头
+ * @ingroup RecordManager
+ * @details 前两个字段与定长记录页的 record_num、record_real_size 位置相同，定长页面的 record_real_size 不会是负数，
+ * 所以通过 magic 就可以区分一个页面是否已经压缩了。
+ */
+struct CompressedPageHeader
+{
+  int32_t record_num;        ///< 当前页面有效记录的个数
+  int32_t magic;             ///< 固定为 COMPRESSED_PAGE_MAGIC
+  int32_t record_real_size;  ///< 每条记录的实际大小
+  int32_t column_num;        ///< 列的个数
+  int32_t encoded_num;       ///< 压缩区域中的记录个数，槽位 [0, encoded_num) 的记录是压缩存放的
+  int32_t tail_num;          ///< 追加区域中的记录个数，槽位从 encoded_num 开始
+  int32_t tail_capacity;     ///< 追加区域最多能放多少条记录
+  int32_t tail_offset;       ///< 追加区域在页面中的偏移
+  int32_t sealed;            ///< 再压缩也腾不出多少空间了，追加区域满了之后不再重新压缩
+};
+
+/**
+ * @brief 压缩页面上一列数据的编码方式
+ */
+enum class ColumnEncoding : int32_t
+{
+  RAW = 0,      ///< 不压缩，值按照槽位顺序连续存放
+  FOR_BITPACK,  ///< 整数：减去最小值(frame of reference)之后按照需要的位数紧凑存放
+  DICTIONARY,   ///< 字符串：不同的值放在字典中，每条记录只存放字典下标，下标也是按位紧凑存放的
+};
+
+/**
+ * @brief 压缩页面上每一列的描述信息，页面是自描述的，解压时不需要表的元数据
+ */
+struct CompressedColumn
+{
+  int32_t        field_offset;  ///< 这一列在行记录中的偏移
+  int32_t        len;           ///< 这一列每个值的长度
+  int32_t        type;          ///< 字段类型(AttrType)
+  ColumnEncoding encoding;      ///< 编码方式
+  int32_t        bit_width;     ///< FOR_BITPACK 和 DICTIONARY 每个编码占用的位数
+  int32_t        base;          ///< FOR_BITPACK 的基准值，即这一列的最小值
+  int32_t        dict_size;     ///< DICTIONARY 字典中值的个数，字典放在 data_offset 的位置，编码紧随其后
+  int32_t        data_offset;   ///< 这一列的数据在页面中的偏移
+  int32_t        data_len;      ///< 这一列的数据长度
+  int32_t        in_place;      ///< 不为0时总是不压缩(RAW)，修改时直接改页面上的值，用于事务字段
+};
+
+static constexpr int32_t COMPRESSED_PAGE_MAGIC = -0x43505253;  ///< "CPRS"，取负数与定长页面的记录长度区分开
+/// 一个压缩页面最多存放多少条记录，槽位的位图按照这个大小预留
+static constexpr int COMPRESSED_MAX_SLOTS = 2048;
+/// 重新压缩之后追加区域放不下这么多记录，就认为页面已经满了，避免每插入几条记录就压缩一次整个页面
+static constexpr int COMPRESSED_MIN_TAIL_RECORDS = 8;
+
+/**
+ * @brief 压缩格式的页面
+ * @ingroup RecordManager
+ * @details 新页面与定长记录页面完全一样，写满之后再把整个页面按列压缩，页面的组织大概是这样的：
+ * @code
+ * | CompressedPageHeader | slot bitmap | column0 desc | ... | columnN desc |
+ * |-----------------------------------------------------------------------|
+ * | column0 data | column1 data | ... | columnN data | tail records ...   |
+ * @endcode
+ * 整数使用 frame of reference + 位压缩，字符串使用字典编码，浮点数不压缩。
+ * 压缩之后空出来的空间作为追加区域，新的记录先按照定长格式放在这里，追加区域满了之后再把整个页面重新压缩一次。
+ * 记录的槽位号在压缩前后保持不变，所以 RID 是稳定的，索引不需要修改；删除记录只清除位图，空间不会再使用。
+ *
+ * 读取压缩区域中的记录时，第一次访问会把整个压缩区域解压到对象自己的缓存中，同一个页面上后续的访问都直接使用缓存。
+ * 修改压缩区域中的记录需要重新压缩整个页面，代价比较高，所以这种格式只适合很少修改的冷数据。
+ * 事务字段(TableMeta::sys_field_num)例外，它们总是不压缩，提交、删除时修改事务字段只需要改页面上的值，
+ * 不需要重新压缩，也不会因为压缩之后放不下而失败。
+ */
+class CompressedRecordPageHandler : public FixedRecordPageHandler
+{
+public:
+  explicit CompressedRecordPageHandler(const TableMeta *table_meta) : table_meta_(table_meta) {}
+  virtual ~CompressedRecordPageHandler() = default;
+
+  RC init_empty_page(
+      DiskBufferPool &buffer_pool, PageNum page_num, int record_size, const TableMeta *table_meta) override;
+
+  /**
+   * @copydoc RecordPageHandler::insert_record
+   * @details 定长页面写满之后就压缩，压缩页面的追加区域写满之后就重新压缩
+   */
+  RC insert_record(const char *data, int data_len, RID *rid) override;
+  RC recover_insert_record(const char *data, int data_len, const RID &rid) override;
+  RC delete_record(const RID *rid) override;
+  RC update_record(const RID &rid, const char *data, int data_len) override;
+
+  /**
+   * @copydoc RecordPageHandler::get_record
+   * @note 压缩区域中的记录指向对象自己的解压缓存，在 cleanup 或者修改页面之前都是有效的
+   */
+  RC get_record(const RID *rid, Record *rec) override;
+
+  SlotNum next_record_slot(SlotNum start_slot_num) const override;
+  bool    is_full() const override;
+
+  /**
+   * @brief 压缩当前页面。已经压缩过的页面会把追加区域的记录也压缩进去
+   * @return 压缩之后放不下时返回 RECORD_NOMEM，页面保持不变
+   */
+  RC compress();
+
+  bool is_compressed() const { return compressed_header_ != nullptr; }
+
+  /**
+   * @brief 统计当前页面上有效记录的原始大小和实际占用的空间，用来计算压缩率
+   */
+  void space_usage(int64_t &raw_size, int64_t &used_size) const;
+
+  static bool is_compressed_page(const char *page_data)
+  {
+    return reinterpret_cast<const CompressedPageHeader *>(page_data)->magic == COMPRESSED_PAGE_MAGIC;
+  }
+
+protected:
+  void init_page_layout() override;
+
+private:
+  int slot_count() const { return compressed_header_->encoded_num + compressed_header_->tail_num; }
+  int tail_stride() const;
+
+  RC check_slot(SlotNum slot_num) const;
+
+  /**
+   * @brief 取出页面上所有槽位的记录，已经删除的槽位填0
+   */
+  void load_rows(std::vector<char> &rows) const;
+
+  /**
+   * @brief 把 rows 中的记录压缩存放到当前页面上，替换掉页面原来的内容
+   * @param rows     按照槽位顺序存放的定长记录
+   * @param row_num  记录的个数
+   * @param row_size 每条记录的长度
+   * @param bitmap   槽位的位图，至少有 row_num 位
+   * @param columns  每一列的偏移、长度和类型，使用 CompressedColumn 的前三个字段
+   */
+  RC rebuild(const char *rows, int row_num, int row_size, const char *bitmap,
+      const std::vector<CompressedColumn> &columns);
+
+  /**
+   * @brief 修改压缩区域中的一条记录
+   * @details 只修改了 in_place 的列时直接修改页面上的值，否则需要重新压缩整个页面
+   */
+  RC update_encoded_record(SlotNum slot_num, const char *data);
+
+  /**
+   * @brief 追加区域满了，尝试重新压缩腾出空间
+   */
+  RC recompress_if_full();
+
+  /**
+   * @brief 压缩区域中的记录，第一次访问时解压整个压缩区域
+   */
+  char *encoded_record(SlotNum slot_num);
+  char *tail_record(SlotNum slot_num) const
+  {
+    return frame_->data() + compressed_header_->tail_offset +
+           (slot_num - compressed_header_->encoded_num) * tail_stride();
+  }
+
+private:
+  const TableMeta      *table_meta_        = nullptr;
+  CompressedPageHeader *compressed_header_ = nullptr;  ///< 页面压缩之后才有效
+  char                 *slot_bitmap_       = nullptr;  ///< 压缩页面的槽位位图，有 COMPRESSED_MAX_SLOTS 位
+  CompressedColumn     *columns_           = nullptr;  ///< 压缩页面上每一列的描述信息
+  std::vector<char>     decoded_;                      ///< 压缩区域解压之后的记录
+  bool                  decoded_valid_ = false;
+};
@@ -0,0 +1,93 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdint.h>
+
+#include "storage/record/free_page_pool.h"
+
+using namespace std;
+
+FreePagePool::FreePagePool(int capacity)
+{
+  size_t size = 2;
+  while (size < static_cast<size_t>(capacity)) {
+    size <<= 1;
+  }
+
+  cells_.reset(new Cell[size]);
+  mask_ = size - 1;
+  for (size_t i = 0; i < size; i++) {
+    cells_[i].sequence.store(i, memory_order_relaxed);
+  }
+}
+
+bool FreePagePool::push(PageNum page_num)
+{
+  Cell  *cell = nullptr;
+  size_t pos  = enqueue_pos_.load(memory_order_relaxed);
+  while (true) {
+    cell          = &cells_[pos & mask_];
+    size_t   seq  = cell->sequence.load(memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      // 槽位是空的，抢到队尾的位置就可以写入
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // 槽位上的数据还没有被取走，池子满了
+      return false;
+    } else {
+      pos = enqueue_pos_.load(memory_order_relaxed);
+    }
+  }
+
+  cell->page_num = page_num;
+  cell->sequence.store(pos + 1, memory_order_release);
+  return true;
+}
+
+bool FreePagePool::pop(PageNum &page_num)
+{
+  Cell  *cell = nullptr;
+  size_t pos  = dequeue_pos_.load(memory_order_relaxed);
+  while (true) {
+    cell          = &cells_[pos & mask_];
+    size_t   seq  = cell->sequence.load(memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // 槽位上还没有写入数据，池子空了
+      return false;
+    } else {
+      pos = dequeue_pos_.load(memory_order_relaxed);
+    }
+  }
+
+  page_num = cell->page_num;
+  // 这个槽位可以在下一轮被生产者使用
+  cell->sequence.store(pos + mask_ + 1, memory_order_release);
+  return true;
+}
+
+bool FreePagePool::empty() const
+{
+  return dequeue_pos_.load(memory_order_relaxed) >= enqueue_pos_.load(memory_order_relaxed);
+}
+
+void FreePagePool::clear()
+{
+  PageNum page_num;
+  while (pop(page_num)) {
+  }
+}
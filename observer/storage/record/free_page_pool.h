@@ -0,0 +1,71 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+
+#include "storage/buffer/page.h"
+
+/**
+ * @brief 无锁的空闲页面池
+ * @ingroup RecordManager
+ * @details 插入记录的线程从这里领取自己的插入页面。使用固定大小的环形数组实现多生产者多消费者队列，
+ * 每个槽位上有一个序号，生产者和消费者通过 CAS 竞争队尾和队头的位置，不需要加锁。
+ * 池子满了之后放入会失败，这时丢掉即可，页面的空闲状态在 FreeSpaceMap 中还有记录，之后还能找回来。
+ * 池子本身不检查重复的页面，由 RecordFileHandler 记录哪些页面已经放进来或者被领取了。
+ * 领取页面的一方仍然需要自己判断页面是否真的还有空闲位置。
+ */
+class FreePagePool
+{
+public:
+  /**
+   * @param capacity 最多存放多少个页面，会向上取整为2的幂
+   */
+  explicit FreePagePool(int capacity = DEFAULT_CAPACITY);
+  ~FreePagePool() = default;
+
+  /**
+   * @brief 放入一个空闲页面
+   * @return 池子满了返回 false
+   */
+  bool push(PageNum page_num);
+
+  /**
+   * @brief 取出一个空闲页面
+   * @return 池子空了返回 false
+   */
+  bool pop(PageNum &page_num);
+
+  /**
+   * @brief 当前是否为空。并发时只是一个近似的结果
+   */
+  bool empty() const;
+
+  void clear();
+
+public:
+  static constexpr int DEFAULT_CAPACITY = 1024;
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence{0};
+    PageNum             page_num = BP_INVALID_PAGE_NUM;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t                  mask_ = 0;
+
+  alignas(64) std::atomic<size_t> enqueue_pos_{0};
+  alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
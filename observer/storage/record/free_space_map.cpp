@@ -0,0 +1,249 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <mutex>
+#include <shared_mutex>
+#include <string.h>
+
+#include "storage/record/free_space_map.h"
+#include "common/lang/bitmap.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+
+using namespace common;
+using namespace std;
+
+static char *fsm_bitmap(Frame *frame) { return frame->data() + sizeof(FsmPageHeader); }
+
+RC FreeSpaceMap::init(DiskBufferPool &buffer_pool)
+{
+  if (buffer_pool_ != nullptr) {
+    LOG_WARN("free space map has been opened");
+    return RC::RECORD_OPENNED;
+  }
+
+  BufferPoolIterator bp_iterator;
+  bp_iterator.init(buffer_pool);
+  if (!bp_iterator.has_next()) {
+    return create(buffer_pool);
+  }
+
+  if (bp_iterator.next() != FSM_ROOT_PAGE) {
+    LOG_INFO("no free space map in file, it is created by an old version. file=%d", buffer_pool.file_desc());
+    return RC::SUCCESS;
+  }
+
+  return load(buffer_pool);
+}
+
+void FreeSpaceMap::close()
+{
+  lock_guard<SharedMutex> guard(lock_);
+  fsm_pages_.clear();
+  buffer_pool_ = nullptr;
+}
+
+RC FreeSpaceMap::create(DiskBufferPool &buffer_pool)
+{
+  Frame *frame = nullptr;
+  RC     rc    = buffer_pool.allocate_page(&frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate free space map root page. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (frame->page_num() != FSM_ROOT_PAGE) {
+    LOG_WARN("free space map root page is allocated at unexpected page. page num=%d", frame->page_num());
+    buffer_pool.unpin_page(frame);
+    return RC::INTERNAL;
+  }
+
+  memset(frame->data(), 0, BP_PAGE_DATA_SIZE);
+  FsmPageHeader *header = reinterpret_cast<FsmPageHeader *>(frame->data());
+  header->magic         = FSM_PAGE_MAGIC;
+  header->next_page     = BP_INVALID_PAGE_NUM;
+  header->index         = 0;
+  frame->mark_dirty();
+
+  // 根页面一定要先落盘，否则崩溃之后它看起来像是一个空的记录页，文件会被当作旧格式
+  rc = buffer_pool.flush_page(*frame);
+  buffer_pool.unpin_page(frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush free space map root page. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  fsm_pages_.push_back(FSM_ROOT_PAGE);
+  buffer_pool_ = &buffer_pool;
+  LOG_INFO("create free space map. file=%d", buffer_pool.file_desc());
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::load(DiskBufferPool &buffer_pool)
+{
+  PageNum page_num = FSM_ROOT_PAGE;
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    Frame *frame = nullptr;
+    RC     rc    = buffer_pool.get_this_page(page_num, &frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get free space map page. page num=%d, rc=%s", page_num, strrc(rc));
+      fsm_pages_.clear();
+      return rc;
+    }
+
+    const FsmPageHeader *header = reinterpret_cast<const FsmPageHeader *>(frame->data());
+    if (header->magic != FSM_PAGE_MAGIC || header->index != static_cast<int32_t>(fsm_pages_.size())) {
+      buffer_pool.unpin_page(frame);
+      if (page_num == FSM_ROOT_PAGE) {
+        LOG_INFO("no free space map in file, it is created by an old version. file=%d", buffer_pool.file_desc());
+        return RC::SUCCESS;
+      }
+
+      LOG_ERROR("invalid free space map page. page num=%d, magic=%d, index=%d, expect index=%d",
+                page_num, header->magic, header->index, static_cast<int>(fsm_pages_.size()));
+      fsm_pages_.clear();
+      return RC::INTERNAL;
+    }
+
+    fsm_pages_.push_back(page_num);
+    page_num = header->next_page;
+    buffer_pool.unpin_page(frame);
+  }
+
+  buffer_pool_ = &buffer_pool;
+  LOG_INFO("load free space map. file=%d, fsm pages=%d", buffer_pool.file_desc(), static_cast<int>(fsm_pages_.size()));
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::find_free_pages(PageNum start_page, int max_num, vector<PageNum> &page_nums)
+{
+  shared_lock<SharedMutex> guard(lock_);
+
+  const int first_index = start_page / FSM_PAGE_BITS;
+  int       found       = 0;
+  for (int index = first_index; index < static_cast<int>(fsm_pages_.size()) && found < max_num; index++) {
+    Frame *frame = nullptr;
+    RC     rc    = buffer_pool_->get_this_page(fsm_pages_[index], &frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get free space map page. page num=%d, rc=%s", fsm_pages_[index], strrc(rc));
+      return rc;
+    }
+
+    frame->read_latch();
+    Bitmap bitmap(fsm_bitmap(frame), FSM_PAGE_BITS);
+    int    bit = (index == first_index) ? start_page % FSM_PAGE_BITS : 0;
+    while (found < max_num && (bit = bitmap.next_setted_bit(bit)) != -1) {
+      page_nums.push_back(index * FSM_PAGE_BITS + bit);
+      found++;
+      bit++;
+    }
+    frame->read_unlatch();
+    buffer_pool_->unpin_page(frame);
+  }
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::set_page_free(PageNum page_num, bool free, bool *changed /*= nullptr*/)
+{
+  if (changed != nullptr) {
+    *changed = false;
+  }
+
+  const int index = page_num / FSM_PAGE_BITS;
+  const int bit   = page_num % FSM_PAGE_BITS;
+
+  shared_lock<SharedMutex> guard(lock_);
+  if (index >= static_cast<int>(fsm_pages_.size())) {
+    if (!free) {
+      // 没有覆盖到的页面本来就当作没有空闲位置
+      return RC::SUCCESS;
+    }
+
+    guard.unlock();
+    {
+      lock_guard<SharedMutex> extend_guard(lock_);
+      RC rc = extend(index);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+    guard.lock();
+  }
+
+  Frame *frame = nullptr;
+  RC     rc    = buffer_pool_->get_this_page(fsm_pages_[index], &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get free space map page. page num=%d, rc=%s", fsm_pages_[index], strrc(rc));
+    return rc;
+  }
+
+  frame->write_latch();
+  Bitmap bitmap(fsm_bitmap(frame), FSM_PAGE_BITS);
+  if (bitmap.get_bit(bit) != free) {
+    if (free) {
+      bitmap.set_bit(bit);
+    } else {
+      bitmap.clear_bit(bit);
+    }
+    frame->mark_dirty();
+    if (changed != nullptr) {
+      *changed = true;
+    }
+  }
+  frame->write_unlatch();
+  buffer_pool_->unpin_page(frame);
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::extend(int index)
+{
+  while (static_cast<int>(fsm_pages_.size()) <= index) {
+    Frame *frame = nullptr;
+    RC     rc    = buffer_pool_->allocate_page(&frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate free space map page. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    const PageNum page_num = frame->page_num();
+    memset(frame->data(), 0, BP_PAGE_DATA_SIZE);
+    FsmPageHeader *header = reinterpret_cast<FsmPageHeader *>(frame->data());
+    header->magic         = FSM_PAGE_MAGIC;
+    header->next_page     = BP_INVALID_PAGE_NUM;
+    header->index         = static_cast<int32_t>(fsm_pages_.size());
+    frame->mark_dirty();
+
+    // 新页面先落盘再挂到链表上，保证链表上不会出现未初始化的页面
+    rc = buffer_pool_->flush_page(*frame);
+    buffer_pool_->unpin_page(frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to flush free space map page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    Frame *prev_frame = nullptr;
+    rc                = buffer_pool_->get_this_page(fsm_pages_.back(), &prev_frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get free space map page. page num=%d, rc=%s", fsm_pages_.back(), strrc(rc));
+      return rc;
+    }
+
+    prev_frame->write_latch();
+    reinterpret_cast<FsmPageHeader *>(prev_frame->data())->next_page = page_num;
+    prev_frame->mark_dirty();
+    prev_frame->write_unlatch();
+    buffer_pool_->unpin_page(prev_frame);
+
+    fsm_pages_.push_back(page_num);
+    LOG_INFO("extend free space map. file=%d, page num=%d, index=%d",
+             buffer_pool_->file_desc(), page_num, static_cast<int>(fsm_pages_.size()) - 1);
+  }
+  return RC::SUCCESS;
+}
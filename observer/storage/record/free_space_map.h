@@ -0,0 +1,106 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "common/lang/mutex.h"
+#include "common/rc.h"
+#include "storage/buffer/page.h"
+
+class DiskBufferPool;
+
+/**
+ * @brief 空闲空间映射页的页头
+ * @ingroup RecordManager
+ * @details magic 与记录页 PageHeader::record_num 在同一个位置，record_num 不会是负数，
+ * 所以可以根据页面的第一个字段区分空闲空间映射页和记录页。
+ */
+struct FsmPageHeader
+{
+  int32_t magic;      ///< 固定为 FSM_PAGE_MAGIC
+  PageNum next_page;  ///< 下一个空闲空间映射页，没有时是 BP_INVALID_PAGE_NUM
+  int32_t index;      ///< 当前是第几个空闲空间映射页，负责第 index 段 FSM_PAGE_BITS 个页面
+};
+
+static constexpr int32_t FSM_PAGE_MAGIC = -0x46534d;  ///< "FSM"，取负数与记录页区分开
+static constexpr PageNum FSM_ROOT_PAGE  = 1;          ///< 第一个空闲空间映射页固定放在 header 页之后
+static constexpr int     FSM_PAGE_BITS  = (BP_PAGE_DATA_SIZE - sizeof(FsmPageHeader)) * 8;
+
+/**
+ * @brief 持久化的空闲空间映射(Free Space Map)
+ * @ingroup RecordManager
+ * @details 使用数据文件中专门的页面记录每个记录页是否还有空闲位置，每个页面对应一个比特。
+ * 空闲空间映射页从 FSM_ROOT_PAGE 开始，通过 next_page 串成一个链表，第 i 个页面负责第 i 段页号。
+ * 打开文件时只需要读取这几个页面，不再需要访问所有的记录页；插入、删除记录时增量地修改对应的比特。
+ *
+ * 空闲空间映射不记录日志，只是一个提示：某个页面标记为空闲但实际已经满了，插入时会发现并清除标记；
+ * 某个页面有空闲位置但没有标记，在该页面上删除记录或者恢复时插入记录会重新设置标记。
+ *
+ * 加锁顺序是先记录页的页面锁，再空闲空间映射页的页面锁。查找空闲页面时不会拿着记录页的锁。
+ */
+class FreeSpaceMap
+{
+public:
+  FreeSpaceMap() = default;
+  ~FreeSpaceMap() = default;
+
+  /**
+   * @brief 在文件上打开空闲空间映射
+   * @details 新文件会在 FSM_ROOT_PAGE 上创建空闲空间映射。不是按照这种格式创建的旧文件，
+   * 返回成功但是 is_open 返回 false，由调用方使用其它方式管理空闲页面。
+   */
+  RC init(DiskBufferPool &buffer_pool);
+
+  void close();
+
+  bool is_open() const { return buffer_pool_ != nullptr; }
+
+  /**
+   * @brief 从指定的页面开始，找一批标记为空闲的页面
+   *
+   * @param start_page 从哪个页面开始找
+   * @param max_num    最多找多少个页面
+   * @param page_nums  找到的页面追加到这里，按照页号从小到大排列
+   */
+  RC find_free_pages(PageNum start_page, int max_num, std::vector<PageNum> &page_nums);
+
+  /**
+   * @brief 设置某个页面是否还有空闲位置
+   * @details 页号超出当前空闲空间映射的范围时，会分配新的空闲空间映射页
+   * @param changed 如果不为空，返回标记是否发生了变化
+   */
+  RC set_page_free(PageNum page_num, bool free, bool *changed = nullptr);
+
+  /**
+   * @brief 判断页面数据是否是空闲空间映射页
+   */
+  static bool is_fsm_page(const char *page_data)
+  {
+    return reinterpret_cast<const FsmPageHeader *>(page_data)->magic == FSM_PAGE_MAGIC;
+  }
+
+private:
+  RC create(DiskBufferPool &buffer_pool);
+  RC load(DiskBufferPool &buffer_pool);
+
+  /**
+   * @brief 分配空闲空间映射页，直到能够覆盖 index 指定的那一段页号。需要加 lock_ 的写锁
+   */
+  RC extend(int index);
+
+private:
+  DiskBufferPool *buffer_pool_ = nullptr;
+
+  common::SharedMutex  lock_;       ///< 保护 fsm_pages_
+  std::vector<PageNum> fsm_pages_;  ///< 所有的空闲空间映射页，下标就是 FsmPageHeader::index
+};
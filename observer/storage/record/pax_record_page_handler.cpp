@@ -0,0 +1,237 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "storage/record/pax_record_page_handler.h"
+#include "common/lang/bitmap.h"
+#include "common/log/log.h"
+#include "storage/table/table_meta.h"
+
+using namespace std;
+using namespace common;
+
+// 定义在 record_manager.cpp 中
+int align8(int size);
+int page_bitmap_size(int record_capacity);
+
+static constexpr int PAX_PAGE_HEADER_SIZE = sizeof(PaxPageHeader);
+
+void PaxRecordPageHandler::init_page_layout()
+{
+  char *data   = frame_->data();
+  page_header_ = reinterpret_cast<PaxPageHeader *>(data);
+  bitmap_      = data + PAX_PAGE_HEADER_SIZE;
+  columns_     = reinterpret_cast<PaxColumnIndex *>(data + page_header_->col_idx_offset);
+}
+
+RC PaxRecordPageHandler::init_empty_page(
+    DiskBufferPool &buffer_pool, PageNum page_num, int record_size, const TableMeta *table_meta)
+{
+  if (nullptr == table_meta) {
+    LOG_ERROR("table meta is required to init pax page. page_num=%d", page_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  RC rc = init(buffer_pool, page_num, false /*readonly*/);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page. page_num=%d, rc=%s", page_num, strrc(rc));
+    return rc;
+  }
+
+  // 每一列的数据都按照8字节对齐，先把对齐可能浪费的空间都扣掉，再计算能放多少条记录
+  const int column_num = table_meta->field_num();
+  const int fixed_size = PAX_PAGE_HEADER_SIZE + column_num * sizeof(PaxColumnIndex) + (column_num + 2) * 8;
+  const int capacity   = static_cast<int>((BP_PAGE_DATA_SIZE - fixed_size - 1) / (record_size + 0.125));
+
+  page_header_->record_num       = 0;
+  page_header_->record_real_size = record_size;
+  page_header_->record_capacity  = capacity;
+  page_header_->column_num       = column_num;
+  page_header_->col_idx_offset   = align8(PAX_PAGE_HEADER_SIZE + page_bitmap_size(capacity));
+  init_page_layout();
+
+  int offset = align8(page_header_->col_idx_offset + column_num * sizeof(PaxColumnIndex));
+  for (int i = 0; i < column_num; i++) {
+    const FieldMeta *field   = table_meta->field(i);
+    columns_[i].field_offset = field->offset();
+    columns_[i].len          = field->len();
+    columns_[i].data_offset  = offset;
+    offset                   = align8(offset + field->len() * capacity);
+  }
+  ASSERT(offset <= BP_PAGE_DATA_SIZE, "Record overflow the page size");
+
+  memset(bitmap_, 0, page_bitmap_size(capacity));
+
+  if (OB_FAIL(rc = buffer_pool.flush_page(*frame_))) {
+    LOG_ERROR("Failed to flush page header %d:%d.", buffer_pool.file_desc(), page_num);
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::insert_record(const char *data, int /*data_len*/, RID *rid)
+{
+  ASSERT(readonly_ == false, "cannot insert record into page while the page is readonly");
+
+  if (page_header_->record_num == page_header_->record_capacity) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    index = bitmap.next_unsetted_bit(0);
+  bitmap.set_bit(index);
+  page_header_->record_num++;
+
+  write_columns(index, data);
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::recover_insert_record(const char *data, int /*data_len*/, const RID &rid)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    bitmap.set_bit(rid.slot_num);
+    page_header_->record_num++;
+  }
+
+  write_columns(rid.slot_num, data);
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::delete_record(const RID *rid)
+{
+  ASSERT(readonly_ == false, "cannot delete record from page while the page is readonly");
+
+  RC rc = check_slot(rid->slot_num);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  bitmap.clear_bit(rid->slot_num);
+  page_header_->record_num--;
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::update_record(const RID &rid, const char *data, int /*data_len*/)
+{
+  ASSERT(readonly_ == false, "cannot update record in page while the page is readonly");
+
+  RC rc = check_slot(rid.slot_num);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  write_columns(rid.slot_num, data);
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::get_record(const RID *rid, Record *rec)
+{
+  RC rc = check_slot(rid->slot_num);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 同一个页面上的记录长度都一样，拼装记录的缓存只在第一次访问时分配，之后都复用
+  const int len = page_header_->record_real_size;
+  row_buffer_.resize(len);
+  char *data = row_buffer_.data();
+
+  for (int i = 0; i < page_header_->column_num; i++) {
+    const PaxColumnIndex &column = columns_[i];
+    memcpy(data + column.field_offset, column_value(column, rid->slot_num), column.len);
+  }
+
+  rec->set_rid(*rid);
+  rec->set_data(data, len);
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::get_column(int column_index, ColumnChunk &chunk)
+{
+  if (column_index < 0 || column_index >= page_header_->column_num) {
+    LOG_WARN("invalid column index. page_num=%d, column=%d, column num=%d",
+             frame_->page_num(), column_index, page_header_->column_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const PaxColumnIndex &column = columns_[column_index];
+  chunk.page_num               = frame_->page_num();
+  chunk.value_len              = column.len;
+  chunk.slots.clear();
+  chunk.data.resize(static_cast<size_t>(column.len) * page_header_->record_num);
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (page_header_->record_num == page_header_->record_capacity) {
+    // 页面是满的，整列一次复制出来
+    memcpy(chunk.data.data(), column_value(column, 0), chunk.data.size());
+    for (SlotNum slot_num = 0; slot_num < page_header_->record_capacity; slot_num++) {
+      chunk.slots.push_back(slot_num);
+    }
+    return RC::SUCCESS;
+  }
+
+  char *dst = chunk.data.data();
+  for (SlotNum slot_num = bitmap.next_setted_bit(0); slot_num != -1; slot_num = bitmap.next_setted_bit(slot_num + 1)) {
+    memcpy(dst, column_value(column, slot_num), column.len);
+    dst += column.len;
+    chunk.slots.push_back(slot_num);
+  }
+  return RC::SUCCESS;
+}
+
+SlotNum PaxRecordPageHandler::next_record_slot(SlotNum start_slot_num) const
+{
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  return bitmap.next_setted_bit(start_slot_num);
+}
+
+bool PaxRecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
+
+RC PaxRecordPageHandler::check_slot(SlotNum slot_num) const
+{
+  if (slot_num < 0 || slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num:%d, exceed page's record capacity, page_num %d.", slot_num, frame_->page_num());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(slot_num)) {
+    LOG_DEBUG("Invalid slot_num:%d, slot is empty, page_num %d.", slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+  return RC::SUCCESS;
+}
+
+void PaxRecordPageHandler::write_columns(SlotNum slot_num, const char *data)
+{
+  for (int i = 0; i < page_header_->column_num; i++) {
+    const PaxColumnIndex &column = columns_[i];
+    memcpy(column_value(column, slot_num), data + column.field_offset, column.len);
+  }
+}
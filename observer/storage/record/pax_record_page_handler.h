@@ -0,0 +1,107 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "storage/record/record_manager.h"
+
+/**
+ * @brief PAX 页面的页头
+ * @ingroup RecordManager
+ * @details record_num 放在第一个字段，与定长记录页一样不会是负数，可以与空闲空间映射页和溢出页区分开。
+ */
+struct PaxPageHeader
+{
+  int32_t record_num;        ///< 当前页面记录的个数
+  int32_t record_real_size;  ///< 每条记录的实际大小
+  int32_t record_capacity;   ///< 最大记录个数
+  int32_t column_num;        ///< 列的个数
+  int32_t col_idx_offset;    ///< 列索引数组在页面中的偏移
+};
+
+/**
+ * @brief PAX 页面上每一列的索引，描述了这一列的数据(minipage)放在页面的什么位置
+ * @details 页面是自描述的，读取记录时不需要表的元数据
+ */
+struct PaxColumnIndex
+{
+  int32_t field_offset;  ///< 这一列在行记录中的偏移
+  int32_t len;           ///< 这一列每个值的长度
+  int32_t data_offset;   ///< 这一列的数据在页面中的偏移，第 i 个值属于槽位 i
+};
+
+/**
+ * @brief 按列存放定长记录的页面(PAX, Partition Attributes Across)
+ * @ingroup RecordManager
+ * @details 页面的组织大概是这样的：
+ * @code
+ * | PaxPageHeader | record allocate bitmap | column index |
+ * |------------------------------------------------------|
+ * | column0: value0 | value1 | ..... | valueN            |
+ * | column1: value0 | value1 | ..... | valueN            |
+ * | ......                                               |
+ * @endcode
+ * 同一列的值连续存放在一个 minipage 中，只访问少数几列时不需要把整条记录都读到缓存里，
+ * 也可以通过 get_column 一次取出整列数据做向量化的计算。
+ * 按行访问时把各列的值拼装成与定长格式一样的记录，所以上层算子不需要区分存储格式。
+ */
+class PaxRecordPageHandler : public RecordPageHandler
+{
+public:
+  PaxRecordPageHandler()          = default;
+  virtual ~PaxRecordPageHandler() = default;
+
+  RC init_empty_page(
+      DiskBufferPool &buffer_pool, PageNum page_num, int record_size, const TableMeta *table_meta) override;
+
+  RC insert_record(const char *data, int data_len, RID *rid) override;
+  RC recover_insert_record(const char *data, int data_len, const RID &rid) override;
+  RC delete_record(const RID *rid) override;
+  RC update_record(const RID &rid, const char *data, int data_len) override;
+
+  /**
+   * @copydoc RecordPageHandler::get_record
+   * @note 记录是从各列拼装出来的，放在 handler 内部的缓存中，下一次调用 get_record 或者 cleanup 之后就失效了
+   */
+  RC get_record(const RID *rid, Record *rec) override;
+
+  RC get_column(int column_index, ColumnChunk &chunk) override;
+
+  SlotNum next_record_slot(SlotNum start_slot_num) const override;
+  bool    is_full() const override;
+
+protected:
+  void init_page_layout() override;
+
+private:
+  /**
+   * @brief 检查槽位是否存在并且有记录
+   */
+  RC check_slot(SlotNum slot_num) const;
+
+  /**
+   * @brief 把行记录的各个字段写到各列对应的位置上
+   */
+  void write_columns(SlotNum slot_num, const char *data);
+
+  char *column_value(const PaxColumnIndex &column, SlotNum slot_num) const
+  {
+    return frame_->data() + column.data_offset + column.len * slot_num;
+  }
+
+private:
+  PaxPageHeader    *page_header_ = nullptr;  ///< 当前页面上页面头
+  char             *bitmap_      = nullptr;  ///< 当前页面上record分配状态信息bitmap内存起始位置
+  PaxColumnIndex   *columns_     = nullptr;  ///< 当前页面上的列索引数组
+  std::vector<char> row_buffer_;             ///< 按行访问时拼装记录用的缓存
+};
@@ -17,6 +17,7 @@ See the Mulan PSL v2 for more details. */
 #include <limits>
 #include <sstream>
 #include <stddef.h>
+#include <utility>
 #include <vector>
 
 #include "common/log/log.h"
@@ -126,10 +127,37 @@ public:
     return *this;
   }
 
+  /**
+   * @brief 移动时直接接管对方的内存，不需要复制数据
+   */
+  Record(Record &&other) noexcept
+      : rid_(other.rid_), data_(other.data_), len_(other.len_), owner_(other.owner_)
+  {
+    other.data_  = nullptr;
+    other.len_   = 0;
+    other.owner_ = false;
+  }
+
+  Record &operator=(Record &&other) noexcept
+  {
+    if (this == &other) {
+      return *this;
+    }
+
+    this->~Record();
+    new (this) Record(std::move(other));
+    return *this;
+  }
+
   void set_data(char *data, int len = 0)
   {
-    this->data_ = data;
-    this->len_  = len;
+    if (owner_ && data_ != nullptr) {
+      free(data_);
+    }
+
+    this->data_  = data;
+    this->len_   = len;
+    this->owner_ = false;
   }
   void set_data_owner(char *data, int len)
   {
@@ -0,0 +1,116 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "storage/record/record_codec.h"
+#include "common/log/log.h"
+#include "storage/record/record.h"
+#include "storage/table/table_meta.h"
+
+using namespace std;
+
+/// 字符串长度使用两个字节存放
+using VarlenSize = uint16_t;
+
+RC VarlenRecordCodec::init(const TableMeta &table_meta)
+{
+  columns_.clear();
+  max_encoded_size_ = 0;
+
+  for (const FieldMeta &field : *table_meta.field_metas()) {
+    const bool varlen = field.type() == CHARS;
+    if (varlen && field.len() > UINT16_MAX) {
+      LOG_WARN("field is too long to store as variable length. field=%s, len=%d", field.name(), field.len());
+      return RC::INVALID_ARGUMENT;
+    }
+
+    columns_.push_back(Column{field.offset(), field.len(), varlen});
+    max_encoded_size_ += field.len() + (varlen ? sizeof(VarlenSize) : 0);
+  }
+
+  record_size_ = table_meta.record_size();
+  return RC::SUCCESS;
+}
+
+int VarlenRecordCodec::encode(const char *record, char *buffer) const
+{
+  char *pos = buffer;
+  for (const Column &column : columns_) {
+    const char *field_data = record + column.offset;
+    if (!column.varlen) {
+      memcpy(pos, field_data, column.len);
+      pos += column.len;
+      continue;
+    }
+
+    const VarlenSize len = static_cast<VarlenSize>(strnlen(field_data, column.len));
+    memcpy(pos, &len, sizeof(len));
+    pos += sizeof(len);
+    memcpy(pos, field_data, len);
+    pos += len;
+  }
+  return static_cast<int>(pos - buffer);
+}
+
+RC VarlenRecordCodec::decode(const char *data, int len, char *record) const
+{
+  const char *pos = data;
+  const char *end = data + len;
+  for (const Column &column : columns_) {
+    char *field_data = record + column.offset;
+    if (!column.varlen) {
+      if (end - pos < column.len) {
+        LOG_WARN("invalid variable length record. len=%d", len);
+        return RC::INTERNAL;
+      }
+      memcpy(field_data, pos, column.len);
+      pos += column.len;
+      continue;
+    }
+
+    VarlenSize field_len = 0;
+    if (end - pos < static_cast<int>(sizeof(field_len))) {
+      LOG_WARN("invalid variable length record. len=%d", len);
+      return RC::INTERNAL;
+    }
+    memcpy(&field_len, pos, sizeof(field_len));
+    pos += sizeof(field_len);
+    if (field_len > column.len || end - pos < field_len) {
+      LOG_WARN("invalid variable length record. len=%d, field len=%d", len, field_len);
+      return RC::INTERNAL;
+    }
+
+    memcpy(field_data, pos, field_len);
+    memset(field_data + field_len, 0, column.len - field_len);
+    pos += field_len;
+  }
+  return RC::SUCCESS;
+}
+
+RC VarlenRecordCodec::decode(Record &record) const
+{
+  char *data = static_cast<char *>(malloc(record_size_));
+  if (nullptr == data) {
+    LOG_WARN("failed to allocate memory for record. size=%d", record_size_);
+    return RC::NOMEM;
+  }
+
+  RC rc = decode(record.data(), record.len(), data);
+  if (OB_FAIL(rc)) {
+    free(data);
+    return rc;
+  }
+
+  record.set_data_owner(data, record_size_);
+  return RC::SUCCESS;
+}
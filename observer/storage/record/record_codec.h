@@ -0,0 +1,79 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <vector>
+
+#include "common/rc.h"
+
+class Record;
+class TableMeta;
+
+/**
+ * @brief 变长记录的编码
+ * @ingroup RecordManager
+ * @details 内存中的记录仍然是定长的格式，每个字段都在固定的偏移位置上，上层的算子不需要关心记录在页面上怎么存放。
+ * 使用 SLOTTED_FORMAT 的表，在写入页面之前把记录编码成变长的格式：字符串字段只保存实际的内容，
+ * 前面加上两个字节的长度，去掉末尾的填充；其它字段原样保存。读取时再解码成定长的格式，字符串末尾补0。
+ */
+class VarlenRecordCodec
+{
+public:
+  VarlenRecordCodec()  = default;
+  ~VarlenRecordCodec() = default;
+
+  RC init(const TableMeta &table_meta);
+
+  /**
+   * @brief 解码之后(定长格式)的记录大小
+   */
+  int record_size() const { return record_size_; }
+
+  /**
+   * @brief 编码之后最长有多长
+   */
+  int max_encoded_size() const { return max_encoded_size_; }
+
+  /**
+   * @brief 把定长格式的记录编码成变长格式
+   *
+   * @param record 定长格式的记录，长度是 record_size
+   * @param buffer 编码结果，至少要有 max_encoded_size 个字节
+   * @return 编码之后的长度
+   */
+  int encode(const char *record, char *buffer) const;
+
+  /**
+   * @brief 把变长格式的数据解码成定长格式
+   *
+   * @param data   变长格式的数据
+   * @param len    数据的长度
+   * @param record 解码结果，至少要有 record_size 个字节
+   */
+  RC decode(const char *data, int len, char *record) const;
+
+  /**
+   * @brief 把记录中变长格式的数据解码成定长格式，解码后的数据由 record 自己管理
+   */
+  RC decode(Record &record) const;
+
+private:
+  struct Column
+  {
+    int  offset;
+    int  len;
+    bool varlen;  ///< 是否按照变长的方式存放
+  };
+
+  std::vector<Column> columns_;
+  int                 record_size_      = 0;
+  int                 max_encoded_size_ = 0;
+};
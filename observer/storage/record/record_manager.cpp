@@ -15,9 +15,14 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/bitmap.h"
 #include "common/log/log.h"
 #include "storage/common/condition_filter.h"
+#include "storage/record/compressed_record_page_handler.h"
+#include "storage/record/pax_record_page_handler.h"
+#include "storage/record/slotted_record_page_handler.h"
+#include "storage/table/table.h"
 #include "storage/trx/trx.h"
 
 using namespace common;
+using namespace std;
 
 static constexpr int PAGE_HEADER_SIZE = (sizeof(PageHeader));
 
@@ -58,32 +63,47 @@ void RecordPageIterator::init(RecordPageHandler &record_page_handler, SlotNum st
 {
   record_page_handler_ = &record_page_handler;
   page_num_            = record_page_handler.get_page_num();
-  bitmap_.init(record_page_handler.bitmap_, record_page_handler.page_header_->record_capacity);
-  next_slot_num_ = bitmap_.next_setted_bit(start_slot_num);
+  next_slot_num_       = record_page_handler.next_record_slot(start_slot_num);
 }
 
 bool RecordPageIterator::has_next() { return -1 != next_slot_num_; }
 
 RC RecordPageIterator::next(Record &record)
 {
-  record.set_rid(page_num_, next_slot_num_);
-  record.set_data(record_page_handler_->get_record_data(record.rid().slot_num));
+  if (next_slot_num_ < 0) {
+    return RC::RECORD_EOF;
+  }
 
-  if (next_slot_num_ >= 0) {
-    next_slot_num_ = bitmap_.next_setted_bit(next_slot_num_ + 1);
+  RID rid(page_num_, next_slot_num_);
+  RC  rc = record_page_handler_->get_record(&rid, &record);
+  if (OB_FAIL(rc)) {
+    return rc;
   }
-  return record.rid().slot_num != -1 ? RC::SUCCESS : RC::RECORD_EOF;
+
+  next_slot_num_ = record_page_handler_->next_record_slot(next_slot_num_ + 1);
+  return RC::SUCCESS;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 RecordPageHandler::~RecordPageHandler() { cleanup(); }
 
+RecordPageHandler *RecordPageHandler::create(StorageFormat format, const TableMeta *table_meta /*= nullptr*/)
+{
+  switch (format) {
+    case StorageFormat::SLOTTED_FORMAT: return new SlottedRecordPageHandler();
+    case StorageFormat::PAX_FORMAT: return new PaxRecordPageHandler();
+    case StorageFormat::COMPRESSED_FORMAT: return new CompressedRecordPageHandler(table_meta);
+    default: return new FixedRecordPageHandler();
+  }
+}
+
 RC RecordPageHandler::init(DiskBufferPool &buffer_pool, PageNum page_num, bool readonly)
 {
   if (disk_buffer_pool_ != nullptr) {
     if (frame_->page_num() == page_num) {
-      LOG_WARN("Disk buffer pool has been opened for page_num %d.", page_num);
+      // 连续访问同一个页面上的记录时会走到这里，比如索引扫描批量回表
+      LOG_TRACE("Disk buffer pool has been opened for page_num %d.", page_num);
       return RC::RECORD_OPENNED;
     } else {
       cleanup();
@@ -96,8 +116,6 @@ RC RecordPageHandler::init(DiskBufferPool &buffer_pool, PageNum page_num, bool r
     return ret;
   }
 
-  char *data = frame_->data();
-
   if (readonly) {
     frame_->read_latch();
   } else {
@@ -105,8 +123,7 @@ RC RecordPageHandler::init(DiskBufferPool &buffer_pool, PageNum page_num, bool r
   }
   disk_buffer_pool_ = &buffer_pool;
   readonly_         = readonly;
-  page_header_      = (PageHeader *)(data);
-  bitmap_           = data + PAGE_HEADER_SIZE;
+  init_page_layout();
 
   LOG_TRACE("Successfully init page_num %d.", page_num);
   return ret;
@@ -125,13 +142,10 @@ RC RecordPageHandler::recover_init(DiskBufferPool &buffer_pool, PageNum page_num
     return ret;
   }
 
-  char *data = frame_->data();
-
   frame_->write_latch();
   disk_buffer_pool_ = &buffer_pool;
   readonly_         = false;
-  page_header_      = (PageHeader *)(data);
-  bitmap_           = data + PAGE_HEADER_SIZE;
+  init_page_layout();
 
   buffer_pool.recover_page(page_num);
 
@@ -139,7 +153,53 @@ RC RecordPageHandler::recover_init(DiskBufferPool &buffer_pool, PageNum page_num
   return ret;
 }
 
-RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, PageNum page_num, int record_size)
+RC RecordPageHandler::cleanup()
+{
+  if (disk_buffer_pool_ != nullptr) {
+    if (readonly_) {
+      frame_->read_unlatch();
+    } else {
+      frame_->write_unlatch();
+    }
+    disk_buffer_pool_->unpin_page(frame_);
+    disk_buffer_pool_ = nullptr;
+  }
+
+  return RC::SUCCESS;
+}
+
+PageNum RecordPageHandler::get_page_num() const
+{
+  if (nullptr == frame_) {
+    return (PageNum)(-1);
+  }
+  return frame_->page_num();
+}
+
+RC RecordPageHandler::get_column(int column_index, ColumnChunk & /*chunk*/)
+{
+  LOG_WARN("column access is not supported by this storage format. page_num=%d, column=%d",
+           get_page_num(), column_index);
+  return RC::UNIMPLENMENT;
+}
+
+bool RecordPageHandler::is_record_page() const
+{
+  const char *data = frame_->data();
+  return !FreeSpaceMap::is_fsm_page(data) && !SlottedRecordPageHandler::is_overflow_page(data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void FixedRecordPageHandler::init_page_layout()
+{
+  char *data   = frame_->data();
+  page_header_ = (PageHeader *)(data);
+  bitmap_      = data + PAGE_HEADER_SIZE;
+}
+
+RC FixedRecordPageHandler::init_empty_page(
+    DiskBufferPool &buffer_pool, PageNum page_num, int record_size, const TableMeta * /*table_meta*/)
 {
   RC ret = init(buffer_pool, page_num, false /*readonly*/);
   if (ret != RC::SUCCESS) {
@@ -167,22 +227,7 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, PageNum page_
   return RC::SUCCESS;
 }
 
-RC RecordPageHandler::cleanup()
-{
-  if (disk_buffer_pool_ != nullptr) {
-    if (readonly_) {
-      frame_->read_unlatch();
-    } else {
-      frame_->write_unlatch();
-    }
-    disk_buffer_pool_->unpin_page(frame_);
-    disk_buffer_pool_ = nullptr;
-  }
-
-  return RC::SUCCESS;
-}
-
-RC RecordPageHandler::insert_record(const char *data, RID *rid)
+RC FixedRecordPageHandler::insert_record(const char *data, int /*data_len*/, RID *rid)
 {
   ASSERT(readonly_ == false, "cannot insert record into page while the page is readonly");
 
@@ -212,7 +257,7 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid)
   return RC::SUCCESS;
 }
 
-RC RecordPageHandler::recover_insert_record(const char *data, const RID &rid)
+RC FixedRecordPageHandler::recover_insert_record(const char *data, int /*data_len*/, const RID &rid)
 {
   if (rid.slot_num >= page_header_->record_capacity) {
     LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
@@ -235,7 +280,7 @@ RC RecordPageHandler::recover_insert_record(const char *data, const RID &rid)
   return RC::SUCCESS;
 }
 
-RC RecordPageHandler::delete_record(const RID *rid)
+RC FixedRecordPageHandler::delete_record(const RID *rid)
 {
   ASSERT(readonly_ == false, "cannot delete record from page while the page is readonly");
 
@@ -249,11 +294,6 @@ RC RecordPageHandler::delete_record(const RID *rid)
     bitmap.clear_bit(rid->slot_num);
     page_header_->record_num--;
     frame_->mark_dirty();
-
-    if (page_header_->record_num == 0) {
-      // PageNum page_num = get_page_num();
-      cleanup();
-    }
     return RC::SUCCESS;
   } else {
     LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
@@ -261,7 +301,30 @@ RC RecordPageHandler::delete_record(const RID *rid)
   }
 }
 
-RC RecordPageHandler::get_record(const RID *rid, Record *rec)
+RC FixedRecordPageHandler::update_record(const RID &rid, const char *data, int /*data_len*/)
+{
+  ASSERT(readonly_ == false, "cannot update record in page while the page is readonly");
+
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_WARN("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  char *record_data = get_record_data(rid.slot_num);
+  if (record_data != data) {
+    memcpy(record_data, data, page_header_->record_real_size);
+  }
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC FixedRecordPageHandler::get_record(const RID *rid, Record *rec)
 {
   if (rid->slot_num >= page_header_->record_capacity) {
     LOG_ERROR("Invalid slot_num:%d, exceed page's record capacity, page_num %d.", rid->slot_num, frame_->page_num());
@@ -279,30 +342,48 @@ RC RecordPageHandler::get_record(const RID *rid, Record *rec)
   return RC::SUCCESS;
 }
 
-PageNum RecordPageHandler::get_page_num() const
+SlotNum FixedRecordPageHandler::next_record_slot(SlotNum start_slot_num) const
 {
-  if (nullptr == page_header_) {
-    return (PageNum)(-1);
-  }
-  return frame_->page_num();
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  return bitmap.next_setted_bit(start_slot_num);
 }
 
-bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
+bool FixedRecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 RecordFileHandler::~RecordFileHandler() { this->close(); }
 
-RC RecordFileHandler::init(DiskBufferPool *buffer_pool)
+RC RecordFileHandler::init(DiskBufferPool *buffer_pool, const TableMeta *table_meta)
 {
   if (disk_buffer_pool_ != nullptr) {
     LOG_ERROR("record file handler has been openned.");
     return RC::RECORD_OPENNED;
   }
 
+  RC rc = RC::SUCCESS;
+  table_meta_     = table_meta;
+  storage_format_ = StorageFormat::FIXED_FORMAT;
+  if (table_meta != nullptr) {
+    storage_format_ = table_meta->storage_format();
+  }
+  if (storage_format_ == StorageFormat::SLOTTED_FORMAT && OB_FAIL(rc = codec_.init(*table_meta))) {
+    LOG_WARN("failed to init record codec. table=%s, rc=%s", table_meta->name(), strrc(rc));
+    return rc;
+  }
+
   disk_buffer_pool_ = buffer_pool;
 
-  RC rc = init_free_pages();
+  rc = free_space_map_.init(*buffer_pool);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init free space map. rc=%s", strrc(rc));
+    disk_buffer_pool_ = nullptr;
+    return rc;
+  }
+
+  if (!free_space_map_.is_open()) {
+    rc = init_free_pages();
+  }
 
   LOG_INFO("open record file handle done. rc=%s", strrc(rc));
   return RC::SUCCESS;
@@ -311,7 +392,14 @@ RC RecordFileHandler::init(DiskBufferPool *buffer_pool)
 void RecordFileHandler::close()
 {
   if (disk_buffer_pool_ != nullptr) {
+    free_space_map_.close();
+    free_page_pool_.clear();
+    for (InsertSlot &slot : insert_slots_) {
+      slot.page_num.store(BP_INVALID_PAGE_NUM);
+    }
+    queued_pages_.clear();
     free_pages_.clear();
+    table_meta_       = nullptr;
     disk_buffer_pool_ = nullptr;
   }
 }
@@ -326,34 +414,33 @@ RC RecordFileHandler::init_free_pages()
 
   BufferPoolIterator bp_iterator;
   bp_iterator.init(*disk_buffer_pool_);
-  RecordPageHandler record_page_handler;
-  PageNum           current_page_num = 0;
+  bp_iterator.set_read_ahead(true);
+  unique_ptr<RecordPageHandler> record_page_handler(create_page_handler());
+  PageNum                       current_page_num = 0;
 
   while (bp_iterator.has_next()) {
     current_page_num = bp_iterator.next();
 
-    rc = record_page_handler.init(*disk_buffer_pool_, current_page_num, true /*readonly*/);
+    rc = record_page_handler->init(*disk_buffer_pool_, current_page_num, true /*readonly*/);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, rc, strrc(rc));
       return rc;
     }
 
-    if (!record_page_handler.is_full()) {
+    if (record_page_handler->is_record_page() && !record_page_handler->is_full()) {
       free_pages_.insert(current_page_num);
     }
-    record_page_handler.cleanup();
+    record_page_handler->cleanup();
   }
   LOG_INFO("record file handler init free pages done. free page num=%d, rc=%s", free_pages_.size(), strrc(rc));
   return rc;
 }
 
-RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
+RC RecordFileHandler::find_free_page(RecordPageHandler &record_page_handler, int record_size)
 {
-  RC ret = RC::SUCCESS;
-
-  RecordPageHandler record_page_handler;
-  bool              page_found       = false;
-  PageNum           current_page_num = 0;
+  RC      ret              = RC::SUCCESS;
+  bool    page_found       = false;
+  PageNum current_page_num = 0;
 
   // 当前要访问free_pages对象，所以需要加锁。在非并发编译模式下，不需要考虑这个锁
   lock_.lock();
@@ -378,81 +465,434 @@ RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
   }
   lock_.unlock();  // 如果找到了一个有效的页面，那么此时已经拿到了页面的写锁
 
+  if (page_found) {
+    return RC::SUCCESS;
+  }
+
   // 找不到就分配一个新的页面
-  if (!page_found) {
-    Frame *frame = nullptr;
-    if ((ret = disk_buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
-      LOG_ERROR("Failed to allocate page while inserting record. ret:%d", ret);
-      return ret;
+  Frame *frame = nullptr;
+  if ((ret = disk_buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate page while inserting record. ret:%d", ret);
+    return ret;
+  }
+
+  current_page_num = frame->page_num();
+
+  ret = record_page_handler.init_empty_page(*disk_buffer_pool_, current_page_num, record_size, table_meta_);
+  if (ret != RC::SUCCESS) {
+    frame->unpin();
+    LOG_ERROR("Failed to init empty page. ret:%d", ret);
+    // this is for allocate_page
+    return ret;
+  }
+
+  // frame 在allocate_page的时候，是有一个pin的，在init_empty_page时又会增加一个，所以这里手动释放一个
+  frame->unpin();
+
+  // 这里的加锁顺序看起来与上面是相反的，但是不会出现死锁
+  // 上面的逻辑是先加lock锁，然后加页面写锁，这里是先加上
+  // 了页面写锁，然后加lock的锁，但是不会引起死锁。
+  // 为什么？
+  return add_free_page(current_page_num);
+}
+
+int RecordFileHandler::current_insert_slot()
+{
+  // 每个线程第一次插入时按顺序分配一个 slot，线程数不超过 INSERT_SLOT_NUM 时各个线程的插入页面互不相同
+  static std::atomic<int> next_slot{0};
+  static thread_local int slot = next_slot.fetch_add(1) % INSERT_SLOT_NUM;
+  return slot;
+}
+
+RC RecordFileHandler::claim_insert_page(RecordPageHandler &record_page_handler, int record_size, bool new_page)
+{
+  InsertSlot &slot = insert_slots_[current_insert_slot()];
+  while (true) {
+    PageNum page_num = slot.page_num.load();
+    if (page_num == BP_INVALID_PAGE_NUM || new_page) {
+      RC rc = new_page ? allocate_extent(record_size, &page_num) : take_free_page(page_num, record_size);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      new_page = false;
+
+      // 共用这个 slot 的其它线程可能已经领取了页面，这时把刚领取的页面还回去，这一次仍然向它插入
+      PageNum expected = BP_INVALID_PAGE_NUM;
+      if (!slot.page_num.compare_exchange_strong(expected, page_num)) {
+        return_free_page(page_num);
+      }
+    }
+
+    RC rc = record_page_handler.init(*disk_buffer_pool_, page_num, false /*readonly*/);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to init record page handler. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
     }
 
-    current_page_num = frame->page_num();
+    if (!record_page_handler.is_full()) {
+      return RC::SUCCESS;
+    }
 
-    ret = record_page_handler.init_empty_page(*disk_buffer_pool_, current_page_num, record_size);
-    if (ret != RC::SUCCESS) {
-      frame->unpin();
-      LOG_ERROR("Failed to init empty page. ret:%d", ret);
-      // this is for allocate_page
-      return ret;
+    // 空闲标记已经过时了，或者被其它共用这个 slot 的线程填满了。
+    // 拿着页面锁清除标记，避免与删除记录时设置标记相互覆盖
+    rc = release_insert_page(page_num);
+    record_page_handler.cleanup();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+}
+
+RC RecordFileHandler::release_insert_page(PageNum page_num)
+{
+  RC rc = free_space_map_.set_page_free(page_num, false);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to update free space map. page num=%d, rc=%s", page_num, strrc(rc));
+    return rc;
+  }
+
+  skip_insert_page(page_num);
+  return RC::SUCCESS;
+}
+
+void RecordFileHandler::skip_insert_page(PageNum page_num)
+{
+  // slot 中已经不是这个页面时，说明共用 slot 的其它线程已经处理过它了
+  InsertSlot &slot     = insert_slots_[current_insert_slot()];
+  PageNum     expected = page_num;
+  if (slot.page_num.compare_exchange_strong(expected, BP_INVALID_PAGE_NUM)) {
+    unqueue_free_page(page_num);
+  }
+}
+
+bool RecordFileHandler::queue_free_page(PageNum page_num)
+{
+  lock_guard<Mutex> guard(queued_lock_);
+  if (!queued_pages_.insert(page_num).second) {
+    return false;
+  }
+
+  if (!free_page_pool_.push(page_num)) {
+    queued_pages_.erase(page_num);
+    return false;
+  }
+  return true;
+}
+
+void RecordFileHandler::unqueue_free_page(PageNum page_num)
+{
+  lock_guard<Mutex> guard(queued_lock_);
+  queued_pages_.erase(page_num);
+}
+
+void RecordFileHandler::return_free_page(PageNum page_num)
+{
+  lock_guard<Mutex> guard(queued_lock_);
+  if (!free_page_pool_.push(page_num)) {
+    queued_pages_.erase(page_num);
+  }
+}
+
+RC RecordFileHandler::take_free_page(PageNum &page_num, int record_size)
+{
+  while (!free_page_pool_.pop(page_num)) {
+    RC rc = refill_free_page_pool(record_size);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC RecordFileHandler::refill_free_page_pool(int record_size)
+{
+  lock_guard<Mutex> guard(refill_lock_);
+  if (!free_page_pool_.empty()) {
+    // 其它线程已经补充过了
+    return RC::SUCCESS;
+  }
+
+  // 从上次结束的位置继续找，找到文件末尾之后再从头找一遍
+  vector<PageNum> page_nums;
+  RC              rc = free_space_map_.find_free_pages(refill_cursor_, REFILL_PAGES, page_nums);
+  if (OB_SUCC(rc) && page_nums.empty() && refill_cursor_ != 0) {
+    refill_cursor_ = 0;
+    rc             = free_space_map_.find_free_pages(refill_cursor_, REFILL_PAGES, page_nums);
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to find free pages from free space map. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (page_nums.empty()) {
+    return allocate_extent(record_size);
+  }
+
+  // 找到的页面可能正是某个线程的插入页面，或者已经在池子中了，queue_free_page 会跳过它们。
+  // 一个都没有放进去时分配新的页面，否则领取页面的线程会一直在这里空转
+  refill_cursor_ = page_nums.back() + 1;
+  int queued     = 0;
+  for (PageNum page_num : page_nums) {
+    if (queue_free_page(page_num)) {
+      queued++;
+    }
+  }
+  return queued > 0 ? RC::SUCCESS : allocate_extent(record_size);
+}
+
+RC RecordFileHandler::allocate_extent(int record_size, PageNum *claimed_page /* = nullptr */)
+{
+  RC  rc        = RC::SUCCESS;
+  int allocated = 0;
+  for (; allocated < EXTENT_PAGES; allocated++) {
+    Frame *frame = nullptr;
+    if (OB_FAIL(rc = disk_buffer_pool_->allocate_page(&frame))) {
+      LOG_WARN("failed to allocate page. allocated=%d, rc=%s", allocated, strrc(rc));
+      break;
     }
 
+    const PageNum                 page_num = frame->page_num();
+    unique_ptr<RecordPageHandler> record_page_handler(create_page_handler());
+    rc = record_page_handler->init_empty_page(*disk_buffer_pool_, page_num, record_size, table_meta_);
     // frame 在allocate_page的时候，是有一个pin的，在init_empty_page时又会增加一个，所以这里手动释放一个
     frame->unpin();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to init empty page. page num=%d, rc=%s", page_num, strrc(rc));
+      break;
+    }
+
+    rc = free_space_map_.set_page_free(page_num, true);
+    record_page_handler->cleanup();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to update free space map. page num=%d, rc=%s", page_num, strrc(rc));
+      break;
+    }
 
-    // 这里的加锁顺序看起来与上面是相反的，但是不会出现死锁
-    // 上面的逻辑是先加lock锁，然后加页面写锁，这里是先加上
-    // 了页面写锁，然后加lock的锁，但是不会引起死锁。
-    // 为什么？
-    lock_.lock();
-    free_pages_.insert(current_page_num);
-    lock_.unlock();
+    if (claimed_page != nullptr && allocated == 0) {
+      lock_guard<Mutex> guard(queued_lock_);
+      queued_pages_.insert(page_num);
+      *claimed_page = page_num;
+    } else {
+      queue_free_page(page_num);
+    }
   }
 
-  // 找到空闲位置
-  return record_page_handler.insert_record(data, rid);
+  LOG_TRACE("allocate extent. pages=%d, rc=%s", allocated, strrc(rc));
+  // 分配到了一部分页面就可以先用着
+  return allocated > 0 ? RC::SUCCESS : rc;
+}
+
+RC RecordFileHandler::add_free_page(PageNum page_num)
+{
+  if (free_space_map_.is_open()) {
+    // 只有页面从满变成不满时才放到空闲页面池中，避免同一个页面被重复放入很多次
+    bool changed = false;
+    RC   rc      = free_space_map_.set_page_free(page_num, true, &changed);
+    if (OB_SUCC(rc) && changed) {
+      queue_free_page(page_num);
+    }
+    return rc;
+  }
+
+  lock_.lock();
+  free_pages_.insert(page_num);
+  LOG_TRACE("add free page %d to free page list", page_num);
+  lock_.unlock();
+  return RC::SUCCESS;
+}
+
+RC RecordFileHandler::mark_page_full(PageNum page_num)
+{
+  if (free_space_map_.is_open()) {
+    return release_insert_page(page_num);
+  }
+
+  lock_.lock();
+  free_pages_.erase(page_num);
+  lock_.unlock();
+  return RC::SUCCESS;
+}
+
+RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
+{
+  // 变长记录先编码，页面上存放的是编码之后的数据
+  unique_ptr<char[]> encoded;
+  int                data_len = record_size;
+  if (storage_format_ == StorageFormat::SLOTTED_FORMAT) {
+    encoded.reset(new char[codec_.max_encoded_size()]);
+    data_len = codec_.encode(data, encoded.get());
+    data     = encoded.get();
+  }
+
+  unique_ptr<RecordPageHandler> record_page_handler(create_page_handler());
+
+  RC  ret           = RC::SUCCESS;
+  int skipped_pages = 0;
+  while (true) {
+    if (free_space_map_.is_open()) {
+      ret = claim_insert_page(*record_page_handler, record_size, skipped_pages >= MAX_SKIP_PAGES /*new_page*/);
+    } else {
+      ret = find_free_page(*record_page_handler, record_size);
+    }
+    if (OB_FAIL(ret)) {
+      return ret;
+    }
+
+    // 找到空闲位置
+    ret = record_page_handler->insert_record(data, data_len, rid);
+    if (ret != RC::RECORD_NOMEM) {
+      break;
+    }
+
+    // 变长记录的页面虽然没有满，但是放不下这条记录，换一个页面再试
+    const PageNum page_num = record_page_handler->get_page_num();
+    if (free_space_map_.is_open() && !record_page_handler->is_full()) {
+      // 页面上还能放下更短的记录，不能清除空闲标记。连续几个页面都放不下时直接使用新页面，
+      // 新页面也放不下就没有办法了
+      skip_insert_page(page_num);
+      record_page_handler->cleanup();
+      if (skipped_pages++ >= MAX_SKIP_PAGES) {
+        LOG_WARN("record is too large for an empty page. size=%d", data_len);
+        return RC::RECORD_NOMEM;
+      }
+      continue;
+    }
+
+    ret = mark_page_full(page_num);
+    record_page_handler->cleanup();
+    if (OB_FAIL(ret)) {
+      LOG_WARN("failed to mark page full. page num=%d, rc=%s", page_num, strrc(ret));
+      return ret;
+    }
+  }
+
+  if (OB_SUCC(ret) && free_space_map_.is_open() && record_page_handler->is_full()) {
+    // 插入之后页面满了，及时清除标记，当前线程下次插入时换一个页面
+    RC rc = release_insert_page(record_page_handler->get_page_num());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to release insert page. page num=%d, rc=%s", record_page_handler->get_page_num(), strrc(rc));
+    }
+  }
+  return ret;
 }
 
 RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid)
 {
   RC ret = RC::SUCCESS;
 
-  RecordPageHandler record_page_handler;
+  unique_ptr<char[]> encoded;
+  int                data_len = record_size;
+  if (storage_format_ == StorageFormat::SLOTTED_FORMAT) {
+    encoded.reset(new char[codec_.max_encoded_size()]);
+    data_len = codec_.encode(data, encoded.get());
+    data     = encoded.get();
+  }
+
+  unique_ptr<RecordPageHandler> record_page_handler(create_page_handler());
 
-  ret = record_page_handler.recover_init(*disk_buffer_pool_, rid.page_num);
+  ret = record_page_handler->recover_init(*disk_buffer_pool_, rid.page_num);
   if (ret != RC::SUCCESS) {
     LOG_WARN("failed to init record page handler. page num=%d, rc=%s", rid.page_num, strrc(ret));
     return ret;
   }
 
-  return record_page_handler.recover_insert_record(data, rid);
+  ret = record_page_handler->recover_insert_record(data, data_len, rid);
+  if (OB_SUCC(ret) && free_space_map_.is_open()) {
+    // 空闲空间映射不记录日志，恢复时顺便修正一下
+    ret = free_space_map_.set_page_free(rid.page_num, !record_page_handler->is_full());
+    if (OB_FAIL(ret)) {
+      LOG_WARN("failed to update free space map. page num=%d, rc=%s", rid.page_num, strrc(ret));
+    }
+  }
+  return ret;
 }
 
 RC RecordFileHandler::delete_record(const RID *rid)
 {
   RC rc = RC::SUCCESS;
 
-  RecordPageHandler page_handler;
-  if ((rc = page_handler.init(*disk_buffer_pool_, rid->page_num, false /*readonly*/)) != RC::SUCCESS) {
+  unique_ptr<RecordPageHandler> page_handler(create_page_handler());
+  if ((rc = page_handler->init(*disk_buffer_pool_, rid->page_num, false /*readonly*/)) != RC::SUCCESS) {
     LOG_ERROR("Failed to init record page handler.page number=%d. rc=%s", rid->page_num, strrc(rc));
     return rc;
   }
 
-  rc = page_handler.delete_record(rid);
+  rc = page_handler->delete_record(rid);
   // 📢 这里注意要清理掉资源，否则会与insert_record中的加锁顺序冲突而可能出现死锁
   // delete record的加锁逻辑是拿到页面锁，删除指定记录，然后加上和释放record manager锁
   // insert record是加上 record manager锁，然后拿到指定页面锁再释放record manager锁
-  page_handler.cleanup();
+  page_handler->cleanup();
   if (OB_SUCC(rc)) {
     // 因为这里已经释放了页面锁，并发时，其它线程可能又把该页面填满了，那就不应该再放入 free_pages_
     // 中。但是这里可以不关心，因为在查找空闲页面时，会自动过滤掉已经满的页面
-    lock_.lock();
-    free_pages_.insert(rid->page_num);
-    LOG_TRACE("add free page %d to free page list", rid->page_num);
-    lock_.unlock();
+    rc = add_free_page(rid->page_num);
   }
   return rc;
 }
 
+RC RecordFileHandler::compress()
+{
+  if (nullptr == table_meta_ || table_meta_->storage_format() != StorageFormat::COMPRESSED_FORMAT) {
+    LOG_WARN("table is not in compressed format, cannot compress pages.");
+    return RC::INVALID_ARGUMENT;
+  }
+  storage_format_ = StorageFormat::COMPRESSED_FORMAT;
+
+  BufferPoolIterator bp_iterator;
+  bp_iterator.init(*disk_buffer_pool_);
+  bp_iterator.set_read_ahead(true);
+
+  CompressedRecordPageHandler page_handler(table_meta_);
+
+  RC      rc               = RC::SUCCESS;
+  int     page_count       = 0;
+  int     compressed_count = 0;
+  int64_t raw_size         = 0;
+  int64_t used_size        = 0;
+  while (bp_iterator.has_next()) {
+    const PageNum page_num = bp_iterator.next();
+
+    rc = page_handler.init(*disk_buffer_pool_, page_num, false /*readonly*/);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to init record page handler. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    if (!page_handler.is_record_page()) {
+      page_handler.cleanup();
+      continue;
+    }
+
+    page_count++;
+    rc = page_handler.compress();
+    if (OB_SUCC(rc)) {
+      compressed_count++;
+    } else if (rc != RC::RECORD_NOMEM) {
+      LOG_WARN("failed to compress page. page num=%d, rc=%s", page_num, strrc(rc));
+      page_handler.cleanup();
+      return rc;
+    }
+
+    int64_t page_raw_size  = 0;
+    int64_t page_used_size = 0;
+    page_handler.space_usage(page_raw_size, page_used_size);
+    raw_size += page_raw_size;
+    used_size += page_used_size;
+
+    const bool full = page_handler.is_full();
+    page_handler.cleanup();
+    if (!full && OB_FAIL(rc = add_free_page(page_num))) {
+      LOG_WARN("failed to add free page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+  }
+
+  LOG_INFO("compress record file done. pages=%d, compressed pages=%d, raw size=%ld, used size=%ld, ratio=%.2f",
+           page_count, compressed_count, raw_size, used_size,
+           used_size > 0 ? static_cast<double>(raw_size) / used_size : 0.0);
+  return RC::SUCCESS;
+}
+
 RC RecordFileHandler::get_record(RecordPageHandler &page_handler, const RID *rid, bool readonly, Record *rec)
 {
   if (nullptr == rid || nullptr == rec) {
@@ -466,27 +906,109 @@ RC RecordFileHandler::get_record(RecordPageHandler &page_handler, const RID *rid
     return ret;
   }
 
-  return page_handler.get_record(rid, rec);
+  ret = page_handler.get_record(rid, rec);
+  if (OB_SUCC(ret) && storage_format_ == StorageFormat::SLOTTED_FORMAT) {
+    ret = codec_.decode(*rec);
+  }
+  return ret;
+}
+
+RC RecordFileHandler::delete_records(PageNum page_num, const vector<SlotNum> &slot_nums)
+{
+  unique_ptr<RecordPageHandler> page_handler(create_page_handler());
+
+  RC rc = page_handler->init(*disk_buffer_pool_, page_num, false /*readonly*/);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init record page handler.page number=%d. rc=%s", page_num, strrc(rc));
+    return rc;
+  }
+
+  for (SlotNum slot_num : slot_nums) {
+    RID rid(page_num, slot_num);
+    rc = page_handler->delete_record(&rid);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to delete record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+      break;
+    }
+  }
+
+  // 与 delete_record 一样，先释放页面锁再修改空闲页面信息
+  page_handler->cleanup();
+  if (OB_SUCC(rc) && !slot_nums.empty()) {
+    rc = add_free_page(page_num);
+  }
+  return rc;
 }
 
 RC RecordFileHandler::visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor)
 {
-  RecordPageHandler page_handler;
+  unique_ptr<RecordPageHandler> page_handler(create_page_handler());
 
-  RC rc = page_handler.init(*disk_buffer_pool_, rid.page_num, readonly);
+  RC rc = page_handler->init(*disk_buffer_pool_, rid.page_num, readonly);
   if (OB_FAIL(rc)) {
     LOG_ERROR("Failed to init record page handler.page number=%d", rid.page_num);
     return rc;
   }
 
+  return visit_record_in_page(*page_handler, rid, readonly, visitor);
+}
+
+RC RecordFileHandler::visit_records(
+    PageNum page_num, const vector<SlotNum> &slot_nums, bool readonly, std::function<void(Record &)> visitor)
+{
+  unique_ptr<RecordPageHandler> page_handler(create_page_handler());
+
+  RC rc = page_handler->init(*disk_buffer_pool_, page_num, readonly);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init record page handler.page number=%d", page_num);
+    return rc;
+  }
+
+  for (SlotNum slot_num : slot_nums) {
+    rc = visit_record_in_page(*page_handler, RID(page_num, slot_num), readonly, visitor);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC RecordFileHandler::visit_record_in_page(
+    RecordPageHandler &page_handler, const RID &rid, bool readonly, const std::function<void(Record &)> &visitor)
+{
   Record record;
-  rc = page_handler.get_record(&rid, &record);
+  RC     rc = page_handler.get_record(&rid, &record);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to get record from record page handle. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
     return rc;
   }
 
+  if (storage_format_ == StorageFormat::FIXED_FORMAT) {
+    visitor(record);
+    return rc;
+  }
+
+  // 其它格式访问的是解码或者拼装出来的副本，修改之后要写回页面
+  if (storage_format_ == StorageFormat::SLOTTED_FORMAT && OB_FAIL(rc = codec_.decode(record))) {
+    LOG_WARN("failed to decode record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
   visitor(record);
+  if (readonly) {
+    return rc;
+  }
+
+  if (storage_format_ == StorageFormat::SLOTTED_FORMAT) {
+    unique_ptr<char[]> encoded(new char[codec_.max_encoded_size()]);
+    const int          data_len = codec_.encode(record.data(), encoded.get());
+    rc                          = page_handler.update_record(rid, encoded.get(), data_len);
+  } else {
+    rc = page_handler.update_record(rid, record.data(), record.len());
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to update record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+  }
   return rc;
 }
 
@@ -504,11 +1026,27 @@ RC RecordFileScanner::open_scan(
   trx_              = trx;
   readonly_         = readonly;
 
-  RC rc = bp_iterator_.init(buffer_pool);
+  storage_format_ = table->table_meta().storage_format();
+  record_page_handler_.reset(RecordPageHandler::create(storage_format_, &table->table_meta()));
+  record_page_iterator_ = RecordPageIterator();
+  RC rc = RC::SUCCESS;
+  if (storage_format_ == StorageFormat::SLOTTED_FORMAT) {
+    if (OB_FAIL(rc = codec_.init(table->table_meta()))) {
+      LOG_WARN("failed to init record codec. table=%s, rc=%s", table->name(), strrc(rc));
+      return rc;
+    }
+    record_buffer_.reset(new char[codec_.record_size()]);
+  }
+  advance_pending_ = false;
+  fetch_rc_        = RC::SUCCESS;
+
+  rc = bp_iterator_.init(buffer_pool);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to init bp iterator. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
+  // 全表扫描是顺序访问所有页面的，提前把后面的页面读上来
+  bp_iterator_.set_read_ahead(true);
   condition_filter_ = condition_filter;
 
   rc = fetch_next_record();
@@ -541,14 +1079,18 @@ RC RecordFileScanner::fetch_next_record()
   // 上个页面遍历完了，或者还没有开始遍历某个页面，那么就从一个新的页面开始遍历查找
   while (bp_iterator_.has_next()) {
     PageNum page_num = bp_iterator_.next();
-    record_page_handler_.cleanup();
-    rc = record_page_handler_.init(*disk_buffer_pool_, page_num, readonly_);
+    record_page_handler_->cleanup();
+    rc = record_page_handler_->init(*disk_buffer_pool_, page_num, readonly_);
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
 
-    record_page_iterator_.init(record_page_handler_);
+    if (!record_page_handler_->is_record_page()) {
+      continue;
+    }
+
+    record_page_iterator_.init(*record_page_handler_);
     rc = fetch_next_record_in_page();
     if (rc == RC::SUCCESS || rc != RC::RECORD_EOF) {
       // 有有效记录：RC::SUCCESS
@@ -560,7 +1102,7 @@ RC RecordFileScanner::fetch_next_record()
 
   // 所有的页面都遍历完了，没有数据了
   next_record_.rid().slot_num = -1;
-  record_page_handler_.cleanup();
+  record_page_handler_->cleanup();
   return RC::RECORD_EOF;
 }
 
@@ -573,11 +1115,21 @@ RC RecordFileScanner::fetch_next_record_in_page()
   while (record_page_iterator_.has_next()) {
     rc = record_page_iterator_.next(next_record_);
     if (rc != RC::SUCCESS) {
-      const auto page_num = record_page_handler_.get_page_num();
+      const auto page_num = record_page_handler_->get_page_num();
       LOG_TRACE("failed to get next record from page. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
 
+    if (storage_format_ == StorageFormat::SLOTTED_FORMAT) {
+      // 解码到扫描器自己的缓存中，每条记录都复用同一块内存
+      rc = codec_.decode(next_record_.data(), next_record_.len(), record_buffer_.get());
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to decode record. rid=%s, rc=%s", next_record_.rid().to_string().c_str(), strrc(rc));
+        return rc;
+      }
+      next_record_.set_data(record_buffer_.get(), codec_.record_size());
+    }
+
     // 如果有过滤条件，就用过滤条件过滤一下
     if (condition_filter_ != nullptr && !condition_filter_->filter(next_record_)) {
       continue;
@@ -612,20 +1164,100 @@ RC RecordFileScanner::close_scan()
     condition_filter_ = nullptr;
   }
 
-  record_page_handler_.cleanup();
+  if (record_page_handler_ != nullptr) {
+    record_page_handler_->cleanup();
+  }
 
+  advance_pending_ = false;
+  column_pending_  = false;
   return RC::SUCCESS;
 }
 
-bool RecordFileScanner::has_next() { return next_record_.rid().slot_num != -1; }
+bool RecordFileScanner::has_next()
+{
+  if (advance_pending_) {
+    // 上一条记录已经不再使用了，现在才移动到下一条记录，上一条记录所在的页面也在这时才释放
+    advance_pending_ = false;
+
+    RC rc = fetch_next_record();
+    if (OB_FAIL(rc) && rc != RC::RECORD_EOF) {
+      // 出错时返回 true，让调用者通过 next 拿到错误码
+      fetch_rc_ = rc;
+      return true;
+    }
+  }
+  return next_record_.rid().slot_num != -1;
+}
 
-RC RecordFileScanner::next(Record &record)
+RC RecordFileScanner::next_column(int column_index, ColumnChunk &chunk)
 {
-  record = next_record_;
+  if (column_pending_) {
+    // 上一个页面的数据已经用完了，现在才移动到下一个页面
+    column_pending_       = false;
+    record_page_iterator_ = RecordPageIterator();
+    RC rc                 = fetch_next_record();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
 
-  RC rc = fetch_next_record();
-  if (rc == RC::RECORD_EOF) {
-    rc = RC::SUCCESS;
+  if (!has_next()) {
+    return RC::RECORD_EOF;
+  }
+
+  if (OB_FAIL(fetch_rc_)) {
+    RC rc     = fetch_rc_;
+    fetch_rc_ = RC::SUCCESS;
+    return rc;
+  }
+
+  RC rc = record_page_handler_->get_column(column_index, chunk);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  column_pending_ = true;
+  return RC::SUCCESS;
+}
+
+RC RecordFileScanner::get_column_record(SlotNum slot_num, Record &record)
+{
+  if (!column_pending_) {
+    LOG_WARN("no page returned by next_column. slot_num=%d", slot_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  RID rid(record_page_handler_->get_page_num(), slot_num);
+  RC  rc = record_page_handler_->get_record(&rid, &record);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get record from page. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  if (condition_filter_ != nullptr && !condition_filter_->filter(record)) {
+    return RC::RECORD_INVISIBLE;
+  }
+
+  if (trx_ != nullptr) {
+    rc = trx_->visit_record(table_, record, readonly_);
   }
   return rc;
 }
+
+RC RecordFileScanner::next(Record &record)
+{
+  if (!has_next()) {
+    return RC::RECORD_EOF;
+  }
+
+  if (OB_FAIL(fetch_rc_)) {
+    RC rc     = fetch_rc_;
+    fetch_rc_ = RC::SUCCESS;
+    return rc;
+  }
+
+  // 不复制数据。记录指向页面或者扫描器的缓存，下一次调用 has_next 或 next 之前都是有效的
+  record           = std::move(next_record_);
+  advance_pending_ = true;
+  return RC::SUCCESS;
+}
@@ -15,14 +15,22 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "common/lang/bitmap.h"
+#include "common/types.h"
 #include "storage/buffer/disk_buffer_pool.h"
+#include "storage/record/free_page_pool.h"
+#include "storage/record/free_space_map.h"
 #include "storage/record/record.h"
+#include "storage/record/record_codec.h"
 #include "storage/trx/latch_memo.h"
+#include <atomic>
 #include <limits>
+#include <memory>
 #include <sstream>
+#include <vector>
 
 class ConditionFilter;
 class RecordPageHandler;
+class TableMeta;
 class Trx;
 class Table;
 
@@ -36,6 +44,7 @@ class Table;
  * 每个页面的分配状态等。所以第一个页面对RecordManager来说没有作用。RecordManager 本身没有再单独拿一个页面
  * 来存放元数据，每一个页面都存放了一个页面头信息，也就是每个页面都有 RecordManager 的元数据信息，可以参考
  * PageHeader，这虽然有点浪费但是做起来简单。
+ * 另外，从第二个页面开始有几个页面用来记录哪些页面还有空闲位置，参考 FreeSpaceMap，遍历记录时需要跳过这些页面。
  *
  * 对单个页面来说，最开始是一个页头，然后接着就是一行行记录（会对齐）。
  * 如何标识一个记录，或者定位一个记录？
@@ -45,9 +54,11 @@ class Table;
  * 问题2：如何更有效地存放不定长数据呢？
  * 问题3：如果一个页面不能存放一个记录，那么怎么组织记录存放效果更好呢？
  *
+ * 问题1和问题2可以参考 SlottedRecordPageHandler，表可以在创建时选择使用变长记录的格式(StorageFormat)。
+ *
  * 按照上面的描述，这里提供了几个类，分别是：
  * - RecordFileHandler：管理整个文件/表的记录增删改查
- * - RecordPageHandler：管理单个页面上记录的增删改查
+ * - RecordPageHandler：管理单个页面上记录的增删改查，不同的存储格式有不同的实现
  * - RecordFileScanner：可以用来遍历整个文件上的所有记录
  * - RecordPageIterator：可以用来遍历指定页面上的所有记录
  * - PageHeader：每个页面上都会记录的页面头信息
@@ -69,6 +80,23 @@ struct PageHeader
   int32_t first_record_offset;  ///< 第一条记录的偏移量
 };
 
+/**
+ * @brief 某个页面上一列的数据
+ * @ingroup RecordManager
+ * @details 只包含有记录的槽位，值按照槽位顺序连续存放，可以当作一个定长的数组做向量化的计算。
+ * 数据是从页面上复制出来的，不需要拿着页面锁。
+ */
+struct ColumnChunk
+{
+  PageNum              page_num  = BP_INVALID_PAGE_NUM;  ///< 数据来自哪个页面
+  int                  value_len = 0;                    ///< 每个值的长度
+  std::vector<char>    data;                             ///< 所有值连续存放，长度是 value_len * slots.size()
+  std::vector<SlotNum> slots;                            ///< 每个值所在的槽位，与 page_num 组成 RID
+
+  int count() const { return static_cast<int>(slots.size()); }
+  const char *value(int index) const { return data.data() + static_cast<size_t>(index) * value_len; }
+};
+
 /**
  * @brief 遍历一个页面中每条记录的iterator
  * @ingroup RecordManager
@@ -107,25 +135,28 @@ public:
 private:
   RecordPageHandler *record_page_handler_ = nullptr;
   PageNum            page_num_            = BP_INVALID_PAGE_NUM;
-  common::Bitmap     bitmap_;             ///< bitmap 的相关信息可以参考 RecordPageHandler 的说明
-  SlotNum            next_slot_num_ = 0;  ///< 当前遍历到了哪一个slot
+  SlotNum            next_slot_num_       = 0;  ///< 当前遍历到了哪一个slot
 };
 
 /**
  * @brief 负责处理一个页面中各种操作，比如插入记录、删除记录或者查找记录
  * @ingroup RecordManager
- * @details 当前定长记录模式下每个页面的组织大概是这样的：
- * @code
- * | PageHeader | record allocate bitmap |
- * |------------|------------------------|
- * | record1 | record2 | ..... | recordN |
- * @endcode
+ * @details 这里只处理页面的获取和加锁，页面上的记录怎么组织由子类负责，每种 StorageFormat 对应一个子类：
+ * - FixedRecordPageHandler 定长记录
+ * - SlottedRecordPageHandler 变长记录
+ * - PaxRecordPageHandler 定长记录按列存放
  */
 class RecordPageHandler
 {
 public:
   RecordPageHandler() = default;
-  ~RecordPageHandler();
+  virtual ~RecordPageHandler();
+
+  /**
+   * @brief 创建指定存储格式的页面处理对象
+   * @param table_meta 表的元数据。压缩格式把定长页面转换成压缩页面时需要知道字段的类型，只读访问时可以为空
+   */
+  static RecordPageHandler *create(StorageFormat format, const TableMeta *table_meta = nullptr);
 
   /**
    * @brief 初始化
@@ -145,13 +176,15 @@ public:
   RC recover_init(DiskBufferPool &buffer_pool, PageNum page_num);
 
   /**
-   * @brief 对一个新的页面做初始化，初始化关于该页面记录信息的页头PageHeader
+   * @brief 对一个新的页面做初始化，初始化关于该页面记录信息的页头
    *
    * @param buffer_pool 关联某个文件时，都通过buffer pool来做读写文件
    * @param page_num    当前处理哪个页面
-   * @param record_size 每个记录的大小
+   * @param record_size 每个记录的大小。变长记录不关心这个参数
+   * @param table_meta  表的元数据。按列存放的页面需要知道每一列的位置和长度
    */
-  RC init_empty_page(DiskBufferPool &buffer_pool, PageNum page_num, int record_size);
+  virtual RC init_empty_page(
+      DiskBufferPool &buffer_pool, PageNum page_num, int record_size, const TableMeta *table_meta) = 0;
 
   /**
    * @brief 操作结束后做的清理工作，比如释放页面、解锁
@@ -161,33 +194,59 @@ public:
   /**
    * @brief 插入一条记录
    *
-   * @param data 要插入的记录
-   * @param rid  如果插入成功，通过这个参数返回插入的位置
+   * @param data     要插入的记录
+   * @param data_len 记录的长度。定长记录的长度就是初始化页面时指定的大小
+   * @param rid      如果插入成功，通过这个参数返回插入的位置
+   * @return 页面上放不下这条记录时返回 RC::RECORD_NOMEM
    */
-  RC insert_record(const char *data, RID *rid);
+  virtual RC insert_record(const char *data, int data_len, RID *rid) = 0;
 
   /**
    * @brief 数据库恢复时，在指定位置插入数据
    *
-   * @param data 要插入的数据行
-   * @param rid  插入的位置
+   * @param data     要插入的数据行
+   * @param data_len 数据的长度
+   * @param rid      插入的位置
    */
-  RC recover_insert_record(const char *data, const RID &rid);
+  virtual RC recover_insert_record(const char *data, int data_len, const RID &rid) = 0;
 
   /**
    * @brief 删除指定的记录
    *
    * @param rid 要删除的记录标识
    */
-  RC delete_record(const RID *rid);
+  virtual RC delete_record(const RID *rid) = 0;
+
+  /**
+   * @brief 使用新的数据替换指定的记录，记录的位置不变
+   *
+   * @param rid      要修改的记录
+   * @param data     新的数据
+   * @param data_len 新数据的长度
+   */
+  virtual RC update_record(const RID &rid, const char *data, int data_len) = 0;
 
   /**
    * @brief 获取指定位置的记录数据
    *
    * @param rid 指定的位置
-   * @param rec 返回指定的数据。这里不会将数据复制出来，而是使用指针，所以调用者必须保证数据使用期间受到保护
+   * @param rec 返回指定的数据。数据在当前页面中时不会复制出来，而是使用指针，所以调用者必须保证数据使用期间受到保护
+   */
+  virtual RC get_record(const RID *rid, Record *rec) = 0;
+
+  /**
+   * @brief 从 start_slot_num 开始(包括)找到下一个有记录的槽位
+   * @return 没有记录时返回 -1
+   */
+  virtual SlotNum next_record_slot(SlotNum start_slot_num) const = 0;
+
+  /**
+   * @brief 读取当前页面上某一列的所有数据
+   * @details 只有按列存放的页面支持，其它格式返回 RC::UNIMPLENMENT
+   * @param column_index 第几列，与 TableMeta 中字段的下标一致
+   * @param chunk        返回列数据
    */
-  RC get_record(const RID *rid, Record *rec);
+  virtual RC get_column(int column_index, ColumnChunk &chunk);
 
   /**
    * @brief 返回该记录页的页号
@@ -197,9 +256,56 @@ public:
   /**
    * @brief 当前页面是否已经没有空闲位置插入新的记录
    */
-  bool is_full() const;
+  virtual bool is_full() const = 0;
+
+  /**
+   * @brief 当前页面是否是记录页。数据文件中还有空闲空间映射页和溢出页，它们不存放记录
+   */
+  bool is_record_page() const;
+
+protected:
+  /**
+   * @brief 页面加载到内存之后，设置页面格式相关的指针，比如页头
+   */
+  virtual void init_page_layout() = 0;
+
+protected:
+  DiskBufferPool *disk_buffer_pool_ = nullptr;  ///< 当前操作的buffer pool(文件)
+  Frame *frame_    = nullptr;  ///< 当前操作页面关联的frame(frame的更多概念可以参考buffer pool和frame)
+  bool   readonly_ = false;    ///< 当前的操作是否都是只读的
+};
+
+/**
+ * @brief 定长记录的页面
+ * @ingroup RecordManager
+ * @details 当前定长记录模式下每个页面的组织大概是这样的：
+ * @code
+ * | PageHeader | record allocate bitmap |
+ * |------------|------------------------|
+ * | record1 | record2 | ..... | recordN |
+ * @endcode
+ */
+class FixedRecordPageHandler : public RecordPageHandler
+{
+public:
+  FixedRecordPageHandler()          = default;
+  virtual ~FixedRecordPageHandler() = default;
+
+  RC init_empty_page(
+      DiskBufferPool &buffer_pool, PageNum page_num, int record_size, const TableMeta *table_meta) override;
+
+  RC insert_record(const char *data, int data_len, RID *rid) override;
+  RC recover_insert_record(const char *data, int data_len, const RID &rid) override;
+  RC delete_record(const RID *rid) override;
+  RC update_record(const RID &rid, const char *data, int data_len) override;
+  RC get_record(const RID *rid, Record *rec) override;
+
+  SlotNum next_record_slot(SlotNum start_slot_num) const override;
+  bool    is_full() const override;
 
 protected:
+  void init_page_layout() override;
+
   /**
    * @details
    * 前面在计算record_capacity时并没有考虑对齐，但第一个record需要8字节对齐
@@ -227,20 +333,18 @@ protected:
   }
 
 protected:
-  DiskBufferPool *disk_buffer_pool_ = nullptr;  ///< 当前操作的buffer pool(文件)
-  Frame *frame_ = nullptr;  ///< 当前操作页面关联的frame(frame的更多概念可以参考buffer pool和frame)
-  bool   readonly_         = false;    ///< 当前的操作是否都是只读的
   PageHeader *page_header_ = nullptr;  ///< 当前页面上页面头
   char       *bitmap_      = nullptr;  ///< 当前页面上record分配状态信息bitmap内存起始位置
-
-private:
-  friend class RecordPageIterator;
 };
 
 /**
  * @brief 管理整个文件中记录的增删改查
  * @ingroup RecordManager
  * @details 整个文件的组织格式请参考该文件中最前面的注释
+ *
+ * 有空闲空间映射时，插入记录的线程各自有一个当前插入的页面(insert slot)，不同的线程向不同的页面插入，
+ * 不会都去抢同一个页面的锁。当前页面满了之后从无锁的空闲页面池中领取一个新的页面；
+ * 池子空了再从空闲空间映射中找一批有空闲位置的页面，还找不到的话一次分配一批(EXTENT_PAGES个)新页面。
  */
 class RecordFileHandler
 {
@@ -252,8 +356,9 @@ public:
    * @brief 初始化
    *
    * @param buffer_pool 当前操作的是哪个文件
+   * @param table_meta  表的元数据，决定记录的存储格式。为空时使用定长记录
    */
-  RC init(DiskBufferPool *buffer_pool);
+  RC init(DiskBufferPool *buffer_pool, const TableMeta *table_meta = nullptr);
 
   /**
    * @brief 关闭，做一些资源清理的工作
@@ -299,6 +404,7 @@ public:
 
   /**
    * @brief 与get_record类似，访问某个记录，并提供回调函数来操作相应的记录
+   * @details 变长记录访问的是解码之后的数据，如果不是只读的，回调结束之后会重新编码写回页面
    *
    * @param rid 想要访问的记录ID
    * @param readonly 是否会修改记录
@@ -306,15 +412,154 @@ public:
    */
   RC visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor);
 
+  /**
+   * @brief 删除同一个页面上的一批记录，整个过程只加一次页面锁
+   *
+   * @param page_num  记录所在的页面
+   * @param slot_nums 要删除的记录的槽位
+   */
+  RC delete_records(PageNum page_num, const std::vector<SlotNum> &slot_nums);
+
+  /**
+   * @brief 与visit_record类似，访问同一个页面上的一批记录，整个过程只加一次页面锁
+   * @details 可以用来按页面批量修改记录
+   *
+   * @param page_num  记录所在的页面
+   * @param slot_nums 要访问的记录的槽位
+   * @param readonly  是否会修改记录
+   * @param visitor   访问记录的回调函数，每条记录调用一次
+   */
+  RC visit_records(PageNum page_num, const std::vector<SlotNum> &slot_nums, bool readonly,
+      std::function<void(Record &)> visitor);
+
+  StorageFormat storage_format() const { return storage_format_; }
+
+  /**
+   * @brief 创建一个与当前文件存储格式一致的页面处理对象
+   */
+  RecordPageHandler *create_page_handler() const { return RecordPageHandler::create(storage_format_, table_meta_); }
+
+  /**
+   * @brief 把表切换成压缩格式之后，压缩文件中所有的记录页面
+   * @details ALTER TABLE ... COMPRESS 时使用，调用者保证这时没有其它的并发访问
+   */
+  RC compress();
+
 private:
+  /**
+   * @brief 在已经拿到页面锁的 page_handler 上访问一条记录，参考 visit_record
+   */
+  RC visit_record_in_page(RecordPageHandler &page_handler, const RID &rid, bool readonly,
+      const std::function<void(Record &)> &visitor);
+
   /**
    * @brief 初始化当前没有填满记录的页面，初始化free_pages_成员
+   * @details 只有没有空闲空间映射的旧文件才需要，会访问所有的页面
    */
   RC init_free_pages();
 
+  /**
+   * @brief 没有空闲空间映射时，找到一个没有填满的页面，找不到就分配一个新的页面
+   * @details 返回成功时 record_page_handler 拿着该页面的写锁
+   */
+  RC find_free_page(RecordPageHandler &record_page_handler, int record_size);
+
+  /**
+   * @brief 获取当前线程插入记录的页面，返回成功时 record_page_handler 拿着该页面的写锁
+   * @param new_page 不管当前的插入页面，直接分配一批新页面并使用其中的第一个
+   */
+  RC claim_insert_page(RecordPageHandler &record_page_handler, int record_size, bool new_page);
+
+  /**
+   * @brief 页面已经满了，清除空闲标记，并且不再作为当前线程插入记录的页面
+   */
+  RC release_insert_page(PageNum page_num);
+
+  /**
+   * @brief 页面上放不下要插入的这条记录，但是还能放下更短的记录
+   * @details 不清除空闲标记，只是不再作为当前线程插入记录的页面，以后补充空闲页面池时还能找到它
+   */
+  void skip_insert_page(PageNum page_num);
+
+  /**
+   * @brief 从空闲页面池中领取一个页面，池子空了就先补充
+   */
+  RC take_free_page(PageNum &page_num, int record_size);
+
+  /**
+   * @brief 把页面放到空闲页面池中
+   * @details 已经在池子中或者被某个 slot 领取了的页面不会再放入，否则同一个页面会被多个线程同时当作插入页面
+   * @return 是否放进去了
+   */
+  bool queue_free_page(PageNum page_num);
+
+  /**
+   * @brief 页面不在池子中也不再被 slot 领取，参考 queue_free_page
+   */
+  void unqueue_free_page(PageNum page_num);
+
+  /**
+   * @brief 领取到的页面用不上了，还给空闲页面池，池子满了就丢掉
+   */
+  void return_free_page(PageNum page_num);
+
+  /**
+   * @brief 从空闲空间映射中找一批页面放到空闲页面池中，找不到时分配新的页面
+   */
+  RC refill_free_page_pool(int record_size);
+
+  /**
+   * @brief 一次分配 EXTENT_PAGES 个新的记录页，放到空闲页面池中
+   * @param[out] claimed_page 不为空时，第一个页面不放到池子中，直接交给调用者
+   */
+  RC allocate_extent(int record_size, PageNum *claimed_page = nullptr);
+
+  /**
+   * @brief 记录某个页面还有空闲位置
+   */
+  RC add_free_page(PageNum page_num);
+
+  /**
+   * @brief 页面上放不下要插入的记录，以后不再从这个页面插入，直到页面上又删除了记录
+   */
+  RC mark_page_full(PageNum page_num);
+
+  /**
+   * @brief 当前线程使用哪个 insert slot
+   */
+  static int current_insert_slot();
+
 private:
-  DiskBufferPool             *disk_buffer_pool_ = nullptr;
-  std::unordered_set<PageNum> free_pages_;  ///< 没有填充满的页面集合
+  static constexpr int INSERT_SLOT_NUM = 32;  ///< 最多同时有多少个线程向不同的页面插入
+  static constexpr int EXTENT_PAGES    = 8;   ///< 没有空闲页面时一次分配多少个页面
+  static constexpr int REFILL_PAGES    = 64;  ///< 一次从空闲空间映射中最多取出多少个页面
+  static constexpr int MAX_SKIP_PAGES  = 8;   ///< 连续几个页面都放不下一条记录时，直接使用新页面
+
+  /**
+   * @brief 某些线程当前插入记录的页面。按照缓存行对齐，避免不同线程之间的伪共享
+   */
+  struct alignas(64) InsertSlot
+  {
+    std::atomic<PageNum> page_num{BP_INVALID_PAGE_NUM};
+  };
+
+  DiskBufferPool   *disk_buffer_pool_ = nullptr;
+  FreeSpaceMap      free_space_map_;  ///< 持久化的空闲空间映射，旧文件没有
+  const TableMeta  *table_meta_     = nullptr;
+  StorageFormat     storage_format_ = StorageFormat::FIXED_FORMAT;
+  VarlenRecordCodec codec_;  ///< 变长记录格式使用
+
+  InsertSlot    insert_slots_[INSERT_SLOT_NUM];
+  FreePagePool  free_page_pool_;     ///< 有空闲位置、还没有被线程领取的页面
+  common::Mutex refill_lock_;        ///< 同一时刻只有一个线程补充空闲页面池
+  PageNum       refill_cursor_ = 0;  ///< 下次从哪个页面开始在空闲空间映射中查找，受 refill_lock_ 保护
+
+  /// 在空闲页面池中或者被某个 slot 领取了的页面。空闲空间映射只说明页面有没有空闲位置，
+  /// 补充空闲页面池时要靠它跳过这些页面，参考 queue_free_page
+  std::unordered_set<PageNum> queued_pages_;
+  common::Mutex               queued_lock_;
+
+  std::unordered_set<PageNum> free_pages_;  ///< 没有空闲空间映射时，在内存中记录没有填充满的页面集合
   common::Mutex               lock_;  ///< 当编译时增加-DCONCURRENCY=ON 选项时，才会真正的支持并发
 };
 
@@ -322,6 +567,9 @@ private:
  * @brief 遍历某个文件中所有记录
  * @ingroup RecordManager
  * @details 遍历所有的页面，同时访问这些页面中所有的记录
+ *
+ * 返回的记录不会复制数据，而是直接指向页面(或者扫描器内部解码用的缓存)。扫描器一直 pin 住并锁住当前页面，
+ * 直到调用者再次调用 has_next 或 next 时才移动到下一条记录，所以记录在这之前都是有效的。
  */
 class RecordFileScanner
 {
@@ -356,10 +604,34 @@ public:
    *
    * @param record 返回的下一条记录
    *
-   * @details 获取下一条记录之前先调用has_next()判断是否还有数据
+   * @details 获取下一条记录之前先调用has_next()判断是否还有数据。
+   * 返回的记录只是一个视图，在下一次调用 has_next 或 next 之后就不能再访问了，需要保留的话要自己复制
    */
   RC next(Record &record);
 
+  /**
+   * @brief 读取下一个页面上某一列的所有数据，用于向量化的过滤
+   * @details 每次返回一个页面上指定列的所有值，下一次调用时才移动到下一个有记录的页面，在这之前可以通过
+   * get_column_record 取出这个页面上的完整记录。
+   * 这里不做条件过滤，也不判断事务可见性，调用方需要根据返回的槽位自己处理。
+   * 只有 PAX 格式的表支持，不要与 next 混用。
+   *
+   * @param column_index 第几列，与 TableMeta 中字段的下标一致
+   * @param chunk        返回列数据
+   * @return 没有数据时返回 RC::RECORD_EOF
+   */
+  RC next_column(int column_index, ColumnChunk &chunk);
+
+  /**
+   * @brief 取出 next_column 当前页面上某个槽位的完整记录
+   * @details 会使用扫描时的过滤条件和事务检查记录是否可见。返回的记录与 next 一样只是一个视图，
+   * 下一次调用 get_column_record 或 next_column 之后就不能再访问了
+   * @param slot_num 槽位，来自 ColumnChunk::slots
+   * @param record   返回的记录
+   * @return 记录被过滤掉或者对当前事务不可见时返回 RC::RECORD_INVISIBLE
+   */
+  RC get_column_record(SlotNum slot_num, Record &record);
+
 private:
   /**
    * @brief 获取该文件中的下一条记录
@@ -379,9 +651,15 @@ private:
   Trx            *trx_              = nullptr;  ///< 当前是哪个事务在遍历
   bool            readonly_         = false;    ///< 遍历出来的数据，是否可能对它做修改
 
-  BufferPoolIterator bp_iterator_;                 ///< 遍历buffer pool的所有页面
-  ConditionFilter   *condition_filter_ = nullptr;  ///< 过滤record
-  RecordPageHandler  record_page_handler_;         ///< 处理文件某页面的记录
-  RecordPageIterator record_page_iterator_;        ///< 遍历某个页面上的所有record
-  Record             next_record_;                 ///< 获取的记录放在这里缓存起来
+  BufferPoolIterator                 bp_iterator_;                 ///< 遍历buffer pool的所有页面
+  ConditionFilter                   *condition_filter_ = nullptr;  ///< 过滤record
+  std::unique_ptr<RecordPageHandler> record_page_handler_;         ///< 处理文件某页面的记录
+  RecordPageIterator                 record_page_iterator_;        ///< 遍历某个页面上的所有record
+  Record                             next_record_;                 ///< 获取的记录放在这里缓存起来
+  StorageFormat                      storage_format_ = StorageFormat::FIXED_FORMAT;
+  VarlenRecordCodec                  codec_;  ///< 变长记录格式使用，把页面上的数据解码成定长格式
+  std::unique_ptr<char[]>            record_buffer_;  ///< 变长记录解码之后放在这里，所有记录复用
+  bool                               advance_pending_ = false;  ///< 调用者拿走了 next_record_，还没有移动到下一条
+  bool                               column_pending_  = false;  ///< next_column 返回了当前页面，还没有移动到下一个页面
+  RC                                 fetch_rc_ = RC::SUCCESS;  ///< 移动到下一条记录时出现的错误，由 next 返回
 };
\ No newline at end of file
@@ -0,0 +1,443 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "storage/record/slotted_record_page_handler.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+static constexpr int SLOTTED_PAGE_HEADER_SIZE = sizeof(SlottedPageHeader);
+
+void SlottedRecordPageHandler::init_page_layout()
+{
+  char *data   = frame_->data();
+  page_header_ = reinterpret_cast<SlottedPageHeader *>(data);
+  slots_       = reinterpret_cast<RecordSlot *>(data + SLOTTED_PAGE_HEADER_SIZE);
+}
+
+RC SlottedRecordPageHandler::init_empty_page(
+    DiskBufferPool &buffer_pool, PageNum page_num, int /*record_size*/, const TableMeta * /*table_meta*/)
+{
+  RC rc = init(buffer_pool, page_num, false /*readonly*/);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page. page_num=%d, rc=%s", page_num, strrc(rc));
+    return rc;
+  }
+
+  page_header_->record_num   = 0;
+  page_header_->slot_num     = 0;
+  page_header_->data_offset  = BP_PAGE_DATA_SIZE;
+  page_header_->garbage_size = 0;
+
+  if (OB_FAIL(rc = buffer_pool.flush_page(*frame_))) {
+    LOG_ERROR("Failed to flush page header %d:%d.", buffer_pool.file_desc(), page_num);
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::insert_record(const char *data, int data_len, RID *rid)
+{
+  ASSERT(readonly_ == false, "cannot insert record into page while the page is readonly");
+
+  // 优先复用已经删除的槽位
+  SlotNum slot_num = 0;
+  while (slot_num < page_header_->slot_num && slots_[slot_num].offset != 0) {
+    slot_num++;
+  }
+
+  const bool new_slot = (slot_num == page_header_->slot_num);
+  const int  need     = inline_size(data_len) + (new_slot ? sizeof(RecordSlot) : 0);
+  if (!reserve_space(need)) {
+    LOG_TRACE("Page is full, page_num %d:%d, data len=%d.", disk_buffer_pool_->file_desc(), frame_->page_num(), data_len);
+    return RC::RECORD_NOMEM;
+  }
+
+  if (new_slot) {
+    memset(&slots_[slot_num], 0, sizeof(RecordSlot));
+    page_header_->slot_num++;
+  }
+
+  RC rc = write_record(slot_num, data, data_len);
+  if (OB_FAIL(rc)) {
+    if (new_slot) {
+      page_header_->slot_num--;
+    }
+    return rc;
+  }
+
+  page_header_->record_num++;
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = slot_num;
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::recover_insert_record(const char *data, int data_len, const RID &rid)
+{
+  if (page_header_->data_offset == 0) {
+    // 页面初始化之后还没有刷到磁盘上
+    page_header_->record_num   = 0;
+    page_header_->slot_num     = 0;
+    page_header_->data_offset  = BP_PAGE_DATA_SIZE;
+    page_header_->garbage_size = 0;
+  }
+
+  if (rid.slot_num < page_header_->slot_num && slots_[rid.slot_num].offset != 0) {
+    // 记录已经在页面上了，与定长记录一样使用日志中的数据覆盖
+    return update_record(rid, data, data_len);
+  }
+
+  const int new_slots = max(0, rid.slot_num + 1 - page_header_->slot_num);
+  if (!reserve_space(inline_size(data_len) + new_slots * sizeof(RecordSlot))) {
+    LOG_WARN("no space to recover record. rid=%s, data len=%d", rid.to_string().c_str(), data_len);
+    return RC::RECORD_NOMEM;
+  }
+
+  if (new_slots > 0) {
+    memset(&slots_[page_header_->slot_num], 0, new_slots * sizeof(RecordSlot));
+    page_header_->slot_num += new_slots;
+  }
+
+  RC rc = write_record(rid.slot_num, data, data_len);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  page_header_->record_num++;
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::delete_record(const RID *rid)
+{
+  ASSERT(readonly_ == false, "cannot delete record from page while the page is readonly");
+
+  RC rc = check_slot(rid->slot_num);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  RecordSlot &slot = slots_[rid->slot_num];
+  if (slot.overflow_page != BP_INVALID_PAGE_NUM) {
+    free_overflow(slot.overflow_page);
+  }
+
+  page_header_->garbage_size += slot.inline_len;
+  memset(&slot, 0, sizeof(slot));
+  page_header_->record_num--;
+
+  // 末尾的空槽位可以直接去掉
+  while (page_header_->slot_num > 0 && slots_[page_header_->slot_num - 1].offset == 0) {
+    page_header_->slot_num--;
+  }
+
+  if (page_header_->record_num == 0) {
+    page_header_->slot_num     = 0;
+    page_header_->data_offset  = BP_PAGE_DATA_SIZE;
+    page_header_->garbage_size = 0;
+  }
+
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::update_record(const RID &rid, const char *data, int data_len)
+{
+  ASSERT(readonly_ == false, "cannot update record in page while the page is readonly");
+
+  RC rc = check_slot(rid.slot_num);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  RecordSlot &slot       = slots_[rid.slot_num];
+  const int   inline_len = inline_size(data_len);
+  if (inline_len > slot.inline_len &&
+      contiguous_free_space() + page_header_->garbage_size + slot.inline_len < inline_len) {
+    // 变长之后当前页面放不下了。记录的位置不能变，只能报错
+    LOG_WARN("no space to update record. rid=%s, data len=%d", rid.to_string().c_str(), data_len);
+    return RC::RECORD_NOMEM;
+  }
+
+  // 先写好溢出的部分，失败时原来的记录保持不变
+  PageNum overflow_page = BP_INVALID_PAGE_NUM;
+  if (data_len > inline_len && OB_FAIL(rc = write_overflow(data + inline_len, data_len - inline_len, overflow_page))) {
+    return rc;
+  }
+
+  const PageNum old_overflow_page = slot.overflow_page;
+  if (inline_len <= slot.inline_len) {
+    // 原地覆盖，多出来的部分变成空洞
+    memmove(frame_->data() + slot.offset, data, inline_len);
+    page_header_->garbage_size += slot.inline_len - inline_len;
+    slot.inline_len = static_cast<uint16_t>(inline_len);
+  } else {
+    // 放弃原来的位置，重新分配。前面已经检查过，空间一定是够的
+    page_header_->garbage_size += slot.inline_len;
+    slot.offset     = 0;
+    slot.inline_len = 0;
+    reserve_space(inline_len);
+    write_inline(slot, data, inline_len);
+  }
+  slot.overflow_page = overflow_page;
+  slot.overflow_len  = data_len - inline_len;
+  frame_->mark_dirty();
+
+  if (old_overflow_page != BP_INVALID_PAGE_NUM) {
+    free_overflow(old_overflow_page);
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::get_record(const RID *rid, Record *rec)
+{
+  RC rc = check_slot(rid->slot_num);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const RecordSlot &slot = slots_[rid->slot_num];
+  rec->set_rid(*rid);
+  if (slot.overflow_page == BP_INVALID_PAGE_NUM) {
+    rec->set_data(frame_->data() + slot.offset, slot.inline_len);
+    return RC::SUCCESS;
+  }
+
+  const int len  = slot.inline_len + slot.overflow_len;
+  char     *data = static_cast<char *>(malloc(len));
+  if (nullptr == data) {
+    LOG_WARN("failed to allocate memory for record. size=%d", len);
+    return RC::NOMEM;
+  }
+
+  memcpy(data, frame_->data() + slot.offset, slot.inline_len);
+  rc = read_overflow(slot.overflow_page, data + slot.inline_len, slot.overflow_len);
+  if (OB_FAIL(rc)) {
+    free(data);
+    return rc;
+  }
+
+  rec->set_data_owner(data, len);
+  return RC::SUCCESS;
+}
+
+SlotNum SlottedRecordPageHandler::next_record_slot(SlotNum start_slot_num) const
+{
+  for (SlotNum slot_num = start_slot_num; slot_num < page_header_->slot_num; slot_num++) {
+    if (slots_[slot_num].offset != 0) {
+      return slot_num;
+    }
+  }
+  return -1;
+}
+
+bool SlottedRecordPageHandler::is_full() const
+{
+  return contiguous_free_space() + page_header_->garbage_size < SLOTTED_MIN_FREE_SIZE;
+}
+
+RC SlottedRecordPageHandler::check_slot(SlotNum slot_num) const
+{
+  if (slot_num < 0 || slot_num >= page_header_->slot_num) {
+    LOG_ERROR("Invalid slot_num:%d, exceed page's slot num, page_num %d.", slot_num, frame_->page_num());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  if (slots_[slot_num].offset == 0) {
+    LOG_DEBUG("Invalid slot_num:%d, slot is empty, page_num %d.", slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+  return RC::SUCCESS;
+}
+
+int SlottedRecordPageHandler::contiguous_free_space() const
+{
+  return page_header_->data_offset - SLOTTED_PAGE_HEADER_SIZE - page_header_->slot_num * sizeof(RecordSlot);
+}
+
+bool SlottedRecordPageHandler::reserve_space(int size)
+{
+  if (contiguous_free_space() >= size) {
+    return true;
+  }
+
+  if (contiguous_free_space() + page_header_->garbage_size < size) {
+    return false;
+  }
+
+  compact();
+  return contiguous_free_space() >= size;
+}
+
+void SlottedRecordPageHandler::compact()
+{
+  char  buffer[BP_PAGE_DATA_SIZE];
+  char *data   = frame_->data();
+  int   offset = BP_PAGE_DATA_SIZE;
+  for (SlotNum slot_num = 0; slot_num < page_header_->slot_num; slot_num++) {
+    RecordSlot &slot = slots_[slot_num];
+    if (slot.offset == 0) {
+      continue;
+    }
+
+    offset -= slot.inline_len;
+    memcpy(buffer + offset, data + slot.offset, slot.inline_len);
+    slot.offset = static_cast<uint16_t>(offset);
+  }
+
+  memcpy(data + offset, buffer + offset, BP_PAGE_DATA_SIZE - offset);
+  page_header_->data_offset  = offset;
+  page_header_->garbage_size = 0;
+  frame_->mark_dirty();
+}
+
+RC SlottedRecordPageHandler::write_record(SlotNum slot_num, const char *data, int data_len)
+{
+  const int inline_len    = inline_size(data_len);
+  PageNum   overflow_page = BP_INVALID_PAGE_NUM;
+  if (data_len > inline_len) {
+    RC rc = write_overflow(data + inline_len, data_len - inline_len, overflow_page);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  RecordSlot &slot = slots_[slot_num];
+  write_inline(slot, data, inline_len);
+  slot.overflow_page = overflow_page;
+  slot.overflow_len  = data_len - inline_len;
+
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+void SlottedRecordPageHandler::write_inline(RecordSlot &slot, const char *data, int inline_len)
+{
+  page_header_->data_offset -= inline_len;
+  memcpy(frame_->data() + page_header_->data_offset, data, inline_len);
+  slot.offset     = static_cast<uint16_t>(page_header_->data_offset);
+  slot.inline_len = static_cast<uint16_t>(inline_len);
+}
+
+/**
+ * @details 从最后一段数据开始倒着写，这样每个页面写入时就已经知道下一个页面的页号。
+ * 溢出页的修改不记录日志，所以写完之后立即刷盘，记录页落盘时它引用的溢出页一定已经在磁盘上了。
+ */
+RC SlottedRecordPageHandler::write_overflow(const char *data, int data_len, PageNum &first_page)
+{
+  const int page_count = (data_len + OVERFLOW_PAGE_DATA_SIZE - 1) / OVERFLOW_PAGE_DATA_SIZE;
+  PageNum   next_page  = BP_INVALID_PAGE_NUM;
+  for (int i = page_count - 1; i >= 0; i--) {
+    Frame *frame = nullptr;
+    RC     rc    = disk_buffer_pool_->allocate_page(&frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate overflow page. rc=%s", strrc(rc));
+      free_overflow(next_page);
+      return rc;
+    }
+
+    const int offset = i * OVERFLOW_PAGE_DATA_SIZE;
+    const int len    = min(data_len - offset, OVERFLOW_PAGE_DATA_SIZE);
+
+    frame->write_latch();
+    OverflowPageHeader *header = reinterpret_cast<OverflowPageHeader *>(frame->data());
+    header->magic              = OVERFLOW_PAGE_MAGIC;
+    header->next_page          = next_page;
+    header->data_len           = len;
+    memcpy(frame->data() + sizeof(OverflowPageHeader), data + offset, len);
+    frame->mark_dirty();
+    rc = disk_buffer_pool_->flush_page(*frame);
+    frame->write_unlatch();
+
+    next_page = frame->page_num();
+    disk_buffer_pool_->unpin_page(frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to flush overflow page. page num=%d, rc=%s", next_page, strrc(rc));
+      free_overflow(next_page);
+      return rc;
+    }
+  }
+
+  first_page = next_page;
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::read_overflow(PageNum first_page, char *buffer, int data_len)
+{
+  int     offset   = 0;
+  PageNum page_num = first_page;
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    Frame *frame = nullptr;
+    RC     rc    = disk_buffer_pool_->get_this_page(page_num, &frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get overflow page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    frame->read_latch();
+    const OverflowPageHeader *header = reinterpret_cast<const OverflowPageHeader *>(frame->data());
+    const bool valid = header->magic == OVERFLOW_PAGE_MAGIC && header->data_len <= data_len - offset;
+    if (valid) {
+      memcpy(buffer + offset, frame->data() + sizeof(OverflowPageHeader), header->data_len);
+      offset += header->data_len;
+      page_num = header->next_page;
+    }
+    frame->read_unlatch();
+    disk_buffer_pool_->unpin_page(frame);
+
+    if (!valid) {
+      LOG_WARN("invalid overflow page. page num=%d", page_num);
+      return RC::INTERNAL;
+    }
+  }
+
+  if (offset != data_len) {
+    LOG_WARN("overflow data is incomplete. expect=%d, got=%d", data_len, offset);
+    return RC::INTERNAL;
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::free_overflow(PageNum first_page)
+{
+  PageNum page_num = first_page;
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    Frame *frame = nullptr;
+    RC     rc    = disk_buffer_pool_->get_this_page(page_num, &frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get overflow page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    const OverflowPageHeader *header    = reinterpret_cast<const OverflowPageHeader *>(frame->data());
+    const bool                valid     = header->magic == OVERFLOW_PAGE_MAGIC;
+    const PageNum             next_page = header->next_page;
+    disk_buffer_pool_->unpin_page(frame);
+    if (!valid) {
+      LOG_WARN("invalid overflow page. page num=%d", page_num);
+      return RC::INTERNAL;
+    }
+
+    // 页面还在 buffer pool 中，可以直接释放
+    rc = disk_buffer_pool_->dispose_page(page_num);
+    if (OB_FAIL(rc)) {
+      // 释放失败只是浪费了一个页面
+      LOG_WARN("failed to dispose overflow page. page num=%d, rc=%s", page_num, strrc(rc));
+    }
+    page_num = next_page;
+  }
+  return RC::SUCCESS;
+}
@@ -0,0 +1,149 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "storage/record/record_manager.h"
+
+/**
+ * @brief 变长记录页面的页头
+ * @ingroup RecordManager
+ * @details record_num 放在第一个字段，与定长记录页一样不会是负数，可以与空闲空间映射页和溢出页区分开。
+ */
+struct SlottedPageHeader
+{
+  int32_t record_num;    ///< 当前页面记录的个数
+  int32_t slot_num;      ///< 槽位数组的长度，包括已经删除的空槽位
+  int32_t data_offset;   ///< 记录数据从页尾向前存放，这是最前面一条记录数据的位置
+  int32_t garbage_size;  ///< 删除或缩短记录留下的空洞大小，整理页面之后可以再次使用
+};
+
+/**
+ * @brief 变长记录页面上的槽位，记录了某条记录的数据在页面中的位置
+ * @details 记录的 slot_num 就是槽位数组的下标，整理页面时只移动数据，不改变槽位，所以 RID 保持不变。
+ * 超过 SLOTTED_MAX_INLINE_SIZE 的记录，前面一部分放在页面中，剩下的放到溢出页的链表中。
+ */
+struct RecordSlot
+{
+  uint16_t offset;         ///< 记录数据在页面中的偏移，0表示空槽位
+  uint16_t inline_len;     ///< 在当前页面中存放的长度
+  PageNum  overflow_page;  ///< 第一个溢出页，没有时是 BP_INVALID_PAGE_NUM
+  int32_t  overflow_len;   ///< 放在溢出页中的长度
+};
+
+/**
+ * @brief 溢出页的页头
+ */
+struct OverflowPageHeader
+{
+  int32_t magic;      ///< 固定为 OVERFLOW_PAGE_MAGIC
+  PageNum next_page;  ///< 下一个溢出页，没有时是 BP_INVALID_PAGE_NUM
+  int32_t data_len;   ///< 当前页面存放的数据长度
+};
+
+static constexpr int32_t OVERFLOW_PAGE_MAGIC     = -0x4f5646;  ///< "OVF"，取负数与记录页区分开
+static constexpr int     OVERFLOW_PAGE_DATA_SIZE = BP_PAGE_DATA_SIZE - sizeof(OverflowPageHeader);
+
+/// 一条记录最多在页面中存放多少字节，超出的部分放到溢出页中，保证一个页面至少能放下几条记录
+static constexpr int SLOTTED_MAX_INLINE_SIZE = BP_PAGE_DATA_SIZE / 4;
+/// 页面剩余空间小于这个值时认为页面已经满了，不再作为插入的候选页面
+static constexpr int SLOTTED_MIN_FREE_SIZE = 128;
+
+/**
+ * @brief 变长记录的页面(slotted page)
+ * @ingroup RecordManager
+ * @details 页面的组织大概是这样的：
+ * @code
+ * | SlottedPageHeader | slot0 | slot1 | ... | slotN | ---> free space <--- | recordN | ... | record1 | record0 |
+ * @endcode
+ * 槽位数组从页头之后向后增长，记录数据从页尾向前增长，中间是空闲空间。
+ * 删除记录只是把槽位置空，留下的空洞记在 garbage_size 中，空闲空间不够时再整理页面，把所有记录数据挪到页尾。
+ */
+class SlottedRecordPageHandler : public RecordPageHandler
+{
+public:
+  SlottedRecordPageHandler()          = default;
+  virtual ~SlottedRecordPageHandler() = default;
+
+  RC init_empty_page(
+      DiskBufferPool &buffer_pool, PageNum page_num, int record_size, const TableMeta *table_meta) override;
+
+  RC insert_record(const char *data, int data_len, RID *rid) override;
+  RC recover_insert_record(const char *data, int data_len, const RID &rid) override;
+  RC delete_record(const RID *rid) override;
+  RC update_record(const RID &rid, const char *data, int data_len) override;
+
+  /**
+   * @copydoc RecordPageHandler::get_record
+   * @note 有溢出页的记录会复制到 rec 自己管理的内存中
+   */
+  RC get_record(const RID *rid, Record *rec) override;
+
+  SlotNum next_record_slot(SlotNum start_slot_num) const override;
+  bool    is_full() const override;
+
+  /**
+   * @brief 判断页面数据是否是溢出页
+   */
+  static bool is_overflow_page(const char *page_data)
+  {
+    return reinterpret_cast<const OverflowPageHeader *>(page_data)->magic == OVERFLOW_PAGE_MAGIC;
+  }
+
+protected:
+  void init_page_layout() override;
+
+private:
+  /**
+   * @brief 检查槽位是否存在并且有记录
+   */
+  RC check_slot(SlotNum slot_num) const;
+
+  /**
+   * @brief 槽位数组和记录数据之间连续的空闲空间
+   */
+  int contiguous_free_space() const;
+
+  /**
+   * @brief 确保有 size 字节连续的空闲空间，必要时整理页面
+   * @return 整理之后空间还是不够，返回 false
+   */
+  bool reserve_space(int size);
+
+  /**
+   * @brief 整理页面，把所有记录数据紧凑地挪到页尾，消除空洞
+   */
+  void compact();
+
+  /**
+   * @brief 把记录写入指定的槽位，调用前需要预留好空间
+   */
+  RC write_record(SlotNum slot_num, const char *data, int data_len);
+
+  /**
+   * @brief 在连续的空闲空间中放入记录在页面中存放的部分，并设置到槽位上
+   */
+  void write_inline(RecordSlot &slot, const char *data, int inline_len);
+
+  RC write_overflow(const char *data, int data_len, PageNum &first_page);
+  RC read_overflow(PageNum first_page, char *buffer, int data_len);
+  RC free_overflow(PageNum first_page);
+
+  static int inline_size(int data_len)
+  {
+    return data_len < SLOTTED_MAX_INLINE_SIZE ? data_len : SLOTTED_MAX_INLINE_SIZE;
+  }
+
+private:
+  SlottedPageHeader *page_header_ = nullptr;  ///< 当前页面上页面头
+  RecordSlot        *slots_       = nullptr;  ///< 当前页面上的槽位数组
+};
@@ -52,7 +52,7 @@ Table::~Table()
 }
 
 RC Table::create(int32_t table_id, const char *path, const char *name, const char *base_dir, int attribute_count,
-    const AttrInfoSqlNode attributes[])
+    const AttrInfoSqlNode attributes[], StorageFormat storage_format)
 {
   if (table_id < 0) {
     LOG_WARN("invalid table id. table_id=%d, table_name=%s", table_id, name);
@@ -87,7 +87,7 @@ RC Table::create(int32_t table_id, const char *path, const char *name, const cha
   close(fd);
 
   // 创建文件
-  if ((rc = table_meta_.init(table_id, name, attribute_count, attributes)) != RC::SUCCESS) {
+  if ((rc = table_meta_.init(table_id, name, attribute_count, attributes, storage_format)) != RC::SUCCESS) {
     LOG_ERROR("Failed to init table meta. name:%s, ret:%d", name, rc);
     return rc;  // delete table file
   }
@@ -154,19 +154,24 @@ RC Table::open(const char *meta_file, const char *base_dir)
   const int index_num = table_meta_.index_num();
   for (int i = 0; i < index_num; i++) {
     const IndexMeta *index_meta = table_meta_.index(i);
-    const FieldMeta *field_meta = table_meta_.field(index_meta->field());
-    if (field_meta == nullptr) {
-      LOG_ERROR("Found invalid index meta info which has a non-exists field. table=%s, index=%s, field=%s",
-                name(), index_meta->name(), index_meta->field());
-      // skip cleanup
-      //  do all cleanup action in destructive Table function
-      return RC::INTERNAL;
+
+    std::vector<FieldMeta> field_metas;
+    for (int field_idx = 0; field_idx < index_meta->field_num(); field_idx++) {
+      const FieldMeta *field_meta = table_meta_.field(index_meta->field(field_idx));
+      if (field_meta == nullptr) {
+        LOG_ERROR("Found invalid index meta info which has a non-exists field. table=%s, index=%s, field=%s",
+                  name(), index_meta->name(), index_meta->field(field_idx));
+        // skip cleanup
+        //  do all cleanup action in destructive Table function
+        return RC::INTERNAL;
+      }
+      field_metas.push_back(*field_meta);
     }
 
     BplusTreeIndex *index      = new BplusTreeIndex();
     std::string     index_file = table_index_file(base_dir, name(), index_meta->name());
 
-    rc = index->open(index_file.c_str(), *index_meta, *field_meta);
+    rc = index->open(index_file.c_str(), *index_meta, field_metas);
     if (rc != RC::SUCCESS) {
       delete index;
       LOG_ERROR("Failed to open index. table=%s, index=%s, file=%s, rc=%s",
@@ -211,6 +216,12 @@ RC Table::visit_record(const RID &rid, bool readonly, std::function<void(Record
   return record_handler_->visit_record(rid, readonly, visitor);
 }
 
+RC Table::visit_records(
+    PageNum page_num, const std::vector<SlotNum> &slot_nums, bool readonly, std::function<void(Record &)> visitor)
+{
+  return record_handler_->visit_records(page_num, slot_nums, readonly, visitor);
+}
+
 /**
  * 从表中获取指定记录。
  * 
@@ -325,7 +336,7 @@ RC Table::init_record_handler(const char *base_dir)
 
   record_handler_ = new RecordFileHandler();
 
-  rc = record_handler_->init(data_buffer_pool_);
+  rc = record_handler_->init(data_buffer_pool_, &table_meta_);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to init record handler. rc=%s", strrc(rc));
     data_buffer_pool_->close_file();
@@ -352,19 +363,29 @@ RC Table::set_table_mete(TableMeta new_table_meta) {
   return RC::SUCCESS;
 }
 
-RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name)
+RC Table::create_index(
+    Trx *trx, const std::vector<const FieldMeta *> &field_metas, const char *index_name, bool unique /* = false */)
 {
-  if (common::is_blank(index_name) || nullptr == field_meta) {
+  if (common::is_blank(index_name) || field_metas.empty()) {
     LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", name());
     return RC::INVALID_ARGUMENT;
   }
 
+  std::vector<FieldMeta> index_fields;
+  for (const FieldMeta *field_meta : field_metas) {
+    if (nullptr == field_meta) {
+      LOG_INFO("Invalid input arguments, table name is %s, index_name is %s, field is null", name(), index_name);
+      return RC::INVALID_ARGUMENT;
+    }
+    index_fields.push_back(*field_meta);
+  }
+
   IndexMeta new_index_meta;
 
-  RC rc = new_index_meta.init(index_name, *field_meta);
+  RC rc = new_index_meta.init(index_name, field_metas, unique);
   if (rc != RC::SUCCESS) {
     LOG_INFO("Failed to init IndexMeta in table:%s, index_name:%s, field_name:%s", 
-             name(), index_name, field_meta->name());
+             name(), index_name, field_metas[0]->name());
     return rc;
   }
 
@@ -372,7 +393,7 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
   BplusTreeIndex *index      = new BplusTreeIndex();
   std::string     index_file = table_index_file(base_dir_.c_str(), name(), index_name);
 
-  rc = index->create(index_file.c_str(), new_index_meta, *field_meta);
+  rc = index->create(index_file.c_str(), new_index_meta, index_fields);
   if (rc != RC::SUCCESS) {
     delete index;
     LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
@@ -388,20 +409,16 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
     return rc;
   }
 
-  Record record;
-  while (scanner.has_next()) {
-    rc = scanner.next(record);
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to scan records while creating index. table=%s, index=%s, rc=%s",
-               name(), index_name, strrc(rc));
-      return rc;
-    }
-    rc = index->insert_entry(record.data(), &record.rid());
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to insert record into index while creating index. table=%s, index=%s, rc=%s",
-               name(), index_name, strrc(rc));
-      return rc;
-    }
+  // 先把键值排好序，再自底向上构建整棵树，比逐条插入快很多
+  rc = index->bulk_load(scanner, index_file + ".sort");
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to load records into index while creating index. table=%s, index=%s, rc=%s",
+             name(), index_name, strrc(rc));
+    // 唯一索引遇到重复的数据时会走到这里，把创建了一半的索引文件删掉，以后还可以重新创建
+    scanner.close_scan();
+    delete index;
+    unlink(index_file.c_str());
+    return rc;
   }
   scanner.close_scan();
   LOG_INFO("inserted all records into new index. table=%s, index=%s", name(), index_name);
@@ -416,6 +433,21 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
     return rc;
   }
 
+  rc = write_table_meta(new_table_meta);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to write table meta while creating index (%s) on table (%s). rc=%s",
+              index_name, name(), strrc(rc));
+    return rc;  // 创建索引中途出错，要做还原操作
+  }
+
+  table_meta_.swap(new_table_meta);
+
+  LOG_INFO("Successfully added a new index (%s) on the table (%s)", index_name, name());
+  return rc;
+}
+
+RC Table::write_table_meta(const TableMeta &new_table_meta)
+{
   /// 内存中有一份元数据，磁盘文件也有一份元数据。修改磁盘文件时，先创建一个临时文件，写入完成后再rename为正式文件
   /// 这样可以防止文件内容不完整
   // 创建元数据临时文件
@@ -424,7 +456,7 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
   fs.open(tmp_file, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
   if (!fs.is_open()) {
     LOG_ERROR("Failed to open file for write. file name=%s, errmsg=%s", tmp_file.c_str(), strerror(errno));
-    return RC::IOERR_OPEN;  // 创建索引中途出错，要做还原操作
+    return RC::IOERR_OPEN;
   }
   if (new_table_meta.serialize(fs) < 0) {
     LOG_ERROR("Failed to dump new table meta to file: %s. sys err=%d:%s", tmp_file.c_str(), errno, strerror(errno));
@@ -437,15 +469,42 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
 
   int ret = rename(tmp_file.c_str(), meta_file.c_str());
   if (ret != 0) {
-    LOG_ERROR("Failed to rename tmp meta file (%s) to normal meta file (%s) while creating index (%s) on table (%s). "
-              "system error=%d:%s",
-              tmp_file.c_str(), meta_file.c_str(), index_name, name(), errno, strerror(errno));
+    LOG_ERROR("Failed to rename tmp meta file (%s) to normal meta file (%s) on table (%s). system error=%d:%s",
+              tmp_file.c_str(), meta_file.c_str(), name(), errno, strerror(errno));
     return RC::IOERR_WRITE;
   }
+  return RC::SUCCESS;
+}
 
-  table_meta_.swap(new_table_meta);
+RC Table::compress()
+{
+  const StorageFormat storage_format = table_meta_.storage_format();
+  if (storage_format != StorageFormat::FIXED_FORMAT && storage_format != StorageFormat::COMPRESSED_FORMAT) {
+    LOG_WARN("only fixed format table can be compressed. table=%s, storage format=%s",
+             name(), storage_format_name(storage_format));
+    return RC::INVALID_ARGUMENT;
+  }
 
-  LOG_INFO("Successfully added a new index (%s) on the table (%s)", index_name, name());
+  if (storage_format == StorageFormat::FIXED_FORMAT) {
+    TableMeta new_table_meta(table_meta_);
+    new_table_meta.set_storage_format(StorageFormat::COMPRESSED_FORMAT);
+
+    RC rc = write_table_meta(new_table_meta);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to write table meta while compressing table (%s). rc=%s", name(), strrc(rc));
+      return rc;
+    }
+    table_meta_.swap(new_table_meta);
+  }
+
+  // 已经是压缩格式的表也重新压缩一遍，把追加区域中的记录也压缩进去
+  RC rc = record_handler_->compress();
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to compress record file. table=%s, rc=%s", name(), strrc(rc));
+    return rc;
+  }
+
+  LOG_INFO("Successfully compressed table (%s)", name());
   return rc;
 }
 
@@ -462,6 +521,30 @@ RC Table::delete_record(const Record &record)
   return rc;
 }
 
+RC Table::delete_records(const std::vector<Record> &records)
+{
+  if (records.empty()) {
+    return RC::SUCCESS;
+  }
+
+  const PageNum        page_num = records.front().rid().page_num;
+  std::vector<SlotNum> slot_nums;
+  slot_nums.reserve(records.size());
+  for (const Record &record : records) {
+    ASSERT(record.rid().page_num == page_num, "records to delete should be in the same page. page_num=%d, rid=%s",
+           page_num, record.rid().to_string().c_str());
+
+    for (Index *index : indexes_) {
+      RC rc = index->delete_entry(record.data(), &record.rid());
+      ASSERT(RC::SUCCESS == rc,
+             "failed to delete entry from index. table name=%s, index name=%s, rid=%s, rc=%s",
+             name(), index->index_meta().name(), record.rid().to_string().c_str(), strrc(rc));
+    }
+    slot_nums.push_back(record.rid().slot_num);
+  }
+  return record_handler_->delete_records(page_num, slot_nums);
+}
+
 RC Table::insert_entry_of_indexes(const char *record, const RID &rid)
 {
   RC rc = RC::SUCCESS;
@@ -521,6 +604,14 @@ RC Table::sync()
       return rc;
     }
   }
+
+  if (data_buffer_pool_ != nullptr) {
+    rc = data_buffer_pool_->flush_all_pages();
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to flush table's data pages. table=%s, rc=%d:%s", name(), rc, strrc(rc));
+      return rc;
+    }
+  }
   LOG_INFO("Sync table over. table=%s", name());
   return rc;
 }
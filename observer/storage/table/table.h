@@ -46,9 +46,10 @@ public:
    * @param base_dir 表数据存放的路径
    * @param attribute_count 字段个数
    * @param attributes 字段
+   * @param storage_format 记录在页面上的存储格式
    */
   RC create(int32_t table_id, const char *path, const char *name, const char *base_dir, int attribute_count,
-      const AttrInfoSqlNode attributes[]);
+      const AttrInfoSqlNode attributes[], StorageFormat storage_format = StorageFormat::FIXED_FORMAT);
 
 
   /**
@@ -75,14 +76,37 @@ public:
   RC insert_record(Record &record);
   RC delete_record(const Record &record);
   RC visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor);
+
+  /**
+   * @brief 删除同一个页面上的一批记录
+   * @details 索引项还是逐条删除，表数据页面只加一次锁
+   * @param records 要删除的记录，必须都在同一个页面上
+   */
+  RC delete_records(const std::vector<Record> &records);
+
+  /**
+   * @brief 访问同一个页面上的一批记录，参考 RecordFileHandler::visit_records
+   */
+  RC visit_records(PageNum page_num, const std::vector<SlotNum> &slot_nums, bool readonly,
+      std::function<void(Record &)> visitor);
   RC get_record(const RID &rid, Record &record);
 
   RC recover_insert_record(Record &record);
 
 
   RC set_table_mete(TableMeta new_table_meta);
-  // TODO refactor
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name);
+
+  /**
+   * @brief 把表切换成压缩格式，并压缩已有的数据页面
+   * @details 只有定长格式的表可以压缩，之后写满的页面也会自动压缩
+   */
+  RC compress();
+  /**
+   * @brief 创建索引，多个字段时按照给定的顺序组成联合索引的键值
+   * @param unique 是否是唯一索引，已有的数据中有重复的键值时返回 RECORD_DUPLICATE_KEY
+   */
+  RC create_index(
+      Trx *trx, const std::vector<const FieldMeta *> &field_metas, const char *index_name, bool unique = false);
 
   RC get_record_scanner(RecordFileScanner &scanner, Trx *trx, bool readonly);
 
@@ -105,10 +129,17 @@ private:
 private:
   RC init_record_handler(const char *base_dir);
 
+  /**
+   * @brief 把新的元数据写到元数据文件中
+   */
+  RC write_table_meta(const TableMeta &new_table_meta);
+
 public:
   Index *find_index(const char *index_name) const;
   Index *find_index_by_field(const char *field_name) const;
 
+  const std::vector<Index *> &indexes() const { return indexes_; }
+
 private:
   std::string          base_dir_;
   TableMeta            table_meta_;
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <algorithm>
+#include <strings.h>
 #include <common/lang/string.h>
 
 #include "common/log/log.h"
@@ -26,13 +27,36 @@ static const Json::StaticString FIELD_TABLE_ID("table_id");
 static const Json::StaticString FIELD_TABLE_NAME("table_name");
 static const Json::StaticString FIELD_FIELDS("fields");
 static const Json::StaticString FIELD_INDEXES("indexes");
+static const Json::StaticString FIELD_STORAGE_FORMAT("storage_format");
+
+static const char *STORAGE_FORMAT_NAMES[] = {"unknown", "fixed", "slotted", "pax", "compressed"};
+
+const char *storage_format_name(StorageFormat format)
+{
+  const int index = static_cast<int>(format);
+  if (index < 0 || index >= static_cast<int>(sizeof(STORAGE_FORMAT_NAMES) / sizeof(STORAGE_FORMAT_NAMES[0]))) {
+    return STORAGE_FORMAT_NAMES[0];
+  }
+  return STORAGE_FORMAT_NAMES[index];
+}
+
+StorageFormat storage_format_from_name(const char *name)
+{
+  for (size_t i = 1; i < sizeof(STORAGE_FORMAT_NAMES) / sizeof(STORAGE_FORMAT_NAMES[0]); i++) {
+    if (0 == strcasecmp(name, STORAGE_FORMAT_NAMES[i])) {
+      return static_cast<StorageFormat>(i);
+    }
+  }
+  return StorageFormat::UNKNOWN_FORMAT;
+}
 
 TableMeta::TableMeta(const TableMeta &other)
     : table_id_(other.table_id_),
       name_(other.name_),
       fields_(other.fields_),
       indexes_(other.indexes_),
-      record_size_(other.record_size_)
+      record_size_(other.record_size_),
+      storage_format_(other.storage_format_)
 {}
 
 void TableMeta::swap(TableMeta &other) noexcept
@@ -41,9 +65,11 @@ void TableMeta::swap(TableMeta &other) noexcept
   fields_.swap(other.fields_);
   indexes_.swap(other.indexes_);
   std::swap(record_size_, other.record_size_);
+  std::swap(storage_format_, other.storage_format_);
 }
 
-RC TableMeta::init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[])
+RC TableMeta::init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[],
+    StorageFormat storage_format /*= StorageFormat::FIXED_FORMAT*/)
 {
   if (common::is_blank(name)) {
     LOG_ERROR("Name cannot be empty");
@@ -89,8 +115,9 @@ RC TableMeta::init(int32_t table_id, const char *name, int field_num, const Attr
 
   record_size_ = field_offset;
 
-  table_id_ = table_id;
-  name_     = name;
+  table_id_       = table_id;
+  name_           = name;
+  storage_format_ = storage_format;
   LOG_INFO("Sussessfully initialized table meta. table id=%d, name=%s", table_id, name);
   return RC::SUCCESS;
 }
@@ -194,6 +221,8 @@ int TableMeta::serialize(std::ostream &ss) const
   }
   table_value[FIELD_INDEXES] = std::move(indexes_value);
 
+  table_value[FIELD_STORAGE_FORMAT] = storage_format_name(storage_format_);
+
   Json::StreamWriterBuilder builder;
   Json::StreamWriter       *writer = builder.newStreamWriter();
 
@@ -262,6 +291,20 @@ int TableMeta::deserialize(std::istream &is)
   fields_.swap(fields);
   record_size_ = fields_.back().offset() + fields_.back().len() - fields_.begin()->offset();
 
+  // 旧版本的元数据中没有存储格式，都是定长记录
+  StorageFormat      storage_format       = StorageFormat::FIXED_FORMAT;
+  const Json::Value &storage_format_value = table_value[FIELD_STORAGE_FORMAT];
+  if (!storage_format_value.isNull()) {
+    if (storage_format_value.isString()) {
+      storage_format = storage_format_from_name(storage_format_value.asCString());
+    }
+    if (!storage_format_value.isString() || storage_format == StorageFormat::UNKNOWN_FORMAT) {
+      LOG_ERROR("Invalid storage format. json value=%s", storage_format_value.toStyledString().c_str());
+      return -1;
+    }
+  }
+  storage_format_ = storage_format;
+
   const Json::Value &indexes_value = table_value[FIELD_INDEXES];
   if (!indexes_value.empty()) {
     if (!indexes_value.isArray()) {
@@ -19,6 +19,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/serializable.h"
 #include "common/rc.h"
+#include "common/types.h"
 #include "storage/field/field_meta.h"
 #include "storage/index/index_meta.h"
 
@@ -36,7 +37,8 @@ public:
 
   void swap(TableMeta &other) noexcept;
 
-  RC init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[]);
+  RC init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[],
+      StorageFormat storage_format = StorageFormat::FIXED_FORMAT);
 
   RC add_index(const IndexMeta &index);
 
@@ -60,6 +62,9 @@ public:
 
   int record_size() const;
 
+  StorageFormat storage_format() const { return storage_format_; }
+  void          set_storage_format(StorageFormat storage_format) { storage_format_ = storage_format; }
+
 public:
   int  serialize(std::ostream &os) const override;
   int  deserialize(std::istream &is) override;
@@ -74,4 +79,12 @@ protected:
   std::vector<IndexMeta> indexes_;
 
   int record_size_ = 0;
+
+  StorageFormat storage_format_ = StorageFormat::FIXED_FORMAT;
 };
+
+/**
+ * @brief 存储格式的名字，用于元数据和SQL语句中
+ */
+const char   *storage_format_name(StorageFormat format);
+StorageFormat storage_format_from_name(const char *name);
@@ -152,17 +152,42 @@ RC MvccTrx::delete_record(Table *table, Record &record)
   Field end_field;
   trx_fields(table, begin_field, end_field);
 
-  int32_t                  begin_xid = begin_field.get_int(record);
-  [[maybe_unused]] int32_t end_xid   = end_field.get_int(record);
-  /// 在删除之前，第一次获取record时，就已经对record做了对应的检查，并且保证不会有其它的事务来访问这条数据
-  ASSERT(end_xid > 0, "concurrency conflit: other transaction is updating this record. end_xid=%d, current trx id=%d, rid=%s",
-         end_xid, trx_id_, record.rid().to_string().c_str());
+  int32_t begin_xid = begin_field.get_int(record);
+  int32_t end_xid   = end_field.get_int(record);
+  if (end_xid <= 0) {
+    LOG_WARN("concurrency conflict: other transaction is deleting this record. end_xid=%d, current trx id=%d, rid=%s",
+             end_xid, trx_id_, record.rid().to_string().c_str());
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
   if (end_xid != trx_kit_.max_trx_id()) {
     // 当前不是多版本数据中的最新记录，不需要删除
     return RC::SUCCESS;
   }
 
   end_field.set_int(record, -trx_id_);
+  if (table->table_meta().storage_format() != StorageFormat::FIXED_FORMAT) {
+    // 变长记录扫描出来的是解码之后的副本，修改不会直接反映到页面上，需要写回去。
+    // 副本可能已经过时了，在页面的写锁内再检查一次有没有其它事务删除了它
+    bool conflict       = false;
+    auto record_updater = [this, &end_field, &conflict](Record &page_record) {
+      if (end_field.get_int(page_record) != trx_kit_.max_trx_id()) {
+        conflict = true;
+        return;
+      }
+      end_field.set_int(page_record, -trx_id_);
+    };
+    RC rc = table->visit_record(record.rid(), false /*readonly*/, record_updater);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to mark record deleted. rid=%s, rc=%s", record.rid().to_string().c_str(), strrc(rc));
+      return rc;
+    }
+    if (conflict) {
+      LOG_WARN("concurrency conflict: record was deleted by other transaction. current trx id=%d, rid=%s",
+               trx_id_, record.rid().to_string().c_str());
+      return RC::LOCKED_CONCURRENCY_CONFLICT;
+    }
+  }
+
   RC rc = log_manager_->append_log(CLogType::DELETE, trx_id_, table->table_id(), record.rid(), 0, 0, nullptr);
   ASSERT(rc == RC::SUCCESS, "failed to append delete record log. trx id=%d, table id=%d, rid=%s, record len=%d, rc=%s",
       trx_id_, table->table_id(), record.rid().to_string().c_str(), record.len(), strrc(rc));
@@ -190,6 +215,97 @@ RC MvccTrx::delete_record(Table *table, Record &record)
   return RC::SUCCESS;
 }
 
+RC MvccTrx::delete_records(Table *table, vector<Record> &records)
+{
+  if (records.empty()) {
+    return RC::SUCCESS;
+  }
+
+  Field begin_field;
+  Field end_field;
+  trx_fields(table, begin_field, end_field);
+
+  RC              rc       = RC::SUCCESS;
+  const PageNum   page_num = records.front().rid().page_num;
+  vector<SlotNum> slot_nums;
+  slot_nums.reserve(records.size());
+  for (Record &record : records) {
+    int32_t begin_xid = begin_field.get_int(record);
+    int32_t end_xid   = end_field.get_int(record);
+    if (end_xid <= 0) {
+      LOG_WARN("concurrency conflict: other transaction is deleting this record. end_xid=%d, current trx id=%d, rid=%s",
+               end_xid, trx_id_, record.rid().to_string().c_str());
+      return RC::LOCKED_CONCURRENCY_CONFLICT;
+    }
+    if (end_xid != trx_kit_.max_trx_id()) {
+      continue;
+    }
+
+    if (begin_xid == -trx_id_) {
+      // 当前事务自己插入的记录会直接物理删除，走单条删除的流程
+      rc = delete_record(table, record);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      continue;
+    }
+
+    ASSERT(record.rid().page_num == page_num, "records to delete should be in the same page. page_num=%d, rid=%s",
+           page_num, record.rid().to_string().c_str());
+    end_field.set_int(record, -trx_id_);
+    slot_nums.push_back(record.rid().slot_num);
+  }
+
+  if (slot_nums.empty()) {
+    return RC::SUCCESS;
+  }
+
+  // 扫描出来的记录可能是副本，统一在页面上修改一次。
+  // 副本可能已经过时了，在页面的写锁内再检查一次有没有其它事务删除了这些记录，发现冲突之后不再修改
+  vector<SlotNum> deleted_slots;
+  bool            conflict       = false;
+  auto            record_updater = [this, &end_field, &deleted_slots, &conflict](Record &page_record) {
+    if (conflict) {
+      return;
+    }
+    if (end_field.get_int(page_record) != trx_kit_.max_trx_id()) {
+      conflict = true;
+      return;
+    }
+    end_field.set_int(page_record, -trx_id_);
+    deleted_slots.push_back(page_record.rid().slot_num);
+  };
+  rc = table->visit_records(page_num, slot_nums, false /*readonly*/, record_updater);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to mark records deleted. page_num=%d, rc=%s", page_num, strrc(rc));
+  }
+
+  // 出错之前已经修改过的记录也要记日志和操作，事务回滚时才能恢复它们
+  if (!deleted_slots.empty()) {
+    RC log_rc = log_manager_->append_log(CLogType::DELETE_PAGE, trx_id_, table->table_id(), RID(page_num, -1),
+        static_cast<int32_t>(deleted_slots.size() * sizeof(SlotNum)), 0 /*offset*/,
+        reinterpret_cast<const char *>(deleted_slots.data()));
+    ASSERT(log_rc == RC::SUCCESS, "failed to append delete page log. trx id=%d, table id=%d, page_num=%d, count=%d, rc=%s",
+        trx_id_, table->table_id(), page_num, static_cast<int>(deleted_slots.size()), strrc(log_rc));
+
+    for (SlotNum slot_num : deleted_slots) {
+      pair<OperationSet::iterator, bool> ret =
+          operations_.insert(Operation(Operation::Type::DELETE, table, RID(page_num, slot_num)));
+      if (!ret.second) {
+        LOG_WARN("failed to insert operation(deletion) into operation set: duplicate");
+        return RC::INTERNAL;
+      }
+    }
+  }
+
+  if (OB_SUCC(rc) && conflict) {
+    LOG_WARN("concurrency conflict: records were deleted by other transaction. current trx id=%d, page_num=%d",
+             trx_id_, page_num);
+    rc = RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+  return rc;
+}
+
 RC MvccTrx::visit_record(Table *table, Record &record, bool readonly)
 {
   Field begin_field;
@@ -391,7 +507,8 @@ RC find_table(Db *db, const CLogRecord &log_record, Table *&table)
 {
   switch (clog_type_from_integer(log_record.header().type_)) {
     case CLogType::INSERT:
-    case CLogType::DELETE: {
+    case CLogType::DELETE:
+    case CLogType::DELETE_PAGE: {
       const CLogRecordData &data_record = log_record.data_record();
       table                             = db->find_table(data_record.table_id_);
       if (nullptr == table) {
@@ -436,12 +553,9 @@ RC MvccTrx::redo(Db *db, const CLogRecord &log_record)
       Field                 end_field;
       trx_fields(table, begin_field, end_field);
 
+      // 从检查点开始恢复时，页面中可能已经包含了这条日志之后的修改，比如删除已经提交了，
+      // 所以这里不检查 end xid，直接设置成当前事务正在删除，提交或回滚日志会再把它改成最终的状态
       auto record_updater = [this, &end_field](Record &record) {
-        (void)this;
-        ASSERT(end_field.get_int(record) == trx_kit_.max_trx_id(), 
-               "got an invalid record while committing. end xid=%d, this trx id=%d", 
-               end_field.get_int(record), trx_id_);
-
         end_field.set_int(record, -trx_id_);
       };
 
@@ -452,6 +566,29 @@ RC MvccTrx::redo(Db *db, const CLogRecord &log_record)
       operations_.insert(Operation(Operation::Type::DELETE, table, data_record.rid_));
     } break;
 
+    case CLogType::DELETE_PAGE: {
+      const CLogRecordData &data_record = log_record.data_record();
+      Field                 begin_field;
+      Field                 end_field;
+      trx_fields(table, begin_field, end_field);
+
+      // 与 DELETE 一样不检查 end xid，日志数据是这个页面上被删除的槽位号数组
+      const PageNum   page_num  = data_record.rid_.page_num;
+      const SlotNum  *slots     = reinterpret_cast<const SlotNum *>(data_record.data_);
+      vector<SlotNum> slot_nums(slots, slots + data_record.data_len_ / sizeof(SlotNum));
+
+      auto record_updater = [this, &end_field](Record &record) {
+        end_field.set_int(record, -trx_id_);
+      };
+
+      RC rc = table->visit_records(page_num, slot_nums, false /*readonly*/, record_updater);
+      ASSERT(rc == RC::SUCCESS, "failed to redo delete page. page_num=%d, rc=%s", page_num, strrc(rc));
+
+      for (SlotNum slot_num : slot_nums) {
+        operations_.insert(Operation(Operation::Type::DELETE, table, RID(page_num, slot_num)));
+      }
+    } break;
+
     case CLogType::MTR_COMMIT: {
       const CLogRecordCommitData &commit_record = log_record.commit_record();
       commit_with_trx_id(commit_record.commit_xid_);
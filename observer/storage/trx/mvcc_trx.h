@@ -69,6 +69,12 @@ public:
   RC insert_record(Table *table, Record &record) override;
   RC delete_record(Table *table, Record &record) override;
 
+  /**
+   * @brief 删除同一个页面上的一批记录
+   * @details 所有记录的 end xid 在一次页面锁内修改，只写一条 DELETE_PAGE 日志，日志内容是槽位号数组
+   */
+  RC delete_records(Table *table, std::vector<Record> &records) override;
+
   /**
    * @brief 当访问到某条数据时，使用此函数来判断是否可见，或者是否有访问冲突
    *
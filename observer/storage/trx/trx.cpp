@@ -58,4 +58,15 @@ RC TrxKit::init_global(const char *name)
 
 TrxKit *TrxKit::instance() { return global_trxkit; }
 
+RC Trx::delete_records(Table *table, std::vector<Record> &records)
+{
+  for (Record &record : records) {
+    RC rc = delete_record(table, record);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
 RC Trx::redo(Db *db, const CLogRecord &) { return RC::UNIMPLENMENT; }
@@ -141,6 +141,13 @@ public:
   virtual RC delete_record(Table *table, Record &record)               = 0;
   virtual RC visit_record(Table *table, Record &record, bool readonly) = 0;
 
+  /**
+   * @brief 删除同一个页面上的一批记录
+   * @details 默认逐条调用 delete_record，事务实现可以按页面合并加锁和日志
+   * @param records 要删除的记录，必须都在同一个页面上
+   */
+  virtual RC delete_records(Table *table, std::vector<Record> &records);
+
   virtual RC start_if_need() = 0;
   virtual RC commit()        = 0;
   virtual RC rollback()      = 0;